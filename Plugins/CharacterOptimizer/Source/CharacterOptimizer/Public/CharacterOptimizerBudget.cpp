@@ -0,0 +1,109 @@
+﻿#include "CharacterOptimizerBudget.h"
+
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Allocate Budget"), STAT_CharOptimizer_Allocate, STATGROUP_CharacterOptimizer);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Budget (ms)"), STAT_CharOptimizer_BudgetMs, STATGROUP_CharacterOptimizer);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Estimated Spent (ms)"), STAT_CharOptimizer_SpentMs, STATGROUP_CharacterOptimizer);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Chars Total"), STAT_CharOptimizer_NumTotal, STATGROUP_CharacterOptimizer);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Chars Full Rate"), STAT_CharOptimizer_NumFullRate, STATGROUP_CharacterOptimizer);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Chars Reduced Rate"), STAT_CharOptimizer_NumReducedRate, STATGROUP_CharacterOptimizer);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Chars Over Budget"), STAT_CharOptimizer_NumOverBudget, STATGROUP_CharacterOptimizer);
+
+namespace CharacterOptimizerBudget
+{
+	static int32 Enabled = 0;
+	static FAutoConsoleVariableRef CVarEnabled(
+		TEXT("CharacterOptimizer.Budget.Enabled"), Enabled,
+		TEXT("If 1, characters share per-frame budget by significance instead of using distance waves"),
+		ECVF_Default);
+
+	static float BudgetMs = 1.0f;
+	static FAutoConsoleVariableRef CVarBudgetMs(
+		TEXT("CharacterOptimizer.Budget.BudgetMs"), BudgetMs,
+		TEXT("Per-frame budget for animation and movement of all characters, ms"), ECVF_Default);
+
+	static int32 MaxUpdateRate = 8;
+	static FAutoConsoleVariableRef CVarMaxUpdateRate(
+		TEXT("CharacterOptimizer.Budget.MaxUpdateRate"), MaxUpdateRate,
+		TEXT("Least significant characters are updated once per this amount of frames"), ECVF_Default);
+
+	bool IsEnabled()
+	{
+		return Enabled != 0;
+	}
+
+	float GetBudgetMs()
+	{
+		return FMath::Max(BudgetMs, 0.0f);
+	}
+
+	int32 GetMaxUpdateRate()
+	{
+		return FMath::Max(MaxUpdateRate, 1);
+	}
+
+	FCharOptimizerBudgetResult Allocate(TArrayView<const FCharOptimizerBudgetRequest> Requests,
+	                                    TArrayView<int32> OutUpdateRates, const float InBudgetMs,
+	                                    const int32 InMaxUpdateRate)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_CharOptimizer_Allocate);
+		check(Requests.Num() == OutUpdateRates.Num());
+
+		const int32 MaxRate = FMath::Max(InMaxUpdateRate, 1);
+
+		// Everybody is guaranteed the max update rate, even if that alone doesn't fit into the budget
+		float MinCostMs = 0.0f;
+		for (const FCharOptimizerBudgetRequest& Request : Requests)
+		{
+			MinCostMs += Request.FullRateCostMs / MaxRate;
+		}
+
+		FCharOptimizerBudgetResult Result;
+		float RemainingMs = InBudgetMs - MinCostMs;
+
+		for (int32 Index = 0; Index < Requests.Num(); ++Index)
+		{
+			const float FullCostMs = Requests[Index].FullRateCostMs;
+			const float MinCharCostMs = FullCostMs / MaxRate;
+
+			int32 UpdateRate = MaxRate;
+			if (FullCostMs <= 0.0f || RemainingMs >= FullCostMs - MinCharCostMs)
+			{
+				UpdateRate = 1;
+			}
+			else if (RemainingMs > 0.0f)
+			{
+				// Most frequent rate whose extra cost still fits into what is left
+				UpdateRate = FMath::Clamp(FMath::CeilToInt(FullCostMs / (RemainingMs + MinCharCostMs)), 1, MaxRate);
+			}
+			else if (RemainingMs < 0.0f)
+			{
+				Result.NumOverBudget++;
+			}
+
+			const float CharCostMs = FullCostMs / UpdateRate;
+			RemainingMs -= CharCostMs - MinCharCostMs;
+			Result.EstimatedSpentMs += CharCostMs;
+
+			OutUpdateRates[Index] = UpdateRate;
+			if (UpdateRate == 1)
+			{
+				Result.NumFullRate++;
+			}
+			else
+			{
+				Result.NumReducedRate++;
+			}
+		}
+
+		SET_FLOAT_STAT(STAT_CharOptimizer_BudgetMs, InBudgetMs);
+		SET_FLOAT_STAT(STAT_CharOptimizer_SpentMs, Result.EstimatedSpentMs);
+		SET_DWORD_STAT(STAT_CharOptimizer_NumTotal, Requests.Num());
+		SET_DWORD_STAT(STAT_CharOptimizer_NumFullRate, Result.NumFullRate);
+		SET_DWORD_STAT(STAT_CharOptimizer_NumReducedRate, Result.NumReducedRate);
+		SET_DWORD_STAT(STAT_CharOptimizer_NumOverBudget, Result.NumOverBudget);
+
+		return Result;
+	}
+}
@@ -0,0 +1,58 @@
+﻿// Copyleft: All rights reversed
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+DECLARE_STATS_GROUP(TEXT("CharacterOptimizer"), STATGROUP_CharacterOptimizer, STATCAT_Advanced);
+
+/** Single character competing for the budget */
+struct FCharOptimizerBudgetRequest
+{
+	/** Significance of char, more significant chars are served first */
+	float Significance = 0.0f;
+
+	/** Estimated cost of updating animation and movement of char every frame, ms */
+	float FullRateCostMs = 0.0f;
+};
+
+/** How the budget was spent during one allocation */
+struct FCharOptimizerBudgetResult
+{
+	/** Estimated cost of all chars with allocated update rates, ms */
+	float EstimatedSpentMs = 0.0f;
+
+	/** Number of chars updated every frame */
+	int32 NumFullRate = 0;
+
+	/** Number of chars updated less often than every frame */
+	int32 NumReducedRate = 0;
+
+	/** Number of chars which got the max update rate and still didn't fit into the budget */
+	int32 NumOverBudget = 0;
+};
+
+/**
+ * Global per-frame budget for character animation and movement, distributed across characters by significance.
+ * Update rate N means that char is updated once every N frames.
+ */
+namespace CharacterOptimizerBudget
+{
+	/** Whether budgeted mode is used instead of distance waves */
+	CHARACTEROPTIMIZER_API bool IsEnabled();
+
+	/** Per-frame budget for all characters, ms */
+	CHARACTEROPTIMIZER_API float GetBudgetMs();
+
+	/** Update rate of the least significant characters */
+	CHARACTEROPTIMIZER_API int32 GetMaxUpdateRate();
+
+	/**
+	 * Fills update rate for each request. Requests must be sorted by descending significance: every char starts from
+	 * the max update rate and the remaining budget is then spent on chars in order of significance.
+	 */
+	CHARACTEROPTIMIZER_API FCharOptimizerBudgetResult Allocate(TArrayView<const FCharOptimizerBudgetRequest> Requests,
+	                                                           TArrayView<int32> OutUpdateRates, float BudgetMs,
+	                                                           int32 MaxUpdateRate);
+}
@@ -2,13 +2,11 @@
 
 #include "GameFramework/Character.h"
 #include "GameFramework/CharacterMovementComponent.h"
-#include "Kismet/GameplayStatics.h"
-#include "Kismet/KismetMathLibrary.h"
+#include "Components/SkeletalMeshComponent.h"
 
 UCharacterOptimizerComponent::UCharacterOptimizerComponent()
 {
-	PrimaryComponentTick.bCanEverTick = true;
-	PrimaryComponentTick.bAllowTickOnDedicatedServer = false;
+	PrimaryComponentTick.bCanEverTick = false;
 	bAutoRegister = true;
 	bAutoActivate = true;
 
@@ -19,6 +17,12 @@ UCharacterOptimizerComponent::UCharacterOptimizerComponent()
 	FirstWaveSettings = FCharOptimizationSettings{0.04f, 0.0f, false};
 	SecondWaveDistance = 15000.0f;
 	SecondWaveSettings = FCharOptimizationSettings{0.1, 0.0f, false};
+
+	MaxSignificanceDistance = 20000.0f;
+	NotInViewSignificanceScale = 0.25f;
+	EstimatedUpdateCostMs = 0.05f;
+	ClothSuspendUpdateRate = 3;
+	PhysicsSkipUpdateRate = 2;
 }
 
 void UCharacterOptimizerComponent::OnRegister()
@@ -31,89 +35,233 @@ void UCharacterOptimizerComponent::OnRegister()
 	}
 }
 
-void UCharacterOptimizerComponent::ApplyOptimizationSettingsToChar(FCharOptimizationSettings& Settings)
+bool UCharacterOptimizerComponent::IsOptimizationEnabled() const
 {
-	if (Char)
+	return Char && bOptimizationEnabled;
+}
+
+ECharOptimizationWave UCharacterOptimizerComponent::CalculateWave(const FTransform& Viewpoint,
+                                                                  const double ViewConeCos) const
+{
+	if (!Char || Char->IsLocallyControlled())
 	{
-		if (UCharacterMovementComponent* CMC = Char->GetCharacterMovement())
+		return ECharOptimizationWave::Zero;
+	}
+
+	const FVector ToChar = Char->GetActorLocation() - Viewpoint.GetLocation();
+	const double DistanceSquared = ToChar.SizeSquared();
+
+	if (DistanceSquared >= FMath::Square(NotInViewportDistance))
+	{
+		// Comparing squared values to avoid sqrt, sign of dot product has to be kept
+		const double Dot = FVector::DotProduct(ToChar, Viewpoint.GetRotation().GetForwardVector());
+		const bool bIsInView = Dot > 0 && Dot * Dot >= FMath::Square(ViewConeCos) * DistanceSquared;
+		if (!bIsInView)
 		{
-			if (CMC->GetComponentTickInterval() != Settings.CharMoveComponentTickInterval)
+			return ECharOptimizationWave::Second;
+		}
+	}
+
+	if (DistanceSquared < FMath::Square(FirstWaveDistance))
+	{
+		return ECharOptimizationWave::Zero;
+	}
+	if (DistanceSquared < FMath::Square(SecondWaveDistance))
+	{
+		return ECharOptimizationWave::First;
+	}
+	return ECharOptimizationWave::Second;
+}
+
+void UCharacterOptimizerComponent::ApplyWave(const ECharOptimizationWave Wave)
+{
+	if (!IsOptimizationEnabled() || (LastAppliedWave.IsSet() && LastAppliedWave.GetValue() == Wave))
+	{
+		return;
+	}
+
+	// Switching from budgeted mode, restore what waves don't control
+	if (LastAppliedUpdateRate.IsSet())
+	{
+		ApplyUpdateRate(1, 0.0f);
+		LastAppliedUpdateRate.Reset();
+	}
+
+	LastAppliedWave = Wave;
+	ApplyOptimizationSettingsToChar(GetWaveSettings(Wave));
+}
+
+float UCharacterOptimizerComponent::WaveToSignificance(const ECharOptimizationWave Wave)
+{
+	return static_cast<float>(ECharOptimizationWave::Second) - static_cast<float>(Wave);
+}
+
+ECharOptimizationWave UCharacterOptimizerComponent::SignificanceToWave(const float Significance)
+{
+	const int32 WaveIndex = FMath::Clamp(FMath::RoundToInt(static_cast<float>(ECharOptimizationWave::Second) - Significance),
+	                                     static_cast<int32>(ECharOptimizationWave::Zero),
+	                                     static_cast<int32>(ECharOptimizationWave::Second));
+	return static_cast<ECharOptimizationWave>(WaveIndex);
+}
+
+float UCharacterOptimizerComponent::CalculateSignificance(const FTransform& Viewpoint, const double ViewConeCos) const
+{
+	if (!Char || Char->IsLocallyControlled())
+	{
+		return 1.0f;
+	}
+
+	const FVector ToChar = Char->GetActorLocation() - Viewpoint.GetLocation();
+	const double Distance = ToChar.Size();
+	const float DistanceSignificance = MaxSignificanceDistance > 0.0
+		                                   ? 1.0f - FMath::Clamp(Distance / MaxSignificanceDistance, 0.0, 1.0)
+		                                   : 0.0f;
+
+	const bool bIsInView = Distance < NotInViewportDistance
+		|| FVector::DotProduct(ToChar, Viewpoint.GetRotation().GetForwardVector()) >= ViewConeCos * Distance;
+
+	return bIsInView ? DistanceSignificance : DistanceSignificance * NotInViewSignificanceScale;
+}
+
+void UCharacterOptimizerComponent::ApplyUpdateRate(int32 UpdateRate, const float FrameTime)
+{
+	UpdateRate = FMath::Max(UpdateRate, 1);
+	if (!IsOptimizationEnabled() || (LastAppliedUpdateRate.IsSet() && LastAppliedUpdateRate.GetValue() == UpdateRate))
+	{
+		return;
+	}
+
+	LastAppliedUpdateRate = UpdateRate;
+	LastAppliedWave.Reset();
+
+	// Half a frame of slack, so that interval is reached exactly on the UpdateRate-th frame
+	const float TickInterval = UpdateRate > 1 ? (UpdateRate - 0.5f) * FrameTime : 0.0f;
+
+	if (UCharacterMovementComponent* CMC = Char->GetCharacterMovement())
+	{
+		CMC->SetComponentTickInterval(TickInterval);
+	}
+
+	if (USkeletalMeshComponent* Mesh = Char->GetMesh())
+	{
+		ApplyUpdateRateToAnimation(Mesh, UpdateRate);
+		ApplyUpdateRateToMesh(Mesh, UpdateRate);
+
+		// Customization meshes attached to the main one
+		TArray<USceneComponent*> Children;
+		Mesh->GetChildrenComponents(true, Children);
+		for (USceneComponent* Child : Children)
+		{
+			if (USkeletalMeshComponent* ChildMesh = Cast<USkeletalMeshComponent>(Child))
 			{
-				CMC->SetComponentTickInterval(Settings.CharMoveComponentTickInterval);
+				ApplyUpdateRateToMesh(ChildMesh, UpdateRate);
 			}
 		}
+	}
+}
 
-		if (USkeletalMeshComponent* SkeletalMeshComponent = Char->GetMesh())
+void UCharacterOptimizerComponent::ApplyUpdateRateToAnimation(USkeletalMeshComponent* Mesh, const int32 UpdateRate)
+{
+	// Shared by all skinned meshes of the char
+	FAnimUpdateRateParameters* Params = Mesh->AnimUpdateRateParams;
+	if (!Params)
+	{
+		return;
+	}
+
+	if (UpdateRate > 1)
+	{
+		if (!SavedAnimUpdateRateParams.IsSet())
 		{
-			SkeletalMeshComponent->SetCastShadow(Settings.bShadowsTurnedOn);
+			SavedAnimUpdateRateParams = *Params;
 		}
+		const FAnimUpdateRateParameters& Saved = SavedAnimUpdateRateParams.GetValue();
 
-		if (Char->GetActorTickInterval() != Settings.CharTickInterval)
+		// Budgeted rate replaces distance based frame skipping of URO for every LOD, skipped frames are interpolated
+		Params->bShouldUseLodMap = true;
+		Params->LODToFrameSkipMap.Reset();
+		for (int32 LODIndex = 0; LODIndex < FMath::Max(Mesh->GetNumLODs(), 1); ++LODIndex)
 		{
-			Char->SetActorTickInterval(Settings.CharTickInterval);
+			Params->LODToFrameSkipMap.Add(LODIndex, UpdateRate - 1);
 		}
+		Params->BaseNonRenderedUpdateRate = FMath::Max(Saved.BaseNonRenderedUpdateRate, UpdateRate);
+		Params->bInterpolateSkippedFrames = true;
+		Params->MaxEvalRateForInterpolation = FMath::Max(Saved.MaxEvalRateForInterpolation, UpdateRate);
+	}
+	else if (SavedAnimUpdateRateParams.IsSet())
+	{
+		const FAnimUpdateRateParameters& Saved = SavedAnimUpdateRateParams.GetValue();
+		Params->bShouldUseLodMap = Saved.bShouldUseLodMap;
+		Params->LODToFrameSkipMap = Saved.LODToFrameSkipMap;
+		Params->BaseNonRenderedUpdateRate = Saved.BaseNonRenderedUpdateRate;
+		Params->bInterpolateSkippedFrames = Saved.bInterpolateSkippedFrames;
+		Params->MaxEvalRateForInterpolation = Saved.MaxEvalRateForInterpolation;
+		SavedAnimUpdateRateParams.Reset();
 	}
 }
 
-void UCharacterOptimizerComponent::TickComponent(float DeltaTime, ELevelTick TickType,
-                                                 FActorComponentTickFunction* ThisTickFunction)
+void UCharacterOptimizerComponent::ApplyUpdateRateToMesh(USkeletalMeshComponent* Mesh, const int32 UpdateRate) const
 {
-	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	const USkeletalMeshComponent* Archetype = CastChecked<USkeletalMeshComponent>(Mesh->GetArchetype());
+
+	// Animation is throttled by URO with parameters set by ApplyUpdateRateToAnimation, so it's interpolated
+	// instead of stepping like with tick interval
+	Mesh->bEnableUpdateRateOptimizations = UpdateRate > 1 || Archetype->bEnableUpdateRateOptimizations;
 
-	if (Char && bOptimizationEnabled)
+	const bool bSuspendCloth = UpdateRate >= ClothSuspendUpdateRate;
+	if (bSuspendCloth != Mesh->IsClothingSimulationSuspended())
 	{
-		if (Char->GetNetMode() >= NM_Client || Char->GetNetMode() == NM_Standalone)
+		if (bSuspendCloth)
 		{
-			if (const APlayerController* PlayerController = UGameplayStatics::GetPlayerController(GetWorld(), 0))
+			Mesh->SuspendClothingSimulation();
+		}
+		else
+		{
+			Mesh->ResumeClothingSimulation();
+		}
+	}
+
+	Mesh->KinematicBonesUpdateToPhysics = UpdateRate >= PhysicsSkipUpdateRate
+		                                      ? EKinematicBonesUpdateToPhysics::SkipAllBones
+		                                      : Archetype->KinematicBonesUpdateToPhysics.GetValue();
+}
+
+const FCharOptimizationSettings& UCharacterOptimizerComponent::GetWaveSettings(const ECharOptimizationWave Wave) const
+{
+	switch (Wave)
+	{
+	case ECharOptimizationWave::First:
+		return FirstWaveSettings;
+	case ECharOptimizationWave::Second:
+		return SecondWaveSettings;
+	default:
+		return ZeroWaveSettings;
+	}
+}
+
+void UCharacterOptimizerComponent::ApplyOptimizationSettingsToChar(const FCharOptimizationSettings& Settings)
+{
+	if (Char)
+	{
+		if (UCharacterMovementComponent* CMC = Char->GetCharacterMovement())
+		{
+			if (CMC->GetComponentTickInterval() != Settings.CharMoveComponentTickInterval)
 			{
-				FVector Loc;
-				FRotator Rot;
-				PlayerController->GetActorEyesViewPoint(Loc, Rot);
-
-				FVector2D ScreenLocation;
-				PlayerController->ProjectWorldLocationToScreen(Char->GetActorLocation(), ScreenLocation);
-
-				bool bIsInViewport;
-				if (const UGameViewportClient* GameViewportClient = GetWorld()->GetGameViewport())
-				{
-					FVector2D ViewportSize;
-					GameViewportClient->GetViewportSize(ViewportSize);
-					bIsInViewport = ScreenLocation.X > 0 && ScreenLocation.Y > 0 && ScreenLocation.X < ViewportSize.X
-						&& ScreenLocation.Y < ViewportSize.Y;
-				}
-				else
-				{
-					bIsInViewport = true;
-				}
-
-				const double VectorDistance = UKismetMathLibrary::Vector_Distance(Loc, Char->GetActorLocation());
-
-				FCharOptimizationSettings Settings;
-				if (Char->IsLocallyControlled())
-				{
-					Settings = ZeroWaveSettings;
-				}
-				else if (!bIsInViewport && VectorDistance >= NotInViewportDistance)
-				{
-					Settings = SecondWaveSettings;
-				}
-				else
-				{
-					if (VectorDistance < FirstWaveDistance)
-					{
-						Settings = ZeroWaveSettings;
-					}
-					else if (VectorDistance < SecondWaveDistance)
-					{
-						Settings = FirstWaveSettings;
-					}
-					else
-					{
-						Settings = SecondWaveSettings;
-					}
-				}
-				ApplyOptimizationSettingsToChar(Settings);
+				CMC->SetComponentTickInterval(Settings.CharMoveComponentTickInterval);
+			}
+		}
+
+		if (USkeletalMeshComponent* SkeletalMeshComponent = Char->GetMesh())
+		{
+			if (SkeletalMeshComponent->CastShadow != Settings.bShadowsTurnedOn)
+			{
+				SkeletalMeshComponent->SetCastShadow(Settings.bShadowsTurnedOn);
 			}
 		}
+
+		if (Char->GetActorTickInterval() != Settings.CharTickInterval)
+		{
+			Char->SetActorTickInterval(Settings.CharTickInterval);
+		}
 	}
 }
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Components/SkinnedMeshComponent.h"
 
 #include "CharacterOptimizerComponent.generated.h"
 
@@ -36,8 +37,19 @@ struct FCharOptimizationSettings
 	bool bShadowsTurnedOn;
 };
 
+/** Distance based optimization wave, zero wave is the least optimized one */
+UENUM(BlueprintType)
+enum class ECharOptimizationWave : uint8
+{
+	Zero,
+	First,
+	Second
+};
+
 /**
- * 
+ * Holds optimization settings of a character. Doesn't tick by itself: significance manager of the game is expected
+ * to evaluate all registered optimizers in one pass per frame against all local views and apply resulting waves,
+ * or, in budgeted mode, update rates allocated by CharacterOptimizerBudget.
  */
 UCLASS(ClassGroup=(CharacterOptimization), meta=(BlueprintSpawnableComponent))
 class CHARACTEROPTIMIZER_API UCharacterOptimizerComponent : public UActorComponent
@@ -47,10 +59,35 @@ class CHARACTEROPTIMIZER_API UCharacterOptimizerComponent : public UActorCompone
 public:
 	UCharacterOptimizerComponent();
 
-protected:
-	virtual void TickComponent(float DeltaTime, ELevelTick TickType,
-	                           FActorComponentTickFunction* ThisTickFunction) override;
+	/** Whether owner is a character and optimization should be applied to it */
+	bool IsOptimizationEnabled() const;
+
+	/** Returns optimization wave of char for given viewpoint, char is in view if cos of angle to it is >= ViewConeCos */
+	ECharOptimizationWave CalculateWave(const FTransform& Viewpoint, double ViewConeCos) const;
+
+	/** Applies settings of given wave if they differ from the last applied ones */
+	void ApplyWave(ECharOptimizationWave Wave);
+
+	/** Converts wave to significance value, less optimized waves are more significant */
+	static float WaveToSignificance(ECharOptimizationWave Wave);
 
+	/** Converts significance value back to wave */
+	static ECharOptimizationWave SignificanceToWave(float Significance);
+
+	/** Returns continuous significance of char in [0, 1] for given viewpoint, used in budgeted mode */
+	float CalculateSignificance(const FTransform& Viewpoint, double ViewConeCos) const;
+
+	/** Estimated cost of updating animation and movement of char every frame, ms */
+	float GetEstimatedUpdateCostMs() const { return EstimatedUpdateCostMs; }
+
+	/**
+	 * Applies budgeted update rate (char is updated once every UpdateRate frames) to movement, mesh and skeletal meshes
+	 * attached to it, if it differs from the last applied one. Animation is throttled by URO with interpolation,
+	 * FrameTime (smoothed over frames) is used to convert rate to movement tick interval.
+	 */
+	void ApplyUpdateRate(int32 UpdateRate, float FrameTime);
+
+protected:
 	virtual void OnRegister() override;
 
 private:
@@ -82,10 +119,46 @@ private:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, meta=(AllowPrivateAccess="true"))
 	FCharOptimizationSettings SecondWaveSettings;
 
+	/** Budgeted mode: char further than this distance gets zero significance */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, meta=(AllowPrivateAccess="true"))
+	double MaxSignificanceDistance;
+
+	/** Budgeted mode: significance of char that is not in view is multiplied by this value */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, meta=(AllowPrivateAccess="true"))
+	float NotInViewSignificanceScale;
+
+	/** Budgeted mode: estimated cost of updating animation and movement of char every frame, ms */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, meta=(AllowPrivateAccess="true"))
+	float EstimatedUpdateCostMs;
+
+	/** Budgeted mode: starting from this update rate cloth simulation of char meshes is suspended */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, meta=(AllowPrivateAccess="true"))
+	int32 ClothSuspendUpdateRate;
+
+	/** Budgeted mode: starting from this update rate kinematic bones are not pushed to physics asset bodies */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, meta=(AllowPrivateAccess="true"))
+	int32 PhysicsSkipUpdateRate;
+
 protected:
-	void ApplyOptimizationSettingsToChar(FCharOptimizationSettings& Settings);
+	void ApplyOptimizationSettingsToChar(const FCharOptimizationSettings& Settings);
+
+	const FCharOptimizationSettings& GetWaveSettings(ECharOptimizationWave Wave) const;
+
+	/** Drives URO parameters of char animation by update rate, restores them at rate 1 */
+	void ApplyUpdateRateToAnimation(USkeletalMeshComponent* Mesh, int32 UpdateRate);
+
+	void ApplyUpdateRateToMesh(USkeletalMeshComponent* Mesh, int32 UpdateRate) const;
 
 private:
 	UPROPERTY()
 	ACharacter* Char;
+
+	/** Wave applied to char last time, unset until the first application */
+	TOptional<ECharOptimizationWave> LastAppliedWave;
+
+	/** Budgeted update rate applied to char last time, unset until the first application */
+	TOptional<int32> LastAppliedUpdateRate;
+
+	/** URO parameters of char animation before budgeted rate was applied to them */
+	TOptional<FAnimUpdateRateParameters> SavedAnimUpdateRateParams;
 };
@@ -13,6 +13,9 @@ namespace UE
 		static FAutoConsoleVariableRef CVarShouldLogMessages(TEXT("GameplayMessageSubsystem.LogMessages"),
 			ShouldLogMessages,
 			TEXT("Should messages broadcast through the gameplay message subsystem be logged?"));
+
+		// Listeners deferring messages on every receive would otherwise keep a flush going forever
+		static constexpr int32 MaxDeferredFlushPasses = 16;
 	}
 }
 
@@ -49,13 +52,52 @@ bool UGameplayMessageSubsystem::HasInstance(const UObject* WorldContextObject)
 	return Router != nullptr;
 }
 
+void UGameplayMessageSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &ThisClass::HandleWorldPostActorTick);
+}
+
 void UGameplayMessageSubsystem::Deinitialize()
 {
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+
+	DiscardDeferredMessages();
 	ListenerMap.Reset();
+	ChannelWithParentsMap.Reset();
 
 	Super::Deinitialize();
 }
 
+void UGameplayMessageSubsystem::AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector)
+{
+	Super::AddReferencedObjects(InThis, Collector);
+
+	// Queued copies of messages hold references the same way the structs would as properties
+	UGameplayMessageSubsystem* This = CastChecked<UGameplayMessageSubsystem>(InThis);
+	for (FDeferredMessage& Message : This->DeferredMessages)
+	{
+		Collector.AddReferencedObjects(Message.StructType, This->DeferredMessageData.GetData() + Message.Offset, This);
+	}
+}
+
+const TArray<FGameplayTag, TInlineAllocator<8>>& UGameplayMessageSubsystem::GetChannelWithParents(FGameplayTag Channel)
+{
+	if (const TArray<FGameplayTag, TInlineAllocator<8>>* pChannelWithParents = ChannelWithParentsMap.Find(Channel))
+	{
+		return *pChannelWithParents;
+	}
+
+	// Tag hierarchy doesn't change at runtime, so it only needs to be walked once
+	TArray<FGameplayTag, TInlineAllocator<8>> ChannelWithParents;
+	for (FGameplayTag Tag = Channel; Tag.IsValid(); Tag = Tag.RequestDirectParent())
+	{
+		ChannelWithParents.Add(Tag);
+	}
+	return ChannelWithParentsMap.Add(Channel, MoveTemp(ChannelWithParents));
+}
+
 void UGameplayMessageSubsystem::BroadcastMessageInternal(FGameplayTag Channel, const UScriptStruct* StructType, const void* MessageBytes)
 {
 	// Log the message if enabled
@@ -75,23 +117,37 @@ void UGameplayMessageSubsystem::BroadcastMessageInternal(FGameplayTag Channel, c
 		UE_LOG(LogGameplayMessageSubsystem, Log, TEXT("BroadcastMessage(%s, %s, %s)"), pContextString ? **pContextString : *GetPathNameSafe(this), *Channel.ToString(), *HumanReadableMessage);
 	}
 
+	if (ListenerMap.Num() == 0)
+	{
+		return;
+	}
+
+	// Copied, as callbacks may broadcast on channels not seen before, which changes the map (no allocation up to 8 tags)
+	const TArray<FGameplayTag, TInlineAllocator<8>> ChannelWithParents = GetChannelWithParents(Channel);
+
 	// Broadcast the message
 	bool bOnInitialTag = true;
-	for (FGameplayTag Tag = Channel; Tag.IsValid(); Tag = Tag.RequestDirectParent())
+	for (const FGameplayTag Tag : ChannelWithParents)
 	{
-		if (const FChannelListenerList* pList = ListenerMap.Find(Tag))
+		if (const TUniquePtr<FChannelListenerList>* ppList = ListenerMap.Find(Tag))
 		{
-			// Copy in case there are removals while handling callbacks
-			TArray<FGameplayMessageListenerData> ListenerArray(pList->Listeners);
+			// Listeners array doesn't change until the broadcast ends, registrations and removals during it are deferred
+			FChannelListenerList& List = **ppList;
+			List.BroadcastDepth++;
 
-			for (const FGameplayMessageListenerData& Listener : ListenerArray)
+			for (const FGameplayMessageListenerData& Listener : List.Listeners)
 			{
+				if (Listener.bPendingRemoval)
+				{
+					continue;
+				}
+
 				if (bOnInitialTag || (Listener.MatchType == EGameplayMessageMatch::PartialMatch))
 				{
 					if (Listener.bHadValidType && !Listener.ListenerStructType.IsValid())
 					{
 						UE_LOG(LogGameplayMessageSubsystem, Warning, TEXT("Listener struct type has gone invalid on Channel %s. Removing listener from list"), *Channel.ToString());
-						UnregisterListenerInternal(Channel, Listener.HandleID);
+						UnregisterListenerInternal(Tag, Listener.HandleID);
 						continue;
 					}
 
@@ -110,11 +166,88 @@ void UGameplayMessageSubsystem::BroadcastMessageInternal(FGameplayTag Channel, c
 					}
 				}
 			}
+
+			if (--List.BroadcastDepth == 0)
+			{
+				ApplyPendingListenerChanges(Tag, List);
+			}
 		}
 		bOnInitialTag = false;
 	}
 }
 
+void UGameplayMessageSubsystem::BroadcastMessageDeferredInternal(FGameplayTag Channel, const UScriptStruct* StructType, const void* MessageBytes)
+{
+	check(StructType->GetMinAlignment() <= 16);
+
+	// Messages are copied into one buffer, which keeps its allocation between flushes
+	const int32 Offset = Align(DeferredMessageData.Num(), StructType->GetMinAlignment());
+	DeferredMessageData.SetNumUninitialized(Offset + StructType->GetStructureSize());
+
+	void* MessageCopy = DeferredMessageData.GetData() + Offset;
+	StructType->InitializeStruct(MessageCopy);
+	StructType->CopyScriptStruct(MessageCopy, MessageBytes);
+
+	FDeferredMessage& DeferredMessage = DeferredMessages.AddDefaulted_GetRef();
+	DeferredMessage.Channel = Channel;
+	DeferredMessage.StructType = StructType;
+	DeferredMessage.Offset = Offset;
+}
+
+void UGameplayMessageSubsystem::FlushDeferredMessages()
+{
+	// Messages deferred by listeners go to the emptied queue and are broadcast by the next pass
+	for (int32 Pass = 0; DeferredMessages.Num() > 0; ++Pass)
+	{
+		if (Pass == UE::GameplayMessageSubsystem::MaxDeferredFlushPasses)
+		{
+			UE_LOG(LogGameplayMessageSubsystem, Warning, TEXT("Listeners keep deferring messages after %d passes, %d messages are left for the next flush"),
+				Pass, DeferredMessages.Num());
+			break;
+		}
+
+		TArray<FDeferredMessage> Messages = MoveTemp(DeferredMessages);
+		TArray<uint8, TAlignedHeapAllocator<16>> MessageData = MoveTemp(DeferredMessageData);
+
+		for (const FDeferredMessage& Message : Messages)
+		{
+			BroadcastMessageInternal(Message.Channel, Message.StructType, MessageData.GetData() + Message.Offset);
+		}
+
+		for (const FDeferredMessage& Message : Messages)
+		{
+			Message.StructType->DestroyStruct(MessageData.GetData() + Message.Offset);
+		}
+
+		// Keep allocations for the next frame
+		if (DeferredMessages.Num() == 0)
+		{
+			Messages.Reset();
+			MessageData.Reset();
+			DeferredMessages = MoveTemp(Messages);
+			DeferredMessageData = MoveTemp(MessageData);
+		}
+	}
+}
+
+void UGameplayMessageSubsystem::DiscardDeferredMessages()
+{
+	for (const FDeferredMessage& Message : DeferredMessages)
+	{
+		Message.StructType->DestroyStruct(DeferredMessageData.GetData() + Message.Offset);
+	}
+	DeferredMessages.Empty();
+	DeferredMessageData.Empty();
+}
+
+void UGameplayMessageSubsystem::HandleWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if (World && World->GetGameInstance() == GetGameInstance())
+	{
+		FlushDeferredMessages();
+	}
+}
+
 void UGameplayMessageSubsystem::K2_BroadcastMessage(FGameplayTag Channel, const int32& Message)
 {
 	// This will never be called, the exec version below will be hit instead
@@ -140,9 +273,15 @@ DEFINE_FUNCTION(UGameplayMessageSubsystem::execK2_BroadcastMessage)
 
 FGameplayMessageListenerHandle UGameplayMessageSubsystem::RegisterListenerInternal(FGameplayTag Channel, TFunction<void(FGameplayTag, const UScriptStruct*, const void*)>&& Callback, const UScriptStruct* StructType, EGameplayMessageMatch MatchType)
 {
-	FChannelListenerList& List = ListenerMap.FindOrAdd(Channel);
+	TUniquePtr<FChannelListenerList>& pList = ListenerMap.FindOrAdd(Channel);
+	if (!pList)
+	{
+		pList = MakeUnique<FChannelListenerList>();
+	}
+	FChannelListenerList& List = *pList;
 
-	FGameplayMessageListenerData& Entry = List.Listeners.AddDefaulted_GetRef();
+	// Listeners mustn't change while being iterated by a broadcast
+	FGameplayMessageListenerData& Entry = List.BroadcastDepth > 0 ? List.PendingListeners.AddDefaulted_GetRef() : List.Listeners.AddDefaulted_GetRef();
 	Entry.ReceivedCallback = MoveTemp(Callback);
 	Entry.ListenerStructType = StructType;
 	Entry.bHadValidType = StructType != nullptr;
@@ -168,17 +307,56 @@ void UGameplayMessageSubsystem::UnregisterListener(FGameplayMessageListenerHandl
 
 void UGameplayMessageSubsystem::UnregisterListenerInternal(FGameplayTag Channel, int32 HandleID)
 {
-	if (FChannelListenerList* pList = ListenerMap.Find(Channel))
+	if (const TUniquePtr<FChannelListenerList>* ppList = ListenerMap.Find(Channel))
 	{
-		int32 MatchIndex = pList->Listeners.IndexOfByPredicate([ID = HandleID](const FGameplayMessageListenerData& Other) { return Other.HandleID == ID; });
+		FChannelListenerList& List = **ppList;
+		auto MatchesID = [ID = HandleID](const FGameplayMessageListenerData& Other) { return Other.HandleID == ID; };
+
+		int32 MatchIndex = List.Listeners.IndexOfByPredicate(MatchesID);
 		if (MatchIndex != INDEX_NONE)
 		{
-			pList->Listeners.RemoveAtSwap(MatchIndex);
+			if (List.BroadcastDepth > 0)
+			{
+				List.Listeners[MatchIndex].bPendingRemoval = true;
+				List.bHasPendingRemovals = true;
+			}
+			else
+			{
+				List.Listeners.RemoveAtSwap(MatchIndex);
+			}
+		}
+		else
+		{
+			MatchIndex = List.PendingListeners.IndexOfByPredicate(MatchesID);
+			if (MatchIndex != INDEX_NONE)
+			{
+				List.PendingListeners.RemoveAtSwap(MatchIndex);
+			}
 		}
 
-		if (pList->Listeners.Num() == 0)
+		if (List.BroadcastDepth == 0 && List.Listeners.Num() == 0)
 		{
 			ListenerMap.Remove(Channel);
 		}
 	}
 }
+
+void UGameplayMessageSubsystem::ApplyPendingListenerChanges(FGameplayTag Channel, FChannelListenerList& List)
+{
+	if (List.bHasPendingRemovals)
+	{
+		List.Listeners.RemoveAllSwap([](const FGameplayMessageListenerData& Listener) { return Listener.bPendingRemoval; });
+		List.bHasPendingRemovals = false;
+	}
+
+	if (List.PendingListeners.Num() > 0)
+	{
+		List.Listeners.Append(MoveTemp(List.PendingListeners));
+		List.PendingListeners.Reset();
+	}
+
+	if (List.Listeners.Num() == 0)
+	{
+		ListenerMap.Remove(Channel);
+	}
+}
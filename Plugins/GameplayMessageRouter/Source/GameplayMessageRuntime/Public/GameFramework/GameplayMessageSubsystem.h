@@ -65,6 +65,9 @@ struct FGameplayMessageListenerData
 	// Adding some logging and extra variables around some potential problems with this
 	TWeakObjectPtr<const UScriptStruct> ListenerStructType = nullptr;
 	bool bHadValidType = false;
+
+	// Set when unregistered during a broadcast on its channel, the entry is removed once the broadcast ends
+	bool bPendingRemoval = false;
 };
 
 /**
@@ -101,9 +104,14 @@ public:
 	static bool HasInstance(const UObject* WorldContextObject);
 
 	//~USubsystem interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
 	virtual void Deinitialize() override;
 	//~End of USubsystem interface
 
+	//~UObject interface
+	static void AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector);
+	//~End of UObject interface
+
 	/**
 	 * Broadcast a message on the specified channel
 	 *
@@ -117,6 +125,28 @@ public:
 		BroadcastMessageInternal(Channel, StructType, &Message);
 	}
 
+	/**
+	 * Queue a message to be broadcast on the specified channel later in the frame, together with other deferred messages
+	 * Deferred messages are broadcast in order after actors tick, or by FlushDeferredMessages
+	 * Objects referenced by queued messages are kept alive until they are broadcast
+	 * Use for messages fired many times per frame whose listeners don't need them immediately (eg HUD updates)
+	 *
+	 * @param Channel			The message channel to broadcast on
+	 * @param Message			The message to send, it is copied
+	 */
+	template <typename FMessageStructType>
+	void BroadcastMessageDeferred(FGameplayTag Channel, const FMessageStructType& Message)
+	{
+		const UScriptStruct* StructType = TBaseStructure<FMessageStructType>::Get();
+		BroadcastMessageDeferredInternal(Channel, StructType, &Message);
+	}
+
+	/**
+	 * Broadcast all deferred messages now
+	 * Messages deferred by listeners are broadcast too, up to a limit of passes, the rest waits for the next flush
+	 */
+	void FlushDeferredMessages();
+
 	/**
 	 * Register to receive messages on a specified channel
 	 *
@@ -213,6 +243,17 @@ private:
 	// Internal helper for broadcasting a message
 	void BroadcastMessageInternal(FGameplayTag Channel, const UScriptStruct* StructType, const void* MessageBytes);
 
+	// Internal helper for queueing a deferred message
+	void BroadcastMessageDeferredInternal(FGameplayTag Channel, const UScriptStruct* StructType, const void* MessageBytes);
+
+	// Returns the channel followed by its parents, computed once per channel
+	const TArray<FGameplayTag, TInlineAllocator<8>>& GetChannelWithParents(FGameplayTag Channel);
+
+	void HandleWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+
+	// Destroys deferred messages without broadcasting them
+	void DiscardDeferredMessages();
+
 	// Internal helper for registering a message listener
 	FGameplayMessageListenerHandle RegisterListenerInternal(
 		FGameplayTag Channel, 
@@ -224,12 +265,40 @@ private:
 
 private:
 	// List of all entries for a given channel
+	// Listeners aren't copied for a broadcast: ones registered during it are added when it ends, unregistered ones are marked
 	struct FChannelListenerList
 	{
 		TArray<FGameplayMessageListenerData> Listeners;
 		int32 HandleID = 0;
+
+		// Listeners registered during a broadcast on this channel
+		TArray<FGameplayMessageListenerData> PendingListeners;
+
+		// Number of broadcasts on this channel in progress (they can be nested)
+		int32 BroadcastDepth = 0;
+
+		bool bHasPendingRemovals = false;
 	};
 
+	// A message queued by BroadcastMessageDeferred, its copy lives in DeferredMessageData at Offset
+	struct FDeferredMessage
+	{
+		FGameplayTag Channel;
+		const UScriptStruct* StructType = nullptr;
+		int32 Offset = 0;
+	};
+
+	// Adds listeners registered and removes ones unregistered during broadcasts, once none are in progress
+	void ApplyPendingListenerChanges(FGameplayTag Channel, FChannelListenerList& List);
+
 private:
-	TMap<FGameplayTag, FChannelListenerList> ListenerMap;
+	// Lists are allocated separately, so they stay in place while the map changes during a broadcast
+	TMap<FGameplayTag, TUniquePtr<FChannelListenerList>> ListenerMap;
+
+	TMap<FGameplayTag, TArray<FGameplayTag, TInlineAllocator<8>>> ChannelWithParentsMap;
+
+	TArray<FDeferredMessage> DeferredMessages;
+	TArray<uint8, TAlignedHeapAllocator<16>> DeferredMessageData;
+
+	FDelegateHandle PostActorTickHandle;
 };
@@ -0,0 +1,442 @@
+﻿#include "HttpRequestManager.h"
+
+#include "HttpModule.h"
+#include "PlatformHttp.h"
+#include "Containers/Ticker.h"
+#include "Engine/Engine.h"
+#include "Interfaces/IHttpResponse.h"
+
+static int32 HttpMaxRequestsPerHost = 4;
+static FAutoConsoleVariableRef CVarHttpMaxRequestsPerHost(
+	TEXT("HTTPRequests.MaxRequestsPerHost"),
+	HttpMaxRequestsPerHost,
+	TEXT("Max active requests per host, others wait in queue"),
+	ECVF_Default);
+
+static int32 HttpMaxRequests = 16;
+static FAutoConsoleVariableRef CVarHttpMaxRequests(
+	TEXT("HTTPRequests.MaxRequests"),
+	HttpMaxRequests,
+	TEXT("Max active requests in total, others wait in queue"),
+	ECVF_Default);
+
+static float HttpRetryBaseDelay = 0.5f;
+static FAutoConsoleVariableRef CVarHttpRetryBaseDelay(
+	TEXT("HTTPRequests.RetryBaseDelay"),
+	HttpRetryBaseDelay,
+	TEXT("Delay before first retry in seconds, doubled with each next retry"),
+	ECVF_Default);
+
+static float HttpRetryMaxDelay = 10.0f;
+static FAutoConsoleVariableRef CVarHttpRetryMaxDelay(
+	TEXT("HTTPRequests.RetryMaxDelay"),
+	HttpRetryMaxDelay,
+	TEXT("Max delay before retry in seconds, including Retry-After of response"),
+	ECVF_Default);
+
+static int32 HttpCacheSizeMB = 8;
+static FAutoConsoleVariableRef CVarHttpCacheSizeMB(
+	TEXT("HTTPRequests.CacheSizeMB"),
+	HttpCacheSizeMB,
+	TEXT("Size of cached GET responses, least recently used are evicted above it"),
+	ECVF_Default);
+
+
+FString FHttpManagedResponse::GetContentAsString() const
+{
+	if (!Content || Content->Num() == 0)
+	{
+		return FString();
+	}
+
+	const FUTF8ToTCHAR Converter(reinterpret_cast<const ANSICHAR*>(Content->GetData()), Content->Num());
+	return FString(Converter.Length(), Converter.Get());
+}
+
+
+namespace HttpRequestManager
+{
+	static bool IsIdempotent(const FString& Verb)
+	{
+		return Verb == TEXT("GET") || Verb == TEXT("HEAD") || Verb == TEXT("PUT") || Verb == TEXT("DELETE")
+			|| Verb == TEXT("OPTIONS");
+	}
+
+	/** Headers are part of the key, as they may change response (eg Authorization) */
+	static FString MakeKey(const FHttpManagedRequest& Request)
+	{
+		TArray<FString> Headers;
+		for (const TTuple<FString, FString>& Header : Request.Headers)
+		{
+			Headers.Add(Header.Key.ToLower() + TEXT(": ") + Header.Value);
+		}
+		Headers.Sort();
+		return Request.Url + TEXT("\n") + FString::Join(Headers, TEXT("\n"));
+	}
+
+	/** Returns false if response must not be stored, OutMaxAge is 0 if it must be revalidated before use */
+	static bool ParseCacheControl(const FString& CacheControl, double& OutMaxAge)
+	{
+		OutMaxAge = 0.0;
+
+		TArray<FString> Directives;
+		CacheControl.ParseIntoArray(Directives, TEXT(","));
+		bool bNoCache = false;
+		for (FString& Directive : Directives)
+		{
+			Directive.TrimStartAndEndInline();
+			if (Directive.Equals(TEXT("no-store"), ESearchCase::IgnoreCase))
+			{
+				return false;
+			}
+
+			if (Directive.Equals(TEXT("no-cache"), ESearchCase::IgnoreCase))
+			{
+				bNoCache = true;
+			}
+			else if (Directive.StartsWith(TEXT("max-age="), ESearchCase::IgnoreCase))
+			{
+				OutMaxAge = FCString::Atod(*Directive.RightChop(8));
+			}
+		}
+
+		if (bNoCache)
+		{
+			OutMaxAge = 0.0;
+		}
+		return true;
+	}
+}
+
+
+UHttpRequestManager* UHttpRequestManager::Get()
+{
+	return GEngine ? GEngine->GetEngineSubsystem<UHttpRequestManager>() : nullptr;
+}
+
+void UHttpRequestManager::Deinitialize()
+{
+	// Callbacks may reference objects being destroyed, so they aren't called
+	for (const FPendingRequestRef& Pending : ActiveRequests)
+	{
+		Pending->HttpRequest->OnProcessRequestComplete().Unbind();
+		Pending->HttpRequest->CancelRequest();
+	}
+
+	ActiveRequests.Empty();
+	Hosts.Empty();
+	PendingGets.Empty();
+	ClearCache();
+
+	Super::Deinitialize();
+}
+
+void UHttpRequestManager::ProcessRequest(FHttpManagedRequest&& Request, FHttpManagedRequestComplete&& OnComplete)
+{
+	using namespace HttpRequestManager;
+
+	Request.Verb.ToUpperInline();
+
+	FString Key;
+	if (Request.Verb == TEXT("GET"))
+	{
+		Key = MakeKey(Request);
+
+		if (Request.bUseCache)
+		{
+			if (FCacheEntry* Entry = Cache.Find(Key))
+			{
+				const double Time = FPlatformTime::Seconds();
+				if (Entry->ExpireTime > Time)
+				{
+					Entry->LastUseTime = Time;
+
+					FHttpManagedResponse Response;
+					Response.bSucceeded = true;
+					Response.Code = EHttpResponseCodes::Ok;
+					Response.Content = Entry->Content;
+					Response.ContentType = Entry->ContentType;
+					Response.bFromCache = true;
+					OnComplete.ExecuteIfBound(Response);
+					return;
+				}
+			}
+		}
+
+		if (const FPendingRequestRef* Pending = PendingGets.Find(Key))
+		{
+			(*Pending)->Callbacks.Add(MoveTemp(OnComplete));
+			return;
+		}
+	}
+
+	const FPendingRequestRef Pending = MakeShared<FPendingRequest>();
+	Pending->Host = FPlatformHttp::GetUrlDomain(Request.Url);
+	Pending->Key = Key;
+	Pending->Request = MoveTemp(Request);
+	Pending->Callbacks.Add(MoveTemp(OnComplete));
+
+	if (!Key.IsEmpty())
+	{
+		PendingGets.Add(Key, Pending);
+	}
+
+	Enqueue(Pending);
+}
+
+void UHttpRequestManager::ClearCache()
+{
+	Cache.Empty();
+	CacheSize = 0;
+}
+
+void UHttpRequestManager::Enqueue(const FPendingRequestRef& Pending)
+{
+	Hosts.FindOrAdd(Pending->Host).Queue.Add(Pending);
+	PumpQueues();
+}
+
+void UHttpRequestManager::PumpQueues()
+{
+	// Requests may complete synchronously and queue new ones, outer loop picks them up
+	if (bPumpingQueues)
+	{
+		return;
+	}
+	TGuardValue<bool> PumpingQueuesGuard(bPumpingQueues, true);
+
+	const int32 MaxRequestsPerHost = FMath::Max(HttpMaxRequestsPerHost, 1);
+	const int32 MaxRequests = FMath::Max(HttpMaxRequests, 1);
+
+	// One request per host per pass, so hosts share free slots evenly
+	bool bStartedRequest = true;
+	while (bStartedRequest && ActiveRequests.Num() < MaxRequests)
+	{
+		bStartedRequest = false;
+
+		TArray<FString> HostNames;
+		Hosts.GetKeys(HostNames);
+		for (const FString& HostName : HostNames)
+		{
+			FHostState* HostState = Hosts.Find(HostName);
+			if (HostState && HostState->Queue.Num() > 0 && HostState->NumActive < MaxRequestsPerHost
+				&& ActiveRequests.Num() < MaxRequests)
+			{
+				const FPendingRequestRef Pending = HostState->Queue[0];
+				HostState->Queue.RemoveAt(0);
+				HostState->NumActive++;
+				StartRequest(Pending);
+				bStartedRequest = true;
+			}
+		}
+	}
+}
+
+void UHttpRequestManager::StartRequest(const FPendingRequestRef& Pending)
+{
+	const FHttpManagedRequest& Request = Pending->Request;
+
+	const TSharedRef<IHttpRequest, ESPMode::ThreadSafe> HttpRequest = FHttpModule::Get().CreateRequest();
+	HttpRequest->SetURL(Request.Url);
+	HttpRequest->SetVerb(Request.Verb);
+	for (const TTuple<FString, FString>& Header : Request.Headers)
+	{
+		HttpRequest->SetHeader(Header.Key, Header.Value);
+	}
+	if (Request.Content.Num() > 0)
+	{
+		HttpRequest->SetContent(Request.Content);
+	}
+
+	// Revalidate stale response, server answers 304 with no body if it is still valid
+	if (Request.bUseCache && !Pending->Key.IsEmpty())
+	{
+		if (const FCacheEntry* Entry = Cache.Find(Pending->Key))
+		{
+			if (!Entry->ETag.IsEmpty())
+			{
+				HttpRequest->SetHeader(TEXT("If-None-Match"), Entry->ETag);
+			}
+			if (!Entry->LastModified.IsEmpty())
+			{
+				HttpRequest->SetHeader(TEXT("If-Modified-Since"), Entry->LastModified);
+			}
+		}
+	}
+
+	HttpRequest->OnProcessRequestComplete().BindUObject(this, &ThisClass::OnRequestComplete, Pending);
+
+	Pending->NumAttempts++;
+	Pending->HttpRequest = HttpRequest;
+	ActiveRequests.Add(Pending);
+	HttpRequest->ProcessRequest();
+}
+
+void UHttpRequestManager::OnRequestComplete(FHttpRequestPtr HttpRequest, FHttpResponsePtr HttpResponse,
+                                            const bool bWasSuccessful, const FPendingRequestRef Pending)
+{
+	Pending->HttpRequest.Reset();
+	ActiveRequests.RemoveSingleSwap(Pending);
+	if (FHostState* HostState = Hosts.Find(Pending->Host))
+	{
+		HostState->NumActive--;
+	}
+
+	if (!bWasSuccessful)
+	{
+		HttpResponse.Reset();
+	}
+
+	const float RetryDelay = GetRetryDelay(*Pending, HttpResponse);
+	if (RetryDelay >= 0.0f)
+	{
+		FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateWeakLambda(this, [this, Pending](float)
+		{
+			Enqueue(Pending);
+			return false;
+		}), RetryDelay);
+
+		PumpQueues();
+		return;
+	}
+
+	FHttpManagedResponse Response;
+	if (HttpResponse)
+	{
+		Response.bSucceeded = true;
+		Response.Code = HttpResponse->GetResponseCode();
+
+		FCacheEntry* Entry = Pending->Request.bUseCache && !Pending->Key.IsEmpty() ? Cache.Find(Pending->Key) : nullptr;
+		if (Response.Code == EHttpResponseCodes::NotModified && Entry)
+		{
+			Response.Code = EHttpResponseCodes::Ok;
+			Response.Content = Entry->Content;
+			Response.ContentType = Entry->ContentType;
+			Response.bFromCache = true;
+
+			// Refreshes expiration
+			StoreInCache(Pending->Key, HttpResponse, Response.Content);
+		}
+		else
+		{
+			Response.Content = MakeShared<const TArray<uint8>, ESPMode::ThreadSafe>(HttpResponse->GetContent());
+			Response.ContentType = HttpResponse->GetContentType();
+			if (Response.Code == EHttpResponseCodes::Ok && Pending->Request.bUseCache && !Pending->Key.IsEmpty())
+			{
+				StoreInCache(Pending->Key, HttpResponse, Response.Content);
+			}
+		}
+	}
+
+	Complete(Pending, Response);
+	PumpQueues();
+}
+
+float UHttpRequestManager::GetRetryDelay(const FPendingRequest& Pending, FHttpResponsePtr HttpResponse) const
+{
+	const FHttpManagedRequest& Request = Pending.Request;
+	if (Pending.NumAttempts > Request.MaxRetries)
+	{
+		return -1.0f;
+	}
+
+	if (!Request.bRetryNonIdempotent && !HttpRequestManager::IsIdempotent(Request.Verb))
+	{
+		return -1.0f;
+	}
+
+	const int32 Code = HttpResponse ? HttpResponse->GetResponseCode() : 0;
+	const bool bRetriable = !HttpResponse
+		|| Code == EHttpResponseCodes::RequestTimeout
+		|| Code == EHttpResponseCodes::TooManyRequests
+		|| (Code >= EHttpResponseCodes::ServerError && Code != EHttpResponseCodes::NotSupported);
+	if (!bRetriable)
+	{
+		return -1.0f;
+	}
+
+	// Jitter spreads retries of requests that failed together
+	const float MaxDelay = FMath::Max(HttpRetryMaxDelay, 0.0f);
+	float Delay = HttpRetryBaseDelay * FMath::Pow(2.0f, Pending.NumAttempts - 1) * FMath::FRandRange(0.5f, 1.0f);
+
+	if (HttpResponse)
+	{
+		const FString RetryAfter = HttpResponse->GetHeader(TEXT("Retry-After"));
+		if (RetryAfter.IsNumeric())
+		{
+			Delay = FMath::Max(Delay, FCString::Atof(*RetryAfter));
+		}
+	}
+
+	return FMath::Clamp(Delay, 0.0f, MaxDelay);
+}
+
+void UHttpRequestManager::StoreInCache(const FString& Key, const FHttpResponsePtr& HttpResponse,
+                                       const TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe>& Content)
+{
+	double MaxAge = 0.0;
+	const bool bStore = HttpRequestManager::ParseCacheControl(HttpResponse->GetHeader(TEXT("Cache-Control")), MaxAge);
+
+	FString ETag = HttpResponse->GetHeader(TEXT("ETag"));
+	FString LastModified = HttpResponse->GetHeader(TEXT("Last-Modified"));
+
+	// Not modified response may omit validators, previous ones stay valid then
+	if (const FCacheEntry* Entry = Cache.Find(Key))
+	{
+		ETag = ETag.IsEmpty() ? Entry->ETag : ETag;
+		LastModified = LastModified.IsEmpty() ? Entry->LastModified : LastModified;
+		CacheSize -= Entry->Content->Num();
+		Cache.Remove(Key);
+	}
+
+	const int64 MaxCacheSize = static_cast<int64>(FMath::Max(HttpCacheSizeMB, 0)) * 1024 * 1024;
+	if (!bStore || (MaxAge <= 0.0 && ETag.IsEmpty() && LastModified.IsEmpty()) || Content->Num() > MaxCacheSize)
+	{
+		return;
+	}
+
+	// Evict least recently used
+	while (CacheSize + Content->Num() > MaxCacheSize && Cache.Num() > 0)
+	{
+		const TTuple<FString, FCacheEntry>* Oldest = nullptr;
+		for (const TTuple<FString, FCacheEntry>& KeyAndEntry : Cache)
+		{
+			if (!Oldest || KeyAndEntry.Value.LastUseTime < Oldest->Value.LastUseTime)
+			{
+				Oldest = &KeyAndEntry;
+			}
+		}
+		CacheSize -= Oldest->Value.Content->Num();
+		Cache.Remove(FString(Oldest->Key));
+	}
+
+	const double Time = FPlatformTime::Seconds();
+
+	FCacheEntry& Entry = Cache.Add(Key);
+	Entry.Content = Content;
+	Entry.ContentType = HttpResponse->GetContentType();
+	Entry.ETag = MoveTemp(ETag);
+	Entry.LastModified = MoveTemp(LastModified);
+	Entry.ExpireTime = Time + MaxAge;
+	Entry.LastUseTime = Time;
+	CacheSize += Content->Num();
+}
+
+void UHttpRequestManager::Complete(const FPendingRequestRef& Pending, const FHttpManagedResponse& Response)
+{
+	if (!Pending->Key.IsEmpty())
+	{
+		const FPendingRequestRef* PendingGet = PendingGets.Find(Pending->Key);
+		if (PendingGet && *PendingGet == Pending)
+		{
+			PendingGets.Remove(Pending->Key);
+		}
+	}
+
+	// Callbacks may process new requests
+	const TArray<FHttpManagedRequestComplete> Callbacks = MoveTemp(Pending->Callbacks);
+	for (const FHttpManagedRequestComplete& Callback : Callbacks)
+	{
+		Callback.ExecuteIfBound(Response);
+	}
+}
@@ -0,0 +1,132 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Interfaces/IHttpRequest.h"
+#include "Subsystems/EngineSubsystem.h"
+#include "HttpRequestManager.generated.h"
+
+/** Request processed by UHttpRequestManager */
+struct HTTPREQUESTS_API FHttpManagedRequest
+{
+	FString Verb = TEXT("GET");
+	FString Url;
+	TMap<FString, FString> Headers;
+	TArray<uint8> Content;
+
+	/** Retries after connection errors, 408, 429 and 5xx responses, with exponential backoff */
+	int32 MaxRetries = 3;
+
+	/** Non idempotent requests (POST, PATCH) may be applied twice if retried, so aren't retried by default */
+	bool bRetryNonIdempotent = false;
+
+	/** Whether GET may be served from cache and its response stored in cache, according to Cache-Control and ETag */
+	bool bUseCache = true;
+};
+
+struct HTTPREQUESTS_API FHttpManagedResponse
+{
+	/** Whether response was received, regardless of its code */
+	bool bSucceeded = false;
+
+	int32 Code = 0;
+
+	/** Body, shared between coalesced requests and cache, so isn't copied per request */
+	TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe> Content;
+
+	FString ContentType;
+
+	bool bFromCache = false;
+
+	/** Decodes body as UTF-8 */
+	FString GetContentAsString() const;
+};
+
+DECLARE_DELEGATE_OneParam(FHttpManagedRequestComplete, const FHttpManagedResponse&);
+
+
+/**
+ * Processes HTTP requests with bounded concurrency, so bursts (eg stats and match results at match end)
+ * don't hit the backend all at once. Requests are queued per host and at most HTTPRequests.MaxRequestsPerHost
+ * are active per host, which also lets HTTP module reuse keep-alive connections instead of opening new ones.
+ *
+ * Identical GETs in flight are coalesced into one request. GET responses are cached according to
+ * Cache-Control, and stale entries with ETag or Last-Modified are revalidated with conditional requests.
+ * Failed requests are retried with exponential backoff, honouring Retry-After.
+ */
+UCLASS()
+class HTTPREQUESTS_API UHttpRequestManager : public UEngineSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	static UHttpRequestManager* Get();
+
+	virtual void Deinitialize() override;
+
+	/** Queues request, OnComplete is called on game thread, immediately if served from cache */
+	void ProcessRequest(FHttpManagedRequest&& Request, FHttpManagedRequestComplete&& OnComplete);
+
+	void ClearCache();
+
+private:
+	struct FPendingRequest
+	{
+		FHttpManagedRequest Request;
+		FString Host;
+
+		/** Key of cache and coalescing, empty if request isn't GET */
+		FString Key;
+
+		TArray<FHttpManagedRequestComplete> Callbacks;
+		int32 NumAttempts = 0;
+		TSharedPtr<IHttpRequest, ESPMode::ThreadSafe> HttpRequest;
+	};
+
+	using FPendingRequestRef = TSharedRef<FPendingRequest>;
+
+	struct FHostState
+	{
+		TArray<FPendingRequestRef> Queue;
+		int32 NumActive = 0;
+	};
+
+	struct FCacheEntry
+	{
+		TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe> Content;
+		FString ContentType;
+		FString ETag;
+		FString LastModified;
+		double ExpireTime = 0.0;
+		double LastUseTime = 0.0;
+	};
+
+	void Enqueue(const FPendingRequestRef& Pending);
+
+	/** Starts queued requests while there are free slots */
+	void PumpQueues();
+
+	void StartRequest(const FPendingRequestRef& Pending);
+
+	void OnRequestComplete(FHttpRequestPtr HttpRequest, FHttpResponsePtr HttpResponse, bool bWasSuccessful,
+	                       FPendingRequestRef Pending);
+
+	/** Returns delay of retry, negative if request shouldn't be retried */
+	float GetRetryDelay(const FPendingRequest& Pending, FHttpResponsePtr HttpResponse) const;
+
+	void StoreInCache(const FString& Key, const FHttpResponsePtr& HttpResponse,
+	                  const TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe>& Content);
+
+	void Complete(const FPendingRequestRef& Pending, const FHttpManagedResponse& Response);
+
+	TMap<FString, FHostState> Hosts;
+
+	/** GETs queued or active, by key */
+	TMap<FString, FPendingRequestRef> PendingGets;
+
+	TArray<FPendingRequestRef> ActiveRequests;
+
+	TMap<FString, FCacheEntry> Cache;
+	int64 CacheSize = 0;
+
+	bool bPumpingQueues = false;
+};
@@ -1,47 +1,106 @@
 ﻿#include "HttpRequestTask.h"
 
-
-#include "Interfaces/IHttpResponse.h"
+#include "UObject/StrongObjectPtr.h"
 
 
 void UHttpRequestAsyncAction::Activate()
 {
 	Super::Activate();
 
-	FHttpModule* Module = &FHttpModule::Get();
-	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = Module->CreateRequest();
-	Request->OnProcessRequestComplete().BindUObject(this, &ThisClass::OnPostReceivedResponse);
-
-	Request->SetURL(URL);
-	Request->SetVerb(Method);
-	for (auto [HeaderKey, HeaderValue] : Headers)
+	UHttpRequestManager* RequestManager = UHttpRequestManager::Get();
+	if (!RequestManager)
 	{
-		Request->SetHeader(HeaderKey, HeaderValue);
+		OnFailed.Broadcast();
+		SetReadyToDestroy();
+		return;
 	}
-	Request->SetContentAsString(Content);
-	Request->ProcessRequest();
+
+	FHttpManagedRequest Request;
+	Request.Verb = Method;
+	Request.Url = URL;
+	Request.Headers = Headers;
+	Request.bUseCache = bUseCache;
+
+	const FTCHARToUTF8 Converter(*Content);
+	Request.Content.Append(reinterpret_cast<const uint8*>(Converter.Get()), Converter.Length());
+
+	// Nothing else references the action while request is queued or waits for retry, so it's kept alive by callback
+	RequestManager->ProcessRequest(MoveTemp(Request), FHttpManagedRequestComplete::CreateLambda(
+		                               [StrongThis = TStrongObjectPtr<ThisClass>(this)](const FHttpManagedResponse& Response)
+		                               {
+			                               StrongThis->OnRequestComplete(Response);
+		                               }));
 }
 
 UHttpRequestAsyncAction* UHttpRequestAsyncAction::HttpRequestAsyncAction(
-	FString Method, FString Url, TMap<FString, FString> Headers, FString Content)
+	FString Method, FString Url, TMap<FString, FString> Headers, FString Content, const bool bUseCache)
 {
 	UHttpRequestAsyncAction* MyAction = NewObject<UHttpRequestAsyncAction>();
 	MyAction->Method = Method;
 	MyAction->URL = Url;
 	MyAction->Headers = Headers;
 	MyAction->Content = Content;
+	MyAction->bUseCache = bUseCache;
 	return MyAction;
 }
 
-void UHttpRequestAsyncAction::OnPostReceivedResponse(FHttpRequestPtr Request, FHttpResponsePtr Response,
-                                                     bool bWasSuccessful)
+void UHttpRequestAsyncAction::OnRequestComplete(const FHttpManagedResponse& Response)
 {
-	if (bWasSuccessful && Response.Get())
+	if (Response.bSucceeded)
 	{
-		OnSuccess.Broadcast(Response->GetResponseCode(), Response->GetContentAsString());
+		OnSuccess.Broadcast(Response.Code, Response.GetContentAsString());
 	}
 	else
 	{
 		OnFailed.Broadcast();
 	}
+
+	SetReadyToDestroy();
+}
+
+
+void UHttpBinaryRequestAsyncAction::Activate()
+{
+	Super::Activate();
+
+	UHttpRequestManager* RequestManager = UHttpRequestManager::Get();
+	if (!RequestManager)
+	{
+		OnFailed.Broadcast();
+		SetReadyToDestroy();
+		return;
+	}
+
+	RequestManager->ProcessRequest(MoveTemp(Request), FHttpManagedRequestComplete::CreateLambda(
+		                               [StrongThis = TStrongObjectPtr<ThisClass>(this)](const FHttpManagedResponse& Response)
+		                               {
+			                               StrongThis->OnRequestComplete(Response);
+		                               }));
+}
+
+UHttpBinaryRequestAsyncAction* UHttpBinaryRequestAsyncAction::HttpBinaryRequestAsyncAction(
+	FString Method, FString Url, TMap<FString, FString> Headers, TArray<uint8> Content, const bool bUseCache)
+{
+	UHttpBinaryRequestAsyncAction* MyAction = NewObject<UHttpBinaryRequestAsyncAction>();
+	MyAction->Request.Verb = Method;
+	MyAction->Request.Url = Url;
+	MyAction->Request.Headers = MoveTemp(Headers);
+	MyAction->Request.Content = MoveTemp(Content);
+	MyAction->Request.bUseCache = bUseCache;
+	return MyAction;
+}
+
+void UHttpBinaryRequestAsyncAction::OnRequestComplete(const FHttpManagedResponse& Response)
+{
+	if (Response.bSucceeded)
+	{
+		static const TArray<uint8> EmptyContent;
+		OnSuccess.Broadcast(Response.Code, Response.Content ? *Response.Content : EmptyContent);
+	}
+	else
+	{
+		OnFailed.Broadcast();
+	}
+
+	SetReadyToDestroy();
 }
@@ -2,14 +2,17 @@
 
 #include "CoreMinimal.h"
 #include "Kismet/BlueprintAsyncActionBase.h"
-#include "HttpModule.h"
+#include "HttpRequestManager.h"
 #include "HttpRequestTask.generated.h"
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FRequestSuccess, int32, Result, FString, Content);
 
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FBinaryRequestSuccess, int32, Result, const TArray<uint8>&, Content);
+
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FRequestFailed);
 
 
+/** Request processed by UHttpRequestManager, GETs may be served from cache or coalesced with identical ones */
 UCLASS()
 class HTTPREQUESTS_API UHttpRequestAsyncAction : public UBlueprintAsyncActionBase
 {
@@ -22,11 +25,13 @@ public:
 	UPROPERTY(BlueprintAssignable)
 	FRequestFailed OnFailed;
 
+	/** bUseCache - whether GET may be served from cache and its response stored in cache */
 	UFUNCTION(BlueprintCallable)
 	static UHttpRequestAsyncAction*
-	HttpRequestAsyncAction(FString Method, FString Url, TMap<FString, FString> Headers, FString Content);
+	HttpRequestAsyncAction(FString Method, FString Url, TMap<FString, FString> Headers, FString Content,
+	                       bool bUseCache = true);
 
-	void OnPostReceivedResponse(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful);
+	void OnRequestComplete(const FHttpManagedResponse& Response);
 
 	virtual void Activate() override;
 
@@ -35,4 +40,33 @@ private:
 	FString URL;
 	TMap<FString, FString> Headers;
 	FString Content;
+	bool bUseCache = true;
+};
+
+
+/** Same as UHttpRequestAsyncAction, with binary content of request and response */
+UCLASS()
+class HTTPREQUESTS_API UHttpBinaryRequestAsyncAction : public UBlueprintAsyncActionBase
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(BlueprintAssignable)
+	FBinaryRequestSuccess OnSuccess;
+
+	UPROPERTY(BlueprintAssignable)
+	FRequestFailed OnFailed;
+
+	/** bUseCache - whether GET may be served from cache and its response stored in cache */
+	UFUNCTION(BlueprintCallable)
+	static UHttpBinaryRequestAsyncAction*
+	HttpBinaryRequestAsyncAction(FString Method, FString Url, TMap<FString, FString> Headers, TArray<uint8> Content,
+	                             bool bUseCache = true);
+
+	void OnRequestComplete(const FHttpManagedResponse& Response);
+
+	virtual void Activate() override;
+
+private:
+	FHttpManagedRequest Request;
 };
@@ -1,5 +1,46 @@
 ﻿#include "WebSocketBase.h"
 
+#include "Misc/Compression.h"
+
+namespace WebSocketBinaryFormat
+{
+	enum EFlags : uint8
+	{
+		None = 0,
+		Compressed = 1 << 0
+	};
+
+	/** Guards against allocating for corrupted size */
+	static constexpr uint32 MaxUncompressedSize = 64 * 1024 * 1024;
+
+	static void AppendSize(TArray<uint8>& Data, const uint32 Size)
+	{
+		const uint32 LittleEndianSize = INTEL_ORDER32(Size);
+		Data.Append(reinterpret_cast<const uint8*>(&LittleEndianSize), sizeof(uint32));
+	}
+
+	static bool ReadSize(const TArrayView<const uint8> Data, const int32 Offset, uint32& OutSize)
+	{
+		if (Offset + static_cast<int32>(sizeof(uint32)) > Data.Num())
+		{
+			return false;
+		}
+		FMemory::Memcpy(&OutSize, Data.GetData() + Offset, sizeof(uint32));
+		OutSize = INTEL_ORDER32(OutSize);
+		return true;
+	}
+}
+
+namespace WebSocketTextFormat
+{
+	static void AppendMessage(FString& Frame, const FString& Message)
+	{
+		Frame.AppendInt(Message.Len());
+		Frame.AppendChar(TEXT(':'));
+		Frame.Append(Message);
+	}
+}
+
 UWebSocketBase::UWebSocketBase()
 {
 }
@@ -26,8 +67,69 @@ void UWebSocketBase::SendWebSocketMessage(FString MessageString)
 		return;
 	}
 
-	const FString StringMessage = TEXT("Hello there !");
-	Socket->Send(StringMessage);
+	if (bBatchMessages)
+	{
+		WebSocketTextFormat::AppendMessage(OutgoingText, MessageString);
+		return;
+	}
+
+	Socket->Send(MessageString);
+}
+
+void UWebSocketBase::K2_SendWebSocketBinaryMessage(const TArray<uint8>& Data)
+{
+	SendWebSocketBinaryMessage(Data);
+}
+
+void UWebSocketBase::SendWebSocketBinaryMessage(const TArrayView<const uint8> Data)
+{
+	if (!Socket || !Socket->IsConnected())
+	{
+		return;
+	}
+
+	if (bBatchMessages)
+	{
+		WebSocketBinaryFormat::AppendSize(OutgoingBinary, Data.Num());
+		OutgoingBinary.Append(Data.GetData(), Data.Num());
+		return;
+	}
+
+	SendBinaryFrame(Data);
+}
+
+void UWebSocketBase::SendBinaryFrame(const TArrayView<const uint8> Data)
+{
+	using namespace WebSocketBinaryFormat;
+
+	if (!bCompressBinaryMessages)
+	{
+		Socket->Send(Data.GetData(), Data.Num(), true);
+		return;
+	}
+
+	TArray<uint8> Frame;
+	if (Data.Num() >= CompressionThreshold)
+	{
+		const int32 HeaderSize = sizeof(uint8) + sizeof(uint32);
+		int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, Data.Num());
+		Frame.SetNumUninitialized(HeaderSize + CompressedSize);
+		if (FCompression::CompressMemory(NAME_Zlib, Frame.GetData() + HeaderSize, CompressedSize, Data.GetData(),
+		                                 Data.Num()) && CompressedSize < Data.Num())
+		{
+			Frame.SetNum(HeaderSize + CompressedSize);
+			Frame[0] = Compressed;
+			const uint32 UncompressedSize = INTEL_ORDER32(static_cast<uint32>(Data.Num()));
+			FMemory::Memcpy(Frame.GetData() + sizeof(uint8), &UncompressedSize, sizeof(uint32));
+			Socket->Send(Frame.GetData(), Frame.Num(), true);
+			return;
+		}
+	}
+
+	Frame.Reset(Data.Num() + 1);
+	Frame.Add(None);
+	Frame.Append(Data.GetData(), Data.Num());
+	Socket->Send(Frame.GetData(), Frame.Num(), true);
 }
 
 void UWebSocketBase::CloseSocket()
@@ -42,6 +144,8 @@ void UWebSocketBase::CloseSocket()
 		// Don't send if we're not connected.
 		return;
 	}
+
+	FlushOutgoingMessages();
 	Socket->Close();
 }
 
@@ -72,16 +176,186 @@ void UWebSocketBase::Activate(FString NewProtocol, FString NewServerUrl)
 
 	Socket->OnMessage().AddLambda([this](const FString& Message) -> void
 	{
-		this->OnMessage.Broadcast(Message);
+		if (!bBatchMessages)
+		{
+			this->ReceiveMessage(Message);
+			return;
+		}
+
+		this->ReceiveTextFrame(Message);
 	});
 
-	// Socket->OnRawMessage().AddLambda([](const void* Data, SIZE_T Size, SIZE_T BytesRemaining) -> void
-	// {
-	// 	// This code will run when we receive a raw (binary) message from the server.
-	// });
+	Socket->OnRawMessage().AddLambda([this](const void* Data, SIZE_T Size, SIZE_T BytesRemaining) -> void
+	{
+		// Frames may arrive in fragments, whole frames aren't copied
+		if (BytesRemaining == 0 && IncomingFrame.Num() == 0)
+		{
+			this->ReceiveBinaryFrame(MakeArrayView(static_cast<const uint8*>(Data), Size));
+			return;
+		}
+
+		IncomingFrame.Append(static_cast<const uint8*>(Data), Size);
+		if (BytesRemaining == 0)
+		{
+			this->ReceiveBinaryFrame(IncomingFrame);
+			IncomingFrame.Reset();
+		}
+	});
 
 	Socket->OnMessageSent().AddLambda([this](const FString& MessageString) -> void
 	{
 		this->OnMessageSent.Broadcast(MessageString);
 	});
+
+	if (!TickerHandle.IsValid())
+	{
+		TickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+			FTickerDelegate::CreateUObject(this, &ThisClass::HandleTicker));
+	}
+}
+
+void UWebSocketBase::BeginDestroy()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+
+	Super::BeginDestroy();
+}
+
+void UWebSocketBase::ReceiveMessage(const FString& Message)
+{
+	OnMessage.Broadcast(Message);
+
+	// Not kept if nobody would receive them
+	if (OnMessages.IsBound())
+	{
+		IncomingMessages.Add(Message);
+	}
+}
+
+void UWebSocketBase::ReceiveTextFrame(const FString& Frame)
+{
+	int32 Offset = 0;
+	while (Offset < Frame.Len())
+	{
+		int32 SeparatorIdx = Offset;
+		int64 MessageLength = 0;
+		while (SeparatorIdx < Frame.Len() && FChar::IsDigit(Frame[SeparatorIdx]) && MessageLength <= Frame.Len())
+		{
+			MessageLength = MessageLength * 10 + (Frame[SeparatorIdx] - TEXT('0'));
+			SeparatorIdx++;
+		}
+
+		if (SeparatorIdx == Offset || SeparatorIdx >= Frame.Len() || Frame[SeparatorIdx] != TEXT(':')
+			|| SeparatorIdx + 1 + MessageLength > Frame.Len())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Malformed batched web socket message"));
+			return;
+		}
+
+		Offset = SeparatorIdx + 1;
+		ReceiveMessage(Frame.Mid(Offset, static_cast<int32>(MessageLength)));
+		Offset += static_cast<int32>(MessageLength);
+	}
+}
+
+void UWebSocketBase::ReceiveBinaryFrame(TArrayView<const uint8> Data)
+{
+	using namespace WebSocketBinaryFormat;
+
+	TArray<uint8> UncompressedData;
+	if (bCompressBinaryMessages)
+	{
+		if (Data.Num() == 0)
+		{
+			return;
+		}
+
+		const uint8 Flags = Data[0];
+		Data.RightChopInline(1);
+
+		uint32 UncompressedSize = 0;
+		if (Flags & Compressed)
+		{
+			if (!ReadSize(Data, 0, UncompressedSize) || UncompressedSize > MaxUncompressedSize)
+			{
+				return;
+			}
+			Data.RightChopInline(sizeof(uint32));
+
+			UncompressedData.SetNumUninitialized(UncompressedSize);
+			if (!FCompression::UncompressMemory(NAME_Zlib, UncompressedData.GetData(), UncompressedSize,
+			                                    Data.GetData(), Data.Num()))
+			{
+				UE_LOG(LogTemp, Warning, TEXT("Couldn't decompress web socket message"));
+				return;
+			}
+			Data = UncompressedData;
+		}
+	}
+
+	if (!bBatchMessages)
+	{
+		ReceiveBinaryMessage(Data);
+		return;
+	}
+
+	int32 Offset = 0;
+	uint32 MessageSize = 0;
+	while (ReadSize(Data, Offset, MessageSize)
+		&& static_cast<int64>(Offset) + static_cast<int64>(sizeof(uint32)) + MessageSize <= Data.Num())
+	{
+		Offset += sizeof(uint32);
+		ReceiveBinaryMessage(Data.Slice(Offset, MessageSize));
+		Offset += MessageSize;
+	}
+}
+
+void UWebSocketBase::ReceiveBinaryMessage(const TArrayView<const uint8> Data)
+{
+	if (OnBinaryMessages.IsBound())
+	{
+		IncomingBinaryMessages.AddDefaulted_GetRef().Data = Data;
+	}
+}
+
+bool UWebSocketBase::HandleTicker(float DeltaTime)
+{
+	FlushOutgoingMessages();
+
+	// Delegates may send or receive messages
+	if (IncomingMessages.Num() > 0)
+	{
+		const TArray<FString> Messages = MoveTemp(IncomingMessages);
+		OnMessages.Broadcast(Messages);
+	}
+
+	if (IncomingBinaryMessages.Num() > 0)
+	{
+		const TArray<FWebSocketBinaryMessage> Messages = MoveTemp(IncomingBinaryMessages);
+		OnBinaryMessages.Broadcast(Messages);
+	}
+
+	return true;
+}
+
+void UWebSocketBase::FlushOutgoingMessages()
+{
+	if (!Socket || !Socket->IsConnected())
+	{
+		OutgoingText.Reset();
+		OutgoingBinary.Reset();
+		return;
+	}
+
+	if (!OutgoingText.IsEmpty())
+	{
+		Socket->Send(OutgoingText);
+		OutgoingText.Reset();
+	}
+
+	if (OutgoingBinary.Num() > 0)
+	{
+		SendBinaryFrame(OutgoingBinary);
+		OutgoingBinary.Reset();
+	}
 }
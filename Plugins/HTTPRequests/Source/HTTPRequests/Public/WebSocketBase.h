@@ -2,10 +2,20 @@
 
 #include "CoreMinimal.h"
 #include "Kismet/BlueprintAsyncActionBase.h"
+#include "Containers/Ticker.h"
 #include "WebSocketsModule.h"
 #include "IWebSocket.h"
 #include "WebSocketBase.generated.h"
 
+USTRUCT(BlueprintType)
+struct FWebSocketBinaryMessage
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly)
+	TArray<uint8> Data;
+};
+
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FWebSocketConnected);
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FWebSocketConnectionError, const FString &, Error);
@@ -15,9 +25,27 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FWebSocketClosed, int32, StatusCo
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FWebSocketOnMessage, const FString &, Message);
 
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FWebSocketOnMessages, const TArray<FString>&, Messages);
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FWebSocketOnBinaryMessages, const TArray<FWebSocketBinaryMessage>&,
+                                            Messages);
+
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FWebSocketMessageSent, const FString&, MessageString);
 
 
+/**
+ * Web socket with text and binary messages.
+ *
+ * Messages received during a frame are delivered together by OnMessages and OnBinaryMessages at the start
+ * of next frame, which is cheaper than OnMessage call per message when there are many small ones.
+ *
+ * With bBatchMessages, messages sent during a frame are sent together as one frame by the ticker of next frame:
+ * text messages prefixed with decimal length in UTF-16 code units and a colon ("5:hello"), binary messages prefixed
+ * with uint32 little endian size. Incoming frames are split the same way, so server must use the same format.
+ *
+ * With bCompressBinaryMessages, binary frames start with a byte of flags, and ones of at least
+ * CompressionThreshold bytes are compressed with zlib if it makes them smaller.
+ */
 UCLASS()
 class HTTPREQUESTS_API UWebSocketBase : public UObject
 {
@@ -38,20 +66,72 @@ public:
 	UPROPERTY(BlueprintAssignable)
 	FWebSocketOnMessage OnMessage;
 
+	/** Text messages received since previous frame */
+	UPROPERTY(BlueprintAssignable)
+	FWebSocketOnMessages OnMessages;
+
+	/** Binary messages received since previous frame */
+	UPROPERTY(BlueprintAssignable)
+	FWebSocketOnBinaryMessages OnBinaryMessages;
+
 	UPROPERTY(BlueprintAssignable)
 	FWebSocketMessageSent OnMessageSent;
 
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	bool bBatchMessages = false;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	bool bCompressBinaryMessages = false;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	int32 CompressionThreshold = 256;
+
 	UFUNCTION(BlueprintCallable)
 	void Connect();
 
 	UFUNCTION(BlueprintCallable)
 	void SendWebSocketMessage(FString MessageString);
 
+	UFUNCTION(BlueprintCallable, meta=(DisplayName="Send Web Socket Binary Message"))
+	void K2_SendWebSocketBinaryMessage(const TArray<uint8>& Data);
+
+	/** Data isn't copied unless message is batched or compressed */
+	void SendWebSocketBinaryMessage(TArrayView<const uint8> Data);
+
 	UFUNCTION(BlueprintCallable)
 	void CloseSocket();
 
 	void Activate(FString NewProtocol, FString NewServerUrl);
 
+	virtual void BeginDestroy() override;
+
 private:
+	void SendBinaryFrame(TArrayView<const uint8> Data);
+
+	void ReceiveMessage(const FString& Message);
+
+	void ReceiveTextFrame(const FString& Frame);
+
+	void ReceiveBinaryFrame(TArrayView<const uint8> Data);
+
+	void ReceiveBinaryMessage(TArrayView<const uint8> Data);
+
+	/** Delivers received messages and sends batched ones */
+	bool HandleTicker(float DeltaTime);
+
+	void FlushOutgoingMessages();
+
 	TSharedPtr<IWebSocket> Socket;
+
+	FTSTicker::FDelegateHandle TickerHandle;
+
+	/** Fragments of binary frame being received */
+	TArray<uint8> IncomingFrame;
+
+	TArray<FString> IncomingMessages;
+	TArray<FWebSocketBinaryMessage> IncomingBinaryMessages;
+
+	/** Batched messages */
+	FString OutgoingText;
+	TArray<uint8> OutgoingBinary;
 };
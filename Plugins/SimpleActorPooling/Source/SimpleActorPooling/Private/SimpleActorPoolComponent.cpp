@@ -1,98 +1,93 @@
 ﻿#include "SimpleActorPoolComponent.h"
 
-#include "IPoolableActor.h"
-
-FActorPool::FActorPool()
-{
-	ActorArray = {};
-}
+#include "Engine/World.h"
 
 USimpleActorPoolComponent::USimpleActorPoolComponent()
 {
 }
 
-AActor* USimpleActorPoolComponent::RetrieveActorFromPool(UClass* ActorClass, FTransform SpawnTransform, bool bLogDebug)
+void USimpleActorPoolComponent::BeginPlay()
 {
-	// First try to return a free actor from pool
-	if (FActorPool* Pool = PoolMap.Find(ActorClass))
+	Super::BeginPlay();
+
+	if (USimpleActorPoolSubsystem* PoolSubsystem = GetPoolSubsystem())
 	{
-		if (!Pool->ActorArray.IsEmpty())
+		// Several components may register the same class, only missing actors are pre-warmed
+		for (const TPair<TSubclassOf<AActor>, FActorPoolClassSettings>& Pair : PoolSettings)
 		{
-			AActor* Actor = Pool->ActorArray.Pop();
-			if (Actor)
-			{
-				if (bLogDebug)
-				{
-					UE_LOG(LogTemp, Warning, TEXT("SimplePool: retrieved actor from pool"))
-				}
-				Actor->SetActorTransform(SpawnTransform);
-				IPoolableActor::Execute_OnSpawnedFromPool(Actor, false);
-				return Actor;
-			}
+			const FActorPoolClassSettings Settings = PoolSubsystem->MergeClassSettings(Pair.Key, Pair.Value);
+			PoolSubsystem->PrewarmPoolTo(Pair.Key, FMath::Max(Settings.PrewarmCount, Settings.LowWatermark));
 		}
 	}
+}
 
-	// Didn't find free actor in pool, need to spawn a new one
-	if (UWorld* World = GetWorld())
+void USimpleActorPoolComponent::PrewarmPool(TSubclassOf<AActor> ActorClass, int32 Count)
+{
+	if (USimpleActorPoolSubsystem* PoolSubsystem = GetPoolSubsystem())
 	{
-		FActorSpawnParameters Params;
-		Params.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
-		AActor* SpawnedActor = World->SpawnActor<AActor>(ActorClass, Params);
-		if (bLogDebug)
-		{
-			UE_LOG(LogTemp, Warning, TEXT("SimplePool: had to spawn new actor"))
-		}
-		if (SpawnedActor)
-		{
-			SpawnedActor->SetActorTransform(SpawnTransform);
-			IPoolableActor::Execute_OnSpawnedFromPool(SpawnedActor, true);
+		PoolSubsystem->PrewarmPool(ActorClass, Count);
+	}
+}
 
-			if (!PoolMap.Contains(ActorClass))
-			{
-				PoolMap.Add(ActorClass, {});
-			}
+void USimpleActorPoolComponent::TrimPool(TSubclassOf<AActor> ActorClass)
+{
+	if (USimpleActorPoolSubsystem* PoolSubsystem = GetPoolSubsystem())
+	{
+		PoolSubsystem->TrimPool(ActorClass);
+	}
+}
 
-			return SpawnedActor;
-		} else
-		{
-			UE_LOG(LogTemp, Error, TEXT("SimplePool: SPAWNED ACTOR NULL"))
-		}
-	} else
+FActorPoolStats USimpleActorPoolComponent::GetPoolStats(TSubclassOf<AActor> ActorClass) const
+{
+	if (const USimpleActorPoolSubsystem* PoolSubsystem = GetPoolSubsystem())
 	{
-		if (bLogDebug)
-		{
-			UE_LOG(LogTemp, Error, TEXT("SimplePool: WORLD NULL"))
-		}
+		return PoolSubsystem->GetPoolStats(ActorClass);
 	}
+	return FActorPoolStats{};
+}
 
+AActor* USimpleActorPoolComponent::RetrieveActorFromPool(UClass* ActorClass, FTransform SpawnTransform, bool bLogDebug)
+{
+	if (USimpleActorPoolSubsystem* PoolSubsystem = GetPoolSubsystem())
+	{
+		return PoolSubsystem->RetrieveActorFromPool(ActorClass, SpawnTransform, bLogDebug);
+	}
+
+	if (bLogDebug)
+	{
+		UE_LOG(LogTemp, Error, TEXT("SimplePool: WORLD NULL"))
+	}
 	return nullptr;
 }
 
 void USimpleActorPoolComponent::ReturnActorToPool(AActor* Actor, bool bLogDebug)
 {
-	if (!Actor)
+	if (USimpleActorPoolSubsystem* PoolSubsystem = GetPoolSubsystem())
 	{
-		return;
+		PoolSubsystem->ReturnActorToPool(Actor, bLogDebug);
 	}
+}
 
-	UClass* ActorClass = Actor->GetClass();
-
-	// Only return to pool if pool map already knows about this class
-	if (FActorPool* Pool = PoolMap.Find(ActorClass))
+TArray<UClass*> USimpleActorPoolComponent::GetPoolMapCurrentKeys() const
+{
+	if (const USimpleActorPoolSubsystem* PoolSubsystem = GetPoolSubsystem())
 	{
-		if (bLogDebug)
-		{
-			UE_LOG(LogTemp, Warning, TEXT("SimplePool: returned actor to pool"))
-		}
-
-		Pool->ActorArray.AddUnique(Actor);
-		IPoolableActor::Execute_OnReturnedToPool(Actor);
+		return PoolSubsystem->GetPoolMapCurrentKeys();
 	}
-	else
+	return {};
+}
+
+int32 USimpleActorPoolComponent::GetPoolMapCurrentValueSize(UClass* Class) const
+{
+	if (const USimpleActorPoolSubsystem* PoolSubsystem = GetPoolSubsystem())
 	{
-		if (bLogDebug)
-		{
-			UE_LOG(LogTemp, Error, TEXT("SimplePool: RETURN FAILED: NO KEY!"))
-		}
+		return PoolSubsystem->GetPoolMapCurrentValueSize(Class);
 	}
+	return -1;
+}
+
+USimpleActorPoolSubsystem* USimpleActorPoolComponent::GetPoolSubsystem() const
+{
+	const UWorld* World = GetWorld();
+	return World ? World->GetSubsystem<USimpleActorPoolSubsystem>() : nullptr;
 }
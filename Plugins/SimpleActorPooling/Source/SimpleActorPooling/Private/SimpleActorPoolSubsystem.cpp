@@ -0,0 +1,373 @@
+﻿#include "SimpleActorPoolSubsystem.h"
+
+#include "Engine/World.h"
+#include "IPoolableActor.h"
+
+FActorPool::FActorPool()
+{
+	ActorArray = {};
+	PendingSpawnCount = 0;
+}
+
+USimpleActorPoolSubsystem::USimpleActorPoolSubsystem()
+{
+	PrewarmTimeSliceMs = 1.0f;
+}
+
+void USimpleActorPoolSubsystem::Deinitialize()
+{
+	SpawnQueue.Empty();
+	PooledActorStates.Empty();
+	PoolMap.Empty();
+
+	Super::Deinitialize();
+}
+
+void USimpleActorPoolSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const double EndTime = FPlatformTime::Seconds() + PrewarmTimeSliceMs / 1000.0;
+	bool bSpawnedAny = false;
+
+	while (!SpawnQueue.IsEmpty() && (!bSpawnedAny || FPlatformTime::Seconds() < EndTime))
+	{
+		UClass* ActorClass = SpawnQueue[0].ActorClass;
+		if (--SpawnQueue[0].Count <= 0)
+		{
+			SpawnQueue.RemoveAt(0);
+		}
+
+		FActorPool& PendingPool = PoolMap.FindOrAdd(ActorClass);
+		PendingPool.PendingSpawnCount = FMath::Max(PendingPool.PendingSpawnCount - 1, 0);
+
+		// Spawning can run arbitrary game code, so pool is looked up again afterwards
+		if (AActor* SpawnedActor = SpawnActorForPool(ActorClass, FTransform::Identity))
+		{
+			IPoolableActor::Execute_OnReturnedToPool(SpawnedActor);
+			DeactivatePooledActor(SpawnedActor);
+
+			FActorPool& Pool = PoolMap.FindOrAdd(ActorClass);
+			AddToFreeActors(Pool, SpawnedActor);
+			Pool.NeverRetrievedActorSet.Add(SpawnedActor);
+		}
+		bSpawnedAny = true;
+	}
+}
+
+bool USimpleActorPoolSubsystem::IsTickable() const
+{
+	return !SpawnQueue.IsEmpty();
+}
+
+TStatId USimpleActorPoolSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USimpleActorPoolSubsystem, STATGROUP_Tickables);
+}
+
+void USimpleActorPoolSubsystem::PrewarmPool(TSubclassOf<AActor> ActorClass, int32 Count)
+{
+	if (!ActorClass || Count <= 0)
+	{
+		return;
+	}
+
+	FActorPool& Pool = PoolMap.FindOrAdd(ActorClass);
+	Pool.PendingSpawnCount += Count;
+
+	FActorPoolSpawnRequest& Request = SpawnQueue.AddDefaulted_GetRef();
+	Request.ActorClass = ActorClass;
+	Request.Count = Count;
+}
+
+void USimpleActorPoolSubsystem::PrewarmPoolTo(TSubclassOf<AActor> ActorClass, const int32 Count)
+{
+	if (!ActorClass)
+	{
+		return;
+	}
+
+	const FActorPool& Pool = PoolMap.FindOrAdd(ActorClass);
+	PrewarmPool(ActorClass, Count - Pool.ActorArray.Num() - Pool.PendingSpawnCount);
+}
+
+void USimpleActorPoolSubsystem::TrimPool(TSubclassOf<AActor> ActorClass)
+{
+	if (FActorPool* Pool = PoolMap.Find(ActorClass))
+	{
+		const int32 LowWatermark = GetClassSettings(ActorClass).LowWatermark;
+		FActorPoolStats& Stats = StatsMap.FindOrAdd(ActorClass);
+
+		while (Pool->ActorArray.Num() > LowWatermark)
+		{
+			AActor* Actor = Pool->ActorArray.Pop();
+			Pool->ActorSet.Remove(Actor);
+			Pool->NeverRetrievedActorSet.Remove(Actor);
+			PooledActorStates.Remove(Actor);
+			if (IsValid(Actor))
+			{
+				Actor->Destroy();
+				Stats.Trims++;
+			}
+		}
+	}
+}
+
+void USimpleActorPoolSubsystem::SetClassSettings(TSubclassOf<AActor> ActorClass,
+                                                 const FActorPoolClassSettings& Settings)
+{
+	if (ActorClass)
+	{
+		SettingsMap.Add(ActorClass, Settings);
+	}
+}
+
+FActorPoolClassSettings USimpleActorPoolSubsystem::MergeClassSettings(TSubclassOf<AActor> ActorClass,
+                                                                     const FActorPoolClassSettings& Settings)
+{
+	if (!ActorClass)
+	{
+		return Settings;
+	}
+
+	FActorPoolClassSettings* ExistingSettings = SettingsMap.Find(ActorClass);
+	if (!ExistingSettings)
+	{
+		return SettingsMap.Add(ActorClass, Settings);
+	}
+
+	FActorPoolClassSettings& Merged = *ExistingSettings;
+	if (Merged.PrewarmCount != Settings.PrewarmCount || Merged.LowWatermark != Settings.LowWatermark
+		|| Merged.HighWatermark != Settings.HighWatermark)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("SimplePool: conflicting settings of %s, bigger values are used"),
+		       *ActorClass->GetName())
+	}
+
+	Merged.PrewarmCount = FMath::Max(Merged.PrewarmCount, Settings.PrewarmCount);
+	Merged.LowWatermark = FMath::Max(Merged.LowWatermark, Settings.LowWatermark);
+	// 0 is unbounded, so it wins
+	Merged.HighWatermark = Merged.HighWatermark == 0 || Settings.HighWatermark == 0
+		                       ? 0
+		                       : FMath::Max(Merged.HighWatermark, Settings.HighWatermark);
+	return Merged;
+}
+
+FActorPoolClassSettings USimpleActorPoolSubsystem::GetClassSettings(TSubclassOf<AActor> ActorClass) const
+{
+	if (const FActorPoolClassSettings* Settings = SettingsMap.Find(ActorClass))
+	{
+		return *Settings;
+	}
+	return FActorPoolClassSettings{};
+}
+
+FActorPoolStats USimpleActorPoolSubsystem::GetPoolStats(TSubclassOf<AActor> ActorClass) const
+{
+	if (const FActorPoolStats* Stats = StatsMap.Find(ActorClass))
+	{
+		return *Stats;
+	}
+	return FActorPoolStats{};
+}
+
+TArray<UClass*> USimpleActorPoolSubsystem::GetPoolMapCurrentKeys() const
+{
+	TArray<UClass*> Out;
+	PoolMap.GetKeys(Out);
+	return Out;
+}
+
+int32 USimpleActorPoolSubsystem::GetPoolMapCurrentValueSize(UClass* Class) const
+{
+	if (const FActorPool* ActorPool = PoolMap.Find(Class))
+	{
+		return ActorPool->ActorArray.Num();
+	}
+	return -1;
+}
+
+AActor* USimpleActorPoolSubsystem::SpawnActorForPool(UClass* ActorClass, const FTransform& SpawnTransform)
+{
+	UWorld* World = GetWorld();
+	if (!World)
+	{
+		return nullptr;
+	}
+
+	FActorSpawnParameters Params;
+	Params.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+	AActor* SpawnedActor = World->SpawnActor<AActor>(ActorClass, SpawnTransform, Params);
+	if (SpawnedActor)
+	{
+		StatsMap.FindOrAdd(ActorClass).Spawns++;
+	}
+	else
+	{
+		UE_LOG(LogTemp, Error, TEXT("SimplePool: SPAWNED ACTOR NULL"))
+	}
+	return SpawnedActor;
+}
+
+void USimpleActorPoolSubsystem::AddToFreeActors(FActorPool& Pool, AActor* Actor)
+{
+	Pool.ActorArray.Add(Actor);
+	Pool.ActorSet.Add(Actor);
+}
+
+void USimpleActorPoolSubsystem::RequestRefill(UClass* ActorClass, FActorPool& Pool)
+{
+	PrewarmPoolTo(ActorClass, GetClassSettings(ActorClass).LowWatermark);
+}
+
+void USimpleActorPoolSubsystem::DeactivatePooledActor(AActor* Actor)
+{
+	FPooledActorState& State = PooledActorStates.Add(Actor);
+	State.bHidden = Actor->IsHidden();
+	State.bCollisionEnabled = Actor->GetActorEnableCollision();
+	State.bAlwaysRelevant = Actor->bAlwaysRelevant;
+	State.NetDormancy = Actor->NetDormancy;
+
+	Actor->SetActorHiddenInGame(true);
+	Actor->SetActorEnableCollision(false);
+
+	if (Actor->GetIsReplicated() && Actor->HasAuthority())
+	{
+		// Hidden state has to reach clients before channels are closed by dormancy
+		Actor->bAlwaysRelevant = false;
+		Actor->FlushNetDormancy();
+		Actor->SetNetDormancy(DORM_DormantAll);
+	}
+}
+
+void USimpleActorPoolSubsystem::ActivatePooledActor(AActor* Actor)
+{
+	FPooledActorState State;
+	PooledActorStates.RemoveAndCopyValue(Actor, State);
+
+	Actor->SetActorHiddenInGame(State.bHidden);
+	Actor->SetActorEnableCollision(State.bCollisionEnabled);
+
+	if (Actor->GetIsReplicated() && Actor->HasAuthority())
+	{
+		Actor->bAlwaysRelevant = State.bAlwaysRelevant;
+		Actor->SetNetDormancy(State.NetDormancy);
+		Actor->ForceNetUpdate();
+	}
+}
+
+AActor* USimpleActorPoolSubsystem::RetrieveActorFromPool(UClass* ActorClass, FTransform SpawnTransform, bool bLogDebug)
+{
+	// First try to return a free actor from pool
+	if (FActorPool* Pool = PoolMap.Find(ActorClass))
+	{
+		while (!Pool->ActorArray.IsEmpty())
+		{
+			AActor* Actor = Pool->ActorArray.Pop();
+			Pool->ActorSet.Remove(Actor);
+			const bool bFirstTimeRetrieved = Pool->NeverRetrievedActorSet.Remove(Actor) > 0;
+
+			// Actor could have been destroyed while in pool
+			if (IsValid(Actor))
+			{
+				if (bLogDebug)
+				{
+					UE_LOG(LogTemp, Warning, TEXT("SimplePool: retrieved actor from pool"))
+				}
+				StatsMap.FindOrAdd(ActorClass).Hits++;
+				RequestRefill(ActorClass, *Pool);
+
+				Actor->SetActorTransform(SpawnTransform);
+				ActivatePooledActor(Actor);
+				IPoolableActor::Execute_OnSpawnedFromPool(Actor, bFirstTimeRetrieved);
+				return Actor;
+			}
+			PooledActorStates.Remove(Actor);
+		}
+	}
+
+	// Didn't find free actor in pool, need to spawn a new one
+	if (GetWorld())
+	{
+		AActor* SpawnedActor = SpawnActorForPool(ActorClass, SpawnTransform);
+		if (bLogDebug)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("SimplePool: had to spawn new actor"))
+		}
+		if (SpawnedActor)
+		{
+			StatsMap.FindOrAdd(ActorClass).Misses++;
+			IPoolableActor::Execute_OnSpawnedFromPool(SpawnedActor, true);
+
+			FActorPool& Pool = PoolMap.FindOrAdd(ActorClass);
+			RequestRefill(ActorClass, Pool);
+
+			return SpawnedActor;
+		}
+	} else
+	{
+		if (bLogDebug)
+		{
+			UE_LOG(LogTemp, Error, TEXT("SimplePool: WORLD NULL"))
+		}
+	}
+
+	return nullptr;
+}
+
+void USimpleActorPoolSubsystem::ReturnActorToPool(AActor* Actor, bool bLogDebug)
+{
+	if (!Actor)
+	{
+		return;
+	}
+
+	// Replicated actors are owned by server, clients can't reuse them
+	if (Actor->GetIsReplicated() && !Actor->HasAuthority())
+	{
+		if (bLogDebug)
+		{
+			UE_LOG(LogTemp, Error, TEXT("SimplePool: RETURN FAILED: REPLICATED ACTOR WITHOUT AUTHORITY!"))
+		}
+		return;
+	}
+
+	UClass* ActorClass = Actor->GetClass();
+
+	// Only return to pool if pool map already knows about this class
+	if (FActorPool* Pool = PoolMap.Find(ActorClass))
+	{
+		if (Pool->ActorSet.Contains(Actor))
+		{
+			return;
+		}
+
+		const int32 HighWatermark = GetClassSettings(ActorClass).HighWatermark;
+		if (HighWatermark > 0 && Pool->ActorArray.Num() >= HighWatermark)
+		{
+			if (bLogDebug)
+			{
+				UE_LOG(LogTemp, Warning, TEXT("SimplePool: pool is full, destroying returned actor"))
+			}
+			StatsMap.FindOrAdd(ActorClass).Trims++;
+			Actor->Destroy();
+			return;
+		}
+
+		if (bLogDebug)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("SimplePool: returned actor to pool"))
+		}
+
+		AddToFreeActors(*Pool, Actor);
+		IPoolableActor::Execute_OnReturnedToPool(Actor);
+		DeactivatePooledActor(Actor);
+	}
+	else
+	{
+		if (bLogDebug)
+		{
+			UE_LOG(LogTemp, Error, TEXT("SimplePool: RETURN FAILED: NO KEY!"))
+		}
+	}
+}
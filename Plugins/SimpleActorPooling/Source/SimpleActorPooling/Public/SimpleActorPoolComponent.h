@@ -3,26 +3,17 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "SimpleActorPoolSubsystem.h"
 #include "SimpleActorPoolComponent.generated.h"
 
 
-USTRUCT()
-struct FActorPool
-{
-	GENERATED_BODY()
-
-	FActorPool();
-
-	UPROPERTY()
-	TArray<AActor*> ActorArray;
-};
-
 /**
- * Simple storage of several actor pools of different classes, allowing to
+ * Convenience access to actor pools of the world, allowing to
  * retrieve an actor from pool or return it there after usage
  *
- * Need to store array on something that isn't destroyed, Player Controller for map (recommended)
- * or GameInstance for the whole game
+ * Pools themselves are stored in USimpleActorPoolSubsystem and shared between all components,
+ * so the component can live on any actor. Capacity settings of the component are merged into
+ * ones of the subsystem on begin play and classes are pre-warmed up to PrewarmCount
  */
 UCLASS(Blueprintable, Meta=(BlueprintSpawnableComponent))
 class SIMPLEACTORPOOLING_API USimpleActorPoolComponent : public UActorComponent
@@ -31,6 +22,20 @@ class SIMPLEACTORPOOLING_API USimpleActorPoolComponent : public UActorComponent
 
 	USimpleActorPoolComponent();
 
+public:
+	virtual void BeginPlay() override;
+
+	/** Queues Count actors of class to be spawned into pool over next frames */
+	UFUNCTION(BlueprintCallable)
+	void PrewarmPool(TSubclassOf<AActor> ActorClass, int32 Count);
+
+	/** Destroys free actors of class above its low watermark */
+	UFUNCTION(BlueprintCallable)
+	void TrimPool(TSubclassOf<AActor> ActorClass);
+
+	UFUNCTION(BlueprintCallable)
+	FActorPoolStats GetPoolStats(TSubclassOf<AActor> ActorClass) const;
+
 protected:
 	UFUNCTION(BlueprintCallable)
 	AActor* RetrieveActorFromPool(UClass* ActorClass, FTransform SpawnTransform, bool bLogDebug = false);
@@ -39,23 +44,14 @@ protected:
 	void ReturnActorToPool(AActor* Actor, bool bLogDebug = false);
 
 	UFUNCTION(BlueprintCallable)
-	FORCEINLINE TArray<UClass*> GetPoolMapCurrentKeys() const
-	{
-		TArray<UClass*> Out;
-		PoolMap.GetKeys(Out);
-		return Out;
-	}
+	TArray<UClass*> GetPoolMapCurrentKeys() const;
 
 	UFUNCTION(BlueprintCallable)
-	FORCEINLINE int32 GetPoolMapCurrentValueSize(UClass* Class) const
-	{
-		if (const FActorPool* ActorPool = PoolMap.Find(Class))
-		{
-			return ActorPool->ActorArray.Num();
-		}
-		return -1;
-	}
-private:
-	UPROPERTY()
-	TMap<UClass*, FActorPool> PoolMap;
+	int32 GetPoolMapCurrentValueSize(UClass* Class) const;
+
+	/** Capacity settings per class, merged into settings of the pool subsystem on begin play */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TMap<TSubclassOf<AActor>, FActorPoolClassSettings> PoolSettings;
+
+	USimpleActorPoolSubsystem* GetPoolSubsystem() const;
 };
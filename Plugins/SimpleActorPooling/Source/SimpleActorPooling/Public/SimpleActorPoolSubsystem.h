@@ -0,0 +1,209 @@
+﻿// Copyleft: All rights reversed
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "SimpleActorPoolSubsystem.generated.h"
+
+
+USTRUCT()
+struct FActorPool
+{
+	GENERATED_BODY()
+
+	FActorPool();
+
+	/** Free actors, used as a stack */
+	UPROPERTY()
+	TArray<AActor*> ActorArray;
+
+	/** Same actors as in ActorArray, for O(1) membership checks */
+	TSet<TObjectKey<AActor>> ActorSet;
+
+	/** Pre-warmed actors that were never retrieved from pool yet */
+	TSet<TObjectKey<AActor>> NeverRetrievedActorSet;
+
+	/** Amount of actors queued for time sliced spawning */
+	int32 PendingSpawnCount;
+};
+
+/** Capacity settings of a pool for one actor class */
+USTRUCT(BlueprintType)
+struct FActorPoolClassSettings
+{
+	GENERATED_BODY()
+
+	FActorPoolClassSettings()
+	{
+		PrewarmCount = 0;
+		LowWatermark = 0;
+		HighWatermark = 0;
+	}
+
+	/** How many actors to spawn into pool on begin play, spread over frames */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 PrewarmCount;
+
+	/** If amount of free actors falls below this value, pool is refilled to it over next frames */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 LowWatermark;
+
+	/** Max amount of free actors kept in pool, actors returned above it are destroyed. 0 means unbounded */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 HighWatermark;
+};
+
+/** Usage counters of a pool for one actor class */
+USTRUCT(BlueprintType)
+struct FActorPoolStats
+{
+	GENERATED_BODY()
+
+	FActorPoolStats()
+	{
+		Hits = 0;
+		Misses = 0;
+		Spawns = 0;
+		Trims = 0;
+	}
+
+	/** Retrievals served by a free actor from pool */
+	UPROPERTY(BlueprintReadOnly)
+	int32 Hits;
+
+	/** Retrievals that had to spawn an actor synchronously */
+	UPROPERTY(BlueprintReadOnly)
+	int32 Misses;
+
+	/** All spawned actors, including pre-warmed ones */
+	UPROPERTY(BlueprintReadOnly)
+	int32 Spawns;
+
+	/** Actors destroyed because pool was above its capacity */
+	UPROPERTY(BlueprintReadOnly)
+	int32 Trims;
+};
+
+/** Actors of class waiting to be spawned into pool */
+USTRUCT()
+struct FActorPoolSpawnRequest
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TSubclassOf<AActor> ActorClass;
+
+	UPROPERTY()
+	int32 Count = 0;
+};
+
+/** State of actor before it was put to pool, restored on retrieval */
+struct FPooledActorState
+{
+	bool bHidden = false;
+	bool bCollisionEnabled = true;
+	bool bAlwaysRelevant = false;
+	ENetDormancy NetDormancy = DORM_Awake;
+};
+
+/**
+ * Actor pools of the world shared by all pool components and blueprints, allowing to
+ * retrieve an actor from pool or return it there after usage
+ *
+ * Pools can be pre-warmed and refilled to their low watermark, such spawns are spread over frames
+ * within PrewarmTimeSliceMs, so that they happen during loading instead of mid-fight
+ *
+ * Replicated actors can be pooled on server only. While in pool they are hidden, not always relevant
+ * and dormant, so that their channels are closed without destroying them on clients
+ */
+UCLASS()
+class SIMPLEACTORPOOLING_API USimpleActorPoolSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	USimpleActorPoolSubsystem();
+
+	//~UTickableWorldSubsystem interface
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	//~End of UTickableWorldSubsystem interface
+
+	UFUNCTION(BlueprintCallable)
+	AActor* RetrieveActorFromPool(UClass* ActorClass, FTransform SpawnTransform, bool bLogDebug = false);
+
+	UFUNCTION(BlueprintCallable)
+	void ReturnActorToPool(AActor* Actor, bool bLogDebug = false);
+
+	/** Queues Count actors of class to be spawned into pool over next frames */
+	UFUNCTION(BlueprintCallable)
+	void PrewarmPool(TSubclassOf<AActor> ActorClass, int32 Count);
+
+	/** Queues spawning of actors missing for pool of class to have Count free actors, pending spawns included */
+	UFUNCTION(BlueprintCallable)
+	void PrewarmPoolTo(TSubclassOf<AActor> ActorClass, int32 Count);
+
+	/** Destroys free actors of class above its low watermark */
+	UFUNCTION(BlueprintCallable)
+	void TrimPool(TSubclassOf<AActor> ActorClass);
+
+	/** Sets capacity settings of class, classes without them are unbounded and not pre-warmed */
+	UFUNCTION(BlueprintCallable)
+	void SetClassSettings(TSubclassOf<AActor> ActorClass, const FActorPoolClassSettings& Settings);
+
+	/**
+	 * Merges settings into ones of class already set, eg by other pool components: the bigger of counts is kept,
+	 * conflicting values are logged. Returns merged settings
+	 */
+	FActorPoolClassSettings MergeClassSettings(TSubclassOf<AActor> ActorClass, const FActorPoolClassSettings& Settings);
+
+	UFUNCTION(BlueprintCallable)
+	FActorPoolClassSettings GetClassSettings(TSubclassOf<AActor> ActorClass) const;
+
+	UFUNCTION(BlueprintCallable)
+	FActorPoolStats GetPoolStats(TSubclassOf<AActor> ActorClass) const;
+
+	UFUNCTION(BlueprintCallable)
+	TArray<UClass*> GetPoolMapCurrentKeys() const;
+
+	UFUNCTION(BlueprintCallable)
+	int32 GetPoolMapCurrentValueSize(UClass* Class) const;
+
+	/** Max time per frame spent on spawning pre-warmed actors, at least one actor is spawned per frame anyway */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float PrewarmTimeSliceMs;
+
+protected:
+	AActor* SpawnActorForPool(UClass* ActorClass, const FTransform& SpawnTransform);
+
+	void AddToFreeActors(FActorPool& Pool, AActor* Actor);
+
+	/** Queues refill of pool up to its low watermark */
+	void RequestRefill(UClass* ActorClass, FActorPool& Pool);
+
+	/** Hides actor and makes it dormant on server, remembering its previous state */
+	void DeactivatePooledActor(AActor* Actor);
+
+	/** Restores state of actor saved when it was put to pool */
+	void ActivatePooledActor(AActor* Actor);
+
+private:
+	UPROPERTY()
+	TMap<UClass*, FActorPool> PoolMap;
+
+	UPROPERTY()
+	TMap<UClass*, FActorPoolClassSettings> SettingsMap;
+
+	UPROPERTY()
+	TMap<UClass*, FActorPoolStats> StatsMap;
+
+	UPROPERTY()
+	TArray<FActorPoolSpawnRequest> SpawnQueue;
+
+	TMap<TObjectKey<AActor>, FPooledActorState> PooledActorStates;
+};
@@ -0,0 +1,150 @@
+﻿#include "GameplayAnalyticsAggregator.h"
+#include "GameplayAnalyticsStreamWriter.h"
+
+void FGameplayAnalyticsAggregator::FSum::Add(const double Value)
+{
+	Min = Count > 0 ? FMath::Min(Min, Value) : Value;
+	Max = Count > 0 ? FMath::Max(Max, Value) : Value;
+	Sum += Value;
+	Count++;
+}
+
+void FGameplayAnalyticsAggregator::AddToCounter(const FGameplayTag& Metric, const FName Faction, const int64 Count)
+{
+	Counters.FindOrAdd({Metric, Faction}) += Count;
+}
+
+void FGameplayAnalyticsAggregator::AddToSum(const FGameplayTag& Metric, const FName Faction, const double Value)
+{
+	Sums.FindOrAdd({Metric, Faction}).Add(Value);
+}
+
+void FGameplayAnalyticsAggregator::AddToHistogram(const FGameplayTag& Metric, const FName Faction, const double Value)
+{
+	const FHistogramLayout Layout = HistogramLayouts.FindRef(Metric);
+
+	FHistogram& Histogram = Histograms.FindOrAdd({Metric, Faction});
+	if (Histogram.Buckets.Num() != Layout.NumBuckets + 2)
+	{
+		Histogram.Buckets.Init(0, Layout.NumBuckets + 2);
+	}
+
+	const double BucketPosition = (Value - Layout.Min) / FMath::Max(Layout.BucketWidth, UE_SMALL_NUMBER);
+	const int32 Bucket = BucketPosition < 0.0
+		                     ? 0
+		                     : 1 + static_cast<int32>(FMath::Min(BucketPosition, static_cast<double>(Layout.NumBuckets)));
+
+	Histogram.Buckets[Bucket]++;
+	Histogram.Sum.Add(Value);
+}
+
+void FGameplayAnalyticsAggregator::SetHistogramLayout(const FGameplayTag& Metric, const float Min,
+                                                      const float BucketWidth, const int32 NumBuckets)
+{
+	FHistogramLayout& Layout = HistogramLayouts.FindOrAdd(Metric);
+	Layout.Min = Min;
+	Layout.BucketWidth = BucketWidth;
+	Layout.NumBuckets = FMath::Max(NumBuckets, 1);
+}
+
+bool FGameplayAnalyticsAggregator::HasData() const
+{
+	for (const TPair<FKey, int64>& Counter : Counters)
+	{
+		if (Counter.Value != 0)
+		{
+			return true;
+		}
+	}
+
+	for (const TPair<FKey, FSum>& Sum : Sums)
+	{
+		if (Sum.Value.Count > 0)
+		{
+			return true;
+		}
+	}
+
+	for (const TPair<FKey, FHistogram>& Histogram : Histograms)
+	{
+		if (Histogram.Value.Sum.Count > 0)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void FGameplayAnalyticsAggregator::WriteSnapshot(FGameplayAnalyticsStreamWriter& Writer, const double Time)
+{
+	const FString TimeString = FString::SanitizeFloat(Time);
+	TMap<FString, FString> EventData;
+
+	auto ResetEventData = [&EventData, &TimeString](const FKey& Key, const TCHAR* Kind)
+	{
+		EventData.Reset();
+		EventData.Add(TEXT("Time"), TimeString);
+		EventData.Add(TEXT("Metric"), Key.Metric.ToString());
+		EventData.Add(TEXT("Faction"), Key.Faction.ToString());
+		EventData.Add(TEXT("Kind"), Kind);
+	};
+
+	auto AddSumData = [&EventData](const FSum& Sum)
+	{
+		EventData.Add(TEXT("Count"), LexToString(Sum.Count));
+		EventData.Add(TEXT("Sum"), FString::SanitizeFloat(Sum.Sum));
+		EventData.Add(TEXT("Min"), FString::SanitizeFloat(Sum.Min));
+		EventData.Add(TEXT("Max"), FString::SanitizeFloat(Sum.Max));
+	};
+
+	for (TPair<FKey, int64>& Counter : Counters)
+	{
+		if (Counter.Value != 0)
+		{
+			ResetEventData(Counter.Key, TEXT("Counter"));
+			EventData.Add(TEXT("Count"), LexToString(Counter.Value));
+			Writer.AddEvent(TEXT("Aggregate"), EventData);
+			Counter.Value = 0;
+		}
+	}
+
+	for (TPair<FKey, FSum>& Sum : Sums)
+	{
+		if (Sum.Value.Count > 0)
+		{
+			ResetEventData(Sum.Key, TEXT("Sum"));
+			AddSumData(Sum.Value);
+			Writer.AddEvent(TEXT("Aggregate"), EventData);
+			Sum.Value = {};
+		}
+	}
+
+	for (TPair<FKey, FHistogram>& Histogram : Histograms)
+	{
+		if (Histogram.Value.Sum.Count > 0)
+		{
+			const FHistogramLayout Layout = HistogramLayouts.FindRef(Histogram.Key.Metric);
+
+			ResetEventData(Histogram.Key, TEXT("Histogram"));
+			AddSumData(Histogram.Value.Sum);
+			EventData.Add(TEXT("BucketMin"), FString::SanitizeFloat(Layout.Min));
+			EventData.Add(TEXT("BucketWidth"), FString::SanitizeFloat(Layout.BucketWidth));
+			EventData.Add(TEXT("Buckets"), FString::JoinBy(Histogram.Value.Buckets, TEXT(","), [](const int64 Count)
+			{
+				return LexToString(Count);
+			}));
+			Writer.AddEvent(TEXT("Aggregate"), EventData);
+
+			Histogram.Value.Sum = {};
+			FMemory::Memzero(Histogram.Value.Buckets.GetData(), Histogram.Value.Buckets.Num() * sizeof(int64));
+		}
+	}
+}
+
+void FGameplayAnalyticsAggregator::Reset()
+{
+	Counters.Empty();
+	Sums.Empty();
+	Histograms.Empty();
+}
@@ -0,0 +1,76 @@
+﻿// Copyleft: All rights reversed
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+
+class FGameplayAnalyticsStreamWriter;
+
+/**
+ * Counters, sums and fixed bucket histograms keyed by metric tag and faction, for events consumed only as aggregates.
+ * Updated from game thread only, so no locking is needed. Snapshot writes values accumulated since previous snapshot
+ * as one event per aggregate and resets them.
+ */
+class FGameplayAnalyticsAggregator
+{
+public:
+	void AddToCounter(const FGameplayTag& Metric, FName Faction, int64 Count);
+	void AddToSum(const FGameplayTag& Metric, FName Faction, double Value);
+	void AddToHistogram(const FGameplayTag& Metric, FName Faction, double Value);
+
+	/** Sets buckets of histogram metric: NumBuckets of BucketWidth starting at Min, plus underflow and overflow buckets */
+	void SetHistogramLayout(const FGameplayTag& Metric, float Min, float BucketWidth, int32 NumBuckets);
+
+	/** Whether anything was accumulated since previous snapshot */
+	bool HasData() const;
+
+	/** Writes non empty aggregates as events and resets them */
+	void WriteSnapshot(FGameplayAnalyticsStreamWriter& Writer, double Time);
+
+	void Reset();
+
+private:
+	struct FKey
+	{
+		FGameplayTag Metric;
+		FName Faction;
+
+		bool operator==(const FKey& Other) const { return Metric == Other.Metric && Faction == Other.Faction; }
+
+		friend uint32 GetTypeHash(const FKey& Key)
+		{
+			return HashCombine(GetTypeHash(Key.Metric), GetTypeHash(Key.Faction));
+		}
+	};
+
+	struct FSum
+	{
+		int64 Count = 0;
+		double Sum = 0.0;
+		double Min = 0.0;
+		double Max = 0.0;
+
+		void Add(double Value);
+	};
+
+	struct FHistogramLayout
+	{
+		float Min = 0.0f;
+		float BucketWidth = 50.0f;
+		int32 NumBuckets = 20;
+	};
+
+	struct FHistogram
+	{
+		FSum Sum;
+
+		/** Underflow bucket, NumBuckets buckets, overflow bucket */
+		TArray<int64> Buckets;
+	};
+
+	TMap<FKey, int64> Counters;
+	TMap<FKey, FSum> Sums;
+	TMap<FKey, FHistogram> Histograms;
+	TMap<FGameplayTag, FHistogramLayout> HistogramLayouts;
+};
@@ -0,0 +1,345 @@
+﻿#include "GameplayAnalyticsStreamWriter.h"
+
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Paths.h"
+#include "Policies/CondensedJsonPrintPolicy.h"
+#include "Serialization/JsonWriter.h"
+
+static int32 AnalyticsChunkSizeKB = 64;
+static FAutoConsoleVariableRef CVarAnalyticsChunkSizeKB(
+	TEXT("Analytics.ChunkSizeKB"),
+	AnalyticsChunkSizeKB,
+	TEXT("Size of encoded events chunk handed to background writer at once"),
+	ECVF_Default);
+
+static int32 AnalyticsMaxChunksInFlight = 16;
+static FAutoConsoleVariableRef CVarAnalyticsMaxChunksInFlight(
+	TEXT("Analytics.MaxChunksInFlight"),
+	AnalyticsMaxChunksInFlight,
+	TEXT("Chunks submitted and not yet written, above it new events are dropped"),
+	ECVF_Default);
+
+static int32 AnalyticsRetainedChunks = 4;
+static FAutoConsoleVariableRef CVarAnalyticsRetainedChunks(
+	TEXT("Analytics.RetainedChunks"),
+	AnalyticsRetainedChunks,
+	TEXT("Submitted chunks kept in memory, events of them and of the current chunk can be retrieved without reading the file"),
+	ECVF_Default);
+
+static int32 AnalyticsMaxFiles = 20;
+static FAutoConsoleVariableRef CVarAnalyticsMaxFiles(
+	TEXT("Analytics.MaxFiles"),
+	AnalyticsMaxFiles,
+	TEXT("Analytics files kept in the directory, the oldest ones are deleted when new file is started"),
+	ECVF_Default);
+
+namespace GameplayAnalyticsEncoding
+{
+	// Event: uint16 type key id, uint16 number of fields, fields
+	// Field: uint16 key id, uint16 value length, value in UTF-8
+
+	static constexpr uint16 TypeKeyId = 0;
+
+	template <typename T>
+	static void Write(TArray<uint8>& Data, const T Value)
+	{
+		Data.Append(reinterpret_cast<const uint8*>(&Value), sizeof(T));
+	}
+
+	template <typename T>
+	static T Read(const TArray<uint8>& Data, int32& Offset)
+	{
+		T Value;
+		FMemory::Memcpy(&Value, &Data[Offset], sizeof(T));
+		Offset += sizeof(T);
+		return Value;
+	}
+}
+
+FGameplayAnalyticsStreamWriter::FGameplayAnalyticsStreamWriter(const FString& InFilePath)
+	: FilePath(InFilePath)
+	  , Pipe(TEXT("GameplayAnalyticsWriter"))
+{
+	// Type is always key 0
+	InternKey(TEXT("Type"));
+
+	LastWriteTask = Pipe.Launch(UE_SOURCE_LOCATION, [this]
+	{
+		PruneOldFiles();
+		OpenFile();
+	});
+}
+
+FGameplayAnalyticsStreamWriter::~FGameplayAnalyticsStreamWriter()
+{
+	FlushAndWait();
+	FileHandle.Reset();
+}
+
+int32 FGameplayAnalyticsStreamWriter::InternKey(const FString& Key)
+{
+	if (const uint16* KeyId = KeyIds.Find(Key))
+	{
+		return *KeyId;
+	}
+
+	if (KeyIds.Num() > MAX_uint16)
+	{
+		return INDEX_NONE;
+	}
+
+	const uint16 KeyId = KeyIds.Num();
+	KeyIds.Add(Key, KeyId);
+	KeyNames.Add(Key);
+	CurrentChunk.NewKeys.Add(Key);
+	return KeyId;
+}
+
+bool FGameplayAnalyticsStreamWriter::AddEvent(const FString& EventType, const TMap<FString, FString>& EventData)
+{
+	using namespace GameplayAnalyticsEncoding;
+
+	const int32 ChunkSize = FMath::Max(AnalyticsChunkSizeKB, 1) * 1024;
+	if (CurrentChunk.Data.Num() >= ChunkSize)
+	{
+		SubmitChunk();
+	}
+
+	// Writer is behind, keep memory bounded, dropped events are counted and reported by owner
+	if (CurrentChunk.Data.Num() >= ChunkSize)
+	{
+		NumDroppedEvents++;
+		return false;
+	}
+
+	const int32 EventTypeId = InternKey(EventType);
+	if (EventTypeId == INDEX_NONE)
+	{
+		NumDroppedEvents++;
+		return false;
+	}
+
+	if (CurrentChunk.Data.Max() < ChunkSize)
+	{
+		CurrentChunk.Data.Reserve(ChunkSize + ChunkSize / 4);
+	}
+
+	Write<uint16>(CurrentChunk.Data, EventTypeId);
+	const int32 NumFieldsOffset = CurrentChunk.Data.Num();
+	Write<uint16>(CurrentChunk.Data, 0);
+
+	uint16 NumFields = 0;
+	for (const TTuple<FString, FString>& KeyAndValue : EventData)
+	{
+		// Type is always the event type, like when it was stored in the map
+		const int32 KeyId = InternKey(KeyAndValue.Key);
+		if (KeyId == TypeKeyId || KeyId == INDEX_NONE || NumFields == MAX_uint16)
+		{
+			continue;
+		}
+
+		const FTCHARToUTF8 Value(*KeyAndValue.Value);
+		int32 ValueLength = FMath::Min(Value.Length(), static_cast<int32>(MAX_uint16));
+
+		// Truncated on code point boundary, continuation bytes are 10xxxxxx
+		if (ValueLength < Value.Length())
+		{
+			while (ValueLength > 0 && (static_cast<uint8>(Value.Get()[ValueLength]) & 0xC0) == 0x80)
+			{
+				ValueLength--;
+			}
+		}
+
+		Write<uint16>(CurrentChunk.Data, KeyId);
+		Write<uint16>(CurrentChunk.Data, static_cast<uint16>(ValueLength));
+		CurrentChunk.Data.Append(reinterpret_cast<const uint8*>(Value.Get()), ValueLength);
+		NumFields++;
+	}
+
+	FMemory::Memcpy(&CurrentChunk.Data[NumFieldsOffset], &NumFields, sizeof(uint16));
+	return true;
+}
+
+void FGameplayAnalyticsStreamWriter::Flush()
+{
+	if (CurrentChunk.Data.Num() > 0 || CurrentChunk.NewKeys.Num() > 0)
+	{
+		SubmitChunk();
+	}
+}
+
+void FGameplayAnalyticsStreamWriter::SubmitChunk()
+{
+	if (NumChunksInFlight.load() >= FMath::Max(AnalyticsMaxChunksInFlight, 1))
+	{
+		return;
+	}
+
+	NumChunksInFlight++;
+	const FSubmittedChunkRef Chunk = MakeShared<FChunk, ESPMode::ThreadSafe>(MoveTemp(CurrentChunk));
+	CurrentChunk = {};
+
+	RetainedChunks.Add(Chunk);
+	const int32 NumRetainedChunks = FMath::Max(AnalyticsRetainedChunks, 0);
+	if (RetainedChunks.Num() > NumRetainedChunks)
+	{
+		RetainedChunks.RemoveAt(0, RetainedChunks.Num() - NumRetainedChunks, false);
+	}
+
+	LastWriteTask = Pipe.Launch(UE_SOURCE_LOCATION, [this, Chunk]
+	{
+		WriteChunk(*Chunk);
+		NumChunksInFlight--;
+	});
+}
+
+void FGameplayAnalyticsStreamWriter::FlushAndWait()
+{
+	// Writer may be behind, in which case current chunk isn't submitted until it catches up
+	LastWriteTask.Wait();
+	Flush();
+	LastWriteTask.Wait();
+}
+
+void FGameplayAnalyticsStreamWriter::Reset()
+{
+	// Interned keys stay, so only the data is discarded
+	CurrentChunk.Data.Empty();
+	Flush();
+	RetainedChunks.Reset();
+
+	LastWriteTask = Pipe.Launch(UE_SOURCE_LOCATION, [this]
+	{
+		FileHandle.Reset();
+		FPlatformFileManager::Get().GetPlatformFile().DeleteFile(*FilePath);
+		OpenFile();
+	});
+}
+
+void FGameplayAnalyticsStreamWriter::OpenFile()
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(FilePath));
+
+	// Readable while open, so written events can be retrieved
+	FileHandle.Reset(PlatformFile.OpenWrite(*FilePath, true, true));
+	if (!FileHandle)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Couldn't open gameplay analytics file %s"), *FilePath);
+	}
+}
+
+void FGameplayAnalyticsStreamWriter::PruneOldFiles() const
+{
+	IFileManager& FileManager = IFileManager::Get();
+	const FString Directory = FPaths::GetPath(FilePath);
+
+	TArray<FString> FileNames;
+	FileManager.FindFiles(FileNames, *(Directory / (TEXT("*.") + FPaths::GetExtension(FilePath))), true, false);
+
+	// One place is left for the file of this writer
+	const int32 NumFilesToDelete = FileNames.Num() - (FMath::Max(AnalyticsMaxFiles, 1) - 1);
+	if (NumFilesToDelete <= 0)
+	{
+		return;
+	}
+
+	TArray<TPair<FDateTime, FString>> Files;
+	for (const FString& FileName : FileNames)
+	{
+		const FString Path = Directory / FileName;
+		Files.Emplace(FileManager.GetTimeStamp(*Path), Path);
+	}
+
+	Files.Sort([](const TPair<FDateTime, FString>& A, const TPair<FDateTime, FString>& B)
+	{
+		return A.Key < B.Key;
+	});
+
+	for (int32 FileIdx = 0; FileIdx < NumFilesToDelete; ++FileIdx)
+	{
+		// Files still open by other instances can't be deleted, they are pruned next time
+		FileManager.Delete(*Files[FileIdx].Value, false, false, true);
+	}
+}
+
+void FGameplayAnalyticsStreamWriter::DecodeChunk(const TArray<uint8>& Data, const TArray<FString>& Keys,
+                                                 TFunctionRef<void(const FString& EventType,
+                                                                   const TArray<TPair<FString, FString>>& Fields)>
+                                                 Visitor)
+{
+	using namespace GameplayAnalyticsEncoding;
+
+	TArray<TPair<FString, FString>> Fields;
+
+	int32 Offset = 0;
+	while (Offset < Data.Num())
+	{
+		const uint16 EventTypeId = Read<uint16>(Data, Offset);
+		const uint16 NumFields = Read<uint16>(Data, Offset);
+
+		Fields.Reset();
+		for (uint16 FieldIdx = 0; FieldIdx < NumFields; ++FieldIdx)
+		{
+			const uint16 KeyId = Read<uint16>(Data, Offset);
+			const uint16 ValueLength = Read<uint16>(Data, Offset);
+			const FUTF8ToTCHAR Value(reinterpret_cast<const ANSICHAR*>(Data.GetData() + Offset), ValueLength);
+			Offset += ValueLength;
+
+			Fields.Emplace(Keys[KeyId], FString(Value.Length(), Value.Get()));
+		}
+
+		Visitor(Keys[EventTypeId], Fields);
+	}
+}
+
+FString FGameplayAnalyticsStreamWriter::EventToJsonLine(const FString& EventType,
+                                                        const TArray<TPair<FString, FString>>& Fields)
+{
+	FString Line;
+	const TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<
+		TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Line);
+	Writer->WriteObjectStart();
+	Writer->WriteValue(TEXT("Type"), EventType);
+	for (const TPair<FString, FString>& Field : Fields)
+	{
+		Writer->WriteValue(Field.Key, Field.Value);
+	}
+	Writer->WriteObjectEnd();
+	Writer->Close();
+	return Line;
+}
+
+void FGameplayAnalyticsStreamWriter::ForEachRetainedEvent(
+	TFunctionRef<void(const FString& EventType, const TArray<TPair<FString, FString>>& Fields)> Visitor) const
+{
+	// Game thread has all keys interned so far, so it can decode any chunk by itself
+	for (const FSubmittedChunkRef& Chunk : RetainedChunks)
+	{
+		DecodeChunk(Chunk->Data, KeyNames, Visitor);
+	}
+	DecodeChunk(CurrentChunk.Data, KeyNames, Visitor);
+}
+
+void FGameplayAnalyticsStreamWriter::WriteChunk(const FChunk& Chunk)
+{
+	WriterKeys.Append(Chunk.NewKeys);
+	if (!FileHandle || Chunk.Data.Num() == 0)
+	{
+		return;
+	}
+
+	FString Lines;
+	Lines.Reserve(Chunk.Data.Num() * 2);
+
+	DecodeChunk(Chunk.Data, WriterKeys, [&Lines](const FString& EventType, const TArray<TPair<FString, FString>>& Fields)
+	{
+		Lines.Append(EventToJsonLine(EventType, Fields));
+		Lines.AppendChar(TEXT('\n'));
+	});
+
+	const FTCHARToUTF8 Utf8Lines(*Lines);
+	FileHandle->Write(reinterpret_cast<const uint8*>(Utf8Lines.Get()), Utf8Lines.Length());
+	FileHandle->Flush();
+}
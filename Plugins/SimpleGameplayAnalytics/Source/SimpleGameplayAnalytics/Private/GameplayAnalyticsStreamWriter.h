@@ -0,0 +1,101 @@
+﻿// Copyleft: All rights reversed
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tasks/Pipe.h"
+
+#include <atomic>
+
+class IFileHandle;
+
+/**
+ * Streams analytics events to newline delimited JSON file with bounded memory.
+ *
+ * Game thread only encodes events into a compact binary chunk: event type and field names are interned
+ * to 16 bit ids, values are stored as UTF-8. Full chunks are handed to background writer, which converts
+ * them to JSON lines and appends them to the file in order. If writer falls behind by Analytics.MaxChunksInFlight
+ * chunks, new events are dropped instead of growing memory.
+ *
+ * Last Analytics.RetainedChunks submitted chunks and the current one are kept as a ring in memory,
+ * so recent events can be retrieved without waiting for writer or reading the file. Only the newest
+ * Analytics.MaxFiles files of the directory are kept, older ones are deleted when writer starts.
+ */
+class FGameplayAnalyticsStreamWriter
+{
+public:
+	explicit FGameplayAnalyticsStreamWriter(const FString& InFilePath);
+	~FGameplayAnalyticsStreamWriter();
+
+	/** Encodes event, returns false if it was dropped */
+	bool AddEvent(const FString& EventType, const TMap<FString, FString>& EventData);
+
+	/** Submits events not yet submitted to writer */
+	void Flush();
+
+	/** Blocks until all added events are written to file */
+	void FlushAndWait();
+
+	/** Discards all events, including already written, and starts file anew */
+	void Reset();
+
+	/** Calls Visitor with type and fields of events retained in memory, oldest first */
+	void ForEachRetainedEvent(
+		TFunctionRef<void(const FString& EventType, const TArray<TPair<FString, FString>>& Fields)> Visitor) const;
+
+	/** Converts event to a JSON object line */
+	static FString EventToJsonLine(const FString& EventType, const TArray<TPair<FString, FString>>& Fields);
+
+	const FString& GetFilePath() const { return FilePath; }
+
+	int64 GetNumDroppedEvents() const { return NumDroppedEvents; }
+
+private:
+	struct FChunk
+	{
+		TArray<uint8> Data;
+
+		/** Keys interned since previous chunk */
+		TArray<FString> NewKeys;
+	};
+
+	/** Submitted chunks are immutable and shared by the writer and the ring of retained chunks */
+	using FSubmittedChunkRef = TSharedRef<const FChunk, ESPMode::ThreadSafe>;
+
+	/** Decodes events of chunk data, Keys has to contain all keys interned up to the chunk */
+	static void DecodeChunk(const TArray<uint8>& Data, const TArray<FString>& Keys,
+	                        TFunctionRef<void(const FString& EventType, const TArray<TPair<FString, FString>>& Fields)> Visitor);
+
+	/** Returns id of the key, INDEX_NONE if key table is full */
+	int32 InternKey(const FString& Key);
+
+	void SubmitChunk();
+
+	/** Writer side: converts chunk to JSON lines and appends them to the file */
+	void WriteChunk(const FChunk& Chunk);
+
+	void OpenFile();
+
+	/** Deletes oldest files of the directory of FilePath with the same extension above Analytics.MaxFiles */
+	void PruneOldFiles() const;
+
+	const FString FilePath;
+
+	// Game thread state
+	TMap<FString, uint16> KeyIds;
+	TArray<FString> KeyNames;
+	FChunk CurrentChunk;
+	TArray<FSubmittedChunkRef> RetainedChunks;
+	int64 NumDroppedEvents = 0;
+
+	// Writer state, only accessed from tasks of the pipe
+	TArray<FString> WriterKeys;
+	TUniquePtr<IFileHandle> FileHandle;
+
+	UE::Tasks::FPipe Pipe;
+
+	/** Tasks of the pipe are executed in order, so waiting for the last one waits for all */
+	UE::Tasks::FTask LastWriteTask;
+
+	std::atomic<int32> NumChunksInFlight{0};
+};
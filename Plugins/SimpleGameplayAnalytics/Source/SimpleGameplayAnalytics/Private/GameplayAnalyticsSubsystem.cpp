@@ -1,6 +1,21 @@
 ﻿#include "GameplayAnalyticsSubsystem.h"
+#include "GameplayAnalyticsAggregator.h"
+#include "GameplayAnalyticsStreamWriter.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
 #include "Json/Public/Dom/JsonObject.h"
 #include "Json/Public/Dom/JsonValue.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+static float AnalyticsAggregateSnapshotSeconds = 60.0f;
+static FAutoConsoleVariableRef CVarAnalyticsAggregateSnapshotSeconds(
+	TEXT("Analytics.AggregateSnapshotSeconds"),
+	AnalyticsAggregateSnapshotSeconds,
+	TEXT("Interval of writing counters, sums and histograms as events. Change takes effect on next game instance"),
+	ECVF_Default);
 
 TSharedPtr<FJsonObject> FGameplayAnalyticsEventData::ToJson()
 {
@@ -14,43 +29,250 @@ TSharedPtr<FJsonObject> FGameplayAnalyticsEventData::ToJson()
 
 UGameplayAnalyticsSubsystem::UGameplayAnalyticsSubsystem()
 {
-	AnalyticsData = {};
+}
+
+UGameplayAnalyticsSubsystem::~UGameplayAnalyticsSubsystem()
+{
+}
+
+void UGameplayAnalyticsSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Aggregator = MakeUnique<FGameplayAnalyticsAggregator>();
+
+	SnapshotTickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateUObject(this, &ThisClass::HandleSnapshotTicker),
+		FMath::Max(AnalyticsAggregateSnapshotSeconds, 1.0f));
+}
+
+void UGameplayAnalyticsSubsystem::Deinitialize()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(SnapshotTickerHandle);
+
+	WriteAggregateSnapshot();
+	ReportDroppedEvents();
+	Aggregator.Reset();
+	Writer.Reset();
+
+	Super::Deinitialize();
 }
 
 void UGameplayAnalyticsSubsystem::ClearAllData()
 {
-	AnalyticsData.Empty();
+	if (Writer)
+	{
+		Writer->Reset();
+	}
+
+	if (Aggregator)
+	{
+		Aggregator->Reset();
+	}
 }
 
 void UGameplayAnalyticsSubsystem::AddEvent(const FString EventType, TMap<FString, FString> EventData)
 {
-	EventData.Add("Type", EventType);
+	GetOrCreateWriter().AddEvent(EventType, EventData);
+}
+
+FGameplayAnalyticsStreamWriter& UGameplayAnalyticsSubsystem::GetOrCreateWriter()
+{
+	if (!Writer)
+	{
+		// Unique per process and game instance, as PIE runs several of them
+		const FString FileName = FString::Printf(TEXT("Analytics_%s_%u_%u.ndjson"),
+		                                         *FDateTime::Now().ToString(TEXT("%Y%m%d-%H%M%S")),
+		                                         FPlatformProcess::GetCurrentProcessId(), GetUniqueID());
+		Writer = MakeUnique<FGameplayAnalyticsStreamWriter>(FPaths::ProjectSavedDir() / TEXT("Analytics") / FileName);
+	}
+	return *Writer;
+}
+
+void UGameplayAnalyticsSubsystem::AddToCounter(const FGameplayTag Metric, const FName Faction, const int64 Count)
+{
+	if (Aggregator)
+	{
+		Aggregator->AddToCounter(Metric, Faction, Count);
+	}
+}
+
+void UGameplayAnalyticsSubsystem::AddToSum(const FGameplayTag Metric, const FName Faction, const float Value)
+{
+	if (Aggregator)
+	{
+		Aggregator->AddToSum(Metric, Faction, Value);
+	}
+}
+
+void UGameplayAnalyticsSubsystem::AddToHistogram(const FGameplayTag Metric, const FName Faction, const float Value)
+{
+	if (Aggregator)
+	{
+		Aggregator->AddToHistogram(Metric, Faction, Value);
+	}
+}
+
+void UGameplayAnalyticsSubsystem::SetHistogramLayout(const FGameplayTag Metric, const float Min,
+                                                     const float BucketWidth, const int32 NumBuckets)
+{
+	if (Aggregator)
+	{
+		Aggregator->SetHistogramLayout(Metric, Min, BucketWidth, NumBuckets);
+	}
+}
+
+void UGameplayAnalyticsSubsystem::WriteAggregateSnapshot()
+{
+	if (Aggregator && Aggregator->HasData())
+	{
+		const UWorld* World = GetGameInstance() ? GetGameInstance()->GetWorld() : nullptr;
+		Aggregator->WriteSnapshot(GetOrCreateWriter(), World ? World->GetTimeSeconds() : 0.0);
+	}
+}
+
+bool UGameplayAnalyticsSubsystem::HandleSnapshotTicker(float DeltaTime)
+{
+	WriteAggregateSnapshot();
+	ReportDroppedEvents();
+	return true;
+}
+
+void UGameplayAnalyticsSubsystem::ReportDroppedEvents()
+{
+	const int64 NumDroppedEvents = GetNumDroppedEvents();
+	if (NumDroppedEvents > NumReportedDroppedEvents)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Gameplay analytics writer can't keep up, dropped %lld events (%lld in total)"),
+		       NumDroppedEvents - NumReportedDroppedEvents, NumDroppedEvents);
+		NumReportedDroppedEvents = NumDroppedEvents;
+	}
+}
+
+int64 UGameplayAnalyticsSubsystem::GetNumDroppedEvents() const
+{
+	return Writer ? Writer->GetNumDroppedEvents() : 0;
+}
+
+FString UGameplayAnalyticsSubsystem::GetEventsFilePath() const
+{
+	return Writer ? Writer->GetFilePath() : FString();
+}
+
+bool UGameplayAnalyticsSubsystem::ReadEventLines(TArray<FString>& OutLines)
+{
+	if (!Writer)
+	{
+		return false;
+	}
+
+	// Include aggregates accumulated since last snapshot
+	WriteAggregateSnapshot();
 
-	const FGameplayAnalyticsEventData DataContainer = FGameplayAnalyticsEventData{EventData};
-	AnalyticsData.Add(DataContainer);
+	Writer->FlushAndWait();
+	return FFileHelper::LoadFileToStringArray(OutLines, *Writer->GetFilePath());
 }
 
 TArray<FGameplayAnalyticsEventData> UGameplayAnalyticsSubsystem::RetrieveEvents()
 {
-	return AnalyticsData;
+	TArray<FGameplayAnalyticsEventData> Events;
+
+	TArray<FString> Lines;
+	ReadEventLines(Lines);
+	Events.Reserve(Lines.Num());
+
+	for (const FString& Line : Lines)
+	{
+		TSharedPtr<FJsonObject> JsonObject;
+		if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Line), JsonObject) || !JsonObject)
+		{
+			continue;
+		}
+
+		FGameplayAnalyticsEventData& EventData = Events.AddDefaulted_GetRef();
+		for (const TPair<FString, TSharedPtr<FJsonValue>>& Field : JsonObject->Values)
+		{
+			EventData.EventData.Add(Field.Key, Field.Value->AsString());
+		}
+	}
+
+	return Events;
 }
 
 FString UGameplayAnalyticsSubsystem::RetrieveEventsAsJsonString()
 {
-	TSharedPtr<FJsonObject> JsonObject = MakeShareable(new FJsonObject);
+	TArray<FString> Lines;
+	ReadEventLines(Lines);
 
-	TArray<TSharedPtr<FJsonValue>> Array;
-	for (FGameplayAnalyticsEventData EventData : AnalyticsData)
+	// Lines are already serialized objects, so they are joined without building JSON of all events
+	int32 Length = 16;
+	for (const FString& Line : Lines)
 	{
-		TSharedPtr<FJsonObject> Item = EventData.ToJson();
-		Array.Add(MakeShareable(new FJsonValueObject(Item)));
+		Length += Line.Len() + 1;
 	}
 
-	JsonObject->SetArrayField("data", Array);
-
 	FString OutputString;
-	const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&OutputString);
-	FJsonSerializer::Serialize(JsonObject.ToSharedRef(), Writer);
+	OutputString.Reserve(Length);
+	OutputString.Append(TEXT("{\"data\":["));
+	for (int32 LineIdx = 0; LineIdx < Lines.Num(); ++LineIdx)
+	{
+		if (LineIdx > 0)
+		{
+			OutputString.AppendChar(TEXT(','));
+		}
+		OutputString.Append(Lines[LineIdx]);
+	}
+	OutputString.Append(TEXT("]}"));
+
+	return OutputString;
+}
+
+TArray<FGameplayAnalyticsEventData> UGameplayAnalyticsSubsystem::RetrieveRecentEvents()
+{
+	TArray<FGameplayAnalyticsEventData> Events;
+	if (!Writer)
+	{
+		return Events;
+	}
+
+	// Include aggregates accumulated since last snapshot
+	WriteAggregateSnapshot();
+
+	Writer->ForEachRetainedEvent([&Events](const FString& EventType, const TArray<TPair<FString, FString>>& Fields)
+	{
+		FGameplayAnalyticsEventData& EventData = Events.AddDefaulted_GetRef();
+		EventData.EventData.Reserve(Fields.Num() + 1);
+		EventData.EventData.Add(TEXT("Type"), EventType);
+		for (const TPair<FString, FString>& Field : Fields)
+		{
+			EventData.EventData.Add(Field.Key, Field.Value);
+		}
+	});
+
+	return Events;
+}
+
+FString UGameplayAnalyticsSubsystem::RetrieveRecentEventsAsJsonString()
+{
+	FString OutputString(TEXT("{\"data\":["));
+	if (Writer)
+	{
+		// Include aggregates accumulated since last snapshot
+		WriteAggregateSnapshot();
+
+		bool bFirstEvent = true;
+		Writer->ForEachRetainedEvent(
+			[&OutputString, &bFirstEvent](const FString& EventType, const TArray<TPair<FString, FString>>& Fields)
+			{
+				if (!bFirstEvent)
+				{
+					OutputString.AppendChar(TEXT(','));
+				}
+				bFirstEvent = false;
+				OutputString.Append(FGameplayAnalyticsStreamWriter::EventToJsonLine(EventType, Fields));
+			});
+	}
+	OutputString.Append(TEXT("]}"));
 
 	return OutputString;
 }
@@ -3,9 +3,14 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+#include "Containers/Ticker.h"
 #include "Subsystems/GameInstanceSubsystem.h"
 #include "GameplayAnalyticsSubsystem.generated.h"
 
+class FGameplayAnalyticsAggregator;
+class FGameplayAnalyticsStreamWriter;
+
 /** Alliance of factions (eg LSM & Eldar) */
 USTRUCT(BlueprintType)
 struct FGameplayAnalyticsEventData
@@ -22,13 +27,29 @@ struct FGameplayAnalyticsEventData
  * GameInstance Subsystem handling gameplay analytics (via recording gameplay events with attributes,
  * eg event "Damage" with attributes: {"Type": "Damage", "Value": "22.0", "Instigator": "0", "Target": "1",
  * "InstigatorClass": "HeavyInfantry", "TargetClass": "LightInfantry"}).
+ *
+ * Events are streamed to Saved/Analytics as newline delimited JSON by background writer,
+ * so memory doesn't grow with match length. The file is created with the first recorded event, so game instances
+ * which don't record analytics (eg clients) don't create any, and only the newest Analytics.MaxFiles files are kept.
+ * Recent events are also kept in memory (Analytics.RetainedChunks), they can be retrieved without reading the file.
+ *
+ * Frequent events consumed only as aggregates (damage, kills, ability usage) should use counters, sums
+ * and histograms instead, keyed by metric tag and faction. They are written as "Aggregate" events
+ * every Analytics.AggregateSnapshotSeconds, with values accumulated since previous snapshot.
  */
 UCLASS()
 class SIMPLEGAMEPLAYANALYTICS_API UGameplayAnalyticsSubsystem : public UGameInstanceSubsystem
 {
 	GENERATED_BODY()
 
+public:
 	UGameplayAnalyticsSubsystem();
+	virtual ~UGameplayAnalyticsSubsystem() override;
+
+	//~USubsystem interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	//~End of USubsystem interface
 
 protected:
 	UFUNCTION(BlueprintCallable, Category="Gameplay Analytics")
@@ -38,13 +59,67 @@ protected:
 	UFUNCTION(BlueprintCallable, Category="Gameplay Analytics")
 	void AddEvent(FString EventType, TMap<FString, FString> EventData);
 
-	/** Retrieve recorded events */
+	/** Add to counter of metric for faction */
+	UFUNCTION(BlueprintCallable, Category="Gameplay Analytics")
+	void AddToCounter(FGameplayTag Metric, FName Faction, int64 Count = 1);
+
+	/** Add value to sum of metric for faction, count, min and max are tracked too */
+	UFUNCTION(BlueprintCallable, Category="Gameplay Analytics")
+	void AddToSum(FGameplayTag Metric, FName Faction, float Value);
+
+	/** Add value to histogram of metric for faction, buckets are set with SetHistogramLayout */
+	UFUNCTION(BlueprintCallable, Category="Gameplay Analytics")
+	void AddToHistogram(FGameplayTag Metric, FName Faction, float Value);
+
+	/** Set NumBuckets buckets of BucketWidth starting at Min for histogram metric, values outside go to edge buckets */
+	UFUNCTION(BlueprintCallable, Category="Gameplay Analytics")
+	void SetHistogramLayout(FGameplayTag Metric, float Min = 0.0f, float BucketWidth = 50.0f, int32 NumBuckets = 20);
+
+	/** Retrieve all recorded events, waits for them to be written and reads the events file */
 	UFUNCTION(BlueprintCallable, Category="Gameplay Analytics")
 	TArray<FGameplayAnalyticsEventData> RetrieveEvents();
 
+	/** Retrieve all recorded events as {"data": [events]}, waits for them to be written and reads the events file */
 	UFUNCTION(BlueprintCallable, Category="Gameplay Analytics")
 	FString RetrieveEventsAsJsonString();
+
+	/** Retrieve recent events kept in memory (Analytics.RetainedChunks), without waiting or reading the file */
+	UFUNCTION(BlueprintCallable, Category="Gameplay Analytics")
+	TArray<FGameplayAnalyticsEventData> RetrieveRecentEvents();
+
+	/** Retrieve recent events kept in memory as {"data": [events]} */
+	UFUNCTION(BlueprintCallable, Category="Gameplay Analytics")
+	FString RetrieveRecentEventsAsJsonString();
+
+	/** Path of newline delimited JSON file events are written to, empty until the first event is recorded */
+	UFUNCTION(BlueprintPure, Category="Gameplay Analytics")
+	FString GetEventsFilePath() const;
+
+	/** Events dropped because writer couldn't keep up */
+	UFUNCTION(BlueprintPure, Category="Gameplay Analytics")
+	int64 GetNumDroppedEvents() const;
+
 private:
-	/** Array of events, which are maps of strings to strings. Because it's array, can be later converted to table */
-	TArray<FGameplayAnalyticsEventData> AnalyticsData;
+	/** Writes aggregates accumulated since previous snapshot as events */
+	void WriteAggregateSnapshot();
+
+	bool HandleSnapshotTicker(float DeltaTime);
+
+	/** Creates writer and its file when the first event is recorded */
+	FGameplayAnalyticsStreamWriter& GetOrCreateWriter();
+
+	/** Logs events dropped since previous report */
+	void ReportDroppedEvents();
+
+	/** Reads JSON lines of all events written so far */
+	bool ReadEventLines(TArray<FString>& OutLines);
+
+	/** Events are rows of a table, with field names as columns */
+	TUniquePtr<FGameplayAnalyticsStreamWriter> Writer;
+
+	TUniquePtr<FGameplayAnalyticsAggregator> Aggregator;
+
+	FTSTicker::FDelegateHandle SnapshotTickerHandle;
+
+	int64 NumReportedDroppedEvents = 0;
 };
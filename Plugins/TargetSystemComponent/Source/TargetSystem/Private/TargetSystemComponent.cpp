@@ -2,8 +2,8 @@
 
 #include "TargetSystemComponent.h"
 #include "TargetSystemTargetableInterface.h"
+#include "TargetSystemTargetRegistry.h"
 #include "Components/WidgetComponent.h"
-#include "EngineUtils.h"
 #include "TargetSystemLog.h"
 #include "Engine/Classes/Camera/CameraComponent.h"
 #include "Engine/Classes/Kismet/GameplayStatics.h"
@@ -41,6 +41,8 @@ void UTargetSystemComponent::BeginPlay()
 	}
 
 	SetupLocalPlayerController();
+
+	LineOfSightTraceDelegate.BindUObject(this, &UTargetSystemComponent::OnLineOfSightTraceDone);
 }
 
 void UTargetSystemComponent::TickComponent(const float DeltaTime, const ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
@@ -83,6 +85,8 @@ void UTargetSystemComponent::TickComponent(const float DeltaTime, const ELevelTi
 			);
 		}
 	}
+
+	RequestLineOfSightTrace();
 }
 
 void UTargetSystemComponent::TargetActor()
@@ -95,8 +99,7 @@ void UTargetSystemComponent::TargetActor()
 	}
 	else
 	{
-		const TArray<AActor*> Actors = GetAllActorsOfClass(TargetableActors);
-		LockedOnTargetActor = FindNearestTarget(Actors);
+		LockedOnTargetActor = FindNearestTarget(GetTargetsInRange(nullptr));
 		TargetLockOn(LockedOnTargetActor);
 	}
 }
@@ -136,43 +139,30 @@ void UTargetSystemComponent::TargetActorWithAxisInput(const float AxisValue)
 	// Reset Closest Target Distance to Minimum Distance to Enable
 	ClosestTargetDistance = MinimumDistanceToEnable;
 
-	// Get All Actors of Class
-	TArray<AActor*> Actors = GetAllActorsOfClass(TargetableActors);
-
-	// For each of these actors, check line trace and ignore Current Target and build the list of actors to look from
-	TArray<AActor*> ActorsToLook;
-
-	TArray<AActor*> ActorsToIgnore;
-	ActorsToIgnore.Add(CurrentTarget);
-	for (AActor* Actor : Actors)
+	// Find Targets in Range (left or right, based on Character and CurrentTarget), ranked by distance to current target,
+	// so that line of sight is traced only until the closest visible one is found
+	TArray<TPair<float, AActor*>> RankedCandidates;
+	for (AActor* Actor : GetTargetsInRange(CurrentTarget))
 	{
-		const bool bHit = LineTraceForActor(Actor, ActorsToIgnore);
-		if (bHit && IsInViewport(Actor))
+		const float Angle = GetAngleUsingCameraRotation(Actor);
+		if (Angle <= RangeMin || Angle >= RangeMax)
 		{
-			ActorsToLook.Add(Actor);
+			continue;
 		}
-	}
 
-	// Find Targets in Range (left or right, based on Character and CurrentTarget)
-	TArray<AActor*> TargetsInRange = FindTargetsInRange(ActorsToLook, RangeMin, RangeMax);
-
-	// For each of these targets in range, get the closest one to current target
-	AActor* ActorToTarget = nullptr;
-	for (AActor* Actor : TargetsInRange)
-	{
 		// and filter out any character too distant from minimum distance to enable
 		const float Distance = GetDistanceFromCharacter(Actor);
-		if (Distance < MinimumDistanceToEnable)
+		const float RelativeActorsDistance = CurrentTarget->GetDistanceTo(Actor);
+		if (Distance < MinimumDistanceToEnable && RelativeActorsDistance < ClosestTargetDistance && IsInViewport(Actor))
 		{
-			const float RelativeActorsDistance = CurrentTarget->GetDistanceTo(Actor);
-			if (RelativeActorsDistance < ClosestTargetDistance)
-			{
-				ClosestTargetDistance = RelativeActorsDistance;
-				ActorToTarget = Actor;
-			}
+			RankedCandidates.Emplace(RelativeActorsDistance, Actor);
 		}
 	}
 
+	TArray<AActor*> ActorsToIgnore;
+	ActorsToIgnore.Add(CurrentTarget);
+	AActor* ActorToTarget = FindFirstTargetInLineOfSight(RankedCandidates, ActorsToIgnore);
+
 	if (ActorToTarget)
 	{
 		if (SwitchingTargetTimerHandle.IsValid())
@@ -211,22 +201,6 @@ bool UTargetSystemComponent::IsLocked() const
 	return bTargetLocked && LockedOnTargetActor;
 }
 
-TArray<AActor*> UTargetSystemComponent::FindTargetsInRange(TArray<AActor*> ActorsToLook, const float RangeMin, const float RangeMax) const
-{
-	TArray<AActor*> ActorsInRange;
-
-	for (AActor* Actor : ActorsToLook)
-	{
-		const float Angle = GetAngleUsingCameraRotation(Actor);
-		if (Angle > RangeMin && Angle < RangeMax)
-		{
-			ActorsInRange.Add(Actor);
-		}
-	}
-
-	return ActorsInRange;
-}
-
 float UTargetSystemComponent::GetAngleUsingCameraRotation(const AActor* ActorToLook) const
 {
 	UCameraComponent* CameraComponent = OwnerActor->FindComponentByClass<UCameraComponent>();
@@ -322,6 +296,7 @@ void UTargetSystemComponent::TargetLockOn(AActor* TargetToLockOn)
 	SetupLocalPlayerController();
 
 	bTargetLocked = true;
+	ResetLineOfSight();
 	if (bShouldDrawLockedOnWidget)
 	{
 		CreateAndAttachTargetLockedOnWidgetComponent(TargetToLockOn);
@@ -352,6 +327,7 @@ void UTargetSystemComponent::TargetLockOff()
 	SetupLocalPlayerController();
 
 	bTargetLocked = false;
+	ResetLineOfSight();
 	if (TargetLockedOnWidgetComponent)
 	{
 		TargetLockedOnWidgetComponent->DestroyComponent();
@@ -409,16 +385,32 @@ void UTargetSystemComponent::CreateAndAttachTargetLockedOnWidgetComponent(AActor
 TArray<AActor*> UTargetSystemComponent::GetAllActorsOfClass(const TSubclassOf<AActor> ActorClass) const
 {
 	TArray<AActor*> Actors;
-	for (TActorIterator<AActor> ActorIterator(GetWorld(), ActorClass); ActorIterator; ++ActorIterator)
+	if (UTargetSystemTargetRegistry* Registry = UWorld::GetSubsystem<UTargetSystemTargetRegistry>(GetWorld()))
 	{
-		AActor* Actor = *ActorIterator;
-		const bool bIsTargetable = TargetIsTargetable(Actor);
-		if (bIsTargetable)
-		{
-			Actors.Add(Actor);
-		}
+		Registry->GetActorsOfClass(ActorClass, Actors);
+	}
+
+	Actors.RemoveAllSwap([](const AActor* Actor)
+	{
+		return !TargetIsTargetable(Actor);
+	});
+
+	return Actors;
+}
+
+TArray<AActor*> UTargetSystemComponent::GetTargetsInRange(const AActor* ActorToExclude) const
+{
+	TArray<AActor*> Actors;
+	if (UTargetSystemTargetRegistry* Registry = UWorld::GetSubsystem<UTargetSystemTargetRegistry>(GetWorld()))
+	{
+		Registry->GetActorsOfClassInRadius(TargetableActors, OwnerActor->GetActorLocation(), MinimumDistanceToEnable, Actors);
 	}
 
+	Actors.RemoveAllSwap([this, ActorToExclude](const AActor* Actor)
+	{
+		return Actor == OwnerActor || Actor == ActorToExclude || !TargetIsTargetable(Actor);
+	});
+
 	return Actors;
 }
 
@@ -444,43 +436,40 @@ void UTargetSystemComponent::SetupLocalPlayerController()
 	OwnerPlayerController = Cast<APlayerController>(OwnerPawn->GetController());
 }
 
-AActor* UTargetSystemComponent::FindNearestTarget(TArray<AActor*> Actors) const
+AActor* UTargetSystemComponent::FindNearestTarget(const TArray<AActor*>& Actors) const
 {
-	TArray<AActor*> ActorsHit;
-
-	// Find all actors we can line trace to
+	// Rank by distance first, so only the actors closer than the nearest visible one are traced
+	TArray<TPair<float, AActor*>> RankedCandidates;
 	for (AActor* Actor : Actors)
 	{
-		TArray<AActor*> ActorsToIgnore;
-		const bool bHit = LineTraceForActor(Actor, ActorsToIgnore);
-		if (bHit && IsInViewport(Actor))
+		const float Distance = GetDistanceFromCharacter(Actor);
+		if (Distance < ClosestTargetDistance && IsInViewport(Actor))
 		{
-			ActorsHit.Add(Actor);
+			RankedCandidates.Emplace(Distance, Actor);
 		}
 	}
 
-	// From the hit actors, check distance and return the nearest
-	if (ActorsHit.Num() == 0)
+	return FindFirstTargetInLineOfSight(RankedCandidates, TArray<AActor*>());
+}
+
+AActor* UTargetSystemComponent::FindFirstTargetInLineOfSight(TArray<TPair<float, AActor*>>& RankedCandidates, const TArray<AActor*>& ActorsToIgnore) const
+{
+	RankedCandidates.Sort([](const TPair<float, AActor*>& A, const TPair<float, AActor*>& B)
 	{
-		return nullptr;
-	}
+		return A.Key < B.Key;
+	});
 
-	float ClosestDistance = ClosestTargetDistance;
-	AActor* Target = nullptr;
-	for (AActor* Actor : ActorsHit)
+	for (const TPair<float, AActor*>& Candidate : RankedCandidates)
 	{
-		const float Distance = GetDistanceFromCharacter(Actor);
-		if (Distance < ClosestDistance)
+		if (LineTraceForActor(Candidate.Value, ActorsToIgnore))
 		{
-			ClosestDistance = Distance;
-			Target = Actor;
+			return Candidate.Value;
 		}
 	}
 
-	return Target;
+	return nullptr;
 }
 
-
 bool UTargetSystemComponent::LineTraceForActor(const AActor* OtherActor, const TArray<AActor*>& ActorsToIgnore) const
 {
 	FHitResult HitResult;
@@ -586,17 +575,66 @@ bool UTargetSystemComponent::ShouldBreakLineOfSight() const
 		return true;
 	}
 
-	TArray<AActor*> ActorsToIgnore = GetAllActorsOfClass(TargetableActors);
+	return bLineOfSightBlocked;
+}
+
+void UTargetSystemComponent::RequestLineOfSightTrace()
+{
+	UWorld* World = GetWorld();
+	if (!World || !bTargetLocked || !LockedOnTargetActor || bLineOfSightTracePending)
+	{
+		return;
+	}
+
+	const FVector Start = OwnerActor->GetActorLocation();
+	const FVector End = LockedOnTargetActor->GetActorLocation();
+
+	// Other targetable actors don't block line of sight, only the ones around the segment can be hit
+	TArray<AActor*> ActorsToIgnore;
+	if (UTargetSystemTargetRegistry* Registry = UWorld::GetSubsystem<UTargetSystemTargetRegistry>(World))
+	{
+		const float Radius = FVector::Dist(Start, End) * 0.5f + LineOfSightIgnoreMargin;
+		Registry->GetActorsOfClassInRadius(TargetableActors, (Start + End) * 0.5f, Radius, ActorsToIgnore);
+	}
 	ActorsToIgnore.Remove(LockedOnTargetActor);
+	ActorsToIgnore.Add(OwnerActor);
 
-	FHitResult HitResult;
-	const bool bHit = LineTrace(HitResult, LockedOnTargetActor, ActorsToIgnore);
-	if (bHit && HitResult.GetActor() != LockedOnTargetActor)
+	FCollisionQueryParams Params = FCollisionQueryParams(FName("LineTraceSingle"));
+	Params.AddIgnoredActors(ActorsToIgnore);
+
+	// Run by the engine in parallel with other async traces of the frame, result arrives next frame
+	LineOfSightTraceHandle = World->AsyncLineTraceByChannel(
+		EAsyncTraceType::Single,
+		Start,
+		End,
+		TargetableCollisionChannel,
+		Params,
+		FCollisionResponseParams::DefaultResponseParam,
+		&LineOfSightTraceDelegate,
+		LineOfSightTraceId
+	);
+	bLineOfSightTracePending = true;
+}
+
+void UTargetSystemComponent::OnLineOfSightTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum)
+{
+	// Issued for previous target
+	if (TraceDatum.UserData != LineOfSightTraceId)
 	{
-		return true;
+		return;
 	}
 
-	return false;
+	bLineOfSightTracePending = false;
+
+	const FHitResult* Hit = FHitResult::GetFirstBlockingHit(TraceDatum.OutHits);
+	bLineOfSightBlocked = Hit && Hit->GetActor() != LockedOnTargetActor;
+}
+
+void UTargetSystemComponent::ResetLineOfSight()
+{
+	bLineOfSightBlocked = false;
+	bLineOfSightTracePending = false;
+	LineOfSightTraceId++;
 }
 
 void UTargetSystemComponent::BreakLineOfSight()
@@ -0,0 +1,222 @@
+// Copyright 2018-2021 Mickael Daniel. All Rights Reserved.
+
+#include "TargetSystemTargetRegistry.h"
+#include "Algo/BinarySearch.h"
+#include "Engine/Level.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+
+void UTargetSystemTargetRegistry::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	UWorld* World = GetWorld();
+	ActorSpawnedHandle = World->AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateUObject(this, &UTargetSystemTargetRegistry::OnActorSpawned));
+	ActorDestroyedHandle = World->AddOnActorDestroyedHandler(FOnActorDestroyed::FDelegate::CreateUObject(this, &UTargetSystemTargetRegistry::OnActorDestroyed));
+	LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &UTargetSystemTargetRegistry::OnLevelAddedToWorld);
+	LevelRemovedHandle = FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &UTargetSystemTargetRegistry::OnLevelRemovedFromWorld);
+}
+
+void UTargetSystemTargetRegistry::Deinitialize()
+{
+	if (UWorld* World = GetWorld())
+	{
+		World->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+		World->RemoveOnActorDestroyedHandler(ActorDestroyedHandle);
+	}
+	FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedHandle);
+	FWorldDelegates::LevelRemovedFromWorld.Remove(LevelRemovedHandle);
+
+	ClassActorsMap.Empty();
+
+	Super::Deinitialize();
+}
+
+void UTargetSystemTargetRegistry::GetActorsOfClass(const TSubclassOf<AActor> ActorClass, TArray<AActor*>& OutActors)
+{
+	OutActors.Reset();
+	if (!ActorClass)
+	{
+		return;
+	}
+
+	const FClassActors& ClassActors = FindOrGatherClassActors(ActorClass);
+	OutActors.Reserve(ClassActors.Actors.Num());
+	for (const TWeakObjectPtr<AActor>& Actor : ClassActors.Actors)
+	{
+		if (AActor* ValidActor = Actor.Get())
+		{
+			OutActors.Add(ValidActor);
+		}
+	}
+}
+
+void UTargetSystemTargetRegistry::GetActorsOfClassInRadius(const TSubclassOf<AActor> ActorClass, const FVector& Origin, const float Radius, TArray<AActor*>& OutActors)
+{
+	OutActors.Reset();
+	if (!ActorClass)
+	{
+		return;
+	}
+
+	FClassActors& ClassActors = FindOrGatherClassActors(ActorClass);
+	UpdateGrid(ClassActors);
+
+	const double RadiusSquared = FMath::Square(Radius);
+	auto AddIfInRadius = [&ClassActors, &Origin, RadiusSquared, &OutActors](const int32 ActorIdx)
+	{
+		if (FVector::DistSquared(ClassActors.Locations[ActorIdx], Origin) <= RadiusSquared)
+		{
+			if (AActor* Actor = ClassActors.Actors[ActorIdx].Get())
+			{
+				OutActors.Add(Actor);
+			}
+		}
+	};
+
+	const int32 MinCellX = FMath::FloorToInt((Origin.X - Radius) / GridCellSize);
+	const int32 MaxCellX = FMath::FloorToInt((Origin.X + Radius) / GridCellSize);
+	const int32 MinCellY = FMath::FloorToInt((Origin.Y - Radius) / GridCellSize);
+	const int32 MaxCellY = FMath::FloorToInt((Origin.Y + Radius) / GridCellSize);
+
+	// Huge radius covers most of the actors anyway
+	const int64 NumCells = static_cast<int64>(MaxCellX - MinCellX + 1) * (MaxCellY - MinCellY + 1);
+	if (NumCells > ClassActors.Actors.Num())
+	{
+		for (int32 ActorIdx = 0; ActorIdx < ClassActors.Actors.Num(); ++ActorIdx)
+		{
+			AddIfInRadius(ActorIdx);
+		}
+		return;
+	}
+
+	for (int32 CellX = MinCellX; CellX <= MaxCellX; ++CellX)
+	{
+		for (int32 CellY = MinCellY; CellY <= MaxCellY; ++CellY)
+		{
+			const uint64 CellKey = GetCellKey(CellX, CellY);
+			int32 CellIdx = Algo::LowerBoundBy(ClassActors.CellActors, CellKey, [](const TPair<uint64, int32>& CellActor)
+			{
+				return CellActor.Key;
+			});
+
+			for (; CellIdx < ClassActors.CellActors.Num() && ClassActors.CellActors[CellIdx].Key == CellKey; ++CellIdx)
+			{
+				AddIfInRadius(ClassActors.CellActors[CellIdx].Value);
+			}
+		}
+	}
+}
+
+UTargetSystemTargetRegistry::FClassActors& UTargetSystemTargetRegistry::FindOrGatherClassActors(UClass* ActorClass)
+{
+	if (FClassActors* ClassActors = ClassActorsMap.Find(ActorClass))
+	{
+		return *ClassActors;
+	}
+
+	FClassActors& ClassActors = ClassActorsMap.Add(ActorClass);
+	for (TActorIterator<AActor> ActorIterator(GetWorld(), ActorClass); ActorIterator; ++ActorIterator)
+	{
+		ClassActors.Actors.Add(*ActorIterator);
+	}
+
+	return ClassActors;
+}
+
+void UTargetSystemTargetRegistry::UpdateGrid(FClassActors& ClassActors)
+{
+	if (ClassActors.GridFrame == GFrameCounter)
+	{
+		return;
+	}
+	ClassActors.GridFrame = GFrameCounter;
+
+	ClassActors.Actors.RemoveAllSwap([](const TWeakObjectPtr<AActor>& Actor)
+	{
+		return !Actor.IsValid();
+	});
+
+	const int32 NumActors = ClassActors.Actors.Num();
+	ClassActors.Locations.SetNumUninitialized(NumActors);
+	ClassActors.CellActors.SetNumUninitialized(NumActors);
+	for (int32 ActorIdx = 0; ActorIdx < NumActors; ++ActorIdx)
+	{
+		const FVector Location = ClassActors.Actors[ActorIdx]->GetActorLocation();
+		ClassActors.Locations[ActorIdx] = Location;
+		ClassActors.CellActors[ActorIdx] = {
+			GetCellKey(FMath::FloorToInt(Location.X / GridCellSize), FMath::FloorToInt(Location.Y / GridCellSize)), ActorIdx
+		};
+	}
+
+	ClassActors.CellActors.Sort([](const TPair<uint64, int32>& A, const TPair<uint64, int32>& B)
+	{
+		return A.Key < B.Key;
+	});
+}
+
+uint64 UTargetSystemTargetRegistry::GetCellKey(const int32 CellX, const int32 CellY)
+{
+	return (static_cast<uint64>(static_cast<uint32>(CellX)) << 32) | static_cast<uint32>(CellY);
+}
+
+void UTargetSystemTargetRegistry::OnActorSpawned(AActor* Actor)
+{
+	for (TPair<TObjectKey<UClass>, FClassActors>& ClassActors : ClassActorsMap)
+	{
+		const UClass* ActorClass = ClassActors.Key.ResolveObjectPtr();
+		if (ActorClass && Actor->IsA(ActorClass))
+		{
+			ClassActors.Value.Actors.Add(Actor);
+			ClassActors.Value.GridFrame = MAX_uint64;
+		}
+	}
+}
+
+void UTargetSystemTargetRegistry::OnActorDestroyed(AActor* Actor)
+{
+	for (TPair<TObjectKey<UClass>, FClassActors>& ClassActors : ClassActorsMap)
+	{
+		if (ClassActors.Value.Actors.RemoveSingleSwap(Actor) > 0)
+		{
+			ClassActors.Value.GridFrame = MAX_uint64;
+		}
+	}
+}
+
+void UTargetSystemTargetRegistry::OnLevelAddedToWorld(ULevel* Level, UWorld* World)
+{
+	if (!Level || World != GetWorld() || ClassActorsMap.Num() == 0)
+	{
+		return;
+	}
+
+	for (AActor* Actor : Level->Actors)
+	{
+		if (Actor)
+		{
+			OnActorSpawned(Actor);
+		}
+	}
+}
+
+void UTargetSystemTargetRegistry::OnLevelRemovedFromWorld(ULevel* Level, UWorld* World)
+{
+	// Null level means all levels are being removed
+	if (World != GetWorld())
+	{
+		return;
+	}
+
+	for (TPair<TObjectKey<UClass>, FClassActors>& ClassActors : ClassActorsMap)
+	{
+		const int32 NumRemoved = ClassActors.Value.Actors.RemoveAllSwap([Level](const TWeakObjectPtr<AActor>& Actor)
+		{
+			return !Actor.IsValid() || !Level || Actor->GetLevel() == Level;
+		});
+		if (NumRemoved > 0)
+		{
+			ClassActors.Value.GridFrame = MAX_uint64;
+		}
+	}
+}
@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
 #include "Engine/HitResult.h"
+#include "WorldCollision.h"
 #include "TargetSystemComponent.generated.h"
 
 class UUserWidget;
@@ -50,6 +51,11 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Target System")
 	float BreakLineOfSightDelay = 2.0f;
 
+	// Targetable actors whose location is farther than this from the line of sight segment's bounding sphere are not ignored by its trace.
+	// Should cover the collision extent of the targetable actors
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Target System")
+	float LineOfSightIgnoreMargin = 200.0f;
+
 	// Lower this value is, easier it will be to switch new target on right or left. Must be < 1.0f if controlling with gamepad stick
 	//
 	// When using Sticky Feeling feature, it has no effect (see StickyRotationThreshold)
@@ -199,12 +205,24 @@ private:
 	bool bDesireToSwitch = false;
 	float StartRotatingStack = 0.0f;
 
+	// Result of the latest async line of sight trace to locked on target
+	bool bLineOfSightBlocked = false;
+	bool bLineOfSightTracePending = false;
+	uint32 LineOfSightTraceId = 0;
+	FTraceHandle LineOfSightTraceHandle;
+	FTraceDelegate LineOfSightTraceDelegate;
+
 	//~ Actors search / trace
 
 	TArray<AActor*> GetAllActorsOfClass(TSubclassOf<AActor> ActorClass) const;
-	TArray<AActor*> FindTargetsInRange(TArray<AActor*> ActorsToLook, float RangeMin, float RangeMax) const;
 
-	AActor* FindNearestTarget(TArray<AActor*> Actors) const;
+	// Targetable actors of TargetableActors class within MinimumDistanceToEnable, except owner and ActorToExclude
+	TArray<AActor*> GetTargetsInRange(const AActor* ActorToExclude) const;
+
+	AActor* FindNearestTarget(const TArray<AActor*>& Actors) const;
+
+	// Traces to candidates in order of their rank (lowest first) and returns the first one in line of sight
+	AActor* FindFirstTargetInLineOfSight(TArray<TPair<float, AActor*>>& RankedCandidates, const TArray<AActor*>& ActorsToIgnore) const;
 
 	bool LineTrace(FHitResult& OutHitResult, const AActor* OtherActor, const TArray<AActor*>& ActorsToIgnore) const;
 	bool LineTraceForActor(const AActor* OtherActor, const TArray<AActor*>& ActorsToIgnore) const;
@@ -212,6 +230,10 @@ private:
 	bool ShouldBreakLineOfSight() const;
 	void BreakLineOfSight();
 
+	void RequestLineOfSightTrace();
+	void OnLineOfSightTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
+	void ResetLineOfSight();
+
 	bool IsInViewport(const AActor* TargetActor) const;
 
 	float GetDistanceFromCharacter(const AActor* OtherActor) const;
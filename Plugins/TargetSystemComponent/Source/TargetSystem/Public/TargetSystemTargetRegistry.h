@@ -0,0 +1,62 @@
+// Copyright 2018-2021 Mickael Daniel. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TargetSystemTargetRegistry.generated.h"
+
+/**
+ * Keeps actors of the classes searched by Target System Components, so that lock on doesn't iterate over all
+ * actors of the world.
+ *
+ * Actors of a class are gathered once, when the class is first queried, then kept up to date on actor spawn and
+ * destruction, and on streaming levels being added to and removed from the world. Range queries go through a grid of actor locations, rebuilt at most once per frame when queried.
+ */
+UCLASS()
+class TARGETSYSTEM_API UTargetSystemTargetRegistry : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// Returns all actors of the class, targetable or not
+	void GetActorsOfClass(TSubclassOf<AActor> ActorClass, TArray<AActor*>& OutActors);
+
+	// Returns actors of the class within Radius of Origin, targetable or not
+	void GetActorsOfClassInRadius(TSubclassOf<AActor> ActorClass, const FVector& Origin, float Radius, TArray<AActor*>& OutActors);
+
+private:
+	static constexpr float GridCellSize = 1000.0f;
+
+	struct FClassActors
+	{
+		TArray<TWeakObjectPtr<AActor>> Actors;
+
+		// Actor locations and indices of actors sorted by grid cell, valid for GridFrame
+		TArray<FVector> Locations;
+		TArray<TPair<uint64, int32>> CellActors;
+		uint64 GridFrame = MAX_uint64;
+	};
+
+	FClassActors& FindOrGatherClassActors(UClass* ActorClass);
+	static void UpdateGrid(FClassActors& ClassActors);
+
+	static uint64 GetCellKey(int32 CellX, int32 CellY);
+
+	void OnActorSpawned(AActor* Actor);
+	void OnActorDestroyed(AActor* Actor);
+
+	// Actors of streamed in levels aren't spawned, so they are added with their level
+	void OnLevelAddedToWorld(ULevel* Level, UWorld* World);
+	void OnLevelRemovedFromWorld(ULevel* Level, UWorld* World);
+
+	TMap<TObjectKey<UClass>, FClassActors> ClassActorsMap;
+
+	FDelegateHandle ActorSpawnedHandle;
+	FDelegateHandle ActorDestroyedHandle;
+	FDelegateHandle LevelAddedHandle;
+	FDelegateHandle LevelRemovedHandle;
+};
@@ -10,6 +10,7 @@ public class ECR : ModuleRules
 
 		PublicDependencyModuleNames.AddRange(new string[]
 		{
+			"CharacterOptimizer",
 			"Core", 
 			"CoreUObject", 
 			"ECRCommon", 
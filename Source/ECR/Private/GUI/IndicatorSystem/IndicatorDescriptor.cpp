@@ -4,95 +4,168 @@
 #include "Engine/LocalPlayer.h"
 
 
-bool FIndicatorProjection::Project(const UIndicatorDescriptor& IndicatorDescriptor, const FSceneViewProjectionData& InProjectionData, const FVector2D& ScreenSize, FVector& OutScreenPositionWithDepth)
+bool FIndicatorProjection::GetWorldPoint(const UIndicatorDescriptor& IndicatorDescriptor, FVector& OutWorldPoint)
 {
-	if (USceneComponent* Component = IndicatorDescriptor.GetSceneComponent())
+	USceneComponent* Component = IndicatorDescriptor.GetSceneComponent();
+	if (!Component)
+	{
+		return false;
+	}
+
+	const EActorCanvasProjectionMode ProjectionMode = IndicatorDescriptor.GetProjectionMode();
+	switch (ProjectionMode)
 	{
-		TOptional<FVector> WorldLocation;
-		if (IndicatorDescriptor.GetComponentSocketName() != NAME_None)
+		case EActorCanvasProjectionMode::ComponentPoint:
 		{
-			WorldLocation = Component->GetSocketTransform(IndicatorDescriptor.GetComponentSocketName()).GetLocation();
+			const FVector WorldLocation = IndicatorDescriptor.GetComponentSocketName() != NAME_None
+				                              ? Component->GetSocketTransform(IndicatorDescriptor.GetComponentSocketName()).GetLocation()
+				                              : Component->GetComponentLocation();
+			OutWorldPoint = WorldLocation + IndicatorDescriptor.GetWorldPositionOffset();
+			return true;
 		}
-		else
+		case EActorCanvasProjectionMode::ActorBoundingBox:
+		case EActorCanvasProjectionMode::ComponentBoundingBox:
 		{
-			WorldLocation = Component->GetComponentLocation();
+			const FBox IndicatorBox = ProjectionMode == EActorCanvasProjectionMode::ActorBoundingBox
+				                          ? Component->GetOwner()->GetComponentsBoundingBox()
+				                          : Component->Bounds.GetBox();
+			OutWorldPoint = IndicatorBox.GetCenter() + (IndicatorBox.GetSize() * (IndicatorDescriptor.GetBoundingBoxAnchor() - FVector(0.5)));
+			return true;
 		}
+		default:
+			return false;
+	}
+}
+
+void FIndicatorProjection::ProjectPoints(const FSceneViewProjectionData& InProjectionData, const FVector2D& ScreenSize,
+                                         const TConstArrayView<FVector> WorldPoints,
+                                         const TArrayView<FVector> OutScreenPositionsWithDepth,
+                                         const TArrayView<bool> OutInFrontOfCamera)
+{
+	check(WorldPoints.Num() == OutScreenPositionsWithDepth.Num() && WorldPoints.Num() == OutInFrontOfCamera.Num());
+
+	// Same as ULocalPlayer::GetPixelPoint with allotted size, which computes view projection matrix for every point
+	const FMatrix ViewProjectionMatrix = InProjectionData.ComputeViewProjectionMatrix();
+	const FIntRect ViewRect = InProjectionData.GetConstrainedViewRect();
+	const FVector2D ViewRectSize(ViewRect.Width(), ViewRect.Height());
+	const FVector2D ViewRectMin(ViewRect.Min.X, ViewRect.Min.Y);
+	const FVector2D PixelScale = ScreenSize / ViewRectSize;
+
+	// Points are transposed to arrays of coordinates and projected four at a time, padding lanes are zeros
+	const int32 NumPoints = WorldPoints.Num();
+	const int32 NumPadded = Align(NumPoints, 4);
+
+	enum EScratchArray { WorldX, WorldY, WorldZ, ScreenX, ScreenY, Depth, ClipW, NumScratchArrays };
+	TArray<double, TInlineAllocator<NumScratchArrays * 64>> Scratch;
+	Scratch.SetNumZeroed(NumScratchArrays * NumPadded);
+	double* Arrays[NumScratchArrays];
+	for (int32 ArrayIdx = 0; ArrayIdx < NumScratchArrays; ++ArrayIdx)
+	{
+		Arrays[ArrayIdx] = Scratch.GetData() + ArrayIdx * NumPadded;
+	}
+
+	for (int32 PointIdx = 0; PointIdx < NumPoints; ++PointIdx)
+	{
+		Arrays[WorldX][PointIdx] = WorldPoints[PointIdx].X;
+		Arrays[WorldY][PointIdx] = WorldPoints[PointIdx].Y;
+		Arrays[WorldZ][PointIdx] = WorldPoints[PointIdx].Z;
+	}
+
+	// Only X, Y and W of clip space position are needed
+	const FMatrix& M = ViewProjectionMatrix;
+	const VectorRegister4Double M00 = VectorSetFloat1(M.M[0][0]), M10 = VectorSetFloat1(M.M[1][0]);
+	const VectorRegister4Double M20 = VectorSetFloat1(M.M[2][0]), M30 = VectorSetFloat1(M.M[3][0]);
+	const VectorRegister4Double M01 = VectorSetFloat1(M.M[0][1]), M11 = VectorSetFloat1(M.M[1][1]);
+	const VectorRegister4Double M21 = VectorSetFloat1(M.M[2][1]), M31 = VectorSetFloat1(M.M[3][1]);
+	const VectorRegister4Double M03 = VectorSetFloat1(M.M[0][3]), M13 = VectorSetFloat1(M.M[1][3]);
+	const VectorRegister4Double M23 = VectorSetFloat1(M.M[2][3]), M33 = VectorSetFloat1(M.M[3][3]);
+
+	// Screen = ((Clip * RHW * 0.5 + 0.5) * ViewRectSize + ViewRectMin) * PixelScale, Y flipped
+	const VectorRegister4Double ScaleX = VectorSetFloat1(0.5 * ViewRectSize.X * PixelScale.X);
+	const VectorRegister4Double ScaleY = VectorSetFloat1(-0.5 * ViewRectSize.Y * PixelScale.Y);
+	const VectorRegister4Double OffsetX = VectorSetFloat1((0.5 * ViewRectSize.X + ViewRectMin.X) * PixelScale.X);
+	const VectorRegister4Double OffsetY = VectorSetFloat1((0.5 * ViewRectSize.Y + ViewRectMin.Y) * PixelScale.Y);
+
+	const VectorRegister4Double OriginX = VectorSetFloat1(InProjectionData.ViewOrigin.X);
+	const VectorRegister4Double OriginY = VectorSetFloat1(InProjectionData.ViewOrigin.Y);
+	const VectorRegister4Double OriginZ = VectorSetFloat1(InProjectionData.ViewOrigin.Z);
+	const VectorRegister4Double Zero = VectorZeroDouble();
+	const VectorRegister4Double One = VectorOneDouble();
+
+	for (int32 PointIdx = 0; PointIdx < NumPadded; PointIdx += 4)
+	{
+		const VectorRegister4Double X = VectorLoad(Arrays[WorldX] + PointIdx);
+		const VectorRegister4Double Y = VectorLoad(Arrays[WorldY] + PointIdx);
+		const VectorRegister4Double Z = VectorLoad(Arrays[WorldZ] + PointIdx);
+
+		const VectorRegister4Double ClipX = VectorMultiplyAdd(X, M00, VectorMultiplyAdd(Y, M10, VectorMultiplyAdd(Z, M20, M30)));
+		const VectorRegister4Double ClipY = VectorMultiplyAdd(X, M01, VectorMultiplyAdd(Y, M11, VectorMultiplyAdd(Z, M21, M31)));
+		const VectorRegister4Double W = VectorMultiplyAdd(X, M03, VectorMultiplyAdd(Y, M13, VectorMultiplyAdd(Z, M23, M33)));
 
-		const FVector ProjectWorldLocation = WorldLocation.GetValue() + IndicatorDescriptor.GetWorldPositionOffset();
-		const EActorCanvasProjectionMode ProjectionMode = IndicatorDescriptor.GetProjectionMode();
-		
-		switch (ProjectionMode)
+		// Same as GetPixelPoint, points behind camera are mirrored rather than flipped
+		const VectorRegister4Double RHW = VectorSelect(VectorCompareEQ(W, Zero), One, VectorDivide(One, VectorAbs(W)));
+		VectorStore(VectorMultiplyAdd(VectorMultiply(ClipX, RHW), ScaleX, OffsetX), Arrays[ScreenX] + PointIdx);
+		VectorStore(VectorMultiplyAdd(VectorMultiply(ClipY, RHW), ScaleY, OffsetY), Arrays[ScreenY] + PointIdx);
+		VectorStore(W, Arrays[ClipW] + PointIdx);
+
+		const VectorRegister4Double DX = VectorSubtract(X, OriginX);
+		const VectorRegister4Double DY = VectorSubtract(Y, OriginY);
+		const VectorRegister4Double DZ = VectorSubtract(Z, OriginZ);
+		const VectorRegister4Double DistanceSquared = VectorMultiplyAdd(DX, DX, VectorMultiplyAdd(DY, DY, VectorMultiply(DZ, DZ)));
+		VectorStore(VectorSqrt(DistanceSquared), Arrays[Depth] + PointIdx);
+	}
+
+	for (int32 PointIdx = 0; PointIdx < NumPoints; ++PointIdx)
+	{
+		OutScreenPositionsWithDepth[PointIdx] = FVector(Arrays[ScreenX][PointIdx], Arrays[ScreenY][PointIdx],
+		                                                Arrays[Depth][PointIdx]);
+		OutInFrontOfCamera[PointIdx] = Arrays[ClipW][PointIdx] >= 0.0;
+	}
+}
+
+bool FIndicatorProjection::Project(const UIndicatorDescriptor& IndicatorDescriptor, const FSceneViewProjectionData& InProjectionData, const FVector2D& ScreenSize, FVector& OutScreenPositionWithDepth)
+{
+	USceneComponent* Component = IndicatorDescriptor.GetSceneComponent();
+	if (!Component)
+	{
+		return false;
+	}
+
+	FVector WorldPoint;
+	if (GetWorldPoint(IndicatorDescriptor, WorldPoint))
+	{
+		FVector2D OutScreenSpacePosition;
+		if (ULocalPlayer::GetPixelPoint(InProjectionData, WorldPoint, OutScreenSpacePosition, &ScreenSize))
 		{
-			case EActorCanvasProjectionMode::ComponentPoint:
-			{
-				if (WorldLocation.IsSet())
-				{
-					FVector2D OutScreenSpacePosition;
-					if (ULocalPlayer::GetPixelPoint(InProjectionData, ProjectWorldLocation, OutScreenSpacePosition, &ScreenSize))
-					{
-						OutScreenSpacePosition += IndicatorDescriptor.GetScreenSpaceOffset();
-
-						OutScreenPositionWithDepth = FVector(OutScreenSpacePosition.X, OutScreenSpacePosition.Y, FVector::Dist(InProjectionData.ViewOrigin, ProjectWorldLocation));
-						return true;
-					}
-				}
-
-				return false;
-			}
-			case EActorCanvasProjectionMode::ComponentScreenBoundingBox:
-			case EActorCanvasProjectionMode::ActorScreenBoundingBox:
-			{
-				FBox IndicatorBox;
-				if (ProjectionMode == EActorCanvasProjectionMode::ActorScreenBoundingBox)
-				{
-					IndicatorBox = Component->GetOwner()->GetComponentsBoundingBox();
-				}
-				else
-				{
-					IndicatorBox = Component->Bounds.GetBox();
-				}
-
-				FVector2D LL, UR;
-				if (ULocalPlayer::GetPixelBoundingBox(InProjectionData, IndicatorBox, LL, UR, &ScreenSize))
-				{
-					const FVector& BoundingBoxAnchor = IndicatorDescriptor.GetBoundingBoxAnchor();
-					const FVector2D& ScreenSpaceOffset = IndicatorDescriptor.GetScreenSpaceOffset();
-					
-					OutScreenPositionWithDepth.X = FMath::Lerp(LL.X, UR.X, BoundingBoxAnchor.X) + ScreenSpaceOffset.X;
-					OutScreenPositionWithDepth.Y = FMath::Lerp(LL.Y, UR.Y, BoundingBoxAnchor.Y) + ScreenSpaceOffset.Y;
-					OutScreenPositionWithDepth.Z = FVector::Dist(InProjectionData.ViewOrigin, ProjectWorldLocation);
-					return true;
-				}
-
-				return false;
-			}
-			case EActorCanvasProjectionMode::ActorBoundingBox:
-			case EActorCanvasProjectionMode::ComponentBoundingBox:
-			{
-				FBox IndicatorBox;
-				if (ProjectionMode == EActorCanvasProjectionMode::ActorBoundingBox)
-				{
-					IndicatorBox = Component->GetOwner()->GetComponentsBoundingBox();
-				}
-				else
-				{
-					IndicatorBox = Component->Bounds.GetBox();
-				}
-
-				const FVector ProjectBoxPoint = IndicatorBox.GetCenter() + (IndicatorBox.GetSize() * (IndicatorDescriptor.GetBoundingBoxAnchor() - FVector(0.5)));
-
-				FVector2D OutScreenSpacePosition;
-				if (ULocalPlayer::GetPixelPoint(InProjectionData, ProjectBoxPoint, OutScreenSpacePosition, &ScreenSize))
-				{
-					OutScreenSpacePosition += IndicatorDescriptor.GetScreenSpaceOffset();
-
-					OutScreenPositionWithDepth = FVector(OutScreenSpacePosition.X, OutScreenSpacePosition.Y, FVector::Dist(InProjectionData.ViewOrigin, ProjectBoxPoint));
-					return true;
-				}
-
-				return false;
-			}
+			OutScreenSpacePosition += IndicatorDescriptor.GetScreenSpaceOffset();
+
+			OutScreenPositionWithDepth = FVector(OutScreenSpacePosition.X, OutScreenSpacePosition.Y, FVector::Dist(InProjectionData.ViewOrigin, WorldPoint));
+			return true;
 		}
+
+		return false;
+	}
+
+	// Screen bounding box modes
+	const FVector WorldLocation = IndicatorDescriptor.GetComponentSocketName() != NAME_None
+		                              ? Component->GetSocketTransform(IndicatorDescriptor.GetComponentSocketName()).GetLocation()
+		                              : Component->GetComponentLocation();
+	const FVector ProjectWorldLocation = WorldLocation + IndicatorDescriptor.GetWorldPositionOffset();
+
+	const FBox IndicatorBox = IndicatorDescriptor.GetProjectionMode() == EActorCanvasProjectionMode::ActorScreenBoundingBox
+		                          ? Component->GetOwner()->GetComponentsBoundingBox()
+		                          : Component->Bounds.GetBox();
+
+	FVector2D LL, UR;
+	if (ULocalPlayer::GetPixelBoundingBox(InProjectionData, IndicatorBox, LL, UR, &ScreenSize))
+	{
+		const FVector& BoundingBoxAnchor = IndicatorDescriptor.GetBoundingBoxAnchor();
+		const FVector2D& ScreenSpaceOffset = IndicatorDescriptor.GetScreenSpaceOffset();
+
+		OutScreenPositionWithDepth.X = FMath::Lerp(LL.X, UR.X, BoundingBoxAnchor.X) + ScreenSpaceOffset.X;
+		OutScreenPositionWithDepth.Y = FMath::Lerp(LL.Y, UR.Y, BoundingBoxAnchor.Y) + ScreenSpaceOffset.Y;
+		OutScreenPositionWithDepth.Z = FVector::Dist(InProjectionData.ViewOrigin, ProjectWorldLocation);
+		return true;
 	}
 
 	return false;
@@ -4,6 +4,39 @@
 #include "Engine/Canvas.h"
 #include "Gameplay/Player/ECRPlayerController.h"
 
+DECLARE_STATS_GROUP(TEXT("ECRCamera"), STATGROUP_ECRCamera, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Prevent Camera Penetration"), STAT_ECRCamera_PreventPenetration, STATGROUP_ECRCamera);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Penetration Sync Sweeps"), STAT_ECRCamera_SyncSweeps, STATGROUP_ECRCamera);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Penetration Async Sweeps"), STAT_ECRCamera_AsyncSweeps, STATGROUP_ECRCamera);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Penetration Async Error"), STAT_ECRCamera_AsyncError, STATGROUP_ECRCamera);
+
+namespace ECRConsoleVariables
+{
+	static int32 CameraAsyncPenetrationSweeps = 1;
+	static FAutoConsoleVariableRef CVarCameraAsyncPenetrationSweeps(
+		TEXT("ECR.Camera.AsyncPenetrationSweeps"),
+		CameraAsyncPenetrationSweeps,
+		TEXT("If 1, secondary camera penetration feelers are swept asynchronously and their hits are used next frame, ")
+		TEXT("reprojected on the current feeler rays. Main feeler is always swept synchronously"),
+		ECVF_Default);
+
+	static float CameraAsyncPenetrationMaxRayDeviation = 10.0f;
+	static FAutoConsoleVariableRef CVarCameraAsyncPenetrationMaxRayDeviation(
+		TEXT("ECR.Camera.AsyncPenetrationMaxRayDeviation"),
+		CameraAsyncPenetrationMaxRayDeviation,
+		TEXT("Async feeler hits are discarded if feeler ray rotated more than this (degrees) since sweep ")
+		TEXT("(or its origin moved more than feeler extent)"),
+		ECVF_Default);
+
+	static int32 CameraValidateAsyncPenetration = 0;
+	static FAutoConsoleVariableRef CVarCameraValidateAsyncPenetration(
+		TEXT("ECR.Camera.ValidateAsyncPenetration"),
+		CameraValidateAsyncPenetration,
+		TEXT("If 1, async feeler results are compared with synchronous sweeps of the same frame, ")
+		TEXT("difference of blocked pct is shown in stat ECRCamera"),
+		ECVF_Cheat);
+}
+
 namespace ECRCameraMode_PenetrationAvoidant_Statics
 {
 	static const FName NAME_IgnoreCameraCollision = TEXT("IgnoreCameraCollision");
@@ -108,6 +141,8 @@ void UECRCameraMode_PenetrationAvoidant::PreventCameraPenetration(class AActor c
                                                                   float const& DeltaTime, float& DistBlockedPct,
                                                                   bool bSingleRayOnly)
 {
+	SCOPE_CYCLE_COUNTER(STAT_ECRCamera_PreventPenetration);
+
 #if ENABLE_DRAW_DEBUG
 	DebugActorsHitDuringCameraPenetration.Reset();
 #endif
@@ -158,93 +193,116 @@ void UECRCameraMode_PenetrationAvoidant::PreventCameraPenetration(class AActor c
 	FCollisionShape SphereShape = FCollisionShape::MakeSphere(0.f);
 	UWorld* World = GetWorld();
 
+	const bool bAsyncSweeps = ECRConsoleVariables::CameraAsyncPenetrationSweeps > 0;
+	const bool bValidateAsyncSweeps = bAsyncSweeps && ECRConsoleVariables::CameraValidateAsyncPenetration > 0;
+	const float MinRayDeviationCos = FMath::Cos(
+		FMath::DegreesToRadians(ECRConsoleVariables::CameraAsyncPenetrationMaxRayDeviation));
+	float ValidationDistBlockedPctThisFrame = 1.f;
+
+	PendingFeelerSweeps.SetNum(PenetrationAvoidanceFeelers.Num());
+
 	for (int32 RayIdx = 0; RayIdx < NumRaysToShoot; ++RayIdx)
 	{
 		FECRPenetrationAvoidanceFeeler& Feeler = PenetrationAvoidanceFeelers[RayIdx];
-		if (Feeler.FramesUntilNextTrace <= 0)
+
+		// calc ray target
+		FVector RayTarget;
 		{
-			// calc ray target
-			FVector RayTarget;
-			{
-				FVector RotatedRay = BaseRay.RotateAngleAxis(Feeler.AdjustmentRot.Yaw, BaseRayLocalUp);
-				RotatedRay = RotatedRay.RotateAngleAxis(Feeler.AdjustmentRot.Pitch, BaseRayLocalRight);
-				RayTarget = SafeLoc + RotatedRay;
-			}
+			FVector RotatedRay = BaseRay.RotateAngleAxis(Feeler.AdjustmentRot.Yaw, BaseRayLocalUp);
+			RotatedRay = RotatedRay.RotateAngleAxis(Feeler.AdjustmentRot.Pitch, BaseRayLocalRight);
+			RayTarget = SafeLoc + RotatedRay;
+		}
+
+		// cast for world and pawn hits separately.  this is so we can safely ignore the 
+		// camera's target pawn
+		SphereShape.Sphere.Radius = Feeler.Extent;
+		ECollisionChannel TraceChannel = ECC_Camera; //(Feeler.PawnWeight > 0.f) ? ECC_Pawn : ECC_Camera;
+
+		FHitResult Hit;
+		bool bHasHitResult = false;
 
-			// cast for world and pawn hits separately.  this is so we can safely ignore the 
-			// camera's target pawn
-			SphereShape.Sphere.Radius = Feeler.Extent;
-			ECollisionChannel TraceChannel = ECC_Camera; //(Feeler.PawnWeight > 0.f) ? ECC_Pawn : ECC_Camera;
+		// Main ray is snapped to, so it can't use a hit of the last frame
+		const bool bAsyncFeeler = bAsyncSweeps && RayIdx > 0;
 
+		if (bAsyncFeeler)
+		{
+			// Sweep requested last frame, its hit is reprojected on this frame's ray as long as the ray didn't
+			// rotate too much and its origin didn't move further than the feeler extent since
+			FFeelerSweep& PendingSweep = PendingFeelerSweeps[RayIdx];
+			FTraceDatum SweepData;
+			if (PendingSweep.Handle.IsValid() && World->QueryTraceData(PendingSweep.Handle, SweepData))
+			{
+				const FVector SweptRayDir = (PendingSweep.RayTarget - PendingSweep.SafeLoc).GetSafeNormal();
+				if ((SweptRayDir | (RayTarget - SafeLoc).GetSafeNormal()) >= MinRayDeviationCos
+					&& FVector::DistSquared(PendingSweep.SafeLoc, SafeLoc) <= FMath::Square(Feeler.Extent))
+				{
+					if (const FHitResult* AsyncHit = FHitResult::GetFirstBlockingHit(SweepData.OutHits))
+					{
+						Hit = *AsyncHit;
+					}
+					bHasHitResult = true;
+				}
+			}
+			PendingSweep.Handle = FTraceHandle();
+		}
+		else if (Feeler.FramesUntilNextTrace <= 0)
+		{
 			// do multi-line check to make sure the hits we throw out aren't
 			// masking real hits behind (these are important rays).
 
 			// MT-> passing camera as actor so that camerablockingvolumes know when it's the camera doing traces
-			FHitResult Hit;
-			const bool bHit = World->SweepSingleByChannel(Hit, SafeLoc, RayTarget, FQuat::Identity, TraceChannel,
-			                                              SphereShape, SphereParams);
+			World->SweepSingleByChannel(Hit, SafeLoc, RayTarget, FQuat::Identity, TraceChannel, SphereShape,
+			                            SphereParams);
+			INC_DWORD_STAT(STAT_ECRCamera_SyncSweeps);
+			bHasHitResult = true;
+
+			Feeler.FramesUntilNextTrace = Feeler.TraceInterval;
+		}
+		else
+		{
+			--Feeler.FramesUntilNextTrace;
+		}
+
+		if (bHasHitResult)
+		{
 #if ENABLE_DRAW_DEBUG
 			if (World->TimeSince(LastDrawDebugTime) < 1.f)
 			{
+				const FVector HitLocation = Hit.bBlockingHit ? Hit.Location : RayTarget;
 				DrawDebugSphere(World, SafeLoc, SphereShape.Sphere.Radius, 8, FColor::Red);
-				DrawDebugSphere(World, bHit ? Hit.Location : RayTarget, SphereShape.Sphere.Radius, 8, FColor::Red);
-				DrawDebugLine(World, SafeLoc, bHit ? Hit.Location : RayTarget, FColor::Red);
+				DrawDebugSphere(World, HitLocation, SphereShape.Sphere.Radius, 8, FColor::Red);
+				DrawDebugLine(World, SafeLoc, HitLocation, FColor::Red);
 			}
 #endif // ENABLE_DRAW_DEBUG
 
-			Feeler.FramesUntilNextTrace = Feeler.TraceInterval;
-
-			const AActor* HitActor = Hit.GetActor();
-
-			if (bHit && HitActor)
+			float NewBlockPct;
+			const bool bBlocked = GetFeelerBlockedPct(ViewTarget, Hit, SafeLoc, RayTarget, SphereParams, NewBlockPct);
+			if (bBlocked)
 			{
-				bool bIgnoreHit = false;
+				DistBlockedPctThisFrame = FMath::Min(NewBlockPct, DistBlockedPctThisFrame);
 
-				if (HitActor->ActorHasTag(ECRCameraMode_PenetrationAvoidant_Statics::NAME_IgnoreCameraCollision))
-				{
-					bIgnoreHit = true;
-					SphereParams.AddIgnoredActor(HitActor);
-				}
+				// This feeler got a hit, so do another trace next frame
+				Feeler.FramesUntilNextTrace = 0;
+			}
 
-				// Ignore CameraBlockingVolume hits that occur in front of the ViewTarget.
-				if (!bIgnoreHit && HitActor->IsA<ACameraBlockingVolume>())
+			if (bValidateAsyncSweeps && !bAsyncFeeler)
+			{
+				if (bBlocked)
 				{
-					const FVector ViewTargetForwardXY = ViewTarget.GetActorForwardVector().GetSafeNormal2D();
-					const FVector ViewTargetLocation = ViewTarget.GetActorLocation();
-					const FVector HitOffset = Hit.Location - ViewTargetLocation;
-					const FVector HitDirectionXY = HitOffset.GetSafeNormal2D();
-					const float DotHitDirection = FVector::DotProduct(ViewTargetForwardXY, HitDirectionXY);
-					if (DotHitDirection > 0.0f)
-					{
-						bIgnoreHit = true;
-						// Ignore this CameraBlockingVolume on the remaining sweeps.
-						SphereParams.AddIgnoredActor(HitActor);
-					}
-					else
-					{
-#if ENABLE_DRAW_DEBUG
-						DebugActorsHitDuringCameraPenetration.AddUnique(TObjectPtr<const AActor>(HitActor));
-#endif
-					}
+					ValidationDistBlockedPctThisFrame = FMath::Min(NewBlockPct, ValidationDistBlockedPctThisFrame);
 				}
-
-				if (!bIgnoreHit)
+			}
+			else if (bValidateAsyncSweeps)
+			{
+				FHitResult ValidationHit;
+				World->SweepSingleByChannel(ValidationHit, SafeLoc, RayTarget, FQuat::Identity, TraceChannel,
+				                            SphereShape, SphereParams);
+				float ValidationBlockPct;
+				if (GetFeelerBlockedPct(ViewTarget, ValidationHit, SafeLoc, RayTarget, SphereParams,
+				                        ValidationBlockPct))
 				{
-					float const Weight = Cast<APawn>(Hit.GetActor()) ? Feeler.PawnWeight : Feeler.WorldWeight;
-					float NewBlockPct = Hit.Time;
-					NewBlockPct += (1.f - NewBlockPct) * (1.f - Weight);
-
-					// Recompute blocked pct taking into account pushout distance.
-					NewBlockPct = ((Hit.Location - SafeLoc).Size() - CollisionPushOutDistance) / (RayTarget - SafeLoc).
-						Size();
-					DistBlockedPctThisFrame = FMath::Min(NewBlockPct, DistBlockedPctThisFrame);
-
-					// This feeler got a hit, so do another trace next frame
-					Feeler.FramesUntilNextTrace = 0;
-
-#if ENABLE_DRAW_DEBUG
-					DebugActorsHitDuringCameraPenetration.AddUnique(TObjectPtr<const AActor>(HitActor));
-#endif
+					ValidationDistBlockedPctThisFrame = FMath::Min(ValidationBlockPct,
+					                                               ValidationDistBlockedPctThisFrame);
 				}
 			}
 
@@ -259,12 +317,34 @@ void UECRCameraMode_PenetrationAvoidant::PreventCameraPenetration(class AActor c
 				SoftBlockedPct = DistBlockedPctThisFrame;
 			}
 		}
-		else
+
+		// All secondary feelers due this frame are dispatched together and run in parallel with the rest of the frame
+		if (bAsyncFeeler)
 		{
-			--Feeler.FramesUntilNextTrace;
+			if (Feeler.FramesUntilNextTrace <= 0)
+			{
+				FFeelerSweep& PendingSweep = PendingFeelerSweeps[RayIdx];
+				PendingSweep.Handle = World->AsyncSweepByChannel(EAsyncTraceType::Single, SafeLoc, RayTarget,
+				                                                 FQuat::Identity, TraceChannel, SphereShape,
+				                                                 SphereParams);
+				PendingSweep.SafeLoc = SafeLoc;
+				PendingSweep.RayTarget = RayTarget;
+				INC_DWORD_STAT(STAT_ECRCamera_AsyncSweeps);
+
+				Feeler.FramesUntilNextTrace = Feeler.TraceInterval;
+			}
+			else
+			{
+				--Feeler.FramesUntilNextTrace;
+			}
 		}
 	}
 
+	if (bValidateAsyncSweeps)
+	{
+		SET_FLOAT_STAT(STAT_ECRCamera_AsyncError, FMath::Abs(DistBlockedPctThisFrame - ValidationDistBlockedPctThisFrame));
+	}
+
 	if (bResetInterpolation)
 	{
 		DistBlockedPct = DistBlockedPctThisFrame;
@@ -310,6 +390,51 @@ void UECRCameraMode_PenetrationAvoidant::PreventCameraPenetration(class AActor c
 	}
 }
 
+bool UECRCameraMode_PenetrationAvoidant::GetFeelerBlockedPct(AActor const& ViewTarget, const FHitResult& Hit,
+                                                             FVector const& SafeLoc, FVector const& RayTarget,
+                                                             FCollisionQueryParams& SphereParams, float& OutBlockedPct)
+{
+	const AActor* HitActor = Hit.GetActor();
+	if (!Hit.bBlockingHit || !HitActor)
+	{
+		return false;
+	}
+
+	if (HitActor->ActorHasTag(ECRCameraMode_PenetrationAvoidant_Statics::NAME_IgnoreCameraCollision))
+	{
+		SphereParams.AddIgnoredActor(HitActor);
+		return false;
+	}
+
+	// Ignore CameraBlockingVolume hits that occur in front of the ViewTarget.
+	if (HitActor->IsA<ACameraBlockingVolume>())
+	{
+		const FVector ViewTargetForwardXY = ViewTarget.GetActorForwardVector().GetSafeNormal2D();
+		const FVector ViewTargetLocation = ViewTarget.GetActorLocation();
+		const FVector HitOffset = Hit.Location - ViewTargetLocation;
+		const FVector HitDirectionXY = HitOffset.GetSafeNormal2D();
+		const float DotHitDirection = FVector::DotProduct(ViewTargetForwardXY, HitDirectionXY);
+		if (DotHitDirection > 0.0f)
+		{
+			// Ignore this CameraBlockingVolume on the remaining sweeps.
+			SphereParams.AddIgnoredActor(HitActor);
+			return false;
+		}
+	}
+
+	// Blocked pct taking into account pushout distance. Hit is projected on the ray, as hits of async sweeps
+	// were found for the ray of the previous frame, for sync sweeps it's the distance to hit.
+	const FVector Ray = RayTarget - SafeLoc;
+	const float RayLength = Ray.Size();
+	OutBlockedPct = (((Hit.Location - SafeLoc) | Ray.GetSafeNormal()) - CollisionPushOutDistance) /
+		FMath::Max(RayLength, UE_KINDA_SMALL_NUMBER);
+
+#if ENABLE_DRAW_DEBUG
+	DebugActorsHitDuringCameraPenetration.AddUnique(TObjectPtr<const AActor>(HitActor));
+#endif
+
+	return true;
+}
 
 void UECRCameraMode_PenetrationAvoidant::DrawDebug(UCanvas* Canvas) const
 {
@@ -3,6 +3,7 @@
 #include "Gameplay/Character/ECRCharacter.h"
 
 #include "AbilitySystemBlueprintLibrary.h"
+#include "CharacterOptimizerComponent.h"
 #include "Gameplay/Character/ECRCharacterMovementComponent.h"
 #include "System/ECRLogChannels.h"
 #include "Gameplay/ECRGameplayTags.h"
@@ -10,6 +11,7 @@
 #include "Components/CapsuleComponent.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "System/ECRSignificanceManager.h"
+#include "Gameplay/Weapons/ECRLagCompensationSubsystem.h"
 #include "Components/InputComponent.h"
 #include "Gameplay/Camera/ECRCameraComponent.h"
 #include "Gameplay/GAS/ECRAbilitySystemComponent.h"
@@ -132,7 +134,15 @@ void AECRCharacter::BeginPlay()
 	{
 		if (UECRSignificanceManager* SignificanceManager = USignificanceManager::Get<UECRSignificanceManager>(World))
 		{
-			//@TODO: SignificanceManager->RegisterObject(this, (EFortSignificanceType)SignificanceType);
+			SignificanceManager->RegisterCharacterOptimizer(FindComponentByClass<UCharacterOptimizerComponent>());
+		}
+	}
+
+	if (HasAuthority())
+	{
+		if (UECRLagCompensationSubsystem* LagCompensation = World->GetSubsystem<UECRLagCompensationSubsystem>())
+		{
+			LagCompensation->RegisterCharacter(this);
 		}
 	}
 
@@ -150,9 +160,14 @@ void AECRCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
 	{
 		if (UECRSignificanceManager* SignificanceManager = USignificanceManager::Get<UECRSignificanceManager>(World))
 		{
-			SignificanceManager->UnregisterObject(this);
+			SignificanceManager->UnregisterCharacterOptimizer(FindComponentByClass<UCharacterOptimizerComponent>());
 		}
 	}
+
+	if (UECRLagCompensationSubsystem* LagCompensation = World->GetSubsystem<UECRLagCompensationSubsystem>())
+	{
+		LagCompensation->UnregisterCharacter(this);
+	}
 }
 
 void AECRCharacter::Reset()
@@ -729,8 +744,14 @@ bool FSharedRepMovement::NetSerialize(FArchive& Ar, class UPackageMap* Map, bool
 	bOutSuccess = true;
 	RepMovement.NetSerialize(Ar, Map, bOutSuccess);
 	Ar << RepMovementMode;
-	Ar << bProxyIsJumpForceApplied;
-	Ar << bIsCrouched;
+
+	// Flags are packed into single bits, serializing bool directly would take 32 bits each
+	uint8 bJumpForceAppliedBit = bProxyIsJumpForceApplied;
+	uint8 bIsCrouchedBit = bIsCrouched;
+	Ar.SerializeBits(&bJumpForceAppliedBit, 1);
+	Ar.SerializeBits(&bIsCrouchedBit, 1);
+	bProxyIsJumpForceApplied = bJumpForceAppliedBit != 0;
+	bIsCrouched = bIsCrouchedBit != 0;
 
 	// Timestamp, if non-zero.
 	uint8 bHasTimeStamp = (RepTimeStamp != 0.f);
@@ -7,6 +7,7 @@
 #include "GameFramework/PlayerState.h"
 #include "Gameplay/Character/ECRCharacter.h"
 #include "Gameplay/Character/ECRPawnExtensionComponent.h"
+#include "Gameplay/Player/ECRPlayerState.h"
 #include "Kismet/GameplayStatics.h"
 #include "UObject/ConstructorHelpers.h"
 
@@ -62,6 +63,15 @@ FString AECRGameMode::InitNewPlayer(APlayerController* NewPlayerController, cons
 {
 	// Storing options for further blueprint usage
 	ControllersToJoinOptions.Add(NewPlayerController, Options);
+
+	// Initial faction, so that team relevancy works before blueprints assign squad (or another faction)
+	const FString DesiredFaction = UGameplayStatics::ParseOption(Options, TEXT("DesiredFaction"));
+	AECRPlayerState* ECRPlayerState = NewPlayerController ? NewPlayerController->GetPlayerState<AECRPlayerState>() : nullptr;
+	if (ECRPlayerState && !DesiredFaction.IsEmpty())
+	{
+		ECRPlayerState->SetFactionAndSquad(FName(*DesiredFaction), INDEX_NONE);
+	}
+
 	return Super::InitNewPlayer(NewPlayerController, UniqueId, Options, Portal);
 }
 
@@ -98,6 +98,8 @@ void FECRGameplayTags::AddAllTags(UGameplayTagsManager& Manager)
 	AddTag(Status_Death_Dead, "Status.Death.Dead", "Target has finished the death process.");
 	AddTag(Status_JumpFlying, "Status.JumpFlying", "Target is jump pack flying.");
 	AddTag(Status_Wounded, "Status.Wounded", "Target is wounded.");
+	AddTag(Status_ObjectiveCarrier, "Status.ObjectiveCarrier",
+	       "Target carries an objective, which keeps it relevant for allies at any distance.");
 
 	AddMovementModeTag(Movement_Mode_Walking, "Movement.Mode.Walking", MOVE_Walking);
 	AddMovementModeTag(Movement_Mode_NavWalking, "Movement.Mode.NavWalking", MOVE_NavWalking);
@@ -31,6 +31,13 @@ void FECREquipmentList::PreReplicatedRemove(const TArrayView<int32> RemovedIndic
 		if (Entry.Instance != nullptr)
 		{
 			Entry.Instance->OnUnequipped();
+			UnindexInstance(Entry.Instance);
+			BroadcastChanged(Entry.Instance, false);
+		}
+		else
+		{
+			// Instance was already garbage collected, so it can't be unindexed by pointer
+			RemoveStaleInstances();
 		}
 	}
 }
@@ -42,13 +49,18 @@ void FECREquipmentList::PostReplicatedAdd(const TArrayView<int32> AddedIndices,
 		const FECRAppliedEquipmentEntry& Entry = Entries[Index];
 		if (Entry.Instance != nullptr)
 		{
+			IndexInstance(Entry.Instance);
 			Entry.Instance->OnEquipped();
+			BroadcastChanged(Entry.Instance, true);
 		}
 	}
 }
 
 void FECREquipmentList::PostReplicatedChange(const TArrayView<int32> ChangedIndices, int32 FinalSize)
 {
+	// Instance may be resolved after the entry was added
+	RebuildIndices();
+
 	// 	for (int32 Index : ChangedIndices)
 	// 	{
 	// 		const FGameplayTagStack& Stack = Stacks[Index];
@@ -63,6 +75,116 @@ UECRAbilitySystemComponent* FECREquipmentList::GetAbilitySystemComponent() const
 	return Cast<UECRAbilitySystemComponent>(UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(OwningActor));
 }
 
+void FECREquipmentList::IndexInstance(UECREquipmentInstance* Instance)
+{
+	for (TPair<TObjectKey<UClass>, TArray<TWeakObjectPtr<UECREquipmentInstance>>>& ClassInstances : InstancesByClass)
+	{
+		const UClass* InstanceClass = ClassInstances.Key.ResolveObjectPtr();
+		if (InstanceClass && Instance->IsA(InstanceClass))
+		{
+			ClassInstances.Value.AddUnique(Instance);
+		}
+	}
+
+	for (const FName VisibilityChannel : Instance->GetVisibilityChannels())
+	{
+		InstancesByChannel.FindOrAdd(VisibilityChannel).AddUnique(Instance);
+	}
+
+	if (UECREquipmentInstance_EquipmentMod* ItemMod = Cast<UECREquipmentInstance_EquipmentMod>(Instance))
+	{
+		// Parents are indexed too, as tag queries match parents of modifier tags
+		for (const FGameplayTag& Tag : ItemMod->ModifierTags.GetGameplayTagParents())
+		{
+			ModifiersByTag.FindOrAdd(Tag).AddUnique(ItemMod);
+		}
+	}
+}
+
+void FECREquipmentList::UnindexInstance(UECREquipmentInstance* Instance)
+{
+	for (TPair<TObjectKey<UClass>, TArray<TWeakObjectPtr<UECREquipmentInstance>>>& ClassInstances : InstancesByClass)
+	{
+		ClassInstances.Value.Remove(Instance);
+	}
+
+	for (TPair<FName, TArray<TWeakObjectPtr<UECREquipmentInstance>>>& ChannelInstances : InstancesByChannel)
+	{
+		ChannelInstances.Value.Remove(Instance);
+	}
+
+	if (UECREquipmentInstance_EquipmentMod* ItemMod = Cast<UECREquipmentInstance_EquipmentMod>(Instance))
+	{
+		for (TPair<FGameplayTag, TArray<TWeakObjectPtr<UECREquipmentInstance_EquipmentMod>>>& TagModifiers :
+		     ModifiersByTag)
+		{
+			TagModifiers.Value.Remove(ItemMod);
+		}
+	}
+}
+
+void FECREquipmentList::RemoveStaleInstances()
+{
+	auto IsStale = [](const auto& Instance) { return !Instance.IsValid(); };
+
+	for (TPair<TObjectKey<UClass>, TArray<TWeakObjectPtr<UECREquipmentInstance>>>& ClassInstances : InstancesByClass)
+	{
+		ClassInstances.Value.RemoveAll(IsStale);
+	}
+
+	for (TPair<FName, TArray<TWeakObjectPtr<UECREquipmentInstance>>>& ChannelInstances : InstancesByChannel)
+	{
+		ChannelInstances.Value.RemoveAll(IsStale);
+	}
+
+	for (TPair<FGameplayTag, TArray<TWeakObjectPtr<UECREquipmentInstance_EquipmentMod>>>& TagModifiers : ModifiersByTag)
+	{
+		TagModifiers.Value.RemoveAll(IsStale);
+	}
+}
+
+void FECREquipmentList::RebuildIndices()
+{
+	InstancesByClass.Reset();
+	InstancesByChannel.Reset();
+	ModifiersByTag.Reset();
+
+	for (const FECRAppliedEquipmentEntry& Entry : Entries)
+	{
+		if (Entry.Instance != nullptr)
+		{
+			IndexInstance(Entry.Instance);
+		}
+	}
+}
+
+const TArray<TWeakObjectPtr<UECREquipmentInstance>>& FECREquipmentList::GetInstancesOfClass(
+	const UClass* InstanceClass) const
+{
+	if (const TArray<TWeakObjectPtr<UECREquipmentInstance>>* ClassInstances = InstancesByClass.Find(InstanceClass))
+	{
+		return *ClassInstances;
+	}
+
+	TArray<TWeakObjectPtr<UECREquipmentInstance>>& ClassInstances = InstancesByClass.Add(InstanceClass);
+	for (const FECRAppliedEquipmentEntry& Entry : Entries)
+	{
+		if (Entry.Instance != nullptr && Entry.Instance->IsA(InstanceClass))
+		{
+			ClassInstances.Add(Entry.Instance);
+		}
+	}
+	return ClassInstances;
+}
+
+void FECREquipmentList::BroadcastChanged(UECREquipmentInstance* Instance, const bool bEquipped) const
+{
+	if (UECREquipmentManagerComponent* EquipmentManager = Cast<UECREquipmentManagerComponent>(OwnerComponent))
+	{
+		EquipmentManager->OnEquipmentChanged.Broadcast(Instance, bEquipped);
+	}
+}
+
 UECREquipmentInstance* FECREquipmentList::AddEntry(TSubclassOf<UECREquipmentDefinition> EquipmentDefinition)
 {
 	UECREquipmentInstance* Result = nullptr;
@@ -99,6 +221,7 @@ UECREquipmentInstance* FECREquipmentList::AddEntry(TSubclassOf<UECREquipmentDefi
 
 	Result->SpawnEquipmentActors(EquipmentCDO->ActorsToSpawn);
 
+	IndexInstance(Result);
 	MarkItemDirty(NewEntry);
 
 	return Result;
@@ -117,7 +240,7 @@ void FECREquipmentList::RemoveEntry(UECREquipmentInstance* Instance)
 			}
 
 			Instance->DestroyEquipmentActors();
-
+			UnindexInstance(Instance);
 
 			EntryIt.RemoveCurrent();
 			MarkArrayDirty();
@@ -160,6 +283,7 @@ UECREquipmentInstance* UECREquipmentManagerComponent::EquipItem(TSubclassOf<UECR
 			{
 				Result->SetVisibility(false);
 			}
+			EquipmentList.BroadcastChanged(Result, true);
 		}
 	}
 	return Result;
@@ -173,19 +297,19 @@ void UECREquipmentManagerComponent::SetItemVisible(UECREquipmentInstance* ItemIn
 		return;
 	}
 
-	TArray<FName> VisibilityChannels = ItemInstance->GetVisibilityChannels();
-	for (FName VisibilityChannel : VisibilityChannels)
+	for (const FName VisibilityChannel : ItemInstance->GetVisibilityChannels())
 	{
-		for (const FECRAppliedEquipmentEntry& Entry : EquipmentList.Entries)
+		if (const TArray<TWeakObjectPtr<UECREquipmentInstance>>* ChannelInstances = EquipmentList.InstancesByChannel.Find(
+			VisibilityChannel))
 		{
-			if (Entry.Instance)
+			for (const TWeakObjectPtr<UECREquipmentInstance>& Instance : *ChannelInstances)
 			{
-				if (Entry.Instance->GetVisibilityChannels().Contains(VisibilityChannel))
+				if (Instance.IsValid())
 				{
-					Entry.Instance->SetVisibility(false);
+					Instance->SetVisibility(false);
 				}
 			}
-		};
+		}
 	}
 	ItemInstance->SetVisibility(true);
 }
@@ -211,6 +335,7 @@ void UECREquipmentManagerComponent::UnequipItem(UECREquipmentInstance* ItemInsta
 	{
 		ItemInstance->OnUnequipped();
 		EquipmentList.RemoveEntry(ItemInstance);
+		EquipmentList.BroadcastChanged(ItemInstance, false);
 	}
 }
 
@@ -263,32 +388,30 @@ UECREquipmentInstance* UECREquipmentManagerComponent::GetFirstInstanceOfType(
 		return nullptr;
 	}
 
-	for (FECRAppliedEquipmentEntry& Entry : EquipmentList.Entries)
+	for (const TWeakObjectPtr<UECREquipmentInstance>& Instance : EquipmentList.GetInstancesOfClass(InstanceType))
 	{
-		if (UECREquipmentInstance* Instance = Entry.Instance)
+		if (Instance.IsValid())
 		{
-			if (Instance->IsA(InstanceType))
-			{
-				return Instance;
-			}
+			return Instance.Get();
 		}
 	}
-
 	return nullptr;
 }
 
 TArray<UECREquipmentInstance*> UECREquipmentManagerComponent::GetEquipmentInstancesOfType(
 	TSubclassOf<UECREquipmentInstance> InstanceType) const
 {
+	if (!IsValid(InstanceType))
+	{
+		return {};
+	}
+
 	TArray<UECREquipmentInstance*> Results;
-	for (const FECRAppliedEquipmentEntry& Entry : EquipmentList.Entries)
+	for (const TWeakObjectPtr<UECREquipmentInstance>& Instance : EquipmentList.GetInstancesOfClass(InstanceType))
 	{
-		if (UECREquipmentInstance* Instance = Entry.Instance)
+		if (Instance.IsValid())
 		{
-			if (Instance->IsA(InstanceType))
-			{
-				Results.Add(Instance);
-			}
+			Results.Add(Instance.Get());
 		}
 	}
 	return Results;
@@ -300,13 +423,17 @@ TArray<UECREquipmentInstance_EquipmentMod*> UECREquipmentManagerComponent::GetEq
 	ModifierTags.AddTag(FECRGameplayTags::Get().Mod_AnyWeaponMod);
 
 	TArray<UECREquipmentInstance_EquipmentMod*> Results;
-	for (const FECRAppliedEquipmentEntry& Entry : EquipmentList.Entries)
+	for (const FGameplayTag& Tag : ModifierTags)
 	{
-		if (UECREquipmentInstance_EquipmentMod* ItemMod = Cast<UECREquipmentInstance_EquipmentMod>(Entry.Instance))
+		if (const TArray<TWeakObjectPtr<UECREquipmentInstance_EquipmentMod>>* TagModifiers = EquipmentList.ModifiersByTag.
+			Find(Tag))
 		{
-			if (ItemMod->ModifierTags.HasAny(ModifierTags))
+			for (const TWeakObjectPtr<UECREquipmentInstance_EquipmentMod>& ItemMod : *TagModifiers)
 			{
-				Results.Add(ItemMod);
+				if (ItemMod.IsValid())
+				{
+					Results.AddUnique(ItemMod.Get());
+				}
 			}
 		}
 	}
@@ -315,16 +442,14 @@ TArray<UECREquipmentInstance_EquipmentMod*> UECREquipmentManagerComponent::GetEq
 
 UECREquipmentInstance* UECREquipmentManagerComponent::GetFirstInstanceVisibleInChannel(const FName VisibilityChannel)
 {
-	for (const FECRAppliedEquipmentEntry& Entry : EquipmentList.Entries)
+	if (const TArray<TWeakObjectPtr<UECREquipmentInstance>>* ChannelInstances = EquipmentList.InstancesByChannel.Find(
+		VisibilityChannel))
 	{
-		if (UECREquipmentInstance* Instance = Entry.Instance)
+		for (const TWeakObjectPtr<UECREquipmentInstance>& Instance : *ChannelInstances)
 		{
-			if (Instance->GetVisibilityChannels().Contains(VisibilityChannel))
+			if (Instance.IsValid() && Instance->GetIsVisible())
 			{
-				if (Instance->GetIsVisible())
-				{
-					return Instance;
-				}
+				return Instance.Get();
 			}
 		}
 	}
@@ -2,58 +2,132 @@
 
 #include "Gameplay/GAS/ECRAbilityTagRelationshipMapping.h"
 
-void UECRAbilityTagRelationshipMapping::GetAbilityTagsToBlockAndCancel(const FGameplayTagContainer& AbilityTags, FGameplayTagContainer* OutTagsToBlock, FGameplayTagContainer* OutTagsToCancel) const
+namespace ECRAbilityTagRelationshipMapping
+{
+	/** Containers of tags of abilities in use are few, cache is cleared once it grows above this */
+	static constexpr int32 MaxResolvedRelationships = 128;
+}
+
+void UECRAbilityTagRelationshipMapping::PostLoad()
+{
+	Super::PostLoad();
+
+	CompileRelationships();
+}
+
+#if WITH_EDITOR
+void UECRAbilityTagRelationshipMapping::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	InvalidateCompiledRelationships();
+}
+#endif
+
+void UECRAbilityTagRelationshipMapping::CompileRelationships()
+{
+	CompiledRelationships.Reset();
+	ResolvedRelationshipsCache.Reset();
+
+	for (const FECRAbilityTagRelationship& Tags : AbilityTagRelationships)
+	{
+		FECRAbilityTagRelationship& CompiledTags = CompiledRelationships.FindOrAdd(Tags.AbilityTag);
+		CompiledTags.AbilityTag = Tags.AbilityTag;
+		CompiledTags.AbilityTagsToBlock.AppendTags(Tags.AbilityTagsToBlock);
+		CompiledTags.AbilityTagsToCancel.AppendTags(Tags.AbilityTagsToCancel);
+		CompiledTags.ActivationRequiredTags.AppendTags(Tags.ActivationRequiredTags);
+		CompiledTags.ActivationBlockedTags.AppendTags(Tags.ActivationBlockedTags);
+	}
+
+	bCompiled = true;
+}
+
+void UECRAbilityTagRelationshipMapping::InvalidateCompiledRelationships()
 {
-	// Simple iteration for now
-	for (int32 i = 0; i < AbilityTagRelationships.Num(); i++)
+	bCompiled = false;
+	CompiledRelationships.Reset();
+	ResolvedRelationshipsCache.Reset();
+}
+
+const UECRAbilityTagRelationshipMapping::FResolvedRelationships& UECRAbilityTagRelationshipMapping::ResolveRelationships(const FGameplayTagContainer& AbilityTags) const
+{
+	if (!bCompiled)
+	{
+		// Asset created or edited since load
+		const_cast<UECRAbilityTagRelationshipMapping*>(this)->CompileRelationships();
+	}
+
+	// Order independent, as equal containers may list tags in different order
+	uint32 Hash = 0;
+	for (const FGameplayTag& Tag : AbilityTags)
+	{
+		Hash += GetTypeHash(Tag);
+	}
+
+	if (const FResolvedRelationships* CachedRelationships = ResolvedRelationshipsCache.Find(Hash))
 	{
-		const FECRAbilityTagRelationship& Tags = AbilityTagRelationships[i];
-		if (AbilityTags.HasTag(Tags.AbilityTag))
+		if (CachedRelationships->AbilityTags == AbilityTags)
 		{
-			if (OutTagsToBlock)
-			{
-				OutTagsToBlock->AppendTags(Tags.AbilityTagsToBlock);
-			}
-			if (OutTagsToCancel)
-			{
-				OutTagsToCancel->AppendTags(Tags.AbilityTagsToCancel);
-			}
+			return *CachedRelationships;
 		}
 	}
+
+	if (ResolvedRelationshipsCache.Num() >= ECRAbilityTagRelationshipMapping::MaxResolvedRelationships)
+	{
+		ResolvedRelationshipsCache.Reset();
+	}
+
+	// Relationship applies if its tag or a child of it is in the container, so look up the container tags with their parents
+	FResolvedRelationships Resolved;
+	Resolved.AbilityTags = AbilityTags;
+	for (const FGameplayTag& Tag : AbilityTags.GetGameplayTagParents())
+	{
+		if (const FECRAbilityTagRelationship* Tags = CompiledRelationships.Find(Tag))
+		{
+			Resolved.AbilityTagsToBlock.AppendTags(Tags->AbilityTagsToBlock);
+			Resolved.AbilityTagsToCancel.AppendTags(Tags->AbilityTagsToCancel);
+			Resolved.ActivationRequiredTags.AppendTags(Tags->ActivationRequiredTags);
+			Resolved.ActivationBlockedTags.AppendTags(Tags->ActivationBlockedTags);
+		}
+	}
+
+	return ResolvedRelationshipsCache.Add(Hash, MoveTemp(Resolved));
+}
+
+void UECRAbilityTagRelationshipMapping::GetAbilityTagsToBlockAndCancel(const FGameplayTagContainer& AbilityTags, FGameplayTagContainer* OutTagsToBlock, FGameplayTagContainer* OutTagsToCancel) const
+{
+	const FResolvedRelationships& Tags = ResolveRelationships(AbilityTags);
+	if (OutTagsToBlock)
+	{
+		OutTagsToBlock->AppendTags(Tags.AbilityTagsToBlock);
+	}
+	if (OutTagsToCancel)
+	{
+		OutTagsToCancel->AppendTags(Tags.AbilityTagsToCancel);
+	}
 }
 
 void UECRAbilityTagRelationshipMapping::GetRequiredAndBlockedActivationTags(const FGameplayTagContainer& AbilityTags, FGameplayTagContainer* OutActivationRequired, FGameplayTagContainer* OutActivationBlocked) const
 {
-	// Simple iteration for now
-	for (int32 i = 0; i < AbilityTagRelationships.Num(); i++)
+	const FResolvedRelationships& Tags = ResolveRelationships(AbilityTags);
+	if (OutActivationRequired)
 	{
-		const FECRAbilityTagRelationship& Tags = AbilityTagRelationships[i];
-		if (AbilityTags.HasTag(Tags.AbilityTag))
-		{
-			if (OutActivationRequired)
-			{
-				OutActivationRequired->AppendTags(Tags.ActivationRequiredTags);
-			}
-			if (OutActivationBlocked)
-			{
-				OutActivationBlocked->AppendTags(Tags.ActivationBlockedTags);
-			}
-		}
+		OutActivationRequired->AppendTags(Tags.ActivationRequiredTags);
+	}
+	if (OutActivationBlocked)
+	{
+		OutActivationBlocked->AppendTags(Tags.ActivationBlockedTags);
 	}
 }
 
 bool UECRAbilityTagRelationshipMapping::IsAbilityCancelledByTag(const FGameplayTagContainer& AbilityTags, const FGameplayTag& ActionTag) const
 {
-	// Simple iteration for now
-	for (int32 i = 0; i < AbilityTagRelationships.Num(); i++)
+	if (!bCompiled)
 	{
-		const FECRAbilityTagRelationship& Tags = AbilityTagRelationships[i];
-
-		if (Tags.AbilityTag == ActionTag && Tags.AbilityTagsToCancel.HasAny(AbilityTags))
-		{
-			return true;
-		}
+		const_cast<UECRAbilityTagRelationshipMapping*>(this)->CompileRelationships();
 	}
 
-	return false;
+	// Cancel tags of all relationships with the action tag are merged, so matching any of them matches the merged ones
+	const FECRAbilityTagRelationship* Tags = CompiledRelationships.Find(ActionTag);
+	return Tags && Tags->AbilityTagsToCancel.HasAny(AbilityTags);
 }
@@ -22,6 +22,8 @@ void AECRPlayerState::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutL
 	// SharedParams.bIsPushBased = true;
 
 	DOREPLIFETIME(ThisClass, StatTags);
+	DOREPLIFETIME(ThisClass, Faction);
+	DOREPLIFETIME(ThisClass, SquadId);
 }
 
 void AECRPlayerState::PreInitializeComponents()
@@ -66,6 +68,12 @@ int32 AECRPlayerState::GetStatTagStackCount(FGameplayTag Tag) const
 	return StatTags.GetStackCount(Tag);
 }
 
+void AECRPlayerState::SetFactionAndSquad(FName NewFaction, int32 NewSquadId)
+{
+	Faction = NewFaction;
+	SquadId = NewSquadId;
+}
+
 void AECRPlayerState::PostInitializeComponents()
 {
 	Super::PostInitializeComponents();
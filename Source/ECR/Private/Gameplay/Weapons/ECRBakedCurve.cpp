@@ -0,0 +1,81 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Gameplay/Weapons/ECRBakedCurve.h"
+
+#include "Curves/RichCurve.h"
+
+namespace ECRConsoleVariables
+{
+	static float CurveBakeTolerance = 0.005f;
+	static FAutoConsoleVariableRef CVarCurveBakeTolerance(
+		TEXT("ECR.Weapon.CurveBakeTolerance"),
+		CurveBakeTolerance,
+		TEXT("Max error of baked weapon curves, as fraction of curve value range. Applies to curves baked after change"),
+		ECVF_Default);
+}
+
+void FECRBakedCurve::Bake(const FRichCurve* Curve)
+{
+	static constexpr int32 MinNumSamples = 32;
+	static constexpr int32 MaxNumSamples = 1024;
+
+	SourceCurve = Curve;
+	Values.Reset();
+	MinTime = MaxTime = InvStep = MinValue = MaxValue = 0.0f;
+
+	if (!Curve)
+	{
+		Values.Add(0.0f);
+		return;
+	}
+
+	Curve->GetTimeRange(MinTime, MaxTime);
+	Curve->GetValueRange(MinValue, MaxValue);
+
+	if (Curve->GetNumKeys() <= 1)
+	{
+		Values.Add(Curve->Eval(MinTime));
+		return;
+	}
+
+	// Table is clamped at its ends, which doesn't match other extrapolation
+	const bool bConstantExtrapolation = Curve->PreInfinityExtrap == RCCE_Constant
+		&& Curve->PostInfinityExtrap == RCCE_Constant;
+	if (!bConstantExtrapolation || MaxTime <= MinTime)
+	{
+		return;
+	}
+
+	const float Tolerance = ECRConsoleVariables::CurveBakeTolerance * FMath::Max(MaxValue - MinValue, KINDA_SMALL_NUMBER);
+	for (int32 NumSamples = MinNumSamples; NumSamples <= MaxNumSamples; NumSamples *= 2)
+	{
+		const float Step = (MaxTime - MinTime) / (NumSamples - 1);
+
+		Values.SetNumUninitialized(NumSamples);
+		for (int32 SampleIdx = 0; SampleIdx < NumSamples; ++SampleIdx)
+		{
+			Values[SampleIdx] = Curve->Eval(MinTime + SampleIdx * Step);
+		}
+
+		// Interpolation error is largest between samples
+		bool bWithinTolerance = true;
+		for (int32 SampleIdx = 0; SampleIdx < NumSamples - 1 && bWithinTolerance; ++SampleIdx)
+		{
+			const float MidValue = Curve->Eval(MinTime + (SampleIdx + 0.5f) * Step);
+			bWithinTolerance = FMath::Abs(MidValue - 0.5f * (Values[SampleIdx] + Values[SampleIdx + 1])) <= Tolerance;
+		}
+
+		if (bWithinTolerance)
+		{
+			InvStep = 1.0f / Step;
+			return;
+		}
+	}
+
+	Values.Reset();
+}
+
+float FECRBakedCurve::EvalSourceCurve(const float Time) const
+{
+	return SourceCurve ? SourceCurve->Eval(Time) : 0.0f;
+}
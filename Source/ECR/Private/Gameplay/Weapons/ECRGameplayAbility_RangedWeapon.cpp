@@ -9,6 +9,7 @@
 #include "NativeGameplayTags.h"
 #include "GameFramework/GameplayMessageSubsystem.h"
 #include "Gameplay/Weapons/ECRWeaponStateComponent.h"
+#include "Gameplay/Weapons/ECRLagCompensationSubsystem.h"
 #include "AbilitySystemComponent.h"
 #include "GameFramework/PlayerController.h"
 #include "Gameplay/GAS/ECRGameplayEffectContext.h"
@@ -39,6 +40,21 @@ namespace ECRConsoleVariables
 		TEXT(
 			"When bullet hit debug drawing is enabled (see DrawBulletHitDuration), how big should the hit radius be? (in uu)"),
 		ECVF_Default);
+
+	static int32 LagCompensatedHitValidation = 1;
+	static FAutoConsoleVariableRef CVarLagCompensatedHitValidation(
+		TEXT("ECR.Weapon.LagCompensatedHitValidation"),
+		LagCompensatedHitValidation,
+		TEXT("Should server reject hits of remote clients which don't match target's hit volume at the time shooter saw it"),
+		ECVF_Default);
+
+	static int32 AsyncBulletTraces = 1;
+	static FAutoConsoleVariableRef CVarAsyncBulletTraces(
+		TEXT("ECR.Weapon.AsyncBulletTraces"),
+		AsyncBulletTraces,
+		TEXT(
+			"Trace bullets of multi bullet cartridges with async scene queries, processed next frame (0 = never, 1 = for bots, 2 = for everyone on authority). Predicting clients always trace in the activation frame"),
+		ECVF_Default);
 }
 
 // Weapon fire will be blocked/canceled if the player has this tag
@@ -141,37 +157,17 @@ ECollisionChannel UECRGameplayAbility_RangedWeapon::DetermineTraceChannel(
 	return ECR_TraceChannel_Weapon;
 }
 
-FHitResult UECRGameplayAbility_RangedWeapon::WeaponTrace(const FVector& StartTrace, const FVector& EndTrace,
-                                                         float SweepRadius, bool bIsSimulated,
-                                                         OUT TArray<FHitResult>& OutHitResults) const
+FHitResult UECRGameplayAbility_RangedWeapon::FilterWeaponTraceHits(const TArray<FHitResult>& HitResults,
+                                                                   const FVector& StartTrace, const FVector& EndTrace,
+                                                                   OUT TArray<FHitResult>& OutHitResults)
 {
-	TArray<FHitResult> HitResults;
-
-	FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(WeaponTrace), /*bTraceComplex=*/ true, /*IgnoreActor=*/
-	                                  GetAvatarActorFromActorInfo());
-	TraceParams.bReturnPhysicalMaterial = true;
-	AddAdditionalTraceIgnoreActors(TraceParams);
-	//TraceParams.bDebugQuery = true;
-
-	const ECollisionChannel TraceChannel = DetermineTraceChannel(TraceParams, bIsSimulated);
-
-	if (SweepRadius > 0.0f)
-	{
-		GetWorld()->SweepMultiByChannel(HitResults, StartTrace, EndTrace, FQuat::Identity, TraceChannel,
-		                                FCollisionShape::MakeSphere(SweepRadius), TraceParams);
-	}
-	else
-	{
-		GetWorld()->LineTraceMultiByChannel(HitResults, StartTrace, EndTrace, TraceChannel, TraceParams);
-	}
-
 	FHitResult Hit(ForceInit);
 	if (HitResults.Num() > 0)
 	{
 		// Filter the output list to prevent multiple hits on the same actor;
 		// this is to prevent a single bullet dealing damage multiple times to
 		// a single actor if using an overlap trace
-		for (FHitResult& CurHitResult : HitResults)
+		for (const FHitResult& CurHitResult : HitResults)
 		{
 			auto Pred = [&CurHitResult](const FHitResult& Other)
 			{
@@ -195,6 +191,70 @@ FHitResult UECRGameplayAbility_RangedWeapon::WeaponTrace(const FVector& StartTra
 	return Hit;
 }
 
+void UECRGameplayAbility_RangedWeapon::MergeSweepHits(const TArray<FHitResult>& SweepHits,
+                                                      OUT TArray<FHitResult>& OutHits)
+{
+	// If the trace with sweep radius enabled hit a pawn, check if we should use its hit results
+	const int32 FirstPawnIdx = FindFirstPawnHitResult(SweepHits);
+	if (SweepHits.IsValidIndex(FirstPawnIdx))
+	{
+		// If we had a blocking hit in our line trace that occurs in SweepHits before our
+		// hit pawn, we should just use our initial hit results since the Pawn hit should be blocked
+		bool bUseSweepHits = true;
+		for (int32 Idx = 0; Idx < FirstPawnIdx; ++Idx)
+		{
+			const FHitResult& CurHitResult = SweepHits[Idx];
+
+			auto Pred = [&CurHitResult](const FHitResult& Other)
+			{
+				return Other.HitObjectHandle == CurHitResult.HitObjectHandle;
+			};
+			if (CurHitResult.bBlockingHit && OutHits.ContainsByPredicate(Pred))
+			{
+				bUseSweepHits = false;
+				break;
+			}
+		}
+
+		if (bUseSweepHits)
+		{
+			OutHits = SweepHits;
+		}
+	}
+}
+
+FCollisionQueryParams UECRGameplayAbility_RangedWeapon::GetWeaponTraceParams() const
+{
+	FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(WeaponTrace), /*bTraceComplex=*/ true, /*IgnoreActor=*/
+	                                  GetAvatarActorFromActorInfo());
+	TraceParams.bReturnPhysicalMaterial = true;
+	AddAdditionalTraceIgnoreActors(TraceParams);
+	//TraceParams.bDebugQuery = true;
+	return TraceParams;
+}
+
+FHitResult UECRGameplayAbility_RangedWeapon::WeaponTrace(const FVector& StartTrace, const FVector& EndTrace,
+                                                         float SweepRadius, bool bIsSimulated,
+                                                         OUT TArray<FHitResult>& OutHitResults) const
+{
+	TArray<FHitResult> HitResults;
+
+	FCollisionQueryParams TraceParams = GetWeaponTraceParams();
+	const ECollisionChannel TraceChannel = DetermineTraceChannel(TraceParams, bIsSimulated);
+
+	if (SweepRadius > 0.0f)
+	{
+		GetWorld()->SweepMultiByChannel(HitResults, StartTrace, EndTrace, FQuat::Identity, TraceChannel,
+		                                FCollisionShape::MakeSphere(SweepRadius), TraceParams);
+	}
+	else
+	{
+		GetWorld()->LineTraceMultiByChannel(HitResults, StartTrace, EndTrace, TraceChannel, TraceParams);
+	}
+
+	return FilterWeaponTraceHits(HitResults, StartTrace, EndTrace, OutHitResults);
+}
+
 FVector UECRGameplayAbility_RangedWeapon::GetWeaponTargetingSourceLocation() const
 {
 	if (const UECRRangedWeaponInstance* Weapon = GetWeaponInstance())
@@ -350,34 +410,7 @@ FHitResult UECRGameplayAbility_RangedWeapon::DoSingleBulletTrace(const FVector&
 		{
 			TArray<FHitResult> SweepHits;
 			Impact = WeaponTrace(StartTrace, EndTrace, SweepRadius, bIsSimulated, /*out*/ SweepHits);
-
-			// If the trace with sweep radius enabled hit a pawn, check if we should use its hit results
-			const int32 FirstPawnIdx = FindFirstPawnHitResult(SweepHits);
-			if (SweepHits.IsValidIndex(FirstPawnIdx))
-			{
-				// If we had a blocking hit in our line trace that occurs in SweepHits before our
-				// hit pawn, we should just use our initial hit results since the Pawn hit should be blocked
-				bool bUseSweepHits = true;
-				for (int32 Idx = 0; Idx < FirstPawnIdx; ++Idx)
-				{
-					const FHitResult& CurHitResult = SweepHits[Idx];
-
-					auto Pred = [&CurHitResult](const FHitResult& Other)
-					{
-						return Other.HitObjectHandle == CurHitResult.HitObjectHandle;
-					};
-					if (CurHitResult.bBlockingHit && OutHits.ContainsByPredicate(Pred))
-					{
-						bUseSweepHits = false;
-						break;
-					}
-				}
-
-				if (bUseSweepHits)
-				{
-					OutHits = SweepHits;
-				}
-			}
+			MergeSweepHits(SweepHits, /*out*/ OutHits);
 		}
 	}
 
@@ -404,7 +437,7 @@ FVector UECRGameplayAbility_RangedWeapon::GetSingleCameraTraceHitLocation(APawn*
 	return CameraTracingEnd;
 }
 
-void UECRGameplayAbility_RangedWeapon::PerformLocalTargeting(OUT TArray<FHitResult>& OutHits)
+bool UECRGameplayAbility_RangedWeapon::PerformLocalTargeting(OUT TArray<FHitResult>& OutHits)
 {
 	APawn* const AvatarPawn = Cast<APawn>(GetAvatarActorFromActorInfo());
 
@@ -444,8 +477,16 @@ void UECRGameplayAbility_RangedWeapon::PerformLocalTargeting(OUT TArray<FHitResu
 		}
 #endif
 
+		if (ShouldUseAsyncBulletTraces(AvatarPawn, WeaponData))
+		{
+			TraceBulletsInCartridgeAsync(InputData);
+			return false;
+		}
+
 		TraceBulletsInCartridge(InputData, /*out*/ OutHits);
 	}
+
+	return true;
 }
 
 void UECRGameplayAbility_RangedWeapon::TraceBulletsInCartridge(const FRangedWeaponFiringInput& InputData,
@@ -469,45 +510,223 @@ void UECRGameplayAbility_RangedWeapon::TraceBulletsInCartridge(const FRangedWeap
 			WeaponData->GetSpreadExponent());
 
 		const FVector EndTrace = InputData.StartTrace + (BulletDir * WeaponData->GetMaxDamageRange());
-		FVector HitLocation = EndTrace;
 
 		TArray<FHitResult> AllImpacts;
 
 		FHitResult Impact = DoSingleBulletTrace(InputData.StartTrace, EndTrace, WeaponData->GetBulletTraceSweepRadius(),
 		                                        /*bIsSimulated=*/ false, /*out*/ AllImpacts);
 
-		const AActor* HitActor = Impact.GetActor();
+		AddBulletTraceResult(Impact, AllImpacts, EndTrace, /*out*/ OutHits);
+	}
+}
 
-		if (HitActor)
-		{
+void UECRGameplayAbility_RangedWeapon::AddBulletTraceResult(FHitResult& Impact, const TArray<FHitResult>& AllImpacts,
+                                                            const FVector& EndTrace,
+                                                            OUT TArray<FHitResult>& OutHits) const
+{
+	const AActor* HitActor = Impact.GetActor();
+
+	if (HitActor)
+	{
 #if ENABLE_DRAW_DEBUG
-			if (ECRConsoleVariables::DrawBulletHitDuration > 0.0f)
-			{
-				DrawDebugPoint(GetWorld(), Impact.ImpactPoint, ECRConsoleVariables::DrawBulletHitRadius, FColor::Red,
-				               false, ECRConsoleVariables::DrawBulletHitRadius);
-			}
+		if (ECRConsoleVariables::DrawBulletHitDuration > 0.0f)
+		{
+			DrawDebugPoint(GetWorld(), Impact.ImpactPoint, ECRConsoleVariables::DrawBulletHitRadius, FColor::Red,
+			               false, ECRConsoleVariables::DrawBulletHitRadius);
+		}
 #endif
 
-			if (AllImpacts.Num() > 0)
-			{
-				OutHits.Append(AllImpacts);
-			}
+		if (AllImpacts.Num() > 0)
+		{
+			OutHits.Append(AllImpacts);
+		}
+	}
+
+	// Make sure there's always an entry in OutHits so the direction can be used for tracers, etc...
+	if (OutHits.Num() == 0)
+	{
+		if (!Impact.bBlockingHit)
+		{
+			// Locate the fake 'impact' at the end of the trace
+			Impact.Location = EndTrace;
+			Impact.ImpactPoint = EndTrace;
+		}
+
+		OutHits.Add(Impact);
+	}
+}
+
+bool UECRGameplayAbility_RangedWeapon::ShouldUseAsyncBulletTraces(const APawn* AvatarPawn,
+                                                                  const UECRRangedWeaponInstance* WeaponData) const
+{
+	// Single bullets are cheap enough and latency of a frame isn't worth it
+	if (WeaponData->GetBulletsPerCartridge() <= 1)
+	{
+		return false;
+	}
+
+	// Activation prediction key is only valid in the activation frame, so predicting clients can't defer target data
+	if (!CurrentActorInfo->IsNetAuthority())
+	{
+		return false;
+	}
 
-			HitLocation = Impact.ImpactPoint;
+	switch (ECRConsoleVariables::AsyncBulletTraces)
+	{
+	case 1:
+		return AvatarPawn->IsBotControlled();
+	case 2:
+		return true;
+	default:
+		return false;
+	}
+}
+
+void UECRGameplayAbility_RangedWeapon::TraceBulletsInCartridgeAsync(const FRangedWeaponFiringInput& InputData)
+{
+	UECRRangedWeaponInstance* WeaponData = InputData.WeaponData;
+	check(WeaponData);
+
+	UWorld* World = GetWorld();
+	check(World);
+
+	const int32 BulletsPerCartridge = FMath::Min(WeaponData->GetBulletsPerCartridge(), (int32)MAX_uint8);
+
+	AsyncBulletTraceBatchId++;
+	FPendingBulletBatch& Batch = PendingBulletBatches.Add(AsyncBulletTraceBatchId);
+	Batch.Traces.Reserve(BulletsPerCartridge);
+	Batch.SweepRadius = WeaponData->GetBulletTraceSweepRadius();
+
+	const float BaseSpreadAngle = WeaponData->GetCalculatedSpreadAngle();
+	const float SpreadAngleMultiplier = WeaponData->GetCalculatedSpreadAngleMultiplier();
+	const float ActualSpreadAngle = BaseSpreadAngle * SpreadAngleMultiplier;
+	const float HalfSpreadAngleInRadians = FMath::DegreesToRadians(ActualSpreadAngle * 0.5f);
+
+	FCollisionQueryParams TraceParams = GetWeaponTraceParams();
+	const ECollisionChannel TraceChannel = DetermineTraceChannel(TraceParams, /*bIsSimulated=*/ false);
+	const FTraceDelegate TraceDelegate = FTraceDelegate::CreateUObject(this, &ThisClass::OnAsyncBulletTraceDone);
+
+	// All queries of the frame are run in parallel by the engine, results arrive next frame
+	for (int32 BulletIndex = 0; BulletIndex < BulletsPerCartridge; ++BulletIndex)
+	{
+		const FVector BulletDir = UECRGameplayBlueprintLibrary::VRandConeNormalDistribution(
+			InputData.AimDir, HalfSpreadAngleInRadians,
+			WeaponData->GetSpreadExponent());
+
+		FPendingBulletTrace& PendingTrace = Batch.Traces.AddDefaulted_GetRef();
+		PendingTrace.StartTrace = InputData.StartTrace;
+		PendingTrace.EndTrace = InputData.StartTrace + (BulletDir * WeaponData->GetMaxDamageRange());
+
+#if ENABLE_DRAW_DEBUG
+		if (ECRConsoleVariables::DrawBulletTracesDuration > 0.0f)
+		{
+			static float DebugThickness = 1.0f;
+			DrawDebugLine(World, PendingTrace.StartTrace, PendingTrace.EndTrace, FColor::Red, false,
+			              ECRConsoleVariables::DrawBulletTracesDuration, 0, DebugThickness);
 		}
+#endif // ENABLE_DRAW_DEBUG
+
+		// User data: batch id, bullet index, whether it's a sweep
+		const uint32 UserData = ((uint32)AsyncBulletTraceBatchId << 16) | ((uint32)BulletIndex << 1);
 
-		// Make sure there's always an entry in OutHits so the direction can be used for tracers, etc...
-		if (OutHits.Num() == 0)
+		World->AsyncLineTraceByChannel(EAsyncTraceType::Multi, PendingTrace.StartTrace, PendingTrace.EndTrace,
+		                               TraceChannel, TraceParams, FCollisionResponseParams::DefaultResponseParam,
+		                               &TraceDelegate, UserData);
+		Batch.PendingTraceCount++;
+
+		// Sweep is only needed if line trace misses pawns, but it's issued right away to not wait another frame
+		if (Batch.SweepRadius > 0.0f)
 		{
-			if (!Impact.bBlockingHit)
-			{
-				// Locate the fake 'impact' at the end of the trace
-				Impact.Location = EndTrace;
-				Impact.ImpactPoint = EndTrace;
-			}
+			World->AsyncSweepByChannel(EAsyncTraceType::Multi, PendingTrace.StartTrace, PendingTrace.EndTrace,
+			                           FQuat::Identity, TraceChannel,
+			                           FCollisionShape::MakeSphere(Batch.SweepRadius), TraceParams,
+			                           FCollisionResponseParams::DefaultResponseParam, &TraceDelegate, UserData | 1);
+			Batch.PendingTraceCount++;
+		}
+	}
+}
+
+void UECRGameplayAbility_RangedWeapon::OnAsyncBulletTraceDone(const FTraceHandle& TraceHandle,
+                                                              FTraceDatum& TraceDatum)
+{
+	// Batches are dropped on ability end
+	const uint16 BatchId = TraceDatum.UserData >> 16;
+	FPendingBulletBatch* Batch = PendingBulletBatches.Find(BatchId);
+	if (!Batch || Batch->PendingTraceCount <= 0)
+	{
+		return;
+	}
+
+	const int32 BulletIndex = (TraceDatum.UserData & 0xFFFF) >> 1;
+	const bool bIsSweep = (TraceDatum.UserData & 1) != 0;
+	if (!Batch->Traces.IsValidIndex(BulletIndex))
+	{
+		return;
+	}
+
+	FPendingBulletTrace& PendingTrace = Batch->Traces[BulletIndex];
+	(bIsSweep ? PendingTrace.SweepHits : PendingTrace.LineHits) = MoveTemp(TraceDatum.OutHits);
+
+	if (--Batch->PendingTraceCount == 0)
+	{
+		FinishAsyncBulletTraces(BatchId);
+	}
+}
+
+void UECRGameplayAbility_RangedWeapon::FinishAsyncBulletTraces(const uint16 BatchId)
+{
+	FPendingBulletBatch Batch;
+	if (!PendingBulletBatches.RemoveAndCopyValue(BatchId, Batch) || !IsActive())
+	{
+		return;
+	}
+
+	TArray<FHitResult> FoundHits;
+
+	for (const FPendingBulletTrace& PendingTrace : Batch.Traces)
+	{
+		// Same rules as DoSingleBulletTrace, with sweep results already at hand
+		TArray<FHitResult> AllImpacts;
+		FHitResult Impact = FilterWeaponTraceHits(PendingTrace.LineHits, PendingTrace.StartTrace,
+		                                          PendingTrace.EndTrace, /*out*/ AllImpacts);
+
+		if (FindFirstPawnHitResult(AllImpacts) == INDEX_NONE && Batch.SweepRadius > 0.0f)
+		{
+			TArray<FHitResult> SweepHits;
+			Impact = FilterWeaponTraceHits(PendingTrace.SweepHits, PendingTrace.StartTrace, PendingTrace.EndTrace,
+			                               /*out*/ SweepHits);
+			MergeSweepHits(SweepHits, /*out*/ AllImpacts);
+		}
+
+		AddBulletTraceResult(Impact, AllImpacts, PendingTrace.EndTrace, /*out*/ FoundHits);
+	}
+
+	FinishRangedWeaponTargeting(FoundHits, /*bDeferred=*/ true);
+}
+
+void UECRGameplayAbility_RangedWeapon::FlushAsyncBulletTraces()
+{
+	TMap<uint16, FPendingBulletBatch> Batches = MoveTemp(PendingBulletBatches);
+	PendingBulletBatches.Reset();
 
-			OutHits.Add(Impact);
+	// Async results which already arrived are discarded, bullets of the batch are traced again synchronously
+	for (const TPair<uint16, FPendingBulletBatch>& BatchPair : Batches)
+	{
+		TArray<FHitResult> FoundHits;
+		for (const FPendingBulletTrace& PendingTrace : BatchPair.Value.Traces)
+		{
+			TArray<FHitResult> AllImpacts;
+			FHitResult Impact = DoSingleBulletTrace(PendingTrace.StartTrace, PendingTrace.EndTrace,
+			                                        BatchPair.Value.SweepRadius, /*bIsSimulated=*/ false,
+			                                        /*out*/ AllImpacts, /*bSuppressDebugDraw=*/ true);
+			AddBulletTraceResult(Impact, AllImpacts, PendingTrace.EndTrace, /*out*/ FoundHits);
 		}
+
+		if (!IsActive())
+		{
+			return;
+		}
+		FinishRangedWeaponTargeting(FoundHits, /*bDeferred=*/ true);
 	}
 }
 
@@ -546,6 +765,17 @@ void UECRGameplayAbility_RangedWeapon::EndAbility(const FGameplayAbilitySpecHand
 			return;
 		}
 
+		// Cartridges fired with async traces still in flight are finished before ending, the shot was already taken
+		if (PendingBulletBatches.Num() > 0)
+		{
+			FlushAsyncBulletTraces();
+			if (!IsEndAbilityValid(Handle, ActorInfo))
+			{
+				// Target data processing ended the ability already
+				return;
+			}
+		}
+
 		UAbilitySystemComponent* MyAbilityComponent = CurrentActorInfo->AbilitySystemComponent.Get();
 		check(MyAbilityComponent);
 
@@ -598,13 +828,20 @@ void UECRGameplayAbility_RangedWeapon::OnTargetDataReadyCallback(const FGameplay
 					if (UECRWeaponStateComponent* WeaponStateComponent = Controller->FindComponentByClass<
 						UECRWeaponStateComponent>())
 					{
+						// Hits of remote shooters are checked against lag compensated history, rejected ones don't show hit markers
+						TArray<uint8> RejectedHits;
+						if (!CurrentActorInfo->IsLocallyControlled())
+						{
+							FindLagCompensationRejectedHits(LocalTargetDataHandle, /*out*/ RejectedHits);
+						}
+
 						TArray<uint8> HitReplaces;
 						for (uint8 i = 0; (i < LocalTargetDataHandle.Num()) && (i < 255); ++i)
 						{
 							if (FGameplayAbilityTargetData_SingleTargetHit* SingleTargetHit = static_cast<
 								FGameplayAbilityTargetData_SingleTargetHit*>(LocalTargetDataHandle.Get(i)))
 							{
-								if (SingleTargetHit->bHitReplaced)
+								if (SingleTargetHit->bHitReplaced || RejectedHits.Contains(i))
 								{
 									HitReplaces.Add(i);
 								}
@@ -613,6 +850,27 @@ void UECRGameplayAbility_RangedWeapon::OnTargetDataReadyCallback(const FGameplay
 
 						WeaponStateComponent->ClientConfirmTargetData(LocalTargetDataHandle.UniqueId,
 						                                              bIsTargetDataValid, HitReplaces);
+
+						// Shot was still fired, if all its hits are rejected it's kept as a miss along the first one,
+						// so that blueprint gets its direction for cosmetics and applies no effects
+						if (RejectedHits.Num() > 0 && RejectedHits.Num() == LocalTargetDataHandle.Num())
+						{
+							if (const FHitResult* RejectedHit = LocalTargetDataHandle.Get(RejectedHits[0])->GetHitResult())
+							{
+								FECRGameplayAbilityTargetData_SingleTargetHit* MissTargetData = new
+									FECRGameplayAbilityTargetData_SingleTargetHit();
+								MissTargetData->HitResult.TraceStart = RejectedHit->TraceStart;
+								MissTargetData->HitResult.TraceEnd = RejectedHit->TraceEnd;
+								MissTargetData->HitResult.Location = RejectedHit->TraceEnd;
+								MissTargetData->HitResult.ImpactPoint = RejectedHit->TraceEnd;
+								LocalTargetDataHandle.Add(MissTargetData);
+							}
+						}
+
+						for (int32 Idx = RejectedHits.Num() - 1; Idx >= 0; --Idx)
+						{
+							LocalTargetDataHandle.Data.RemoveAt(RejectedHits[Idx]);
+						}
 					}
 				}
 			}
@@ -644,6 +902,49 @@ void UECRGameplayAbility_RangedWeapon::OnTargetDataReadyCallback(const FGameplay
 	                                                      CurrentActivationInfo.GetActivationPredictionKey());
 }
 
+void UECRGameplayAbility_RangedWeapon::FindLagCompensationRejectedHits(
+	const FGameplayAbilityTargetDataHandle& TargetData, OUT TArray<uint8>& OutRejectedHits) const
+{
+	const UECRLagCompensationSubsystem* LagCompensation = GetWorld()->GetSubsystem<UECRLagCompensationSubsystem>();
+	if (!LagCompensation || !ECRConsoleVariables::LagCompensatedHitValidation)
+	{
+		return;
+	}
+
+	// All hits of the cartridge were seen at the same time, so they are validated in one batch
+	TArray<FECRLagCompensatedHit, TInlineAllocator<16>> Hits;
+	TArray<uint8, TInlineAllocator<16>> HitIndices;
+	for (uint8 i = 0; (i < TargetData.Num()) && (i < 255); ++i)
+	{
+		if (const FHitResult* HitResult = TargetData.Get(i) ? TargetData.Get(i)->GetHitResult() : nullptr)
+		{
+			if (const AActor* HitActor = HitResult->GetActor())
+			{
+				Hits.Add({HitActor, HitResult->ImpactPoint});
+				HitIndices.Add(i);
+			}
+		}
+	}
+
+	if (Hits.Num() == 0)
+	{
+		return;
+	}
+
+	TArray<bool> Valid;
+	LagCompensation->ValidateHits(LagCompensation->GetRewindTime(GetControllerFromActorInfo()), Hits, /*out*/ Valid);
+
+	for (int32 HitIdx = 0; HitIdx < Hits.Num(); ++HitIdx)
+	{
+		if (!Valid[HitIdx])
+		{
+			UE_LOG(LogECRAbilitySystem, Verbose, TEXT("Weapon ability %s: rejected hit on %s by lag compensation"),
+			       *GetPathName(), *GetNameSafe(Hits[HitIdx].Target));
+			OutRejectedHits.Add(HitIndices[HitIdx]);
+		}
+	}
+}
+
 void UECRGameplayAbility_RangedWeapon::StartRangedWeaponTargeting()
 {
 	check(CurrentActorInfo);
@@ -651,6 +952,16 @@ void UECRGameplayAbility_RangedWeapon::StartRangedWeaponTargeting()
 	AActor* AvatarActor = CurrentActorInfo->AvatarActor.Get();
 	check(AvatarActor);
 
+	TArray<FHitResult> FoundHits;
+	if (PerformLocalTargeting(/*out*/ FoundHits))
+	{
+		FinishRangedWeaponTargeting(FoundHits);
+	}
+}
+
+void UECRGameplayAbility_RangedWeapon::FinishRangedWeaponTargeting(const TArray<FHitResult>& FoundHits,
+                                                                  const bool bDeferred)
+{
 	UAbilitySystemComponent* MyAbilityComponent = CurrentActorInfo->AbilitySystemComponent.Get();
 	check(MyAbilityComponent);
 
@@ -658,10 +969,16 @@ void UECRGameplayAbility_RangedWeapon::StartRangedWeaponTargeting()
 	check(Controller);
 	UECRWeaponStateComponent* WeaponStateComponent = Controller->FindComponentByClass<UECRWeaponStateComponent>();
 
-	FScopedPredictionWindow ScopedPrediction(MyAbilityComponent, CurrentActivationInfo.GetActivationPredictionKey());
-
-	TArray<FHitResult> FoundHits;
-	PerformLocalTargeting(/*out*/ FoundHits);
+	// Deferred targeting only happens on authority (see ShouldUseAsyncBulletTraces), where nothing is predicted
+	TOptional<FScopedPredictionWindow> ScopedPrediction;
+	if (!bDeferred)
+	{
+		ScopedPrediction.Emplace(MyAbilityComponent, CurrentActivationInfo.GetActivationPredictionKey());
+	}
+	else
+	{
+		check(CurrentActorInfo->IsNetAuthority());
+	}
 
 	// Fill out the target data from the hit results
 	FGameplayAbilityTargetDataHandle TargetData;
@@ -0,0 +1,259 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Gameplay/Weapons/ECRLagCompensationSubsystem.h"
+
+#include "Components/CapsuleComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/PlayerState.h"
+
+namespace ECRConsoleVariables
+{
+	static float LagCompensationMaxRewindMs = 500.0f;
+	static FAutoConsoleVariableRef CVarLagCompensationMaxRewindMs(
+		TEXT("ECR.LagCompensation.MaxRewindMs"),
+		LagCompensationMaxRewindMs,
+		TEXT("How far back in time hits can be validated, older shots are checked against the oldest recorded frame"),
+		ECVF_Default);
+
+	static float LagCompensationExtraRewindMs = 0.0f;
+	static FAutoConsoleVariableRef CVarLagCompensationExtraRewindMs(
+		TEXT("ECR.LagCompensation.ExtraRewindMs"),
+		LagCompensationExtraRewindMs,
+		TEXT("Rewind added to shooter's round trip time, e.g. interpolation delay of simulated proxies"),
+		ECVF_Default);
+
+	static float LagCompensationHitTolerance = 30.0f;
+	static FAutoConsoleVariableRef CVarLagCompensationHitTolerance(
+		TEXT("ECR.LagCompensation.HitTolerance"),
+		LagCompensationHitTolerance,
+		TEXT("Distance (in uu) impact point may be outside of rewound capsule or mesh bounds and still be accepted"),
+		ECVF_Default);
+}
+
+void UECRLagCompensationSubsystem::RegisterCharacter(ACharacter* Character)
+{
+	if (!Character || SlotByActor.Contains(Character))
+	{
+		return;
+	}
+
+	if (FreeSlots.Num() == 0)
+	{
+		GrowCapacity();
+	}
+
+	const int32 Slot = FreeSlots.Pop(false);
+	SlotByActor.Add(Character, Slot);
+	SlotCharacters[Slot] = Character;
+	Radii[Slot] = Character->GetCapsuleComponent()->GetScaledCapsuleRadius();
+
+	// Frames recorded before registration hold data of previous owner of the slot
+	SlotRegisteredSerials[Slot] = FrameSerial + 1;
+}
+
+void UECRLagCompensationSubsystem::UnregisterCharacter(ACharacter* Character)
+{
+	int32 Slot;
+	if (SlotByActor.RemoveAndCopyValue(Character, Slot))
+	{
+		SlotCharacters[Slot].Reset();
+		FreeSlots.Add(Slot);
+	}
+}
+
+void UECRLagCompensationSubsystem::GrowCapacity()
+{
+	const int32 OldCapacity = Capacity;
+	const int32 NewCapacity = FMath::Max(32, OldCapacity * 2);
+
+	auto GrowPerFrameArray = [OldCapacity, NewCapacity](auto& Array)
+	{
+		using FElement = typename TRemoveReference<decltype(Array)>::Type::ElementType;
+
+		TArray<FElement> NewArray;
+		NewArray.SetNumZeroed(MaxHistoryFrames * NewCapacity);
+		for (int32 Frame = 0; Frame < MaxHistoryFrames && OldCapacity > 0; ++Frame)
+		{
+			FMemory::Memcpy(&NewArray[Frame * NewCapacity], &Array[Frame * OldCapacity], OldCapacity * sizeof(FElement));
+		}
+		Array = MoveTemp(NewArray);
+	};
+
+	GrowPerFrameArray(Centers);
+	GrowPerFrameArray(HalfHeights);
+	GrowPerFrameArray(BoundsOrigins);
+	GrowPerFrameArray(BoundsExtents);
+
+	Radii.SetNumZeroed(NewCapacity);
+	SlotRegisteredSerials.SetNumZeroed(NewCapacity);
+	SlotCharacters.SetNum(NewCapacity);
+
+	if (FrameTimes.Num() == 0)
+	{
+		FrameTimes.SetNumZeroed(MaxHistoryFrames);
+		FrameSerials.SetNumZeroed(MaxHistoryFrames);
+	}
+
+	// Lowest slots are used first
+	for (int32 Slot = NewCapacity - 1; Slot >= OldCapacity; --Slot)
+	{
+		FreeSlots.Add(Slot);
+	}
+
+	Capacity = NewCapacity;
+}
+
+void UECRLagCompensationSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// Only listen and dedicated servers validate hits of remote clients
+	const UWorld* World = GetWorld();
+	if (!World || SlotByActor.Num() == 0 || World->GetNetMode() == NM_Client || World->GetNetMode() == NM_Standalone)
+	{
+		return;
+	}
+
+	NewestFrame = (NewestFrame + 1) % MaxHistoryFrames;
+	NumRecordedFrames = FMath::Min(NumRecordedFrames + 1, MaxHistoryFrames);
+	FrameTimes[NewestFrame] = World->GetTimeSeconds();
+	FrameSerials[NewestFrame] = ++FrameSerial;
+
+	FVector3f* FrameCenters = &Centers[NewestFrame * Capacity];
+	float* FrameHalfHeights = &HalfHeights[NewestFrame * Capacity];
+	FVector3f* FrameBoundsOrigins = &BoundsOrigins[NewestFrame * Capacity];
+	FVector3f* FrameBoundsExtents = &BoundsExtents[NewestFrame * Capacity];
+
+	for (const TPair<TObjectKey<AActor>, int32>& SlotPair : SlotByActor)
+	{
+		const int32 Slot = SlotPair.Value;
+		if (const ACharacter* Character = SlotCharacters[Slot].Get())
+		{
+			const UCapsuleComponent* Capsule = Character->GetCapsuleComponent();
+			FrameCenters[Slot] = FVector3f(Capsule->GetComponentLocation());
+			FrameHalfHeights[Slot] = Capsule->GetScaledCapsuleHalfHeight();
+
+			// Bounds of skeletal mesh are built from its physics asset bodies
+			const USkeletalMeshComponent* Mesh = Character->GetMesh();
+			FrameBoundsOrigins[Slot] = Mesh ? FVector3f(Mesh->Bounds.Origin) : FrameCenters[Slot];
+			FrameBoundsExtents[Slot] = Mesh ? FVector3f(Mesh->Bounds.BoxExtent) : FVector3f::ZeroVector;
+		}
+	}
+}
+
+TStatId UECRLagCompensationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UECRLagCompensationSubsystem, STATGROUP_Tickables);
+}
+
+double UECRLagCompensationSubsystem::GetRewindTime(const AController* Shooter) const
+{
+	const UWorld* World = GetWorld();
+	const double Now = World ? World->GetTimeSeconds() : 0.0;
+
+	float RewindMs = ECRConsoleVariables::LagCompensationExtraRewindMs;
+	if (const APlayerState* PlayerState = Shooter ? Shooter->PlayerState.Get() : nullptr)
+	{
+		RewindMs += PlayerState->GetPingInMilliseconds();
+	}
+
+	return Now - FMath::Clamp(RewindMs, 0.0f, ECRConsoleVariables::LagCompensationMaxRewindMs) / 1000.0;
+}
+
+bool UECRLagCompensationSubsystem::FindFrames(double Time, int32& OutOlderFrame, int32& OutNewerFrame,
+                                              float& OutAlpha) const
+{
+	if (NumRecordedFrames == 0)
+	{
+		return false;
+	}
+
+	OutNewerFrame = NewestFrame;
+	OutOlderFrame = NewestFrame;
+	OutAlpha = 0.0f;
+
+	// Walk back from the newest frame until the one recorded before the time
+	for (int32 FrameOffset = 1; FrameOffset < NumRecordedFrames; ++FrameOffset)
+	{
+		if (FrameTimes[OutNewerFrame] <= Time)
+		{
+			break;
+		}
+
+		OutOlderFrame = (NewestFrame - FrameOffset + MaxHistoryFrames) % MaxHistoryFrames;
+		if (FrameTimes[OutOlderFrame] <= Time)
+		{
+			const double FrameDelta = FrameTimes[OutNewerFrame] - FrameTimes[OutOlderFrame];
+			OutAlpha = FrameDelta > 0.0 ? 1.0f - (float)((FrameTimes[OutNewerFrame] - Time) / FrameDelta) : 0.0f;
+			return true;
+		}
+
+		OutNewerFrame = OutOlderFrame;
+	}
+
+	// Time is outside of history, use the closest frame
+	OutOlderFrame = OutNewerFrame;
+	return true;
+}
+
+void UECRLagCompensationSubsystem::ValidateHits(double RewindTime, TConstArrayView<FECRLagCompensatedHit> Hits,
+                                                TArray<bool>& OutValid) const
+{
+	OutValid.Init(true, Hits.Num());
+
+	int32 OlderFrame, NewerFrame;
+	float Alpha;
+	if (!FindFrames(RewindTime, OlderFrame, NewerFrame, Alpha))
+	{
+		return;
+	}
+
+	const FVector3f* OlderCenters = &Centers[OlderFrame * Capacity];
+	const FVector3f* NewerCenters = &Centers[NewerFrame * Capacity];
+	const float* OlderHalfHeights = &HalfHeights[OlderFrame * Capacity];
+	const float* NewerHalfHeights = &HalfHeights[NewerFrame * Capacity];
+	const FVector3f* OlderBoundsOrigins = &BoundsOrigins[OlderFrame * Capacity];
+	const FVector3f* NewerBoundsOrigins = &BoundsOrigins[NewerFrame * Capacity];
+	const FVector3f* OlderBoundsExtents = &BoundsExtents[OlderFrame * Capacity];
+	const FVector3f* NewerBoundsExtents = &BoundsExtents[NewerFrame * Capacity];
+	const float Tolerance = ECRConsoleVariables::LagCompensationHitTolerance;
+	const uint32 OlderFrameSerial = FrameSerials[OlderFrame];
+
+	for (int32 HitIdx = 0; HitIdx < Hits.Num(); ++HitIdx)
+	{
+		const FECRLagCompensatedHit& Hit = Hits[HitIdx];
+		const int32* SlotPtr = SlotByActor.Find(Hit.Target);
+		if (!SlotPtr || SlotRegisteredSerials[*SlotPtr] > OlderFrameSerial)
+		{
+			// Not tracked, or registered after the time shooter saw
+			continue;
+		}
+
+		const int32 Slot = *SlotPtr;
+		const FVector Center = FVector(FMath::Lerp(OlderCenters[Slot], NewerCenters[Slot], Alpha));
+		const float HalfHeight = FMath::Lerp(OlderHalfHeights[Slot], NewerHalfHeights[Slot], Alpha);
+		const float Radius = Radii[Slot];
+
+		// Characters' capsules are always upright
+		const FVector SegmentOffset(0.0, 0.0, FMath::Max(HalfHeight - Radius, 0.0f));
+		const float DistanceSquared = FMath::PointDistToSegmentSquared(Hit.ImpactPoint, Center - SegmentOffset,
+		                                                              Center + SegmentOffset);
+
+		if (DistanceSquared <= FMath::Square(Radius + Tolerance))
+		{
+			continue;
+		}
+
+		// Limbs may reach out of the capsule, those are within bounds of physics asset
+		const FVector3f BoundsOrigin = FMath::Lerp(OlderBoundsOrigins[Slot], NewerBoundsOrigins[Slot], Alpha);
+		const FVector3f BoundsExtent = FMath::Lerp(OlderBoundsExtents[Slot], NewerBoundsExtents[Slot], Alpha)
+			+ FVector3f(Tolerance);
+		const FVector3f BoundsOffset = (FVector3f(Hit.ImpactPoint) - BoundsOrigin).GetAbs();
+
+		OutValid[HitIdx] = BoundsOffset.X <= BoundsExtent.X && BoundsOffset.Y <= BoundsExtent.Y
+			&& BoundsOffset.Z <= BoundsExtent.Z;
+	}
+}
@@ -12,6 +12,7 @@
 #include "Gameplay/Camera/ECRCameraComponent.h"
 #include "Gameplay/Equipment/ECREquipmentManagerComponent.h"
 #include "Gameplay/GAS/Attributes/ECRCombatSet.h"
+#include "Gameplay/Weapons/ECRWeaponHeatSubsystem.h"
 #include "Kismet/GameplayStatics.h"
 #include "Net/UnrealNetwork.h"
 #include "Physics/PhysicalMaterialWithTags.h"
@@ -38,6 +39,7 @@ void UECRRangedWeaponInstance::PostLoad()
 void UECRRangedWeaponInstance::PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent)
 {
 	Super::PostEditChangeProperty(PropertyChangedEvent);
+	bHeatCurvesBaked = false;
 	UpdateDebugVisualization();
 }
 
@@ -55,10 +57,8 @@ void UECRRangedWeaponInstance::OnEquipped()
 {
 	Super::OnEquipped();
 
-	// Start heat in the start
-	float MinHeatRange;
-	float MaxHeatRange;
-	ComputeHeatRange(/*out*/ MinHeatRange, /*out*/ MaxHeatRange);
+	// Curves may be external assets edited since last equip
+	BakeHeatCurves();
 
 	CurrentHeat = 0;
 	if (APawn* Pawn = GetPawn())
@@ -72,26 +72,32 @@ void UECRRangedWeaponInstance::OnEquipped()
 	UpdateFiringTime();
 
 	// Derive spread
-	CurrentSpreadAngle = HeatToSpreadCurve.GetRichCurveConst()->Eval(CurrentHeat * HeatToSpreadMappingMultiplier);
+	CurrentSpreadAngle = BakedHeatToSpreadCurve.Eval(CurrentHeat * HeatToSpreadMappingMultiplier);
 
 	// Default the multipliers to 1x
 	CurrentSpreadAngleMultiplier = 1.0f;
 	StandingStillMultiplier = 1.0f;
 	JumpFallMultiplier = 1.0f;
 	CrouchingMultiplier = 1.0f;
+
+	if (UECRWeaponHeatSubsystem* HeatSubsystem = UWorld::GetSubsystem<UECRWeaponHeatSubsystem>(GetWorld()))
+	{
+		HeatSubsystem->RegisterWeapon(this);
+	}
 }
 
 void UECRRangedWeaponInstance::OnUnequipped()
 {
 	Super::OnUnequipped();
+
+	if (UECRWeaponHeatSubsystem* HeatSubsystem = UWorld::GetSubsystem<UECRWeaponHeatSubsystem>(GetWorld()))
+	{
+		HeatSubsystem->UnregisterWeapon(this);
+	}
 }
 
-void UECRRangedWeaponInstance::Tick(float DeltaSeconds)
+void UECRRangedWeaponInstance::FinishTick(const float DeltaSeconds, const bool bMinSpread)
 {
-	APawn* Pawn = GetPawn();
-	check(Pawn != nullptr);
-
-	const bool bMinSpread = UpdateSpread(DeltaSeconds);
 	const bool bMinMultipliers = UpdateMultipliers(DeltaSeconds);
 
 	bHasFirstShotAccuracy = bAllowFirstShotAccuracy && bMinMultipliers && bMinSpread;
@@ -101,37 +107,46 @@ void UECRRangedWeaponInstance::Tick(float DeltaSeconds)
 #endif
 }
 
-void UECRRangedWeaponInstance::ComputeHeatRange(float& MinHeat, float& MaxHeat)
+void UECRRangedWeaponInstance::BakeHeatCurves()
 {
-	float Min1;
-	float Max1;
-	HeatToHeatPerShotCurve.GetRichCurveConst()->GetTimeRange(/*out*/ Min1, /*out*/ Max1);
-
-	float Min2;
-	float Max2;
-	HeatToCoolDownPerSecondCurve.GetRichCurveConst()->GetTimeRange(/*out*/ Min2, /*out*/ Max2);
-
-	float Min3;
-	float Max3;
-	HeatToSpreadCurve.GetRichCurveConst()->GetTimeRange(/*out*/ Min3, /*out*/ Max3);
+	BakedHeatToHeatPerShotCurve.Bake(HeatToHeatPerShotCurve.GetRichCurveConst());
+	BakedHeatToCoolDownPerSecondCurve.Bake(HeatToCoolDownPerSecondCurve.GetRichCurveConst());
+	BakedHeatToSpreadCurve.Bake(HeatToSpreadCurve.GetRichCurveConst());
+
+	BakedMinHeat = FMath::Min3(BakedHeatToHeatPerShotCurve.GetMinTime(), BakedHeatToCoolDownPerSecondCurve.GetMinTime(),
+	                           BakedHeatToSpreadCurve.GetMinTime());
+	BakedMaxHeat = FMath::Max3(BakedHeatToHeatPerShotCurve.GetMaxTime(), BakedHeatToCoolDownPerSecondCurve.GetMaxTime(),
+	                           BakedHeatToSpreadCurve.GetMaxTime());
+	bHeatCurvesBaked = true;
+}
 
-	MinHeat = FMath::Min(FMath::Min(Min1, Min2), Min3);
-	MaxHeat = FMath::Max(FMath::Max(Max1, Max2), Max3);
+void UECRRangedWeaponInstance::ComputeHeatRange(float& MinHeat, float& MaxHeat)
+{
+	BakeHeatCurvesIfNeeded();
+	MinHeat = BakedMinHeat;
+	MaxHeat = BakedMaxHeat;
 }
 
 void UECRRangedWeaponInstance::ComputeSpreadRange(float& MinSpread, float& MaxSpread)
 {
-	HeatToSpreadCurve.GetRichCurveConst()->GetValueRange(/*out*/ MinSpread, /*out*/ MaxSpread);
+	BakeHeatCurvesIfNeeded();
+	MinSpread = BakedHeatToSpreadCurve.GetMinValue();
+	MaxSpread = BakedHeatToSpreadCurve.GetMaxValue();
+}
+
+void UECRRangedWeaponInstance::SetHeatAndSpread(const float NewHeat)
+{
+	CurrentHeat = NewHeat;
+	// Map the heat to the spread angle
+	CurrentSpreadAngle = BakedHeatToSpreadCurve.Eval(CurrentHeat * HeatToSpreadMappingMultiplier);
 }
 
 void UECRRangedWeaponInstance::AddSpread()
 {
 	// Sample the heat up curve
-	const float HeatPerShot = HeatToHeatPerShotCurve.GetRichCurveConst()->Eval(CurrentHeat) * HeatPerShotMultiplier;
-	CurrentHeat = ClampHeat(CurrentHeat + HeatPerShot);
-
-	// Map the heat to the spread angle
-	CurrentSpreadAngle = HeatToSpreadCurve.GetRichCurveConst()->Eval(CurrentHeat * HeatToSpreadMappingMultiplier);
+	BakeHeatCurvesIfNeeded();
+	const float HeatPerShot = BakedHeatToHeatPerShotCurve.Eval(CurrentHeat) * HeatPerShotMultiplier;
+	SetHeatAndSpread(ClampHeat(CurrentHeat + HeatPerShot));
 
 #if WITH_EDITOR
 	UpdateDebugVisualization();
@@ -145,9 +160,7 @@ void UECRRangedWeaponInstance::OverrideHeat(float NewHeat)
 
 void UECRRangedWeaponInstance::RemoveHeat(float DeltaHeat)
 {
-	CurrentHeat = ClampHeat(CurrentHeat - DeltaHeat);
-	// Map the heat to the spread angle
-	CurrentSpreadAngle = HeatToSpreadCurve.GetRichCurveConst()->Eval(CurrentHeat * HeatToSpreadMappingMultiplier);
+	SetHeatAndSpread(ClampHeat(CurrentHeat - DeltaHeat));
 
 #if WITH_EDITOR
 	UpdateDebugVisualization();
@@ -190,7 +203,7 @@ void UECRRangedWeaponInstance::GetLifetimeReplicatedProps(TArray<FLifetimeProper
 	// DOREPLIFETIME(ThisClass, CurrentHeat);
 }
 
-bool UECRRangedWeaponInstance::UpdateSpread(float DeltaSeconds)
+bool UECRRangedWeaponInstance::ShouldCoolDown()
 {
 	if (APawn* Pawn = GetPawn())
 	{
@@ -204,19 +217,7 @@ bool UECRRangedWeaponInstance::UpdateSpread(float DeltaSeconds)
 	}
 
 	const float TimeSinceFired = GetWorld()->TimeSince(TimeLastFired);
-
-	if (TimeSinceFired > SpreadRecoveryCooldownDelay)
-	{
-		const float CooldownRate = HeatToCoolDownPerSecondCurve.GetRichCurveConst()->Eval(CurrentHeat);
-		CurrentHeat = ClampHeat(CurrentHeat - (CooldownRate * DeltaSeconds));
-		CurrentSpreadAngle = HeatToSpreadCurve.GetRichCurveConst()->Eval(CurrentHeat * HeatToSpreadMappingMultiplier);
-	}
-
-	float MinSpread;
-	float MaxSpread;
-	ComputeSpreadRange(/*out*/ MinSpread, /*out*/ MaxSpread);
-
-	return FMath::IsNearlyEqual(CurrentSpreadAngle, MinSpread, KINDA_SMALL_NUMBER);
+	return TimeSinceFired > SpreadRecoveryCooldownDelay;
 }
 
 bool UECRRangedWeaponInstance::UpdateMultipliers(float DeltaSeconds)
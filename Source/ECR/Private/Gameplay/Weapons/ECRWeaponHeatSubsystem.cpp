@@ -0,0 +1,88 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Gameplay/Weapons/ECRWeaponHeatSubsystem.h"
+
+#include "GameFramework/Controller.h"
+#include "GameFramework/Pawn.h"
+#include "Gameplay/Weapons/ECRRangedWeaponInstance.h"
+#include "Gameplay/Weapons/ECRWeaponStateComponent.h"
+
+void UECRWeaponHeatSubsystem::RegisterWeapon(UECRRangedWeaponInstance* Weapon)
+{
+	if (Weapon)
+	{
+		Weapons.AddUnique(Weapon);
+	}
+}
+
+void UECRWeaponHeatSubsystem::UnregisterWeapon(UECRRangedWeaponInstance* Weapon)
+{
+	Weapons.RemoveSingle(Weapon);
+}
+
+void UECRWeaponHeatSubsystem::Tick(const float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	TickedWeapons.Reset();
+	TickedPawns.Reset();
+	Heats.Reset();
+	CooldownRates.Reset();
+	MinHeats.Reset();
+	MaxHeats.Reset();
+	CoolingFlags.Reset();
+
+	Weapons.RemoveAll([](const TWeakObjectPtr<UECRRangedWeaponInstance>& Weapon)
+	{
+		return !Weapon.IsValid() || !Weapon->GetPawn();
+	});
+
+	// Gather: weapons are ticked only when controller has weapon state component (players, not AI),
+	// which used to tick them, and only the first ranged weapon of pawn is ticked
+	for (const TWeakObjectPtr<UECRRangedWeaponInstance>& WeakWeapon : Weapons)
+	{
+		UECRRangedWeaponInstance* Weapon = WeakWeapon.Get();
+		const APawn* Pawn = Weapon->GetPawn();
+		bool bAlreadyTicked = false;
+		TickedPawns.Add(Pawn, &bAlreadyTicked);
+		const AController* Controller = Pawn->GetController();
+		if (bAlreadyTicked || !Controller || !Controller->FindComponentByClass<UECRWeaponStateComponent>())
+		{
+			continue;
+		}
+
+		// Curves may have been edited since equip
+		Weapon->BakeHeatCurvesIfNeeded();
+
+		const bool bCooling = Weapon->ShouldCoolDown();
+		TickedWeapons.Add(Weapon);
+		CoolingFlags.Add(bCooling);
+		Heats.Add(Weapon->CurrentHeat);
+		CooldownRates.Add(bCooling ? Weapon->BakedHeatToCoolDownPerSecondCurve.Eval(Weapon->CurrentHeat) : 0.0f);
+		MinHeats.Add(Weapon->BakedMinHeat);
+		MaxHeats.Add(Weapon->BakedMaxHeat);
+	}
+
+	// Cooldown of all weapons at once
+	const int32 NumTicked = TickedWeapons.Num();
+	for (int32 Idx = 0; Idx < NumTicked; ++Idx)
+	{
+		Heats[Idx] = FMath::Clamp(Heats[Idx] - CooldownRates[Idx] * DeltaTime, MinHeats[Idx], MaxHeats[Idx]);
+	}
+
+	// Scatter
+	for (int32 Idx = 0; Idx < NumTicked; ++Idx)
+	{
+		UECRRangedWeaponInstance* Weapon = TickedWeapons[Idx];
+		if (CoolingFlags[Idx])
+		{
+			Weapon->SetHeatAndSpread(Heats[Idx]);
+		}
+		Weapon->FinishTick(DeltaTime, Weapon->IsSpreadAtMin());
+	}
+}
+
+TStatId UECRWeaponHeatSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UECRWeaponHeatSubsystem, STATGROUP_Tickables);
+}
@@ -8,8 +8,6 @@
 #include "Kismet/GameplayStatics.h"
 
 #include "GameFramework/Pawn.h"
-#include "Gameplay/Equipment/ECREquipmentManagerComponent.h"
-#include "Gameplay/Weapons/ECRRangedWeaponInstance.h"
 #include "NativeGameplayTags.h"
 #include "Physics/PhysicalMaterialWithTags.h"
 
@@ -20,27 +18,8 @@ UECRWeaponStateComponent::UECRWeaponStateComponent(const FObjectInitializer& Obj
 {
 	SetIsReplicatedByDefault(true);
 
-	PrimaryComponentTick.bStartWithTickEnabled = true;
-	PrimaryComponentTick.bCanEverTick = true;
-}
-
-void UECRWeaponStateComponent::TickComponent(float DeltaTime, enum ELevelTick TickType,
-                                             FActorComponentTickFunction* ThisTickFunction)
-{
-	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
-
-	if (APawn* Pawn = GetPawn<APawn>())
-	{
-		if (UECREquipmentManagerComponent* EquipmentManager = Pawn->FindComponentByClass<
-			UECREquipmentManagerComponent>())
-		{
-			if (UECRRangedWeaponInstance* CurrentWeapon = Cast<UECRRangedWeaponInstance>(
-				EquipmentManager->GetFirstInstanceOfType(UECRRangedWeaponInstance::StaticClass())))
-			{
-				CurrentWeapon->Tick(DeltaTime);
-			}
-		}
-	}
+	// Equipped ranged weapons are ticked by UECRWeaponHeatSubsystem
+	PrimaryComponentTick.bCanEverTick = false;
 }
 
 void UECRWeaponStateComponent::ClientConfirmTargetData_Implementation(uint16 UniqueId, bool bSuccess,
@@ -1,3 +1,171 @@
 ﻿// Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "System/ECRSignificanceManager.h"
+
+#include "CharacterOptimizerBudget.h"
+#include "CharacterOptimizerComponent.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+
+const FName UECRSignificanceManager::CharacterSignificanceTag = FName(TEXT("Character"));
+
+UECRSignificanceManager::UECRSignificanceManager()
+{
+	ViewConeCos = FMath::Cos(FMath::DegreesToRadians(45.0));
+	bBudgetedOptimization = false;
+	SmoothedFrameTime = 0.0f;
+}
+
+void UECRSignificanceManager::RegisterCharacterOptimizer(UCharacterOptimizerComponent* Optimizer)
+{
+	if (!Optimizer || !Optimizer->IsOptimizationEnabled())
+	{
+		return;
+	}
+
+	auto SignificanceFunction = [this, Optimizer](FManagedObjectInfo* ObjectInfo, const FTransform& Viewpoint)
+	{
+		return bBudgetedOptimization
+			       ? Optimizer->CalculateSignificance(Viewpoint, ViewConeCos)
+			       : UCharacterOptimizerComponent::WaveToSignificance(Optimizer->CalculateWave(Viewpoint, ViewConeCos));
+	};
+
+	// Settings are applied sequentially on game thread after significance of all objects has been calculated,
+	// in budgeted mode they are applied after the update when significance of all chars is known
+	auto PostSignificanceFunction = [this, Optimizer](FManagedObjectInfo* ObjectInfo, float OldSignificance,
+	                                                  float Significance, bool bFinal)
+	{
+		if (!bFinal && !bBudgetedOptimization)
+		{
+			Optimizer->ApplyWave(UCharacterOptimizerComponent::SignificanceToWave(Significance));
+		}
+	};
+
+	RegisterObject(Optimizer, CharacterSignificanceTag, SignificanceFunction,
+	               EPostSignificanceType::Sequential, PostSignificanceFunction);
+}
+
+void UECRSignificanceManager::UnregisterCharacterOptimizer(UCharacterOptimizerComponent* Optimizer)
+{
+	if (Optimizer)
+	{
+		UnregisterObject(Optimizer);
+	}
+}
+
+void UECRSignificanceManager::Update(TArrayView<const FTransform> Viewpoints)
+{
+	bBudgetedOptimization = CharacterOptimizerBudget::IsEnabled();
+
+	Super::Update(Viewpoints);
+
+	if (bBudgetedOptimization)
+	{
+		ApplyCharacterBudget();
+	}
+}
+
+void UECRSignificanceManager::ApplyCharacterBudget()
+{
+	const TArray<FManagedObjectInfo*>& CharInfos = GetManagedObjects(CharacterSignificanceTag);
+
+	SortedCharInfosScratch.Reset(CharInfos.Num());
+	SortedCharInfosScratch.Append(CharInfos);
+	SortedCharInfosScratch.Sort([](const FManagedObjectInfo& A, const FManagedObjectInfo& B)
+	{
+		return A.GetSignificance() > B.GetSignificance();
+	});
+
+	BudgetRequestsScratch.Reset(SortedCharInfosScratch.Num());
+	for (const FManagedObjectInfo* CharInfo : SortedCharInfosScratch)
+	{
+		const UCharacterOptimizerComponent* Optimizer = CastChecked<UCharacterOptimizerComponent>(CharInfo->GetObject());
+		BudgetRequestsScratch.Add({CharInfo->GetSignificance(), Optimizer->GetEstimatedUpdateCostMs()});
+	}
+
+	UpdateRatesScratch.SetNumUninitialized(BudgetRequestsScratch.Num(), false);
+	CharacterOptimizerBudget::Allocate(BudgetRequestsScratch, UpdateRatesScratch, CharacterOptimizerBudget::GetBudgetMs(),
+	                                   CharacterOptimizerBudget::GetMaxUpdateRate());
+
+	for (int32 Index = 0; Index < SortedCharInfosScratch.Num(); ++Index)
+	{
+		UCharacterOptimizerComponent* Optimizer = CastChecked<UCharacterOptimizerComponent>(
+			SortedCharInfosScratch[Index]->GetObject());
+		Optimizer->ApplyUpdateRate(UpdateRatesScratch[Index], SmoothedFrameTime);
+	}
+}
+
+void UECRSignificanceManager::Tick(float DeltaTime)
+{
+	// Spikes of single frames shouldn't leak into tick intervals derived from frame time
+	SmoothedFrameTime = SmoothedFrameTime > 0.0f ? FMath::Lerp(SmoothedFrameTime, DeltaTime, 0.1f) : DeltaTime;
+
+	ViewConeCos = GatherLocalViewpoints(ViewpointsScratch);
+	if (ViewpointsScratch.Num() > 0)
+	{
+		Update(ViewpointsScratch);
+	}
+}
+
+ETickableTickType UECRSignificanceManager::GetTickableTickType() const
+{
+	return HasAnyFlags(RF_ClassDefaultObject) ? ETickableTickType::Never : ETickableTickType::Always;
+}
+
+bool UECRSignificanceManager::IsTickable() const
+{
+	if (HasAnyFlags(RF_ClassDefaultObject))
+	{
+		return false;
+	}
+
+	// Chars simulated by server are authoritative, so they are never throttled on dedicated and listen servers
+	const UWorld* World = GetWorld();
+	if (!World || IsRunningDedicatedServer())
+	{
+		return false;
+	}
+	const ENetMode NetMode = World->GetNetMode();
+	return NetMode == NM_Client || NetMode == NM_Standalone;
+}
+
+TStatId UECRSignificanceManager::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UECRSignificanceManager, STATGROUP_Tickables);
+}
+
+UWorld* UECRSignificanceManager::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
+
+double UECRSignificanceManager::GatherLocalViewpoints(TArray<FTransform>& OutViewpoints) const
+{
+	OutViewpoints.Reset();
+
+	double MaxFOV = 0.0;
+	if (const UWorld* World = GetWorld())
+	{
+		for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+		{
+			const APlayerController* PlayerController = It->Get();
+			if (!PlayerController || !PlayerController->IsLocalController())
+			{
+				continue;
+			}
+
+			FVector Location;
+			FRotator Rotation;
+			PlayerController->GetPlayerViewPoint(Location, Rotation);
+			OutViewpoints.Emplace(Rotation, Location);
+
+			const double FOV = PlayerController->PlayerCameraManager
+				                   ? PlayerController->PlayerCameraManager->GetFOVAngle()
+				                   : 90.0;
+			MaxFOV = FMath::Max(MaxFOV, FOV);
+		}
+	}
+
+	return FMath::Cos(FMath::DegreesToRadians(FMath::Clamp(MaxFOV, 1.0, 179.0) * 0.5));
+}
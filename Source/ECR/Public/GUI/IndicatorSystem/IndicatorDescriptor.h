@@ -19,6 +19,18 @@ struct FIndicatorProjection
 {
 	bool Project(const UIndicatorDescriptor& IndicatorDescriptor, const FSceneViewProjectionData& InProjectionData,
 	             const FVector2D& ScreenSize, FVector& ScreenPositionWithDepth);
+
+	/** World point projected for the indicator, false if its projection mode projects a screen bounding box instead */
+	static bool GetWorldPoint(const UIndicatorDescriptor& IndicatorDescriptor, FVector& OutWorldPoint);
+
+	/**
+	 * Projects world points to screen positions with depth (distance from view origin) in one pass, four points at a time
+	 * with vector registers. Screen space offsets of indicators aren't applied. Points behind camera are projected too,
+	 * with OutInFrontOfCamera false
+	 */
+	static void ProjectPoints(const FSceneViewProjectionData& InProjectionData, const FVector2D& ScreenSize,
+	                          TConstArrayView<FVector> WorldPoints, TArrayView<FVector> OutScreenPositionsWithDepth,
+	                          TArrayView<bool> OutInFrontOfCamera);
 };
 
 UENUM(BlueprintType)
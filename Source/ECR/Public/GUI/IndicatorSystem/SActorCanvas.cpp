@@ -8,6 +8,27 @@
 #include "ECRIndicatorManagerComponent.h"
 #include "Widgets/Layout/SBox.h"
 
+DECLARE_STATS_GROUP(TEXT("ECRIndicators"), STATGROUP_ECRIndicators, STATCAT_Advanced);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Indicators Projected"), STAT_ECRIndicators_Projected, STATGROUP_ECRIndicators);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Indicator World Point Updates"), STAT_ECRIndicators_WorldPointUpdates, STATGROUP_ECRIndicators);
+
+namespace ECRConsoleVariables
+{
+	static float IndicatorFarDistance = 5000.0f;
+	static FAutoConsoleVariableRef CVarIndicatorFarDistance(
+		TEXT("ECR.Indicators.FarDistance"),
+		IndicatorFarDistance,
+		TEXT("Indicators further than this (cm) update their world position at reduced rate"),
+		ECVF_Default);
+
+	static float IndicatorReducedUpdateInterval = 0.1f;
+	static FAutoConsoleVariableRef CVarIndicatorReducedUpdateInterval(
+		TEXT("ECR.Indicators.ReducedUpdateInterval"),
+		IndicatorReducedUpdateInterval,
+		TEXT("Interval of world position updates of far and off screen indicators, they are still projected every frame"),
+		ECVF_Default);
+}
+
 namespace EArrowDirection
 {
 	enum Type
@@ -194,6 +215,22 @@ EActiveTimerReturnType SActorCanvas::UpdateCanvas(double InCurrentTime, float In
 
 			bool IndicatorsChanged = false;
 
+			auto FinishSlotUpdate = [this, &IndicatorsChanged](SActorCanvas::FSlot& Slot)
+			{
+				IndicatorsChanged |= Slot.bIsDirty();
+				bSortOrderChanged |= Slot.bSortKeyChanged;
+				Slot.bSortKeyChanged = false;
+				Slot.ClearDirtyFlag();
+			};
+
+			const FSlateRect ScreenRect(FVector2D::ZeroVector, PaintGeometry.Size);
+			const double FarDistance = ECRConsoleVariables::IndicatorFarDistance;
+			const double ReducedUpdateInterval = ECRConsoleVariables::IndicatorReducedUpdateInterval;
+			int32 NumWorldPointUpdates = 0;
+
+			ProjectedSlots.Reset();
+			ProjectedWorldPoints.Reset();
+
 			for (int32 ChildIndex = 0; ChildIndex < CanvasChildren.Num(); ++ChildIndex)
 			{
 				SActorCanvas::FSlot& CurChild = CanvasChildren[ChildIndex];
@@ -214,8 +251,7 @@ EActiveTimerReturnType SActorCanvas::UpdateCanvas(double InCurrentTime, float In
 
 				if (!CurChild.GetIsIndicatorVisible())
 				{
-					IndicatorsChanged |= CurChild.bIsDirty();
-					CurChild.ClearDirtyFlag();
+					FinishSlotUpdate(CurChild);
 					continue;
 				}
 
@@ -227,37 +263,66 @@ EActiveTimerReturnType SActorCanvas::UpdateCanvas(double InCurrentTime, float In
 					IndicatorsChanged = true;
 				}
 
-				FVector ScreenPositionWithDepth;
-
-				FIndicatorProjection Projector;
-				const bool Success = Projector.Project(*Indicator, ProjectionData, PaintGeometry.Size, OUT ScreenPositionWithDepth);
-
-				if (!Success)
+				const EActorCanvasProjectionMode ProjectionMode = Indicator->GetProjectionMode();
+				if (ProjectionMode == EActorCanvasProjectionMode::ComponentScreenBoundingBox ||
+					ProjectionMode == EActorCanvasProjectionMode::ActorScreenBoundingBox)
 				{
-					CurChild.SetHasValidScreenPosition(false);
-					CurChild.SetInFrontOfCamera(false);
+					// Projects whole bounds, so can't be batched
+					FVector ScreenPositionWithDepth;
+					FIndicatorProjection Projector;
+					const bool Success = Projector.Project(*Indicator, ProjectionData, PaintGeometry.Size, OUT ScreenPositionWithDepth);
 
-					IndicatorsChanged |= CurChild.bIsDirty();
-					CurChild.ClearDirtyFlag();
+					ApplyProjection(CurChild, Success, ScreenPositionWithDepth);
+					FinishSlotUpdate(CurChild);
 					continue;
 				}
 
-				CurChild.SetInFrontOfCamera(Success);
-				CurChild.SetHasValidScreenPosition(CurChild.GetInFrontOfCamera() || Indicator->GetClampToScreen());
+				// World position of far and off screen indicators moves them little on screen, camera movement is
+				// still applied every frame by the projection
+				if (!CurChild.bHasWorldPoint || InCurrentTime >= CurChild.NextWorldPointUpdateTime)
+				{
+					CurChild.bHasWorldPoint = FIndicatorProjection::GetWorldPoint(*Indicator, CurChild.WorldPoint);
+					NumWorldPointUpdates++;
+
+					const bool bReducedRate = CurChild.GetDepth() > FarDistance || !CurChild.HasValidScreenPosition()
+						|| !ScreenRect.ContainsPoint(CurChild.GetScreenPosition());
+					// Spread updates of indicators added at once over frames
+					CurChild.NextWorldPointUpdateTime = InCurrentTime + (bReducedRate
+						                                                     ? ReducedUpdateInterval * FMath::FRandRange(0.75, 1.25)
+						                                                     : 0.0);
+				}
 
-				if (CurChild.HasValidScreenPosition())
+				if (!CurChild.bHasWorldPoint)
 				{
-					// Only dirty the screen position if we can actually show this indicator.
-					CurChild.SetScreenPosition(FVector2D(ScreenPositionWithDepth));
-					CurChild.SetDepth(ScreenPositionWithDepth.X);
+					ApplyProjection(CurChild, false, FVector::ZeroVector);
+					FinishSlotUpdate(CurChild);
+					continue;
 				}
 
-				CurChild.SetPriority(Indicator->GetPriority());
+				ProjectedSlots.Add(&CurChild);
+				ProjectedWorldPoints.Add(CurChild.WorldPoint);
+			}
+
+			// Project all point indicators at once
+			const int32 NumProjected = ProjectedSlots.Num();
+			ProjectedScreenPositions.SetNumUninitialized(NumProjected);
+			ProjectedInFrontOfCamera.SetNumUninitialized(NumProjected);
+			FIndicatorProjection::ProjectPoints(ProjectionData, PaintGeometry.Size, ProjectedWorldPoints,
+			                                    ProjectedScreenPositions, ProjectedInFrontOfCamera);
+
+			for (int32 ProjectedIdx = 0; ProjectedIdx < NumProjected; ++ProjectedIdx)
+			{
+				SActorCanvas::FSlot& CurChild = *ProjectedSlots[ProjectedIdx];
+				const FVector ScreenPositionWithDepth = ProjectedScreenPositions[ProjectedIdx]
+					+ FVector(CurChild.Indicator->GetScreenSpaceOffset(), 0.0);
 
-				IndicatorsChanged |= CurChild.bIsDirty();
-				CurChild.ClearDirtyFlag();
+				ApplyProjection(CurChild, ProjectedInFrontOfCamera[ProjectedIdx], ScreenPositionWithDepth);
+				FinishSlotUpdate(CurChild);
 			}
 
+			INC_DWORD_STAT_BY(STAT_ECRIndicators_Projected, NumProjected);
+			INC_DWORD_STAT_BY(STAT_ECRIndicators_WorldPointUpdates, NumWorldPointUpdates);
+
 			if (IndicatorsChanged)
 			{
 				Invalidate(EInvalidateWidget::Paint);
@@ -284,6 +349,70 @@ EActiveTimerReturnType SActorCanvas::UpdateCanvas(double InCurrentTime, float In
 	}
 }
 
+void SActorCanvas::ApplyProjection(FSlot& Slot, const bool bSuccess, const FVector& ScreenPositionWithDepth)
+{
+	if (!bSuccess)
+	{
+		Slot.SetHasValidScreenPosition(false);
+		Slot.SetInFrontOfCamera(false);
+		return;
+	}
+
+	Slot.SetInFrontOfCamera(bSuccess);
+	Slot.SetHasValidScreenPosition(Slot.GetInFrontOfCamera() || Slot.Indicator->GetClampToScreen());
+
+	if (Slot.HasValidScreenPosition())
+	{
+		// Only dirty the screen position if we can actually show this indicator.
+		Slot.SetScreenPosition(FVector2D(ScreenPositionWithDepth));
+		Slot.SetDepth(ScreenPositionWithDepth.Z);
+	}
+
+	Slot.SetPriority(Slot.Indicator->GetPriority());
+}
+
+void SActorCanvas::UpdateSortedSlots() const
+{
+	if (bSortedSlotsStale)
+	{
+		SortedSlots.Reset(CanvasChildren.Num());
+		for (int32 ChildIndex = 0; ChildIndex < CanvasChildren.Num(); ++ChildIndex)
+		{
+			SortedSlots.Add(&CanvasChildren[ChildIndex]);
+		}
+
+		bSortedSlotsStale = false;
+		bSortOrderChanged = true;
+	}
+
+	if (!bSortOrderChanged)
+	{
+		return;
+	}
+	bSortOrderChanged = false;
+
+	// Order changes little between updates, so insertion sort of previous order is close to linear
+	for (int32 SlotIdx = 1; SlotIdx < SortedSlots.Num(); ++SlotIdx)
+	{
+		const SActorCanvas::FSlot* Slot = SortedSlots[SlotIdx];
+
+		int32 InsertIdx = SlotIdx;
+		for (; InsertIdx > 0; --InsertIdx)
+		{
+			const SActorCanvas::FSlot* Prev = SortedSlots[InsertIdx - 1];
+			const bool bDrawnBeforePrev = Slot->GetPriority() == Prev->GetPriority()
+				                              ? Slot->GetDepth() > Prev->GetDepth()
+				                              : Slot->GetPriority() < Prev->GetPriority();
+			if (!bDrawnBeforePrev)
+			{
+				break;
+			}
+			SortedSlots[InsertIdx] = Prev;
+		}
+		SortedSlots[InsertIdx] = Slot;
+	}
+}
+
 void SActorCanvas::SetShowAnyIndicators(bool bIndicators)
 {
 	if (bShowAnyIndicators != bIndicators)
@@ -311,19 +440,9 @@ void SActorCanvas::OnArrangeChildren(const FGeometry& AllottedGeometry, FArrange
 	{
 		const FVector2D ArrowWidgetSize = ActorCanvasArrowBrush->GetImageSize();
 		const FIntPoint FixedPadding = FIntPoint(10.0f, 10.0f) + FIntPoint(ArrowWidgetSize.X, ArrowWidgetSize.Y);
-		const FVector Center = FVector(AllottedGeometry.Size * 0.5f, 0.0f);
+		const FVector2D Center = AllottedGeometry.Size * 0.5f;
 
-		// Sort the children
-		TArray<const SActorCanvas::FSlot*> SortedSlots;
-		for (int32 ChildIndex = 0; ChildIndex < CanvasChildren.Num(); ++ChildIndex)
-		{
-			SortedSlots.Add(&CanvasChildren[ChildIndex]);
-		}
-
-		SortedSlots.StableSort([](const SActorCanvas::FSlot& A, const SActorCanvas::FSlot& B)
-		{
-			return A.GetPriority() == B.GetPriority() ? A.GetDepth() > B.GetDepth() : A.GetPriority() < B.GetPriority();
-		});
+		UpdateSortedSlots();
 
 		// Go through all the sorted children
 		for (int32 ChildIndex = 0; ChildIndex < SortedSlots.Num(); ++ChildIndex)
@@ -365,23 +484,36 @@ void SActorCanvas::OnArrangeChildren(const FGeometry& AllottedGeometry, FArrange
 				// Make sure the screen position is within the clamp rect
 				if (!ClampRect.Contains(FIntPoint(ScreenPosition.X, ScreenPosition.Y)))
 				{
-					const FPlane Planes[] =
+					// Move the position along the line from screen center to the first edge of clamp rect it crosses
+					const FVector2D Direction = ScreenPosition - Center;
+					double Alpha = 1.0;
+					auto ClampToEdge = [&Alpha, &ClampDir](const double EdgeAlpha, const EArrowDirection::Type EdgeDir)
 					{
-						FPlane(FVector(1.0f, 0.0f, 0.0f), ClampRect.Min.X),	// Left
-						FPlane(FVector(0.0f, 1.0f, 0.0f), ClampRect.Min.Y),	// Top
-						FPlane(FVector(-1.0f, 0.0f, 0.0f), -ClampRect.Max.X),	// Right
-						FPlane(FVector(0.0f, -1.0f, 0.0f), -ClampRect.Max.Y)	// Bottom
+						if (EdgeAlpha >= 0.0 && EdgeAlpha < Alpha)
+						{
+							Alpha = EdgeAlpha;
+							ClampDir = EdgeDir;
+						}
 					};
 
-					for (int32 i = 0; i < EArrowDirection::MAX; ++i)
+					if (ScreenPosition.X < ClampRect.Min.X)
 					{
-						FVector NewPoint;
-						if (FMath::SegmentPlaneIntersection(Center, FVector(ScreenPosition, 0.0f), Planes[i], NewPoint))
-						{
-							ClampDir = (EArrowDirection::Type)i;
-							ScreenPosition = FVector2D(NewPoint);
-						}
+						ClampToEdge((ClampRect.Min.X - Center.X) / Direction.X, EArrowDirection::Left);
+					}
+					if (ScreenPosition.Y < ClampRect.Min.Y)
+					{
+						ClampToEdge((ClampRect.Min.Y - Center.Y) / Direction.Y, EArrowDirection::Top);
+					}
+					if (ScreenPosition.X > ClampRect.Max.X)
+					{
+						ClampToEdge((ClampRect.Max.X - Center.X) / Direction.X, EArrowDirection::Right);
+					}
+					if (ScreenPosition.Y > ClampRect.Max.Y)
+					{
+						ClampToEdge((ClampRect.Max.Y - Center.Y) / Direction.Y, EArrowDirection::Bottom);
 					}
+
+					ScreenPosition = Center + Direction * Alpha;
 				}
 				else if (!bInFrontOfCamera)
 				{
@@ -623,6 +755,7 @@ SActorCanvas::FScopedWidgetSlotArguments SActorCanvas::AddActorSlot(UIndicatorDe
 		{
 			if (TSharedPtr<SActorCanvas> Canvas = WeakCanvas.Pin())
 			{
+				Canvas->bSortedSlotsStale = true;
 				Canvas->UpdateActiveTimer();
 			}
 		}};
@@ -635,6 +768,7 @@ int32 SActorCanvas::RemoveActorSlot(const TSharedRef<SWidget>& SlotWidget)
 		if ( SlotWidget == CanvasChildren[SlotIdx].GetWidget() )
 		{
 			CanvasChildren.RemoveAt(SlotIdx);
+			bSortedSlotsStale = true;
 
 			UpdateActiveTimer();
 
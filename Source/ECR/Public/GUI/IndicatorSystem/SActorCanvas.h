@@ -32,10 +32,14 @@ public:
 			, ScreenPosition(FVector2D::ZeroVector)
 			, Depth(0)
 			, Priority(0.f)
+			, WorldPoint(FVector::ZeroVector)
+			, NextWorldPointUpdateTime(0.0)
 			, bIsIndicatorVisible(true)
 			, bInFrontOfCamera(true)
 			, bHasValidScreenPosition(false)
 			, bDirty(true)
+			, bSortKeyChanged(true)
+			, bHasWorldPoint(false)
 			, bWasIndicatorClamped(false)
 			, bWasIndicatorClampedStatusChanged(false)
 		{
@@ -74,6 +78,7 @@ public:
 			{
 				Depth = InDepth;
 				bDirty = true;
+				bSortKeyChanged = true;
 			}
 		}
 
@@ -84,6 +89,7 @@ public:
 			{
 				Priority = InPriority;
 				bDirty = true;
+				bSortKeyChanged = true;
 			}
 		}
 
@@ -147,10 +153,16 @@ public:
 		double Depth;
 		int32 Priority;
 
+		/** World point projected for point projection modes, refreshed at reduced rate when far or off screen */
+		FVector WorldPoint;
+		double NextWorldPointUpdateTime;
+
 		uint8 bIsIndicatorVisible : 1;
 		uint8 bInFrontOfCamera : 1;
 		uint8 bHasValidScreenPosition : 1;
 		uint8 bDirty : 1;
+		uint8 bSortKeyChanged : 1;
+		uint8 bHasWorldPoint : 1;
 		
 		/** 
 		 * Cached & frame-deferred value of whether the indicator was visually screen clamped last frame or not; 
@@ -224,6 +236,11 @@ private:
 
 	void UpdateActiveTimer();
 
+	/** Keeps SortedSlots in draw order, re-sorting only when slots or their depth or priority changed */
+	void UpdateSortedSlots() const;
+
+	void ApplyProjection(FSlot& Slot, bool bSuccess, const FVector& ScreenPositionWithDepth);
+
 private:
 	TArray<UIndicatorDescriptor*> AllIndicators;
 	TArray<UIndicatorDescriptor*> InactiveIndicators;
@@ -250,5 +267,16 @@ private:
 
 	mutable TOptional<FGeometry> OptionalPaintGeometry;
 
+	/** Slots sorted by priority, then back to front */
+	mutable TArray<const FSlot*> SortedSlots;
+	mutable bool bSortedSlotsStale = true;
+	mutable bool bSortOrderChanged = false;
+
+	// Scratch of the batched projection, kept to avoid allocations
+	TArray<FSlot*> ProjectedSlots;
+	TArray<FVector> ProjectedWorldPoints;
+	TArray<FVector> ProjectedScreenPositions;
+	TArray<bool> ProjectedInFrontOfCamera;
+
 	TSharedPtr<FActiveTimerHandle> TickHandle;
 };
@@ -7,6 +7,7 @@
 #include "Curves/CurveFloat.h"
 #include "ECRPenetrationAvoidanceFeeler.h"
 #include "DrawDebugHelpers.h"
+#include "WorldCollision.h"
 #include "ECRCameraMode_PenetrationAvoidant.generated.h"
 
 class UCurveVector;
@@ -30,6 +31,10 @@ protected:
 	void PreventCameraPenetration(class AActor const& ViewTarget, FVector const& SafeLoc, FVector& CameraLoc,
 	                              float const& DeltaTime, float& DistBlockedPct, bool bSingleRayOnly);
 
+	/** Computes blocked pct of feeler ray from SafeLoc to RayTarget, returns false if there is no hit or it's ignored */
+	bool GetFeelerBlockedPct(AActor const& ViewTarget, const FHitResult& Hit, FVector const& SafeLoc,
+	                         FVector const& RayTarget, FCollisionQueryParams& SphereParams, float& OutBlockedPct);
+
 	virtual void DrawDebug(UCanvas* Canvas) const override;
 
 	// Penetration prevention
@@ -75,4 +80,15 @@ public:
 #if ENABLE_DRAW_DEBUG
 	mutable float LastDrawDebugTime = -MAX_FLT;
 #endif
+
+private:
+	struct FFeelerSweep
+	{
+		FTraceHandle Handle;
+		FVector SafeLoc = FVector::ZeroVector;
+		FVector RayTarget = FVector::ZeroVector;
+	};
+
+	/** Async sweeps requested last frame, by feeler index */
+	TArray<FFeelerSweep> PendingFeelerSweeps;
 };
@@ -71,6 +71,16 @@ struct FSharedRepMovement
 	bool bIsCrouched = false;
 };
 
+template<>
+struct TStructOpsTypeTraits<FSharedRepMovement> : public TStructOpsTypeTraitsBase2<FSharedRepMovement>
+{
+	enum
+	{
+		// Without custom serializer the multicast would serialize every property of the struct separately
+		WithNetSerializer = true,
+	};
+};
+
 /**
  * AECRCharacter
  *
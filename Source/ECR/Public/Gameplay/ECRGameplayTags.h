@@ -80,6 +80,7 @@ public:
 	FGameplayTag Status_Death_Dead;
 	FGameplayTag Status_JumpFlying;
 	FGameplayTag Status_Wounded;
+	FGameplayTag Status_ObjectiveCarrier;
 
 	FGameplayTag Movement_Mode_Walking;
 	FGameplayTag Movement_Mode_NavWalking;
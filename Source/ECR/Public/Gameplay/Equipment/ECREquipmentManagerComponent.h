@@ -14,6 +14,9 @@ class UECREquipmentInstance;
 class UECRAbilitySystemComponent;
 struct FECREquipmentList;
 class UECREquipmentManagerComponent;
+class UECREquipmentInstance_EquipmentMod;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnEquipmentChanged, UECREquipmentInstance*, Instance, bool, bEquipped);
 
 /** A single piece of applied equipment */
 USTRUCT(BlueprintType)
@@ -78,6 +81,18 @@ public:
 private:
 	UECRAbilitySystemComponent* GetAbilitySystemComponent() const;
 
+	void IndexInstance(UECREquipmentInstance* Instance);
+	void UnindexInstance(UECREquipmentInstance* Instance);
+	void RebuildIndices();
+
+	/** Removes instances which were garbage collected before they could be unindexed */
+	void RemoveStaleInstances();
+
+	/** Equipped instances of the class or its subclasses, in equip order, may contain stale entries */
+	const TArray<TWeakObjectPtr<UECREquipmentInstance>>& GetInstancesOfClass(const UClass* InstanceClass) const;
+
+	void BroadcastChanged(UECREquipmentInstance* Instance, bool bEquipped) const;
+
 	friend UECREquipmentManagerComponent;
 
 private:
@@ -87,6 +102,17 @@ private:
 
 	UPROPERTY()
 	UActorComponent* OwnerComponent;
+
+	// Indices of entries for lookups done every frame, updated on add, remove and replication of entries.
+	// Instances are referenced by entries, so they are weak here and stale ones are skipped
+
+	/** Filled on first query of a class */
+	mutable TMap<TObjectKey<UClass>, TArray<TWeakObjectPtr<UECREquipmentInstance>>> InstancesByClass;
+
+	TMap<FName, TArray<TWeakObjectPtr<UECREquipmentInstance>>> InstancesByChannel;
+
+	/** Modifiers by each of their modifier tags and parents of these tags */
+	TMap<FGameplayTag, TArray<TWeakObjectPtr<UECREquipmentInstance_EquipmentMod>>> ModifiersByTag;
 };
 
 template <>
@@ -152,6 +178,10 @@ public:
 	UFUNCTION(BlueprintCallable, BlueprintPure)
 	UECREquipmentInstance* GetFirstInstanceVisibleInChannel(FName VisibilityChannel);
 
+	/** Called when instance is equipped or unequipped, on server and on clients when equipment list is replicated */
+	UPROPERTY(BlueprintAssignable)
+	FOnEquipmentChanged OnEquipmentChanged;
+
 private:
 	UPROPERTY(Replicated)
 	FECREquipmentList EquipmentList;
@@ -37,7 +37,12 @@ struct FECRAbilityTagRelationship
 };
 
 
-/** Mapping of how ability tags block or cancel other abilities */
+/**
+ * Mapping of how ability tags block or cancel other abilities
+ *
+ * Relationships are compiled into a map by ability tag once loaded, and tags resolved for an ability tag container
+ * are remembered, as the same few containers are checked on every activation and cancel.
+ */
 UCLASS()
 class UECRAbilityTagRelationshipMapping : public UDataAsset
 {
@@ -48,7 +53,38 @@ private:
 	UPROPERTY(EditAnywhere, Category = Ability, meta=(TitleProperty="AbilityTag"))
 	TArray<FECRAbilityTagRelationship> AbilityTagRelationships;
 
+	/** Tags of all relationships for the ability tag container */
+	struct FResolvedRelationships
+	{
+		FGameplayTagContainer AbilityTags;
+		FGameplayTagContainer AbilityTagsToBlock;
+		FGameplayTagContainer AbilityTagsToCancel;
+		FGameplayTagContainer ActivationRequiredTags;
+		FGameplayTagContainer ActivationBlockedTags;
+	};
+
+	/** Relationships merged by ability tag */
+	TMap<FGameplayTag, FECRAbilityTagRelationship> CompiledRelationships;
+
+	bool bCompiled = false;
+
+	/** Resolved relationships by hash of ability tag container */
+	mutable TMap<uint32, FResolvedRelationships> ResolvedRelationshipsCache;
+
+	void CompileRelationships();
+
+	void InvalidateCompiledRelationships();
+
+	const FResolvedRelationships& ResolveRelationships(const FGameplayTagContainer& AbilityTags) const;
+
 public:
+	//~UObject interface
+	virtual void PostLoad() override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+	//~End of UObject interface
+
 	/** Given a set of ability tags, parse the tag relationship and fill out tags to block and cancel */
 	void GetAbilityTagsToBlockAndCancel(const FGameplayTagContainer& AbilityTags, FGameplayTagContainer* OutTagsToBlock, FGameplayTagContainer* OutTagsToCancel) const;
 
@@ -53,4 +53,23 @@ public:
 
 	UPROPERTY(Replicated)
 	FGameplayTagStackContainer StatTags;
+
+	// Sets faction and squad of the player (INDEX_NONE squad means no squad), faction is initially set from
+	// DesiredFaction join option. Factions of the same match alliance are allies
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category=Teams)
+	void SetFactionAndSquad(FName NewFaction, int32 NewSquadId);
+
+	UFUNCTION(BlueprintCallable, Category=Teams)
+	FName GetFaction() const { return Faction; }
+
+	UFUNCTION(BlueprintCallable, Category=Teams)
+	int32 GetSquadId() const { return SquadId; }
+
+
+private:
+	UPROPERTY(Replicated)
+	FName Faction;
+
+	UPROPERTY(Replicated)
+	int32 SquadId = INDEX_NONE;
 };
@@ -0,0 +1,58 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FRichCurve;
+
+/**
+ * Rich curve sampled into a uniform table and evaluated with linear interpolation, which is much cheaper
+ * than evaluating the curve itself.
+ *
+ * Table size is doubled until interpolated values are within ECR.Weapon.CurveBakeTolerance of the curve,
+ * curves that can't be baked within it (eg with constant interpolation steps) are evaluated directly.
+ */
+struct FECRBakedCurve
+{
+public:
+	void Bake(const FRichCurve* Curve);
+
+	bool IsBaked() const { return Values.Num() > 0; }
+
+	float GetMinTime() const { return MinTime; }
+	float GetMaxTime() const { return MaxTime; }
+	float GetMinValue() const { return MinValue; }
+	float GetMaxValue() const { return MaxValue; }
+
+	float Eval(const float Time) const
+	{
+		if (Values.Num() == 1)
+		{
+			return Values[0];
+		}
+
+		if (Values.Num() == 0)
+		{
+			return EvalSourceCurve(Time);
+		}
+
+		// Curves are baked only with constant extrapolation, so clamping matches them outside of time range
+		const float Position = FMath::Clamp((Time - MinTime) * InvStep, 0.0f, static_cast<float>(Values.Num() - 1));
+		const int32 Index = FMath::Min(static_cast<int32>(Position), Values.Num() - 2);
+		return FMath::Lerp(Values[Index], Values[Index + 1], Position - Index);
+	}
+
+private:
+	float EvalSourceCurve(float Time) const;
+
+	const FRichCurve* SourceCurve = nullptr;
+
+	float MinTime = 0.0f;
+	float MaxTime = 0.0f;
+	float InvStep = 0.0f;
+	float MinValue = 0.0f;
+	float MaxValue = 0.0f;
+
+	TArray<float> Values;
+};
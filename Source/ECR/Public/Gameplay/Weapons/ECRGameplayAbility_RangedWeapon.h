@@ -9,6 +9,8 @@
 
 class UECRRangedWeaponInstance;
 class APawn;
+struct FTraceHandle;
+struct FTraceDatum;
 
 /** Defines where an ability starts its trace from and where it should face */
 UENUM(BlueprintType)
@@ -82,6 +84,14 @@ protected:
 protected:
 	static int32 FindFirstPawnHitResult(const TArray<FHitResult>& HitResults);
 
+	// Filters raw hits of a weapon trace into OutHitResults, leaving one hit per actor, and returns the last one as impact
+	static FHitResult FilterWeaponTraceHits(const TArray<FHitResult>& HitResults, const FVector& StartTrace, const FVector& EndTrace, OUT TArray<FHitResult>& OutHitResults);
+
+	// Replaces line trace hits with sweep hits if sweep hit a pawn which isn't blocked by anything line trace hit
+	static void MergeSweepHits(const TArray<FHitResult>& SweepHits, OUT TArray<FHitResult>& OutHits);
+
+	FCollisionQueryParams GetWeaponTraceParams() const;
+
 	// Does a single weapon trace, either sweeping or ray depending on if SweepRadius is above zero
 	FHitResult WeaponTrace(const FVector& StartTrace, const FVector& EndTrace, float SweepRadius, bool bIsSimulated, OUT TArray<FHitResult>& OutHitResults) const;
 
@@ -95,18 +105,42 @@ protected:
 	// Traces all of the bullets in a single cartridge
 	void TraceBulletsInCartridge(const FRangedWeaponFiringInput& InputData, OUT TArray<FHitResult>& OutHits);
 
+	// Adds result of a single bullet trace to hits of the cartridge
+	void AddBulletTraceResult(FHitResult& Impact, const TArray<FHitResult>& AllImpacts, const FVector& EndTrace, OUT TArray<FHitResult>& OutHits) const;
+
+	// Whether bullets of cartridge are traced with async scene queries, with results processed next frame
+	bool ShouldUseAsyncBulletTraces(const APawn* AvatarPawn, const UECRRangedWeaponInstance* WeaponData) const;
+
+	// Issues line and sweep traces of all bullets of cartridge at once as async scene queries
+	void TraceBulletsInCartridgeAsync(const FRangedWeaponFiringInput& InputData);
+
+	void OnAsyncBulletTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
+
+	// Builds hits of the cartridge from finished async traces with the same rules as DoSingleBulletTrace
+	void FinishAsyncBulletTraces(uint16 BatchId);
+
+	// Finishes cartridges with traces still in flight by tracing them synchronously
+	void FlushAsyncBulletTraces();
+
 	virtual void AddAdditionalTraceIgnoreActors(FCollisionQueryParams& TraceParams) const;
 
 	// Determine the trace channel to use for the weapon trace(s)
 	virtual ECollisionChannel DetermineTraceChannel(FCollisionQueryParams& TraceParams, bool bIsSimulated) const;
 
-	void PerformLocalTargeting(OUT TArray<FHitResult>& OutHits);
+	// Returns false if bullets are traced asynchronously, then targeting is finished when traces are done
+	bool PerformLocalTargeting(OUT TArray<FHitResult>& OutHits);
+
+	// Sends target data built from hits of cartridge, deferred if it happens after the activation frame
+	void FinishRangedWeaponTargeting(const TArray<FHitResult>& FoundHits, bool bDeferred = false);
 
 	FVector GetWeaponTargetingSourceLocation() const;
 	FTransform GetTargetingTransform(APawn* SourcePawn, EECRAbilityTargetingSource Source) const;
 
 	void OnTargetDataReadyCallback(const FGameplayAbilityTargetDataHandle& InData, FGameplayTag ApplicationTag);
 
+	// Finds indices of hits which don't match hit volumes of their targets at the time shooter saw them
+	void FindLagCompensationRejectedHits(const FGameplayAbilityTargetDataHandle& TargetData, OUT TArray<uint8>& OutRejectedHits) const;
+
 	UFUNCTION(BlueprintCallable)
 	void StartRangedWeaponTargeting();
 
@@ -119,6 +153,28 @@ protected:
 private:
 	FDelegateHandle OnTargetDataReadyCallbackDelegateHandle;
 
+	struct FPendingBulletTrace
+	{
+		FVector StartTrace = FVector::ZeroVector;
+		FVector EndTrace = FVector::ZeroVector;
+		TArray<FHitResult> LineHits;
+		TArray<FHitResult> SweepHits;
+	};
+
+	// Bullets of cartridge traced asynchronously
+	struct FPendingBulletBatch
+	{
+		TArray<FPendingBulletTrace> Traces;
+		float SweepRadius = 0.0f;
+		int32 PendingTraceCount = 0;
+	};
+
+	// Cartridges with traces in flight by batch id, a new cartridge may be fired before results of previous one arrive
+	TMap<uint16, FPendingBulletBatch> PendingBulletBatches;
+
+	// Incremented on each async cartridge
+	uint16 AsyncBulletTraceBatchId = 0;
+
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, meta=(AllowPrivateAccess="true"))
 	EECRAbilityTargetingSource TargetingSource;
 };
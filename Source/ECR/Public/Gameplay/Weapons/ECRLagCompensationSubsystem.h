@@ -0,0 +1,81 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "ECRLagCompensationSubsystem.generated.h"
+
+class ACharacter;
+class AController;
+
+/** Hit claimed by a client, to be checked against history of its target */
+struct FECRLagCompensatedHit
+{
+	const AActor* Target = nullptr;
+	FVector ImpactPoint = FVector::ZeroVector;
+};
+
+/**
+ * Server side history of character hit volumes (capsules and mesh bounds, which come from physics asset bodies,
+ * so they include limbs reaching out of the capsule) over last ECR.LagCompensation.MaxRewindMs,
+ * used to validate hits claimed by clients at the time shooter saw the world.
+ *
+ * History is a ring buffer of frames, stored as structure of arrays with all characters of one frame next to each other,
+ * so recording a frame and validating a batch of hits at one time touch contiguous memory.
+ */
+UCLASS()
+class UECRLagCompensationSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	static constexpr int32 MaxHistoryFrames = 64;
+
+	void RegisterCharacter(ACharacter* Character);
+	void UnregisterCharacter(ACharacter* Character);
+
+	/** Time shooter saw the world at: server time minus its round trip time and extra rewind */
+	double GetRewindTime(const AController* Shooter) const;
+
+	/**
+	 * For each hit, whether its impact point was within capsule or mesh bounds of its target at RewindTime.
+	 * Hits on untracked targets are accepted
+	 */
+	void ValidateHits(double RewindTime, TConstArrayView<FECRLagCompensatedHit> Hits, TArray<bool>& OutValid) const;
+
+	//~UTickableWorldSubsystem interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	//~End of UTickableWorldSubsystem interface
+
+private:
+	void GrowCapacity();
+
+	/** Finds frames around the time and blend alpha between them, returns false if there is no history */
+	bool FindFrames(double Time, int32& OutOlderFrame, int32& OutNewerFrame, float& OutAlpha) const;
+
+	int32 Capacity = 0;
+	int32 NumRecordedFrames = 0;
+	int32 NewestFrame = INDEX_NONE;
+	uint32 FrameSerial = 0;
+
+	// Per frame
+	TArray<double> FrameTimes;
+	TArray<uint32> FrameSerials;
+
+	// Per frame and slot, index is Frame * Capacity + Slot
+	TArray<FVector3f> Centers;
+	TArray<float> HalfHeights;
+	TArray<FVector3f> BoundsOrigins;
+	TArray<FVector3f> BoundsExtents;
+
+	// Per slot
+	TArray<float> Radii;
+	TArray<uint32> SlotRegisteredSerials;
+	TArray<TWeakObjectPtr<ACharacter>> SlotCharacters;
+
+	TArray<int32> FreeSlots;
+	TMap<TObjectKey<AActor>, int32> SlotByActor;
+};
@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "Curves/CurveFloat.h"
 #include "Physics/ECRCollisionChannels.h"
+#include "Gameplay/Weapons/ECRBakedCurve.h"
 #include "ECRWeaponInstance.h"
 
 #include "ECRRangedWeaponInstance.generated.h"
@@ -283,9 +284,18 @@ private:
 	// The current crouching multiplier
 	float CrouchingMultiplier = 1.0f;
 
-public:
-	void Tick(float DeltaSeconds);
+	// Heat curves sampled into lookup tables, evaluated on every shot and tick instead of the curves
+	FECRBakedCurve BakedHeatToSpreadCurve;
+	FECRBakedCurve BakedHeatToHeatPerShotCurve;
+	FECRBakedCurve BakedHeatToCoolDownPerSecondCurve;
+
+	float BakedMinHeat = 0.0f;
+	float BakedMaxHeat = 0.0f;
+	bool bHeatCurvesBaked = false;
+
+	friend class UECRWeaponHeatSubsystem;
 
+public:
 	//~UECREquipmentInstance interface
 	virtual void OnEquipped();
 	virtual void OnUnequipped();
@@ -321,15 +331,33 @@ private:
 
 	inline float ClampHeat(float NewHeat)
 	{
-		float MinHeat;
-		float MaxHeat;
-		ComputeHeatRange(/*out*/ MinHeat, /*out*/ MaxHeat);
+		BakeHeatCurvesIfNeeded();
+		return FMath::Clamp(NewHeat, BakedMinHeat, BakedMaxHeat);
+	}
+
+	void BakeHeatCurves();
+
+	inline void BakeHeatCurvesIfNeeded()
+	{
+		if (!bHeatCurvesBaked)
+		{
+			BakeHeatCurves();
+		}
+	}
 
-		return FMath::Clamp(NewHeat, MinHeat, MaxHeat);
+	// Sets heat and derives spread angle from it
+	void SetHeatAndSpread(float NewHeat);
+
+	// Whether heat recovers this frame, ie cooldown delay since last shot has passed
+	bool ShouldCoolDown();
+
+	bool IsSpreadAtMin() const
+	{
+		return FMath::IsNearlyEqual(CurrentSpreadAngle, BakedHeatToSpreadCurve.GetMinValue(), KINDA_SMALL_NUMBER);
 	}
 
-	// Updates the spread and returns true if the spread is at minimum
-	bool UpdateSpread(float DeltaSeconds);
+	// Updates the multipliers and first shot accuracy after the spread was updated by UECRWeaponHeatSubsystem
+	void FinishTick(float DeltaSeconds, bool bMinSpread);
 
 	// Updates the multipliers and returns true if they are at minimum
 	bool UpdateMultipliers(float DeltaSeconds);
@@ -0,0 +1,45 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "ECRWeaponHeatSubsystem.generated.h"
+
+class APawn;
+class UECRRangedWeaponInstance;
+
+/**
+ * Updates heat, spread and spread multipliers of all equipped ranged weapons in one pass per frame,
+ * instead of each weapon state component finding and ticking its weapon.
+ *
+ * Heat cooldown of all weapons is computed over contiguous arrays, per weapon work (cooldown delay and
+ * movement based multipliers) is done in gather and scatter passes around it.
+ */
+UCLASS()
+class UECRWeaponHeatSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	void RegisterWeapon(UECRRangedWeaponInstance* Weapon);
+	void UnregisterWeapon(UECRRangedWeaponInstance* Weapon);
+
+	//~UTickableWorldSubsystem interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	//~End of UTickableWorldSubsystem interface
+
+private:
+	TArray<TWeakObjectPtr<UECRRangedWeaponInstance>> Weapons;
+
+	// Per weapon scratch of the cooldown pass, kept to avoid allocations
+	TArray<UECRRangedWeaponInstance*> TickedWeapons;
+	TSet<const APawn*> TickedPawns;
+	TArray<bool> CoolingFlags;
+	TArray<float> Heats;
+	TArray<float> CooldownRates;
+	TArray<float> MinHeats;
+	TArray<float> MaxHeats;
+};
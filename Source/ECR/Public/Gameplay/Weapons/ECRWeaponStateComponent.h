@@ -56,9 +56,6 @@ class UECRWeaponStateComponent : public UControllerComponent
 public:
 	UECRWeaponStateComponent(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
 
-	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType,
-	                           FActorComponentTickFunction* ThisTickFunction) override;
-
 	UFUNCTION(Client, Reliable)
 	void ClientConfirmTargetData(uint16 UniqueId, bool bSuccess, const TArray<uint8>& HitReplaces);
 
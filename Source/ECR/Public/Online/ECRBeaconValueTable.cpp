@@ -0,0 +1,281 @@
+﻿#include "ECRBeaconValueTable.h"
+
+#include "ECROnlineBeacon.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace ECRBeaconValueTable
+{
+	enum EEntryFlags : uint8
+	{
+		HasKeyName = 1 << 0,
+		Removed = 1 << 1
+	};
+
+	/** Guards against malformed data, senders don't add keys above it */
+	static constexpr uint32 MaxKeys = 16384;
+
+	/** Packed number of entries at the start of delta */
+	static constexpr int32 MaxHeaderSize = 5;
+
+	/** Reads string whose length prefix is checked against remaining data, so peer can't force huge allocation */
+	static bool ReadString(FArchive& Reader, FString& OutString)
+	{
+		const int64 LengthOffset = Reader.Tell();
+		int32 SaveNum = 0;
+		Reader << SaveNum;
+
+		// Negative length means UTF-16 characters
+		const int64 NumBytes = SaveNum < 0 ? -static_cast<int64>(SaveNum) * sizeof(UTF16CHAR) : SaveNum;
+		if (Reader.IsError() || NumBytes > Reader.TotalSize() - Reader.Tell())
+		{
+			Reader.SetError();
+			return false;
+		}
+
+		Reader.Seek(LengthOffset);
+		Reader << OutString;
+		return !Reader.IsError();
+	}
+}
+
+bool FECRBeaconValueTable::SetValue(const FName Key, const FString& Value)
+{
+	if (Entries.Num() >= static_cast<int32>(ECRBeaconValueTable::MaxKeys) && !KeyIds.Contains(Key))
+	{
+		UE_LOG(FBeaconLog, Warning, TEXT("Beacon value %s not set, limit of %u keys reached"), *Key.ToString(),
+		       ECRBeaconValueTable::MaxKeys);
+		return false;
+	}
+
+	int32& KeyId = KeyIds.FindOrAdd(Key, INDEX_NONE);
+	if (KeyId == INDEX_NONE)
+	{
+		KeyId = Entries.Num();
+		Entries.AddDefaulted_GetRef().Key = Key;
+	}
+
+	FEntry& Entry = Entries[KeyId];
+	if (!Entry.bRemoved && Entry.Version != 0 && Entry.Value.Equals(Value, ESearchCase::CaseSensitive))
+	{
+		return false;
+	}
+
+	Entry.Value = Value;
+	Entry.bRemoved = false;
+	Entry.Version = ++Version;
+	return true;
+}
+
+bool FECRBeaconValueTable::RemoveValue(const FName Key)
+{
+	// Entry stays, so removal can be sent to peers
+	const int32* KeyId = KeyIds.Find(Key);
+	if (!KeyId || Entries[*KeyId].bRemoved)
+	{
+		return false;
+	}
+
+	FEntry& Entry = Entries[*KeyId];
+	Entry.Value.Empty();
+	Entry.bRemoved = true;
+	Entry.Version = ++Version;
+	return true;
+}
+
+const FString* FECRBeaconValueTable::FindValue(const FName Key) const
+{
+	const int32* KeyId = KeyIds.Find(Key);
+	return KeyId && !Entries[*KeyId].bRemoved ? &Entries[*KeyId].Value : nullptr;
+}
+
+void FECRBeaconValueTable::GetValues(TMap<FName, FString>& OutValues) const
+{
+	OutValues.Reset();
+	for (const FEntry& Entry : Entries)
+	{
+		if (!Entry.bRemoved)
+		{
+			OutValues.Add(Entry.Key, Entry.Value);
+		}
+	}
+}
+
+uint32 FECRBeaconValueTable::WriteDelta(const uint32 SinceVersion, TBitArray<>& PeerKnownKeys,
+                                        TArray<uint8>& OutData) const
+{
+	using namespace ECRBeaconValueTable;
+
+	// Sent in order of change, so everything up to the returned version is sent even if delta is split
+	TArray<int32> ChangedKeyIds;
+	for (int32 KeyId = 0; KeyId < Entries.Num(); ++KeyId)
+	{
+		if (Entries[KeyId].Version > SinceVersion)
+		{
+			ChangedKeyIds.Add(KeyId);
+		}
+	}
+	ChangedKeyIds.Sort([this](const int32 A, const int32 B)
+	{
+		return Entries[A].Version < Entries[B].Version;
+	});
+
+	if (PeerKnownKeys.Num() < Entries.Num())
+	{
+		PeerKnownKeys.Add(false, Entries.Num() - PeerKnownKeys.Num());
+	}
+
+	TArray<uint8> EntryData;
+	FMemoryWriter Writer(EntryData);
+
+	uint32 NumWrittenEntries = 0;
+	uint32 SentVersion = SinceVersion;
+	for (const int32 KeyId : ChangedKeyIds)
+	{
+		const FEntry& Entry = Entries[KeyId];
+
+		// Peer without any data doesn't need removals
+		if (SinceVersion == 0 && Entry.bRemoved)
+		{
+			SentVersion = Entry.Version;
+			continue;
+		}
+
+		const int64 EntryStart = Writer.Tell();
+		const bool bSendKeyName = !PeerKnownKeys[KeyId];
+		uint8 Flags = (bSendKeyName ? HasKeyName : 0) | (Entry.bRemoved ? Removed : 0);
+
+		uint32 PackedKeyId = KeyId;
+		Writer.SerializeIntPacked(PackedKeyId);
+		Writer << Flags;
+
+		if (bSendKeyName)
+		{
+			FString KeyName = Entry.Key.ToString();
+			Writer << KeyName;
+		}
+
+		if (!Entry.bRemoved)
+		{
+			FString Value = Entry.Value;
+			Writer << Value;
+		}
+
+		if (MaxHeaderSize + EntryData.Num() > MaxDeltaSize)
+		{
+			EntryData.SetNum(EntryStart, false);
+			Writer.Seek(EntryStart);
+
+			// Rest is sent with the next delta
+			if (NumWrittenEntries > 0)
+			{
+				break;
+			}
+
+			// Doesn't fit even alone, it would only be rejected by peer
+			UE_LOG(FBeaconLog, Warning, TEXT("Beacon value %s is too big to be sent"), *Entry.Key.ToString());
+			SentVersion = Entry.Version;
+			continue;
+		}
+
+		PeerKnownKeys[KeyId] = true;
+		NumWrittenEntries++;
+		SentVersion = Entry.Version;
+	}
+
+	OutData.Reset(MaxHeaderSize + EntryData.Num());
+	FMemoryWriter HeaderWriter(OutData);
+	HeaderWriter.SerializeIntPacked(NumWrittenEntries);
+	OutData.Append(EntryData);
+
+	return SentVersion;
+}
+
+bool FECRBeaconValueTable::ReadDelta(const TArray<uint8>& Data, TArray<FName>& OutChangedKeys)
+{
+	using namespace ECRBeaconValueTable;
+
+	OutChangedKeys.Reset();
+	FMemoryReader Reader(Data);
+
+	uint32 NumChangedEntries = 0;
+	Reader.SerializeIntPacked(NumChangedEntries);
+
+	// Whole delta is read and checked before the table is changed
+	struct FReadEntry
+	{
+		FName Key;
+		FString Value;
+		bool bRemoved = false;
+	};
+	TArray<FReadEntry> ReadEntries;
+	TArray<TPair<uint32, FName>> NewPeerKeys;
+
+	for (uint32 EntryIdx = 0; EntryIdx < NumChangedEntries && !Reader.IsError(); ++EntryIdx)
+	{
+		uint32 PeerKeyId = 0;
+		uint8 Flags = 0;
+		Reader.SerializeIntPacked(PeerKeyId);
+		Reader << Flags;
+		if (Reader.IsError() || PeerKeyId >= MaxKeys)
+		{
+			return false;
+		}
+
+		FReadEntry& ReadEntry = ReadEntries.AddDefaulted_GetRef();
+		if (Flags & HasKeyName)
+		{
+			FString KeyName;
+			if (!ReadString(Reader, KeyName) || KeyName.IsEmpty())
+			{
+				return false;
+			}
+			ReadEntry.Key = FName(*KeyName);
+			NewPeerKeys.Emplace(PeerKeyId, ReadEntry.Key);
+		}
+		else if (const TPair<uint32, FName>* NewPeerKey = NewPeerKeys.FindByPredicate(
+			[PeerKeyId](const TPair<uint32, FName>& Pair) { return Pair.Key == PeerKeyId; }))
+		{
+			ReadEntry.Key = NewPeerKey->Value;
+		}
+		else if (PeerKeys.IsValidIndex(PeerKeyId))
+		{
+			ReadEntry.Key = PeerKeys[PeerKeyId];
+		}
+
+		if (ReadEntry.Key.IsNone())
+		{
+			return false;
+		}
+
+		ReadEntry.bRemoved = (Flags & Removed) != 0;
+		if (!ReadEntry.bRemoved && !ReadString(Reader, ReadEntry.Value))
+		{
+			return false;
+		}
+	}
+
+	if (Reader.IsError())
+	{
+		return false;
+	}
+
+	for (const TPair<uint32, FName>& NewPeerKey : NewPeerKeys)
+	{
+		if (PeerKeys.Num() <= static_cast<int32>(NewPeerKey.Key))
+		{
+			PeerKeys.SetNum(NewPeerKey.Key + 1);
+		}
+		PeerKeys[NewPeerKey.Key] = NewPeerKey.Value;
+	}
+
+	for (const FReadEntry& ReadEntry : ReadEntries)
+	{
+		if (ReadEntry.bRemoved ? RemoveValue(ReadEntry.Key) : SetValue(ReadEntry.Key, ReadEntry.Value))
+		{
+			OutChangedKeys.Add(ReadEntry.Key);
+		}
+	}
+
+	return true;
+}
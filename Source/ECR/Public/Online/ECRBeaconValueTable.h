@@ -0,0 +1,57 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Key/value data sent over beacons as deltas.
+ *
+ * Sender table keeps version of each value, peer is sent only values changed since the version it already has,
+ * in compact binary form. Key names are sent once per peer, then referred to by index.
+ * Receiver applies deltas to its own table, which mirrors sender one.
+ */
+class FECRBeaconValueTable
+{
+public:
+	/** Deltas are split to fit it, bigger ones are rejected by receiver */
+	static constexpr int32 MaxDeltaSize = 64 * 1024;
+
+	/** Returns true if value changed, false for new keys above the limit of keys */
+	bool SetValue(FName Key, const FString& Value);
+
+	/** Returns true if value existed */
+	bool RemoveValue(FName Key);
+
+	const FString* FindValue(FName Key) const;
+
+	void GetValues(TMap<FName, FString>& OutValues) const;
+
+	/** Incremented on each change */
+	uint32 GetVersion() const { return Version; }
+
+	/**
+	 * Writes values changed after SinceVersion, oldest changes first, up to MaxDeltaSize bytes
+	 * @param PeerKnownKeys Keys whose names were already sent to the peer, updated
+	 * @return Version peer has after applying the delta, below GetVersion() if not all changes fit
+	 */
+	uint32 WriteDelta(uint32 SinceVersion, TBitArray<>& PeerKnownKeys, TArray<uint8>& OutData) const;
+
+	/** Applies delta written by WriteDelta of peer table, returns false without changing the table if data is malformed */
+	bool ReadDelta(const TArray<uint8>& Data, TArray<FName>& OutChangedKeys);
+
+private:
+	struct FEntry
+	{
+		FName Key;
+		FString Value;
+		uint32 Version = 0;
+		bool bRemoved = false;
+	};
+
+	/** Index is key id */
+	TArray<FEntry> Entries;
+	TMap<FName, int32> KeyIds;
+	uint32 Version = 0;
+
+	/** Key names by peer key id, on receiver side */
+	TArray<FName> PeerKeys;
+};
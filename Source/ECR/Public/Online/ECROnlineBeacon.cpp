@@ -1,4 +1,5 @@
 ﻿#include "ECROnlineBeacon.h"
+#include "OnlineBeaconHostObject.h"
 
 DEFINE_LOG_CATEGORY(FBeaconLog);
 
@@ -7,6 +8,14 @@ AECROnlineBeacon::AECROnlineBeacon(const FObjectInitializer& ObjectInitializer)
 {
 	bClientGotFirstServerData = false;
 	DriverName = FName{TEXT("BeaconSession")};
+
+	ValuesUpdateInterval = 0.2f;
+	SentValuesVersion = 0;
+	NextValuesUpdateTime = 0.0;
+
+	/** Client sends its values from tick **/
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = true;
 }
 
 void AECROnlineBeacon::OnFailure()
@@ -28,7 +37,21 @@ FUniqueNetIdRepl AECROnlineBeacon::GetOwningPlayerId()
 /** The rpc client ping implementation */
 void AECROnlineBeacon::ClientPing_Implementation(const FString& RepServerData)
 {
-	OnReceivedUpdateFromServer.Broadcast(RepServerData, CachedPlayerId);
+	ServerData = RepServerData;
+	OnReceivedUpdateFromServer.Broadcast(ServerData, CachedPlayerId);
+}
+
+void AECROnlineBeacon::ClientPatchServerData_Implementation(const int32 Start, const int32 RemovedLength,
+                                                            const FString& Inserted)
+{
+	if (Start < 0 || RemovedLength < 0 || Start > ServerData.Len() - RemovedLength)
+	{
+		UE_LOG(FBeaconLog, Warning, TEXT("Received malformed server data patch"));
+		return;
+	}
+
+	ServerData = ServerData.Left(Start) + Inserted + ServerData.RightChop(Start + RemovedLength);
+	OnReceivedUpdateFromServer.Broadcast(ServerData, CachedPlayerId);
 }
 
 /** The rpc client ready implementation */
@@ -51,6 +74,7 @@ void AECROnlineBeacon::ServerPong_Implementation(const FString& Channel, const F
 	if (!bClientGotFirstServerData)
 	{
 		ClientPing(ServerData);
+		SentServerData = ServerData;
 		bClientGotFirstServerData = true;
 	}
 }
@@ -96,7 +120,156 @@ void AECROnlineBeacon::SetServerDataNoUpdate(FString NewServerData)
 void AECROnlineBeacon::SetServerDataAndUpdate(FString NewServerData)
 {
 	SetServerDataNoUpdate(NewServerData);
-	ClientPing(NewServerData);
+
+	// Client gets whole data with first communication
+	if (!bClientGotFirstServerData)
+	{
+		return;
+	}
+
+	// Only the part between common prefix and suffix is sent
+	const int32 MaxCommonLength = FMath::Min(SentServerData.Len(), ServerData.Len());
+	int32 PrefixLength = 0;
+	while (PrefixLength < MaxCommonLength && SentServerData[PrefixLength] == ServerData[PrefixLength])
+	{
+		PrefixLength++;
+	}
+
+	if (PrefixLength == SentServerData.Len() && PrefixLength == ServerData.Len())
+	{
+		return;
+	}
+
+	int32 SuffixLength = 0;
+	while (SuffixLength < MaxCommonLength - PrefixLength
+		&& SentServerData[SentServerData.Len() - 1 - SuffixLength] == ServerData[ServerData.Len() - 1 - SuffixLength])
+	{
+		SuffixLength++;
+	}
+
+	const int32 RemovedLength = SentServerData.Len() - PrefixLength - SuffixLength;
+	const int32 InsertedLength = ServerData.Len() - PrefixLength - SuffixLength;
+	if (InsertedLength * 2 < ServerData.Len())
+	{
+		ClientPatchServerData(PrefixLength, RemovedLength, ServerData.Mid(PrefixLength, InsertedLength));
+	}
+	else
+	{
+		ClientPing(ServerData);
+	}
+	SentServerData = ServerData;
+}
+
+void AECROnlineBeacon::SendServerValues(const FECRBeaconValueTable& NewServerValues)
+{
+	if (SentValuesVersion == NewServerValues.GetVersion())
+	{
+		return;
+	}
+
+	// Changes which didn't fit are sent with the next call
+	TArray<uint8> Delta;
+	SentValuesVersion = NewServerValues.WriteDelta(SentValuesVersion, PeerKnownKeys, Delta);
+	ClientReceiveServerValues(Delta);
+}
+
+void AECROnlineBeacon::SetClientValue(const FName Key, const FString& Value)
+{
+	ClientValues.SetValue(Key, Value);
+}
+
+void AECROnlineBeacon::RemoveClientValue(const FName Key)
+{
+	ClientValues.RemoveValue(Key);
+}
+
+bool AECROnlineBeacon::GetServerValue(const FName Key, FString& Value) const
+{
+	const FString* FoundValue = ServerValues.FindValue(Key);
+	Value = FoundValue ? *FoundValue : FString();
+	return FoundValue != nullptr;
+}
+
+bool AECROnlineBeacon::GetClientValue(const FName Key, FString& Value) const
+{
+	const FString* FoundValue = ClientValues.FindValue(Key);
+	Value = FoundValue ? *FoundValue : FString();
+	return FoundValue != nullptr;
+}
+
+void AECROnlineBeacon::ClientReceiveServerValues_Implementation(const TArray<uint8>& Delta)
+{
+	if (Delta.Num() > FECRBeaconValueTable::MaxDeltaSize)
+	{
+		UE_LOG(FBeaconLog, Warning, TEXT("Ignored server values of %d bytes"), Delta.Num());
+		return;
+	}
+
+	TArray<FName> ChangedKeys;
+	if (!ServerValues.ReadDelta(Delta, ChangedKeys))
+	{
+		UE_LOG(FBeaconLog, Warning, TEXT("Received malformed server values"));
+	}
+
+	if (ChangedKeys.Num() > 0)
+	{
+		OnReceivedValuesFromServer.Broadcast(ChangedKeys, CachedPlayerId);
+	}
+}
+
+void AECROnlineBeacon::ServerReceiveClientValues_Implementation(const TArray<uint8>& Delta)
+{
+	// Ignored rather than kicking the client
+	if (Delta.Num() > FECRBeaconValueTable::MaxDeltaSize)
+	{
+		UE_LOG(FBeaconLog, Warning, TEXT("Ignored client values of %d bytes"), Delta.Num());
+		return;
+	}
+
+	TArray<FName> ChangedKeys;
+	if (!ClientValues.ReadDelta(Delta, ChangedKeys))
+	{
+		UE_LOG(FBeaconLog, Warning, TEXT("Received malformed client values, disconnecting client"));
+		if (AOnlineBeaconHostObject* HostObject = GetBeaconOwner())
+		{
+			HostObject->DisconnectClient(this);
+		}
+		return;
+	}
+
+	if (ChangedKeys.Num() > 0)
+	{
+		OnReceivedValuesFromClient.Broadcast(ChangedKeys, GetOwningPlayerId());
+	}
+}
+
+void AECROnlineBeacon::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	// Server side beacon has owner, server sends its values from there for all clients at once
+	if (GetBeaconOwner())
+	{
+		SetActorTickEnabled(false);
+		return;
+	}
+
+	if (GetConnectionState() != EBeaconConnectionState::Open)
+	{
+		return;
+	}
+
+	const double Time = FPlatformTime::Seconds();
+	if (Time < NextValuesUpdateTime || SentValuesVersion == ClientValues.GetVersion())
+	{
+		return;
+	}
+
+	// Changes which didn't fit are sent after next interval
+	TArray<uint8> Delta;
+	SentValuesVersion = ClientValues.WriteDelta(SentValuesVersion, PeerKnownKeys, Delta);
+	NextValuesUpdateTime = Time + ValuesUpdateInterval;
+	ServerReceiveClientValues(Delta);
 }
 
 bool AECROnlineBeacon::InitBase()
@@ -2,6 +2,7 @@
 
 #include "CoreMinimal.h"
 #include "OnlineBeaconClient.h"
+#include "ECRBeaconValueTable.h"
 #include "ECROnlineBeacon.generated.h"
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnBeaconUpdateComplete, FString, JsonString, FUniqueNetIdRepl,
@@ -10,12 +11,21 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnBeaconUpdateComplete, FString, J
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnBeaconChannelUpdateComplete, FString, Channel, FString, JsonString,
                                                FUniqueNetIdRepl, UniqueNetId);
 
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnBeaconValuesUpdated, const TArray<FName>&, ChangedKeys,
+                                             FUniqueNetIdRepl, UniqueNetId);
+
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnBeaconFailure, FUniqueNetIdRepl, UniqueNetId);
 
 DECLARE_LOG_CATEGORY_EXTERN(FBeaconLog, Log, All);
 
 /**
  * Simple ping client beacon class
+ *
+ * Besides JSON strings, server and client can exchange key/value data, which is sent as binary deltas
+ * of values changed since previous update, at most once per ValuesUpdateInterval. Server data string is sent
+ * whole once, then as patches of the changed part.
+ *
+ * Server side beacons don't tick, host object sends server data and values for all of them.
  */
 UCLASS(Blueprintable, BlueprintType, transient, notplaceable, config = Engine)
 class AECROnlineBeacon : public AOnlineBeaconClient
@@ -36,6 +46,10 @@ public:
 	UFUNCTION(Client, Reliable)
 	virtual void ClientPing(const FString& RepServerData);
 
+	/** Replaces RemovedLength characters of server data at Start with Inserted */
+	UFUNCTION(Client, Reliable)
+	void ClientPatchServerData(int32 Start, int32 RemovedLength, const FString& Inserted);
+
 	/** Let's us know the beacon is ready so we can prep the initial start time for ping round trip */
 	UFUNCTION(Client, Reliable)
 	virtual void Ready();
@@ -58,6 +72,46 @@ public:
 	UFUNCTION(BlueprintAuthorityOnly, Category = "ECRBeacon|Server")
 	void SetServerDataAndUpdate(FString NewServerData);
 
+	/** Sends server values changed since previous call to the client */
+	void SendServerValues(const FECRBeaconValueTable& ServerValues);
+
+	/** Client sets value sent to server with next update */
+	UFUNCTION(BlueprintCallable, Category = "ECRBeacon|Client")
+	void SetClientValue(FName Key, const FString& Value);
+
+	UFUNCTION(BlueprintCallable, Category = "ECRBeacon|Client")
+	void RemoveClientValue(FName Key);
+
+	/** Value received from server */
+	UFUNCTION(BlueprintPure, Category = "ECRBeacon|Client")
+	bool GetServerValue(FName Key, FString& Value) const;
+
+	/** Value received from client */
+	UFUNCTION(BlueprintPure, Category = "ECRBeacon|Server")
+	bool GetClientValue(FName Key, FString& Value) const;
+
+	/** Delta of server values */
+	UFUNCTION(Client, Reliable)
+	void ClientReceiveServerValues(const TArray<uint8>& Delta);
+
+	/** Delta of client values, oversized ones are ignored */
+	UFUNCTION(Server, Reliable)
+	void ServerReceiveClientValues(const TArray<uint8>& Delta);
+
+	virtual void Tick(float DeltaSeconds) override;
+
+	/** Client received server values */
+	UPROPERTY(BlueprintAssignable, Category = "ECRBeacon|Client")
+	FOnBeaconValuesUpdated OnReceivedValuesFromServer;
+
+	/** Server received client values */
+	UPROPERTY(BlueprintAssignable, Category = "ECRBeacon|Server")
+	FOnBeaconValuesUpdated OnReceivedValuesFromClient;
+
+	/** Min interval between sending client values to server */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "ECRBeacon|Client")
+	float ValuesUpdateInterval;
+
 	/** Client received update from server */
 	UPROPERTY(BlueprintAssignable, Category = "ECRBeacon|Client")
 	FOnBeaconUpdateComplete OnReceivedUpdateFromServer;
@@ -79,9 +133,13 @@ private:
 	UPROPERTY(BlueprintReadWrite, meta=(AllowPrivateAccess, ExposeOnSpawn))
 	FString InitCallChannel;
 
+	/** Server: data to send to the client. Client: data received from server */
 	UPROPERTY(BlueprintReadWrite, meta=(AllowPrivateAccess))
 	FString ServerData;
 
+	/** Server: data the client has, patches are computed against it */
+	FString SentServerData;
+
 	UPROPERTY(BlueprintReadOnly, meta=(AllowPrivateAccess))
 	FUniqueNetIdRepl CachedPlayerId;
 
@@ -90,4 +148,18 @@ private:
 
 	UPROPERTY(BlueprintReadOnly, meta=(AllowPrivateAccess, ExposeOnSpawn))
 	FName DriverName;
+
+	/** Client: values set locally. Server: values received from client */
+	FECRBeaconValueTable ClientValues;
+
+	/** Client: values received from server */
+	FECRBeaconValueTable ServerValues;
+
+	/** Version of values whose changes were sent to the peer */
+	uint32 SentValuesVersion;
+
+	/** Keys whose names were sent to the peer */
+	TBitArray<> PeerKnownKeys;
+
+	double NextValuesUpdateTime;
 };
@@ -13,6 +13,10 @@ AECROnlineBeaconHostObject::AECROnlineBeaconHostObject(const FObjectInitializer&
 	PrimaryActorTick.bCanEverTick = true;
 	PrimaryActorTick.bAllowTickOnDedicatedServer = true;
 	PrimaryActorTick.bStartWithTickEnabled = true;
+
+	UpdateInterval = 0.2f;
+	bServerDataDirty = false;
+	NextUpdateTime = 0.0;
 }
 
 bool AECROnlineBeaconHostObject::Init()
@@ -21,18 +25,57 @@ bool AECROnlineBeaconHostObject::Init()
 	return true;
 }
 
+void AECROnlineBeaconHostObject::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	// Changes made since previous update are sent together, one RPC per client
+	const double Time = FPlatformTime::Seconds();
+	if (Time < NextUpdateTime)
+	{
+		return;
+	}
+	NextUpdateTime = Time + UpdateInterval;
+
+	for (AECROnlineBeacon* Beacon : ConnectedClients)
+	{
+		if (Beacon)
+		{
+			if (bServerDataDirty)
+			{
+				Beacon->SetServerDataAndUpdate(ServerData);
+			}
+			Beacon->SendServerValues(ServerValues);
+		}
+	}
+	bServerDataDirty = false;
+}
+
 void AECROnlineBeaconHostObject::UpdateServerData(FString NewData)
 {
+	bServerDataDirty |= !ServerData.Equals(NewData, ESearchCase::CaseSensitive);
 	ServerData = NewData;
+
+	// Clients that connect meanwhile get it with first data
 	for (AECROnlineBeacon* Beacon : ConnectedClients)
 	{
 		if (Beacon)
 		{
-			Beacon->SetServerDataAndUpdate(NewData);
+			Beacon->SetServerDataNoUpdate(NewData);
 		}
 	}
 }
 
+void AECROnlineBeaconHostObject::SetServerValue(const FName Key, const FString& Value)
+{
+	ServerValues.SetValue(Key, Value);
+}
+
+void AECROnlineBeaconHostObject::RemoveServerValue(const FName Key)
+{
+	ServerValues.RemoveValue(Key);
+}
+
 void AECROnlineBeaconHostObject::DisconnectClientBeacon(FUniqueNetIdRepl PlayerId)
 {
 	for (AECROnlineBeacon* Client : ConnectedClients)
@@ -49,6 +92,11 @@ void AECROnlineBeaconHostObject::OnReceivedUpdateFromClient(FString Channel, FSt
 	OnReceivedUpdateFromClient_BP.Broadcast(Channel, JsonString, UniqueNetId);
 }
 
+void AECROnlineBeaconHostObject::OnReceivedValuesFromClient(const TArray<FName>& ChangedKeys, FUniqueNetIdRepl UniqueNetId)
+{
+	OnReceivedValuesFromClient_BP.Broadcast(ChangedKeys, UniqueNetId);
+}
+
 void AECROnlineBeaconHostObject::OnClientConnected(AOnlineBeaconClient* NewClientActor,
                                                    UNetConnection* ClientConnection)
 {
@@ -62,6 +110,8 @@ void AECROnlineBeaconHostObject::OnClientConnected(AOnlineBeaconClient* NewClien
 		BeaconClient->SetServerDataNoUpdate(ServerData);
 		BeaconClient->OnReceivedUpdateFromClient.AddDynamic(
 			this, &AECROnlineBeaconHostObject::OnReceivedUpdateFromClient);
+		BeaconClient->OnReceivedValuesFromClient.AddDynamic(
+			this, &AECROnlineBeaconHostObject::OnReceivedValuesFromClient);
 		BeaconClient->Ready();
 		ConnectedClients.Add(BeaconClient);
 	}
@@ -81,6 +131,12 @@ void AECROnlineBeaconHostObject::NotifyClientDisconnected(AOnlineBeaconClient* L
 
 AOnlineBeaconClient* AECROnlineBeaconHostObject::SpawnBeaconActor(UNetConnection* ClientConnection)
 {
-	//Just super for now, technically you can return NULL here as well to prevent spawning
-	return Super::SpawnBeaconActor(ClientConnection);
+	AOnlineBeaconClient* BeaconActor = Super::SpawnBeaconActor(ClientConnection);
+
+	// Server side beacons only answer RPCs, this object sends updates for all of them
+	if (BeaconActor)
+	{
+		BeaconActor->SetActorTickEnabled(false);
+	}
+	return BeaconActor;
 }
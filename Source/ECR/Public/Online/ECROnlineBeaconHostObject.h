@@ -24,10 +24,23 @@ class AECROnlineBeaconHostObject : public AOnlineBeaconHostObject
 	/** In case you ever want to do other things */
 	virtual bool Init();
 
-	/** Updates server data for connected clients */
+	virtual void Tick(float DeltaSeconds) override;
+
+	/** Updates server data for connected clients, sent with next update */
 	UFUNCTION(BlueprintCallable)
 	void UpdateServerData(FString NewData);
 
+	/** Sets value sent to connected clients with next update, only changed values are sent */
+	UFUNCTION(BlueprintCallable, Category = "ECRBeacon|Server")
+	void SetServerValue(FName Key, const FString& Value);
+
+	UFUNCTION(BlueprintCallable, Category = "ECRBeacon|Server")
+	void RemoveServerValue(FName Key);
+
+	/** Min interval between updates sent to clients */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "ECRBeacon|Server")
+	float UpdateInterval;
+
 	UFUNCTION(BlueprintCallable)
 	void DisconnectClientBeacon(FUniqueNetIdRepl PlayerId);
 
@@ -39,13 +52,27 @@ class AECROnlineBeaconHostObject : public AOnlineBeaconHostObject
 	UPROPERTY(BlueprintAssignable, Category = "ECRBeacon|Server")
 	FOnBeaconChannelUpdateComplete OnReceivedUpdateFromClient_BP;
 
+	/** Server received values from client */
+	UPROPERTY(BlueprintAssignable, Category = "ECRBeacon|Server")
+	FOnBeaconValuesUpdated OnReceivedValuesFromClient_BP;
+
 	UFUNCTION()
 	void OnReceivedUpdateFromClient(FString Channel, FString JsonString, FUniqueNetIdRepl UniqueNetId);
 
+	UFUNCTION()
+	void OnReceivedValuesFromClient(const TArray<FName>& ChangedKeys, FUniqueNetIdRepl UniqueNetId);
+
 private:
 	UPROPERTY(BlueprintReadOnly, meta=(AllowPrivateAccess))
 	TArray<AECROnlineBeacon*> ConnectedClients;
 
 	UPROPERTY(BlueprintReadOnly, meta=(AllowPrivateAccess))
 	FString ServerData;
+
+	/** Whether ServerData changed since previous update */
+	bool bServerDataDirty;
+
+	FECRBeaconValueTable ServerValues;
+
+	double NextUpdateTime;
 };
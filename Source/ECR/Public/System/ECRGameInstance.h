@@ -230,6 +230,9 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void UpdateSessionDayTime(FName NewDayTime);
 
+	/** Faction alliances of the current match, factions of one alliance are allies */
+	const TArray<FFactionAlliance>& GetMatchAlliances() const { return MatchCreationSettings.Alliances; }
+
 	/** Leave match */
 	UFUNCTION(BlueprintCallable)
 	void DestroySession();
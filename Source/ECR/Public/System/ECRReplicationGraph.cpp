@@ -27,6 +27,12 @@
 *		This is the spatialization node. All "distance based relevant" actors will be routed here. This node divides the map into a 2D grid. Each cell in the grid contains 
 *		children nodes that hold lists of actors based on how they update/go dormant. Actors are put in multiple cells. Connections pull from the single cell they are in.
 *		
+*		When one cell of the grid gets crowded (ECR.RepGraph.HotCell.ActorThreshold dynamic actors), dynamic actors with small enough cull distance in it are
+*		moved to a second grid node with smaller cells (ECR.RepGraph.HotCell.CellSize), so that connections in the crowd gather less actors which would be
+*		culled by distance anyway. They are moved back once the cell cools down. Cell counts are updated incrementally, only actors which changed
+*		cell or whose cell got hot or cooled down are reevaluated. If SpatialGridBounds are set, the grids are limited to them and never rebuilt,
+*		otherwise only dynamic actors leaving the grid can trigger a rebuild (ECR.RepGraph.DisableSpatialRebuilds), static and dormant ones are clamped.
+*		
 *		UReplicationGraphNode_ActorList
 *		This is an actor list node that contains the always relevant actors. These actors are always relevant to every connection.
 *		
@@ -35,6 +41,16 @@
 *		these actors are all easily accessed from the PlayerController. A persistent list would require notifications to be broadcast when these actors change, which would be possible
 *		but currently not necessary.
 *
+*		UECRReplicationGraphNode_Teams
+*		Global node which each frame sorts pawns into per faction lists of all pawns, objective carriers and squads, based on AECRPlayerState faction data.
+*		It doesn't gather anything by itself, the lists are shared by connection specific team relevancy nodes.
+*
+*		UECRReplicationGraphNode_TeamRelevancy_ForConnection
+*		Connection specific node which returns squad mates and objective carriers of viewer's alliance regardless of spatial grid, once per
+*		ECR.RepGraph.Team.RelevancyPeriodFrames frames (staggered across connections). It also sets connection cull distances of pawns depending
+*		on whether they are allies (ECR.RepGraph.Team.AllyCullDistance) or enemies (ECR.RepGraph.Team.EnemyCullDistance). Factions of one
+*		match alliance are allies, relationships are cached per connection and only lists which changed are reapplied.
+*
 *		UReplicationGraphNode_TearOff_ForConnection
 *		Connection specific node for handling tear off actors. This is created and managed in the base implementation of Replication Graph.
 *		
@@ -60,6 +76,24 @@
 *		Net.RepGraph.PrintAllActorInfo <ActorMatchString> - will print the class, global, and connection replication info associated with an actor/class. If MatchString is empty will print everything. Call directly from client.
 *		
 *		ECR.RepGraph.PrintRouting - will print the EClassRepNodeMapping for each class. That is, how a given actor class is routed (or not) in the Replication Graph.
+*
+*	FastShared Path
+*
+*		When enabled (bEnableFastSharedPath or "fastshared=1"), simulated proxy movement of AECRCharacter is sent via FastSharedMovementReplication on frames when
+*		default property replication of the pawn is skipped. The movement bunch is serialized once per frame per pawn and the same bunch is sent to every relevant
+*		connection, limited by ECR.RepGraph.TargetKBytesSecFastSharedPath and only within ECR.RepGraph.FastSharedPathCullDistPct of the cull distance.
+*
+*		To compare it against the default path, run the same scenario with "fastshared=0" and "fastshared=1" and use:
+*		"ECR.RepGraph.PrintFastSharedStats [reset]" - average ServerReplicateActors time, FastShared updates per frame and current outgoing bandwidth.
+*		"stat ECRRepGraph" and CSV profiles, where AECRCharacter replication time and bits are tracked as their own class.
+*
+*	Profiling
+*
+*		"ECR.RepGraph.Profile.Enabled 1" records gather time and gathered actors per node, actors gathered and replicated per class and bits sent per connection.
+*		"ECR.RepGraph.Profile [csv] [reset]" prints the averages per frame or exports them to Saved/Profiling/RepGraph. "ECR.RepGraph.Profile.Overlay 1" shows them
+*		on screen of a listen server only: on dedicated server, where replication graph runs, the log and CSV export are the output. Replicated actors are
+*		counted once per ECR.RepGraph.Profile.ReplicatedSamplePeriod frames, as it walks actor infos of every connection. Node gathers are also visible as Insights trace events, frame totals are in the ECRRepGraph CSV category, and bits per class are in
+*		CSV profiles for AECRCharacter and every class from ClassSettings.
 *	
 */
 
@@ -82,12 +116,21 @@
 #include "Engine/NetConnection.h"
 #include "UObject/UObjectIterator.h"
 
+#include "AbilitySystemComponent.h"
+#include "AbilitySystemGlobals.h"
+#include "ECRGameInstance.h"
 #include "ECRReplicationGraphSettings.h"
+#include "Gameplay/ECRGameplayTags.h"
 #include "Gameplay/Character/ECRCharacter.h"
 #include "Gameplay/Player/ECRPlayerController.h"
+#include "Gameplay/Player/ECRPlayerState.h"
 
 DEFINE_LOG_CATEGORY(LogECRRepGraph);
 
+DECLARE_STATS_GROUP(TEXT("ECRRepGraph"), STATGROUP_ECRRepGraph, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("ServerReplicateActors"), STAT_ECRRepGraph_ServerReplicateActors, STATGROUP_ECRRepGraph);
+DECLARE_DWORD_COUNTER_STAT(TEXT("FastShared Updates"), STAT_ECRRepGraph_FastSharedUpdates, STATGROUP_ECRRepGraph);
+
 namespace ECR::RepGraph
 {
 	float DestructionInfoMaxDist = 30000.f;
@@ -122,6 +165,30 @@ namespace ECR::RepGraph
 	static FAutoConsoleVariableRef CVarECRRepDisableSpatialRebuilds(
 		TEXT("ECR.RepGraph.DisableSpatialRebuilds"), DisableSpatialRebuilds, TEXT(""), ECVF_Default);
 
+	// Actors are added to every cell within their cull distance: with 5000 cells and 10000 max cull distance it's 25 cells
+	// per actor, smaller cells would multiply the cost of every move of crowd actors
+	float HotCellSize = 5000.f;
+	static FAutoConsoleVariableRef CVarECRRepHotCellSize(
+		TEXT("ECR.RepGraph.HotCell.CellSize"), HotCellSize, TEXT("Cell size of the grid used for crowded cells, applied on grid creation"), ECVF_Default);
+
+	// Amount of dynamic actors in a main grid cell which makes it hot. Cell cools down when amount drops below 3/4 of it
+	int32 HotCellActorThreshold = 24;
+	static FAutoConsoleVariableRef CVarECRRepHotCellActorThreshold(
+		TEXT("ECR.RepGraph.HotCell.ActorThreshold"), HotCellActorThreshold, TEXT(""), ECVF_Default);
+
+	float HotCellMaxCullDistance = 10000.f;
+	static FAutoConsoleVariableRef CVarECRRepHotCellMaxCullDistance(
+		TEXT("ECR.RepGraph.HotCell.MaxCullDistance"), HotCellMaxCullDistance, TEXT(""), ECVF_Default);
+
+	int32 HotCellCheckPeriodFrames = 15;
+	static FAutoConsoleVariableRef CVarECRRepHotCellCheckPeriodFrames(
+		TEXT("ECR.RepGraph.HotCell.CheckPeriodFrames"), HotCellCheckPeriodFrames, TEXT(""), ECVF_Default);
+
+	// Limits how many actors are moved between grids per check, so that a crowd forming doesn't cause a hitch
+	int32 HotCellMaxMigrationsPerCheck = 32;
+	static FAutoConsoleVariableRef CVarECRRepHotCellMaxMigrationsPerCheck(
+		TEXT("ECR.RepGraph.HotCell.MaxMigrationsPerCheck"), HotCellMaxMigrationsPerCheck, TEXT(""), ECVF_Default);
+
 	int32 LogLazyInitClasses = 0;
 	static FAutoConsoleVariableRef CVarECRRepLogLazyInitClasses(
 		TEXT("ECR.RepGraph.LogLazyInitClasses"), LogLazyInitClasses, TEXT(""), ECVF_Default);
@@ -135,6 +202,31 @@ namespace ECR::RepGraph
 	static FAutoConsoleVariableRef CVarECRRepFastSharedPathCullDistPct(
 		TEXT("ECR.RepGraph.FastSharedPathCullDistPct"), FastSharedPathCullDistPct, TEXT(""), ECVF_Default);
 
+	// Squad mates and same faction objective carriers are gathered for a connection once per this amount of frames,
+	// limited to be below ActorChannelFrameTimeout of characters, so that their channels aren't closed between gathers
+	int32 TeamRelevancyPeriodFrames = 4;
+	static FAutoConsoleVariableRef CVarECRRepTeamRelevancyPeriodFrames(
+		TEXT("ECR.RepGraph.Team.RelevancyPeriodFrames"), TeamRelevancyPeriodFrames, TEXT(""), ECVF_Default);
+
+	// Cull distance of pawns of viewer's faction and its alliance, 0 means class cull distance
+	float TeamAllyCullDistance = 45000.f;
+	static FAutoConsoleVariableRef CVarECRRepTeamAllyCullDistance(
+		TEXT("ECR.RepGraph.Team.AllyCullDistance"), TeamAllyCullDistance, TEXT(""), ECVF_Default);
+
+	// Cull distance of pawns of enemy factions, 0 means class cull distance
+	float TeamEnemyCullDistance = 0.f;
+	static FAutoConsoleVariableRef CVarECRRepTeamEnemyCullDistance(
+		TEXT("ECR.RepGraph.Team.EnemyCullDistance"), TeamEnemyCullDistance, TEXT(""), ECVF_Default);
+
+	// FastShared bandwidth is spent on every server frame, so the cap is split by the tick rate server actually runs at
+	int32 GetFastSharedPathMaxBitsPerFrame(const UNetDriver* NetDriver, const int32 AssumedTickRate)
+	{
+		const float TickRate = (NetDriver && NetDriver->NetServerMaxTickRate > 0)
+			                       ? NetDriver->NetServerMaxTickRate
+			                       : FMath::Max(AssumedTickRate, 1);
+		return (int32)((float)(TargetKBytesSecFastSharedPath * 1024 * 8) / TickRate);
+	}
+
 	UReplicationDriver* ConditionalCreateReplicationDriver(UNetDriver* ForNetDriver, UWorld* World)
 	{
 		// Only create for GameNetDriver
@@ -201,6 +293,13 @@ void UECRReplicationGraph::ResetGameWorldState()
 	Super::ResetGameWorldState();
 
 	AlwaysRelevantStreamingLevelActors.Empty();
+	DynamicSpatializedActors.Empty();
+	HotCellGridActors.Empty();
+	HotCells.Empty();
+	CellActorCounts.Empty();
+	DynamicActorCells.Empty();
+	PendingHotCellMigrations.Empty();
+	ChangedCells.Empty();
 
 	for (UNetReplicationGraphConnection* ConnManager : Connections)
 	{
@@ -287,6 +386,16 @@ void UECRReplicationGraph::RegisterClassRepNodeMapping(UClass* Class)
 {
 	EClassRepNodeMapping Mapping = GetClassNodeMapping(Class);
 	ClassRepNodePolicies.Set(Class, Mapping);
+
+	// Lazily initialized classes (blueprints) are mapped after grids were configured
+	if (GridNode)
+	{
+		AddToGridRebuildDenyList(GridNode, Class, Mapping);
+	}
+	if (HotCellGridNode)
+	{
+		AddToGridRebuildDenyList(HotCellGridNode, Class, Mapping);
+	}
 }
 
 void UECRReplicationGraph::InitClassReplicationInfo(FClassReplicationInfo& Info, UClass* Class, bool Spatialize) const
@@ -486,7 +595,9 @@ void UECRReplicationGraph::InitGlobalActorClassSettings()
 	FClassReplicationInfo CharacterClassRepInfo;
 	CharacterClassRepInfo.DistancePriorityScale = 1.f;
 	CharacterClassRepInfo.StarvationPriorityScale = 1.f;
-	CharacterClassRepInfo.ActorChannelFrameTimeout = 4;
+	// Team relevancy gathers allies once per period, their channels have to outlive it
+	CharacterChannelFrameTimeout = FMath::Max(4, ECR::RepGraph::TeamRelevancyPeriodFrames + 2);
+	CharacterClassRepInfo.ActorChannelFrameTimeout = CharacterChannelFrameTimeout;
 	CharacterClassRepInfo.SetCullDistanceSquared(
 		AECRCharacter::StaticClass()->GetDefaultObject<AECRCharacter>()->NetCullDistanceSquared);
 
@@ -524,25 +635,43 @@ void UECRReplicationGraph::InitGlobalActorClassSettings()
 	{
 		UE_LOG(LogECRRepGraph, Display, TEXT("Enabling fast shared replication"));
 
-		CharacterClassRepInfo.FastSharedReplicationFunc = [](AActor* Actor)
+		CharacterClassRepInfo.FastSharedReplicationFunc = [this](AActor* Actor)
 		{
 			bool bSuccess = false;
 			if (AECRCharacter* Character = Cast<AECRCharacter>(Actor))
 			{
 				bSuccess = Character->UpdateSharedReplication();
 			}
+
+			if (bSuccess)
+			{
+				FastSharedPathStats.FastSharedUpdates++;
+				INC_DWORD_STAT(STAT_ECRRepGraph_FastSharedUpdates);
+			}
 			return bSuccess;
 		};
 
-		CharacterClassRepInfo.FastSharedReplicationFuncName = FName(TEXT("FastSharedReplication"));
+		CharacterClassRepInfo.FastSharedReplicationFuncName = FName(TEXT("FastSharedMovementReplication"));
 	}
+	bFastSharedPathEnabled = bEnableFastSharedPath;
 
-	FastSharedPathConstants.MaxBitsPerFrame = (int32)((float)(ECR::RepGraph::TargetKBytesSecFastSharedPath * 1024 * 8) /
-		AssumedTickRate);
+	FastSharedPathConstants.MaxBitsPerFrame = ECR::RepGraph::GetFastSharedPathMaxBitsPerFrame(NetDriver, AssumedTickRate);
 	FastSharedPathConstants.DistanceRequirementPct = ECR::RepGraph::FastSharedPathCullDistPct;
 
 	SetClassInfo(AECRCharacter::StaticClass(), CharacterClassRepInfo);
 
+	// Track characters separately in CSV profiles, so that time and bits spent on them can be compared with and without FastShared path
+	CSVTracker.SetExplicitClassTracking(AECRCharacter::StaticClass(), FName(TEXT("ECRCharacter")));
+
+	// Classes with custom settings are tracked as well, so that bits per class are visible in CSV profiles when tuning them
+	for (const FRepGraphActorClassSettings& ActorClassSettings : ECRRepGraphSettings->ClassSettings)
+	{
+		if (UClass* StaticActorClass = ActorClassSettings.GetStaticActorClass())
+		{
+			CSVTracker.SetExplicitClassTracking(StaticActorClass, StaticActorClass->GetFName());
+		}
+	}
+
 	// ---------------------------------------------------------------------
 	UReplicationGraphNode_ActorListFrequencyBuckets::DefaultSettings.ListSize = 12;
 	UReplicationGraphNode_ActorListFrequencyBuckets::DefaultSettings.NumBuckets =
@@ -570,8 +699,7 @@ void UECRReplicationGraph::InitGlobalActorClassSettings()
 	Zones_NoFastShared.Emplace(   1.00f, 0.20f, 0.75f,  20.f,      15.f,               0.f,        0.f,          AssumedTickRate);	// Directly in viewer's FOV
 	Settings.ZoneSettings_NonFastSharedActors = Zones_NoFastShared;
 
-	Settings.MaxBitsPerFrame = (int32)((float)(ECR::RepGraph::TargetKBytesSecFastSharedPath * 1024 * 8) /
-		NetDriver->NetServerMaxTickRate);
+	Settings.MaxBitsPerFrame = ECR::RepGraph::GetFastSharedPathMaxBitsPerFrame(NetDriver, AssumedTickRate);
 
 	// Apply globally before creating any DSF nodes
 	UReplicationGraphNode_DynamicSpatialFrequency::DefaultSettings = Settings;
@@ -654,10 +782,6 @@ void UECRReplicationGraph::InitGlobalGraphNodes()
 	//	Spatial Actors
 	// -----------------------------------------------
 
-	GridNode = CreateNewNode<UReplicationGraphNode_GridSpatialization2D>();
-	GridNode->CellSize = ECR::RepGraph::CellSize;
-	GridNode->SpatialBias = FVector2D(ECR::RepGraph::SpatialBiasX, ECR::RepGraph::SpatialBiasY);
-
 	const UECRReplicationGraphSettings* ECRRepGraphSettings = GetDefault<UECRReplicationGraphSettings>();
 
 	// If using dynamic spatial frequency, set its node as grid cell dynamic node
@@ -677,8 +801,49 @@ void UECRReplicationGraph::InitGlobalGraphNodes()
 	if (bEnableDynamicSpatializationFrequency)
 	{
 		UE_LOG(LogECRRepGraph, Display, TEXT("Enabling dynamic spatialization frequency"));
+	}
+
+	GridNode = CreateNewNode<UECRReplicationGraphNode_GridSpatialization2D>();
+	ConfigureGridNode(GridNode, ECR::RepGraph::CellSize, bEnableDynamicSpatializationFrequency);
+	AddGlobalGraphNode(GridNode);
+
+	// Crowded cells of the main grid are served by a finer grid, so that connections in a crowd don't gather actors which would be culled anyway
+	if (ECRRepGraphSettings && ECRRepGraphSettings->bEnableHotCellGrid && ECR::RepGraph::HotCellSize > 0.f
+		&& ECR::RepGraph::HotCellSize < ECR::RepGraph::CellSize)
+	{
+		HotCellGridNode = CreateNewNode<UECRReplicationGraphNode_GridSpatialization2D>();
+		ConfigureGridNode(HotCellGridNode, ECR::RepGraph::HotCellSize, bEnableDynamicSpatializationFrequency);
+		AddGlobalGraphNode(HotCellGridNode);
+	}
 
-		GridNode->CreateCellNodeOverride = [](
+	// -----------------------------------------------
+	//	Always Relevant (to everyone) Actors
+	// -----------------------------------------------
+	AlwaysRelevantNode = CreateNewNode<UReplicationGraphNode_ActorList>();
+	AddGlobalGraphNode(AlwaysRelevantNode);
+
+	PlayerStatesNode = CreateNewNode<UReplicationGraphNode_ActorListFrequencyBuckets>();
+	AddGlobalGraphNode(PlayerStatesNode);
+
+	// -----------------------------------------------
+	//	Team Relevancy
+	// -----------------------------------------------
+	if (ECRRepGraphSettings && ECRRepGraphSettings->bEnableTeamRelevancy)
+	{
+		TeamsNode = CreateNewNode<UECRReplicationGraphNode_Teams>();
+		AddGlobalGraphNode(TeamsNode);
+	}
+}
+
+void UECRReplicationGraph::ConfigureGridNode(UReplicationGraphNode_GridSpatialization2D* Node, float InCellSize,
+                                             bool bEnableDynamicSpatializationFrequency)
+{
+	Node->CellSize = InCellSize;
+	Node->SpatialBias = FVector2D(ECR::RepGraph::SpatialBiasX, ECR::RepGraph::SpatialBiasY);
+
+	if (bEnableDynamicSpatializationFrequency)
+	{
+		Node->CreateCellNodeOverride = [](
 			UReplicationGraphNode_GridSpatialization2D* Parent) -> UReplicationGraphNode_GridCell*
 			{
 				// Parent is the cell node; create a DSF node as its child
@@ -693,21 +858,160 @@ void UECRReplicationGraph::InitGlobalGraphNodes()
 			};
 	}
 
-	if (ECR::RepGraph::DisableSpatialRebuilds)
+	const UECRReplicationGraphSettings* ECRRepGraphSettings = GetDefault<UECRReplicationGraphSettings>();
+	if (ECRRepGraphSettings && ECRRepGraphSettings->SpatialGridBounds.IsValid)
 	{
-		GridNode->AddToClassRebuildDenyList(AActor::StaticClass()); // Disable All spatial rebuilding
+		// Known bounds: actors outside are clamped, so grid never needs to be rebuilt
+		Node->SetBiasAndGridBounds(ECRRepGraphSettings->SpatialGridBounds);
 	}
+	else
+	{
+		for (auto It = ClassRepNodePolicies.CreateIterator(); It; ++It)
+		{
+			if (UClass* Class = Cast<UClass>(It.Key().ResolveObjectPtr()))
+			{
+				AddToGridRebuildDenyList(Node, Class, It.Value());
+			}
+		}
+	}
+}
 
-	AddGlobalGraphNode(GridNode);
+void UECRReplicationGraph::AddToGridRebuildDenyList(UReplicationGraphNode_GridSpatialization2D* Node, UClass* Class,
+                                                     EClassRepNodeMapping Mapping) const
+{
+	// Known bounds: actors outside are clamped, so grid never needs to be rebuilt
+	const UECRReplicationGraphSettings* ECRRepGraphSettings = GetDefault<UECRReplicationGraphSettings>();
+	if ((ECRRepGraphSettings && ECRRepGraphSettings->SpatialGridBounds.IsValid) || !ECR::RepGraph::DisableSpatialRebuilds)
+	{
+		return;
+	}
 
-	// -----------------------------------------------
-	//	Always Relevant (to everyone) Actors
-	// -----------------------------------------------
-	AlwaysRelevantNode = CreateNewNode<UReplicationGraphNode_ActorList>();
-	AddGlobalGraphNode(AlwaysRelevantNode);
+	// Actors which don't move (or move only while awake) are clamped to the grid border instead of rebuilding the whole grid.
+	// Only dynamic actors leaving the grid extend it, which happens a few times per map at most
+	if (Mapping == EClassRepNodeMapping::Spatialize_Static || Mapping == EClassRepNodeMapping::Spatialize_Dormancy)
+	{
+		Node->AddToClassRebuildDenyList(Class);
+	}
+}
 
-	PlayerStatesNode = CreateNewNode<UReplicationGraphNode_ActorListFrequencyBuckets>();
-	AddGlobalGraphNode(PlayerStatesNode);
+void UECRReplicationGraph::UpdateHotCells()
+{
+	if (!HotCellGridNode || ECR::RepGraph::HotCellActorThreshold <= 0)
+	{
+		return;
+	}
+
+	const uint32 PeriodFrames = (uint32)FMath::Max(ECR::RepGraph::HotCellCheckPeriodFrames, 1);
+	if (GetReplicationGraphFrame() % PeriodFrames != 0)
+	{
+		return;
+	}
+
+	const float MainCellSize = GridNode->CellSize;
+	const FVector2D MainSpatialBias = GridNode->SpatialBias;
+	auto GetMainCell = [MainCellSize, MainSpatialBias](const FVector& Location)
+	{
+		return FIntPoint(FMath::FloorToInt((Location.X - MainSpatialBias.X) / MainCellSize),
+		                 FMath::FloorToInt((Location.Y - MainSpatialBias.Y) / MainCellSize));
+	};
+
+	// Counts are updated incrementally, only actors which changed main cell are moved between cell counts.
+	// Cells of removed actors are already in changed cells
+	for (FActorRepListType Actor : DynamicSpatializedActors)
+	{
+		const FIntPoint Cell = GetMainCell(GlobalActorReplicationInfoMap.Get(Actor).WorldLocation);
+		FIntPoint* LastCell = DynamicActorCells.Find(Actor);
+		if (LastCell && *LastCell == Cell)
+		{
+			continue;
+		}
+
+		if (LastCell)
+		{
+			CellActorCounts.FindChecked(*LastCell)--;
+			ChangedCells.Add(*LastCell);
+			*LastCell = Cell;
+		}
+		else
+		{
+			DynamicActorCells.Add(Actor, Cell);
+		}
+		CellActorCounts.FindOrAdd(Cell)++;
+		ChangedCells.Add(Cell);
+		PendingHotCellMigrations.Add(Actor);
+	}
+
+	// Hysteresis, so that cells on the edge of threshold don't move actors back and forth
+	const int32 CoolDownThreshold = ECR::RepGraph::HotCellActorThreshold * 3 / 4;
+	FlippedCells.Reset();
+	for (const FIntPoint& Cell : ChangedCells)
+	{
+		const int32 Count = CellActorCounts.FindChecked(Cell);
+		const bool bWasHot = HotCells.Contains(Cell);
+		if (bWasHot && Count < CoolDownThreshold)
+		{
+			HotCells.Remove(Cell);
+			FlippedCells.Add(Cell);
+		}
+		else if (!bWasHot && Count >= ECR::RepGraph::HotCellActorThreshold)
+		{
+			HotCells.Add(Cell);
+			FlippedCells.Add(Cell);
+		}
+
+		if (Count == 0)
+		{
+			CellActorCounts.Remove(Cell);
+		}
+	}
+	ChangedCells.Reset();
+
+	// Actors which stayed in a cell whose state flipped need migration as well
+	if (FlippedCells.Num() > 0)
+	{
+		for (const TPair<FActorRepListType, FIntPoint>& ActorCell : DynamicActorCells)
+		{
+			if (FlippedCells.Contains(ActorCell.Value))
+			{
+				PendingHotCellMigrations.Add(ActorCell.Key);
+			}
+		}
+	}
+
+	// Migrations over the limit stay pending until the next checks
+	const float MaxCullDistanceSquared = FMath::Square(ECR::RepGraph::HotCellMaxCullDistance);
+	int32 MigrationsLeft = ECR::RepGraph::HotCellMaxMigrationsPerCheck;
+
+	for (auto It = PendingHotCellMigrations.CreateIterator(); It && MigrationsLeft > 0; ++It)
+	{
+		const FActorRepListType Actor = *It;
+		It.RemoveCurrent();
+
+		FGlobalActorReplicationInfo& GlobalInfo = GlobalActorReplicationInfoMap.Get(Actor);
+		const bool bWantsHotCellGrid = HotCells.Contains(DynamicActorCells.FindChecked(Actor))
+			&& GlobalInfo.Settings.GetCullDistanceSquared() <= MaxCullDistanceSquared;
+		const bool bInHotCellGrid = HotCellGridActors.Contains(Actor);
+
+		if (bWantsHotCellGrid == bInHotCellGrid)
+		{
+			continue;
+		}
+
+		const FNewReplicatedActorInfo ActorInfo(Actor);
+		if (bWantsHotCellGrid)
+		{
+			GridNode->RemoveActor_Dynamic(ActorInfo);
+			HotCellGridNode->AddActor_Dynamic(ActorInfo, GlobalInfo);
+			HotCellGridActors.Add(Actor);
+		}
+		else
+		{
+			HotCellGridNode->RemoveActor_Dynamic(ActorInfo);
+			GridNode->AddActor_Dynamic(ActorInfo, GlobalInfo);
+			HotCellGridActors.Remove(Actor);
+		}
+		MigrationsLeft--;
+	}
 }
 
 void UECRReplicationGraph::InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection)
@@ -724,6 +1028,38 @@ void UECRReplicationGraph::InitConnectionGraphNodes(UNetReplicationGraphConnecti
 	                                                              &UECRReplicationGraphNode_AlwaysRelevant_ForConnection::OnClientLevelVisibilityRemove);
 
 	AddConnectionGraphNode(AlwaysRelevantConnectionNode, RepGraphConnection);
+
+	if (TeamsNode)
+	{
+		UECRReplicationGraphNode_TeamRelevancy_ForConnection* TeamRelevancyConnectionNode = CreateNewNode<
+			UECRReplicationGraphNode_TeamRelevancy_ForConnection>();
+		AddConnectionGraphNode(TeamRelevancyConnectionNode, RepGraphConnection);
+	}
+}
+
+int32 UECRReplicationGraph::ServerReplicateActors(float DeltaSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ECRRepGraph_ServerReplicateActors);
+
+	UpdateHotCells();
+
+	// Super advances replication frame, actors replicated this frame are marked with the current one
+	const uint32 FrameNum = GetReplicationGraphFrame();
+
+	const double StartTime = FPlatformTime::Seconds();
+	const int32 Result = Super::ServerReplicateActors(DeltaSeconds);
+
+	FastSharedPathStats.Frames++;
+	FastSharedPathStats.ConnectionFrames += Connections.Num();
+	const double ReplicateSeconds = FPlatformTime::Seconds() - StartTime;
+	FastSharedPathStats.ReplicateSeconds += ReplicateSeconds;
+
+	if (FECRReplicationGraphProfiler::IsEnabled())
+	{
+		Profiler.EndFrame(Connections, FrameNum, ReplicateSeconds);
+	}
+
+	return Result;
 }
 
 EClassRepNodeMapping UECRReplicationGraph::GetMappingPolicy(UClass* Class)
@@ -774,6 +1110,7 @@ void UECRReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedActor
 	case EClassRepNodeMapping::Spatialize_Dynamic:
 		{
 			GridNode->AddActor_Dynamic(ActorInfo, GlobalInfo);
+			DynamicSpatializedActors.Add(ActorInfo.Actor);
 			break;
 		}
 
@@ -832,7 +1169,22 @@ void UECRReplicationGraph::RouteRemoveNetworkActorToNodes(const FNewReplicatedAc
 
 	case EClassRepNodeMapping::Spatialize_Dynamic:
 		{
-			GridNode->RemoveActor_Dynamic(ActorInfo);
+			if (HotCellGridActors.Remove(ActorInfo.Actor) > 0)
+			{
+				HotCellGridNode->RemoveActor_Dynamic(ActorInfo);
+			}
+			else
+			{
+				GridNode->RemoveActor_Dynamic(ActorInfo);
+			}
+			DynamicSpatializedActors.Remove(ActorInfo.Actor);
+			PendingHotCellMigrations.Remove(ActorInfo.Actor);
+			FIntPoint Cell;
+			if (DynamicActorCells.RemoveAndCopyValue(ActorInfo.Actor, Cell))
+			{
+				CellActorCounts.FindChecked(Cell)--;
+				ChangedCells.Add(Cell);
+			}
 			break;
 		}
 
@@ -912,6 +1264,9 @@ void UECRReplicationGraphNode_AlwaysRelevant_ForConnection::GatherActorListsForC
 	const FConnectionGatherActorListParameters& Params)
 {
 #if WITH_SERVER_CODE
+	TRACE_CPUPROFILER_EVENT_SCOPE(UECRReplicationGraphNode_AlwaysRelevant_ForConnection::GatherActorListsForConnection);
+	FECRRepGraphNodeGatherScope ProfileScope(this, Params);
+
 	auto UpdateActor = [&](AActor* NewActor, AActor*& LastActor)
 	{
 		if (NewActor != LastActor)
@@ -1114,6 +1469,322 @@ void UECRReplicationGraphNode_AlwaysRelevant_ForConnection::LogNode(FReplication
 
 // ------------------------------------------------------------------------------
 
+void UECRReplicationGraphNode_GridSpatialization2D::GatherActorListsForConnection(
+	const FConnectionGatherActorListParameters& Params)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UECRReplicationGraphNode_GridSpatialization2D::GatherActorListsForConnection);
+	FECRRepGraphNodeGatherScope ProfileScope(this, Params);
+
+	Super::GatherActorListsForConnection(Params);
+}
+
+// ------------------------------------------------------------------------------
+
+UECRReplicationGraphNode_Teams::UECRReplicationGraphNode_Teams()
+{
+	bRequiresPrepareForReplicationCall = true;
+}
+
+void UECRReplicationGraphNode_Teams::NotifyResetAllNetworkActors()
+{
+	Factions.Reset();
+	Revision++;
+}
+
+void UECRReplicationGraphNode_Teams::PrepareForReplication()
+{
+	// Keep allocations of lists between frames, squads which got empty just stay empty
+	for (TPair<FName, FECRFactionRepLists>& FactionPair : Factions)
+	{
+		FECRFactionRepLists& FactionLists = FactionPair.Value;
+		FactionLists.Pawns.Reset();
+		FactionLists.ObjectiveCarriers.Reset();
+		for (TPair<int32, FActorRepListRefView>& SquadPair : FactionLists.Squads)
+		{
+			SquadPair.Value.Reset();
+		}
+		FactionLists.PreviousContentHash = FactionLists.ContentHash;
+		FactionLists.ContentHash = 0;
+	}
+
+	const AGameStateBase* GameState = GraphGlobals.IsValid() && GraphGlobals->World
+		                                  ? GraphGlobals->World->GetGameState()
+		                                  : nullptr;
+	if (!GameState)
+	{
+		return;
+	}
+
+	UpdateAlliances();
+
+	const FGameplayTag ObjectiveCarrierTag = FECRGameplayTags::Get().Status_ObjectiveCarrier;
+	for (APlayerState* PS : GameState->PlayerArray)
+	{
+		const AECRPlayerState* ECRPS = Cast<AECRPlayerState>(PS);
+		APawn* Pawn = ECRPS ? ECRPS->GetPawn() : nullptr;
+		if (!IsValid(Pawn) || !Pawn->GetIsReplicated())
+		{
+			continue;
+		}
+
+		FECRFactionRepLists& FactionLists = Factions.FindOrAdd(ECRPS->GetFaction());
+		FactionLists.Pawns.Add(Pawn);
+
+		const UAbilitySystemComponent* ASC = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(Pawn);
+		const bool bObjectiveCarrier = ASC && ASC->HasMatchingGameplayTag(ObjectiveCarrierTag);
+		if (bObjectiveCarrier)
+		{
+			FactionLists.ObjectiveCarriers.Add(Pawn);
+		}
+
+		if (ECRPS->GetSquadId() != INDEX_NONE)
+		{
+			FactionLists.Squads.FindOrAdd(ECRPS->GetSquadId()).Add(Pawn);
+		}
+
+		FactionLists.ContentHash = HashCombine(FactionLists.ContentHash, HashCombine(
+			                                       GetTypeHash(Pawn), HashCombine(GetTypeHash(ECRPS->GetSquadId()),
+			                                                                      GetTypeHash(bObjectiveCarrier))));
+	}
+
+	for (TPair<FName, FECRFactionRepLists>& FactionPair : Factions)
+	{
+		if (FactionPair.Value.ContentHash != FactionPair.Value.PreviousContentHash)
+		{
+			FactionPair.Value.Revision++;
+		}
+	}
+}
+
+void UECRReplicationGraphNode_Teams::UpdateAlliances()
+{
+	const UECRGameInstance* GameInstance = Cast<UECRGameInstance>(GraphGlobals->World->GetGameInstance());
+	if (!GameInstance)
+	{
+		return;
+	}
+
+	const TArray<FFactionAlliance>& Alliances = GameInstance->GetMatchAlliances();
+	uint32 NewAlliancesHash = 0;
+	for (int32 AllianceIndex = 0; AllianceIndex < Alliances.Num(); ++AllianceIndex)
+	{
+		for (const FName& FactionName : Alliances[AllianceIndex].FactionNames)
+		{
+			NewAlliancesHash = HashCombine(NewAlliancesHash, HashCombine(GetTypeHash(FactionName), AllianceIndex));
+		}
+	}
+
+	if (NewAlliancesHash == AlliancesHash)
+	{
+		return;
+	}
+
+	AlliancesHash = NewAlliancesHash;
+	FactionToAlliance.Reset();
+	for (int32 AllianceIndex = 0; AllianceIndex < Alliances.Num(); ++AllianceIndex)
+	{
+		for (const FName& FactionName : Alliances[AllianceIndex].FactionNames)
+		{
+			FactionToAlliance.Add(FactionName, AllianceIndex);
+		}
+	}
+	Revision++;
+}
+
+bool UECRReplicationGraphNode_Teams::AreFactionsAllied(const FName FactionA, const FName FactionB) const
+{
+	if (FactionA.IsNone() || FactionB.IsNone())
+	{
+		return false;
+	}
+	if (FactionA == FactionB)
+	{
+		return true;
+	}
+
+	const int32* AllianceA = FactionToAlliance.Find(FactionA);
+	const int32* AllianceB = FactionToAlliance.Find(FactionB);
+	return AllianceA && AllianceB && *AllianceA == *AllianceB;
+}
+
+void UECRReplicationGraphNode_Teams::LogNode(FReplicationGraphDebugInfo& DebugInfo, const FString& NodeName) const
+{
+	DebugInfo.Log(NodeName);
+	DebugInfo.PushIndent();
+	for (const TPair<FName, FECRFactionRepLists>& FactionPair : Factions)
+	{
+		const FString FactionName = FactionPair.Key.ToString();
+		LogActorRepList(DebugInfo, FString::Printf(TEXT("Faction %s Pawns"), *FactionName), FactionPair.Value.Pawns);
+		LogActorRepList(DebugInfo, FString::Printf(TEXT("Faction %s Objective Carriers"), *FactionName),
+		                FactionPair.Value.ObjectiveCarriers);
+		for (const TPair<int32, FActorRepListRefView>& SquadPair : FactionPair.Value.Squads)
+		{
+			LogActorRepList(DebugInfo, FString::Printf(TEXT("Faction %s Squad %d"), *FactionName, SquadPair.Key),
+			                SquadPair.Value);
+		}
+	}
+	DebugInfo.PopIndent();
+}
+
+// ------------------------------------------------------------------------------
+
+void UECRReplicationGraphNode_TeamRelevancy_ForConnection::GatherActorListsForConnection(
+	const FConnectionGatherActorListParameters& Params)
+{
+#if WITH_SERVER_CODE
+	TRACE_CPUPROFILER_EVENT_SCOPE(UECRReplicationGraphNode_TeamRelevancy_ForConnection::GatherActorListsForConnection);
+	FECRRepGraphNodeGatherScope ProfileScope(this, Params);
+
+	const UECRReplicationGraph* ECRGraph = CastChecked<UECRReplicationGraph>(GetOuter());
+	const UECRReplicationGraphNode_Teams* TeamsNode = ECRGraph->TeamsNode;
+	if (!TeamsNode)
+	{
+		return;
+	}
+
+	// Connections are spread across frames, so that each frame only part of them pays for team gathering
+	const uint32 PeriodFrames = (uint32)FMath::Clamp(ECR::RepGraph::TeamRelevancyPeriodFrames, 1,
+	                                                 ECRGraph->CharacterChannelFrameTimeout - 1);
+	if ((Params.ReplicationFrameNum + (uint32)Params.ConnectionManager.ConnectionOrderNum) % PeriodFrames != 0)
+	{
+		return;
+	}
+
+	for (const FNetViewer& CurViewer : Params.Viewers)
+	{
+		const APlayerController* PC = Cast<APlayerController>(CurViewer.InViewer);
+		const AECRPlayerState* ViewerPS = PC ? PC->GetPlayerState<AECRPlayerState>() : nullptr;
+		if (!ViewerPS)
+		{
+			continue;
+		}
+
+		UpdateCullDistances(Params, CurViewer, ViewerPS, TeamsNode);
+
+		if (ViewerPS->GetFaction().IsNone())
+		{
+			continue;
+		}
+
+		if (ViewerPS->GetSquadId() != INDEX_NONE)
+		{
+			const FECRFactionRepLists* FactionLists = TeamsNode->FindFactionLists(ViewerPS->GetFaction());
+			if (const FActorRepListRefView* SquadList = FactionLists
+				                                            ? FactionLists->Squads.Find(ViewerPS->GetSquadId())
+				                                            : nullptr)
+			{
+				if (SquadList->Num() > 0)
+				{
+					Params.OutGatheredReplicationLists.AddReplicationActorList(*SquadList);
+				}
+			}
+		}
+
+		// Objective carriers of the whole alliance, relationships were just cached for this viewer
+		for (const TPair<FName, FECRFactionRepLists>& FactionPair : TeamsNode->GetFactions())
+		{
+			const FAppliedFaction* AppliedFaction = AppliedFactions.Find(FactionPair.Key);
+			if (AppliedFaction && AppliedFaction->bAlly && FactionPair.Value.ObjectiveCarriers.Num() > 0)
+			{
+				Params.OutGatheredReplicationLists.AddReplicationActorList(FactionPair.Value.ObjectiveCarriers);
+			}
+		}
+	}
+#endif // WITH_SERVER_CODE
+}
+
+void UECRReplicationGraphNode_TeamRelevancy_ForConnection::UpdateCullDistances(
+	const FConnectionGatherActorListParameters& Params, const FNetViewer& Viewer,
+	const AECRPlayerState* ViewerPlayerState, const UECRReplicationGraphNode_Teams* TeamsNode)
+{
+	const FName ViewerFaction = ViewerPlayerState->GetFaction();
+	const int32 ViewerSquadId = ViewerPlayerState->GetSquadId();
+	const AActor* ViewerPawn = ViewerPlayerState->GetPawn();
+
+	const float AllyCullDistanceSquared = FMath::Square(ECR::RepGraph::TeamAllyCullDistance);
+	const float EnemyCullDistanceSquared = FMath::Square(ECR::RepGraph::TeamEnemyCullDistance);
+
+	// Own pawn and view target are reset to class cull distance by always relevant node when they change, which runs
+	// before this one, so their change also makes all factions reapplied
+	uint32 ViewerHash = HashCombine(GetTypeHash(ViewerFaction), GetTypeHash(ViewerSquadId));
+	ViewerHash = HashCombine(ViewerHash, HashCombine(GetTypeHash(ViewerPawn), GetTypeHash(Viewer.ViewTarget)));
+	ViewerHash = HashCombine(ViewerHash, HashCombine(GetTypeHash(AllyCullDistanceSquared),
+	                                                 GetTypeHash(EnemyCullDistanceSquared)));
+	ViewerHash = HashCombine(ViewerHash, TeamsNode->GetRevision());
+	if (ViewerHash != AppliedViewerHash)
+	{
+		AppliedViewerHash = ViewerHash;
+		AppliedFactions.Reset();
+	}
+
+	for (const TPair<FName, FECRFactionRepLists>& FactionPair : TeamsNode->GetFactions())
+	{
+		const FECRFactionRepLists& FactionLists = FactionPair.Value;
+
+		FAppliedFaction* AppliedFaction = AppliedFactions.Find(FactionPair.Key);
+		if (AppliedFaction && AppliedFaction->Revision == FactionLists.Revision)
+		{
+			continue;
+		}
+		if (!AppliedFaction)
+		{
+			AppliedFaction = &AppliedFactions.Add(FactionPair.Key);
+			AppliedFaction->bAlly = TeamsNode->AreFactionsAllied(ViewerFaction, FactionPair.Key);
+		}
+		AppliedFaction->Revision = FactionLists.Revision;
+
+		const bool bAlly = AppliedFaction->bAlly;
+
+		for (FActorRepListType Actor : FactionLists.Pawns)
+		{
+			// Own pawn and view target are handled by always relevant node
+			if (Actor == ViewerPawn || Actor == Viewer.ViewTarget)
+			{
+				continue;
+			}
+
+			float CullDistanceSquared = bAlly ? AllyCullDistanceSquared : EnemyCullDistanceSquared;
+			if (CullDistanceSquared <= 0.f)
+			{
+				CullDistanceSquared = GraphGlobals->GlobalActorReplicationInfoMap->Get(Actor).Settings.
+				                                    GetCullDistanceSquared();
+			}
+
+			Params.ConnectionManager.ActorInfoMap.FindOrAdd(Actor).SetCullDistanceSquared(CullDistanceSquared);
+		}
+
+		if (!bAlly)
+		{
+			continue;
+		}
+
+		// Squad mates and objective carriers are relevant at any distance
+		for (FActorRepListType Actor : FactionLists.ObjectiveCarriers)
+		{
+			if (Actor != ViewerPawn && Actor != Viewer.ViewTarget)
+			{
+				Params.ConnectionManager.ActorInfoMap.FindOrAdd(Actor).SetCullDistanceSquared(0.f);
+			}
+		}
+
+		// Squad ids are only unique within a faction
+		if (const FActorRepListRefView* SquadList = ViewerSquadId != INDEX_NONE && FactionPair.Key == ViewerFaction
+			                                            ? FactionLists.Squads.Find(ViewerSquadId)
+			                                            : nullptr)
+		{
+			for (FActorRepListType Actor : *SquadList)
+			{
+				if (Actor != ViewerPawn && Actor != Viewer.ViewTarget)
+				{
+					Params.ConnectionManager.ActorInfoMap.FindOrAdd(Actor).SetCullDistanceSquared(0.f);
+				}
+			}
+		}
+	}
+}
+
+// ------------------------------------------------------------------------------
+
 void UECRReplicationGraph::PrintRepNodePolicies()
 {
 	UEnum* Enum = StaticEnum<EClassRepNodeMapping>();
@@ -1148,6 +1819,78 @@ FAutoConsoleCommandWithWorldAndArgs ECRPrintRepNodePoliciesCmd(
 	})
 );
 
+void UECRReplicationGraph::PrintFastSharedPathStats(bool bReset)
+{
+	const FFastSharedPathStats& Stats = FastSharedPathStats;
+	const double Frames = FMath::Max<double>(Stats.Frames, 1);
+
+	int32 OutBytesPerSecond = 0;
+	if (NetDriver)
+	{
+		for (const UNetConnection* ClientConnection : NetDriver->ClientConnections)
+		{
+			if (ClientConnection)
+			{
+				OutBytesPerSecond += ClientConnection->OutBytesPerSecond;
+			}
+		}
+	}
+
+	GLog->Logf(TEXT("===================================="));
+	GLog->Logf(TEXT("ECR FastShared Path Stats (%s)"), bFastSharedPathEnabled ? TEXT("enabled") : TEXT("disabled"));
+	GLog->Logf(TEXT("===================================="));
+	GLog->Logf(TEXT("Frames: %lld, avg connections: %.1f"), Stats.Frames, Stats.ConnectionFrames / Frames);
+	GLog->Logf(TEXT("ServerReplicateActors: %.3f ms avg"), Stats.ReplicateSeconds * 1000.0 / Frames);
+	GLog->Logf(TEXT("FastShared updates: %.1f per frame"), Stats.FastSharedUpdates / Frames);
+	GLog->Logf(TEXT("Outgoing bandwidth: %.1f KB/s total, %.1f KB/s per connection"), OutBytesPerSecond / 1024.0,
+	           NetDriver && NetDriver->ClientConnections.Num() > 0
+		           ? OutBytesPerSecond / 1024.0 / NetDriver->ClientConnections.Num()
+		           : 0.0);
+
+	if (bReset)
+	{
+		FastSharedPathStats = FFastSharedPathStats();
+	}
+}
+
+FAutoConsoleCommandWithWorldAndArgs ECRPrintFastSharedStatsCmd(
+	TEXT("ECR.RepGraph.PrintFastSharedStats"),
+	TEXT("Prints replication cost and bandwidth, used to compare FastShared path with the default one. Pass 'reset' to start new measurement"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		const bool bReset = Args.Num() > 0 && Args[0] == TEXT("reset");
+		for (TObjectIterator<UECRReplicationGraph> It; It; ++It)
+		{
+			It->PrintFastSharedPathStats(bReset);
+		}
+	})
+);
+
+FAutoConsoleCommandWithWorldAndArgs ECRProfileRepGraphCmd(
+	TEXT("ECR.RepGraph.Profile"),
+	TEXT("Prints replication graph profile recorded with ECR.RepGraph.Profile.Enabled. Pass 'csv' to export it to Saved/Profiling/RepGraph, 'reset' to start new measurement"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		for (TObjectIterator<UECRReplicationGraph> It; It; ++It)
+		{
+			FECRReplicationGraphProfiler& Profiler = It->GetProfiler();
+			if (Args.Contains(TEXT("csv")))
+			{
+				UE_LOG(LogECRRepGraph, Display, TEXT("Replication graph profile exported to %s"), *Profiler.ExportCsv());
+			}
+			else
+			{
+				Profiler.PrintToLog();
+			}
+
+			if (Args.Contains(TEXT("reset")))
+			{
+				Profiler.Reset();
+			}
+		}
+	})
+);
+
 // ------------------------------------------------------------------------------
 
 FAutoConsoleCommandWithWorldAndArgs ChangeFrequencyBucketsCmd(
@@ -4,9 +4,11 @@
 
 #include "ReplicationGraph.h"
 #include "ECRReplicationGraphTypes.h"
+#include "ECRReplicationGraphProfiler.h"
 #include "ECRReplicationGraph.generated.h"
 
 class AGameplayDebuggerCategoryReplicator;
+class UECRReplicationGraphNode_Teams;
 
 DECLARE_LOG_CATEGORY_EXTERN(LogECRRepGraph, Display, All);
 
@@ -26,6 +28,7 @@ public:
 	virtual void InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection) override;
 	virtual void RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo) override;
 	virtual void RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo) override;
+	virtual int32 ServerReplicateActors(float DeltaSeconds) override;
 
 	UPROPERTY()
 	TArray<TObjectPtr<UClass>>	AlwaysRelevantClasses;
@@ -33,20 +36,34 @@ public:
 	UPROPERTY()
 	TObjectPtr<UReplicationGraphNode_GridSpatialization2D> GridNode;
 
+	/** Grid with smaller cells, dynamic actors of crowded cells of GridNode are moved here */
+	UPROPERTY()
+	TObjectPtr<UReplicationGraphNode_GridSpatialization2D> HotCellGridNode;
+
 	UPROPERTY()
 	TObjectPtr<UReplicationGraphNode_ActorList> AlwaysRelevantNode;
 
 	UPROPERTY()
 	TObjectPtr<UReplicationGraphNode_ActorListFrequencyBuckets> PlayerStatesNode;
 
+	UPROPERTY()
+	TObjectPtr<UECRReplicationGraphNode_Teams> TeamsNode;
+
 	TMap<FName, FActorRepListRefView> AlwaysRelevantStreamingLevelActors;
 
+	/** ActorChannelFrameTimeout of characters, team relevancy period is kept below it */
+	int32 CharacterChannelFrameTimeout = 4;
+
 #if WITH_GAMEPLAY_DEBUGGER
 	void OnGameplayDebuggerOwnerChange(AGameplayDebuggerCategoryReplicator* Debugger, APlayerController* OldOwner);
 #endif
 
 	void PrintRepNodePolicies();
 
+	void PrintFastSharedPathStats(bool bReset);
+
+	FECRReplicationGraphProfiler& GetProfiler() { return Profiler; }
+
 private:
 	void AddClassRepInfo(UClass* Class, EClassRepNodeMapping Mapping);
 	void RegisterClassRepNodeMapping(UClass* Class);
@@ -60,10 +77,63 @@ private:
 
 	bool IsSpatialized(EClassRepNodeMapping Mapping) const { return Mapping >= EClassRepNodeMapping::Spatialize_Static; }
 
+	void ConfigureGridNode(UReplicationGraphNode_GridSpatialization2D* Node, float InCellSize, bool bEnableDynamicSpatializationFrequency);
+
+	/** Static and dormant classes are clamped to grid bounds instead of rebuilding the grid, if rebuilds are disabled */
+	void AddToGridRebuildDenyList(UReplicationGraphNode_GridSpatialization2D* Node, UClass* Class, EClassRepNodeMapping Mapping) const;
+
+	/**
+	 * Moves dynamic actors between main and hot cell grid depending on amount of dynamic actors in their main grid cell.
+	 * Only actors which changed main cell or whose cell got hot or cooled down are reevaluated
+	 */
+	void UpdateHotCells();
+
 	TClassMap<EClassRepNodeMapping> ClassRepNodePolicies;
 
 	/** Classes that had their replication settings explictly set by code in UECRReplicationGraph::InitGlobalActorClassSettings */
 	TArray<UClass*> ExplicitlySetClasses;
+
+	/** Replication cost accumulated since the last reset, used to compare FastShared path with the default one */
+	struct FFastSharedPathStats
+	{
+		int64 Frames = 0;
+		int64 ConnectionFrames = 0;
+		int64 FastSharedUpdates = 0;
+		double ReplicateSeconds = 0.0;
+	};
+
+	FFastSharedPathStats FastSharedPathStats;
+
+	bool bFastSharedPathEnabled = false;
+
+	FECRReplicationGraphProfiler Profiler;
+
+	/** Actors routed as Spatialize_Dynamic, and the ones of them currently placed in hot cell grid */
+	TSet<FActorRepListType> DynamicSpatializedActors;
+	TSet<FActorRepListType> HotCellGridActors;
+
+	TSet<FIntPoint> HotCells;
+
+	/** Main grid cell of each dynamic actor at the last check, and amount of dynamic actors per cell */
+	TMap<FActorRepListType, FIntPoint> DynamicActorCells;
+	TMap<FIntPoint, int32> CellActorCounts;
+
+	/** Actors to reevaluate, kept between checks when migration limit is hit */
+	TSet<FActorRepListType> PendingHotCellMigrations;
+
+	/** Reused between checks to avoid reallocation */
+	TSet<FIntPoint> ChangedCells;
+	TSet<FIntPoint> FlippedCells;
+};
+
+/** Spatial grid which reports its gather cost to the profiler */
+UCLASS()
+class UECRReplicationGraphNode_GridSpatialization2D : public UReplicationGraphNode_GridSpatialization2D
+{
+	GENERATED_BODY()
+
+public:
+	virtual void GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params) override;
 };
 
 UCLASS()
@@ -94,3 +164,92 @@ private:
 
 	bool bInitializedPlayerState = false;
 };
+
+/** Pawns of one faction, split into lists the team relevancy nodes gather from */
+struct FECRFactionRepLists
+{
+	FActorRepListRefView Pawns;
+	FActorRepListRefView ObjectiveCarriers;
+	TMap<int32, FActorRepListRefView> Squads;
+
+	/** Incremented whenever pawns, squads or objective carriers of the faction change */
+	uint32 Revision = 0;
+
+	/** Hash of the lists content, built during sorting and compared with the previous frame one */
+	uint32 ContentHash = 0;
+	uint32 PreviousContentHash = 0;
+};
+
+/** Global node that once per frame sorts pawns by faction and squad of their player states. Doesn't gather anything by itself */
+UCLASS()
+class UECRReplicationGraphNode_Teams : public UReplicationGraphNode
+{
+	GENERATED_BODY()
+
+public:
+	UECRReplicationGraphNode_Teams();
+
+	virtual void NotifyAddNetworkActor(const FNewReplicatedActorInfo& Actor) override { }
+	virtual bool NotifyRemoveNetworkActor(const FNewReplicatedActorInfo& ActorInfo, bool bWarnIfNotFound=true) override { return false; }
+	virtual void NotifyResetAllNetworkActors() override;
+
+	virtual void PrepareForReplication() override;
+	virtual void GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params) override { }
+
+	virtual void LogNode(FReplicationGraphDebugInfo& DebugInfo, const FString& NodeName) const override;
+
+	const FECRFactionRepLists* FindFactionLists(FName Faction) const { return Factions.Find(Faction); }
+	const TMap<FName, FECRFactionRepLists>& GetFactions() const { return Factions; }
+
+	/** Whether factions are allies, that is the same faction or factions of one match alliance */
+	bool AreFactionsAllied(FName FactionA, FName FactionB) const;
+
+	/** Incremented whenever match alliances change or lists are reset, so that connections reapply cull distances */
+	uint32 GetRevision() const { return Revision; }
+
+private:
+	/** Rebuilds faction to alliance map if alliances of the match changed */
+	void UpdateAlliances();
+
+	TMap<FName, FECRFactionRepLists> Factions;
+
+	/** Index of alliance in match alliances per faction, factions without alliance are allies only to themselves */
+	TMap<FName, int32> FactionToAlliance;
+	uint32 AlliancesHash = 0;
+
+	uint32 Revision = 0;
+};
+
+/**
+ * Connection specific node which keeps squad mates and objective carriers of viewer's alliance relevant at reduced but guaranteed
+ * frequency, and sets connection cull distances of all other pawns according to their relationship with the viewer
+ */
+UCLASS()
+class UECRReplicationGraphNode_TeamRelevancy_ForConnection : public UReplicationGraphNode
+{
+	GENERATED_BODY()
+
+public:
+	virtual void NotifyAddNetworkActor(const FNewReplicatedActorInfo& Actor) override { }
+	virtual bool NotifyRemoveNetworkActor(const FNewReplicatedActorInfo& ActorInfo, bool bWarnIfNotFound=true) override { return false; }
+	virtual void NotifyResetAllNetworkActors() override { AppliedFactions.Reset(); }
+
+	virtual void GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params) override;
+
+private:
+	/** Sets cull distances of pawns of factions whose lists changed since the last application (or of all factions if viewer changed) */
+	void UpdateCullDistances(const FConnectionGatherActorListParameters& Params, const FNetViewer& Viewer,
+	                         const class AECRPlayerState* ViewerPlayerState, const UECRReplicationGraphNode_Teams* TeamsNode);
+
+	/** Relationship of a faction with the viewer, and revision of faction lists whose cull distances were applied */
+	struct FAppliedFaction
+	{
+		uint32 Revision = 0;
+		bool bAlly = false;
+	};
+
+	TMap<FName, FAppliedFaction> AppliedFactions;
+
+	/** Hash of viewer data and settings which applied cull distances depend on, all factions are reapplied when it changes */
+	uint32 AppliedViewerHash = 0;
+};
@@ -0,0 +1,346 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ECRReplicationGraphProfiler.h"
+
+#include "ECRReplicationGraph.h"
+#include "Debug/DebugDrawService.h"
+#include "Engine/Canvas.h"
+#include "Engine/Engine.h"
+#include "Engine/NetConnection.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+CSV_DEFINE_CATEGORY(ECRRepGraph, true);
+
+namespace ECR::RepGraph::Profile
+{
+	int32 Enabled = 0;
+	static FAutoConsoleVariableRef CVarECRRepGraphProfileEnabled(
+		TEXT("ECR.RepGraph.Profile.Enabled"), Enabled,
+		TEXT("Records gather time per node, actors gathered/replicated per class and bits sent per connection"),
+		ECVF_Default);
+
+	int32 Overlay = 0;
+	static FAutoConsoleVariableRef CVarECRRepGraphProfileOverlay(
+		TEXT("ECR.RepGraph.Profile.Overlay"), Overlay,
+		TEXT("Shows replication graph profile on screen, requires ECR.RepGraph.Profile.Enabled"), ECVF_Default);
+
+	int32 ReplicatedSamplePeriod = 8;
+	static FAutoConsoleVariableRef CVarECRRepGraphProfileReplicatedSamplePeriod(
+		TEXT("ECR.RepGraph.Profile.ReplicatedSamplePeriod"), ReplicatedSamplePeriod,
+		TEXT("Replicated actors are counted once per this amount of frames, counting walks actor infos of all connections"),
+		ECVF_Default);
+
+	int32 OverlayMaxRows = 12;
+	static FAutoConsoleVariableRef CVarECRRepGraphProfileOverlayMaxRows(
+		TEXT("ECR.RepGraph.Profile.OverlayMaxRows"), OverlayMaxRows, TEXT("Max rows per section of the overlay"),
+		ECVF_Default);
+}
+
+FECRReplicationGraphProfiler::~FECRReplicationGraphProfiler()
+{
+	if (OverlayHandle.IsValid())
+	{
+		UDebugDrawService::Unregister(OverlayHandle);
+	}
+}
+
+bool FECRReplicationGraphProfiler::IsEnabled()
+{
+	return ECR::RepGraph::Profile::Enabled > 0;
+}
+
+void FECRReplicationGraphProfiler::AddNodeGather(FName NodeName, double Seconds,
+                                                 const FGatheredReplicationActorLists& GatheredLists,
+                                                 const int32 (&ListCountsBefore)[(int32)EActorRepListTypeFlags::Max])
+{
+	FNodeProfile& NodeProfile = Nodes.FindOrAdd(NodeName);
+	NodeProfile.GatherSeconds += Seconds;
+	NodeProfile.GatherCalls++;
+
+	for (int32 FlagsIdx = 0; FlagsIdx < (int32)EActorRepListTypeFlags::Max; ++FlagsIdx)
+	{
+		const TArray<FActorRepListRefView>& Lists = GatheredLists.GetLists((EActorRepListTypeFlags)FlagsIdx);
+		for (int32 ListIdx = ListCountsBefore[FlagsIdx]; ListIdx < Lists.Num(); ++ListIdx)
+		{
+			for (FActorRepListType Actor : Lists[ListIdx])
+			{
+				NodeProfile.GatheredActors++;
+				Classes.FindOrAdd(Actor->GetClass()).Considered++;
+			}
+		}
+	}
+}
+
+void FECRReplicationGraphProfiler::EndFrame(const TArray<UNetReplicationGraphConnection*>& Connections,
+                                            uint32 ReplicationFrameNum, double InReplicateSeconds)
+{
+	Frames++;
+	ReplicateSeconds += InReplicateSeconds;
+	LastFrameReplicateSeconds = InReplicateSeconds;
+
+	for (TPair<FObjectKey, FConnectionProfile>& ConnectionPair : ConnectionProfiles)
+	{
+		ConnectionPair.Value.bActive = false;
+	}
+
+	int64 FrameBits = 0;
+	int64 FrameReplicated = 0;
+
+	const bool bSampleReplicated = Frames % FMath::Max(ECR::RepGraph::Profile::ReplicatedSamplePeriod, 1) == 0;
+	if (bSampleReplicated)
+	{
+		ReplicatedSampleFrames++;
+	}
+
+	for (UNetReplicationGraphConnection* ConnectionManager : Connections)
+	{
+		UNetConnection* NetConnection = ConnectionManager ? ConnectionManager->NetConnection : nullptr;
+		if (!NetConnection)
+		{
+			continue;
+		}
+
+		FConnectionProfile& ConnectionProfile = ConnectionProfiles.FindOrAdd(NetConnection);
+		ConnectionProfile.bActive = true;
+		if (ConnectionProfile.Name.IsEmpty())
+		{
+			ConnectionProfile.Name = NetConnection->LowLevelGetRemoteAddress(true);
+		}
+
+		// Bytes are flushed after replication, so the delta covers previous frame of this connection
+		const int64 OutTotalBytes = NetConnection->OutTotalBytes;
+		if (ConnectionProfile.LastOutTotalBytes != INDEX_NONE && OutTotalBytes >= ConnectionProfile.LastOutTotalBytes)
+		{
+			const int64 Bits = (OutTotalBytes - ConnectionProfile.LastOutTotalBytes) * 8;
+			ConnectionProfile.Bits += Bits;
+			FrameBits += Bits;
+		}
+		ConnectionProfile.LastOutTotalBytes = OutTotalBytes;
+
+		if (!bSampleReplicated)
+		{
+			continue;
+		}
+
+		for (auto It = ConnectionManager->ActorInfoMap.CreateIterator(); It; ++It)
+		{
+			const FConnectionReplicationActorInfo* ActorInfo = It.Value().Get();
+			if (ActorInfo && ActorInfo->LastRepFrameNum == ReplicationFrameNum)
+			{
+				ConnectionProfile.Replicated++;
+				FrameReplicated++;
+				if (const AActor* Actor = It.Key())
+				{
+					Classes.FindOrAdd(Actor->GetClass()).Replicated++;
+				}
+			}
+		}
+	}
+
+	CSV_CUSTOM_STAT(ECRRepGraph, ReplicateMs, InReplicateSeconds * 1000.0, ECsvCustomStatOp::Set);
+	if (bSampleReplicated)
+	{
+		CSV_CUSTOM_STAT(ECRRepGraph, ReplicatedActors, (int32)FrameReplicated, ECsvCustomStatOp::Set);
+	}
+	CSV_CUSTOM_STAT(ECRRepGraph, SentKBits, FrameBits / 1000.0, ECsvCustomStatOp::Set);
+
+	UpdateOverlayRegistration();
+}
+
+void FECRReplicationGraphProfiler::Reset()
+{
+	Nodes.Reset();
+	Classes.Reset();
+	for (TPair<FObjectKey, FConnectionProfile>& ConnectionPair : ConnectionProfiles)
+	{
+		ConnectionPair.Value.Bits = 0;
+		ConnectionPair.Value.Replicated = 0;
+	}
+	Frames = 0;
+	ReplicatedSampleFrames = 0;
+	ReplicateSeconds = 0.0;
+}
+
+void FECRReplicationGraphProfiler::PrintToLog() const
+{
+	const double NumFrames = FMath::Max<double>(Frames, 1);
+	const double NumReplicatedFrames = FMath::Max<double>(ReplicatedSampleFrames, 1);
+
+	GLog->Logf(TEXT("===================================="));
+	GLog->Logf(TEXT("ECR Replication Graph Profile (%lld frames, %.3f ms avg)"), Frames,
+	           ReplicateSeconds * 1000.0 / NumFrames);
+	GLog->Logf(TEXT("===================================="));
+
+	GLog->Logf(TEXT("%-60s %12s %12s"), TEXT("Node"), TEXT("Gather ms"), TEXT("Actors"));
+	for (const TPair<FName, FNodeProfile>& NodePair : Nodes)
+	{
+		GLog->Logf(TEXT("%-60s %12.4f %12.1f"), *NodePair.Key.ToString(),
+		           NodePair.Value.GatherSeconds * 1000.0 / NumFrames, NodePair.Value.GatheredActors / NumFrames);
+	}
+
+	GLog->Logf(TEXT("%-60s %12s %12s"), TEXT("Class"), TEXT("Considered"), TEXT("Replicated"));
+	for (const TPair<FObjectKey, FClassProfile>& ClassPair : Classes)
+	{
+		GLog->Logf(TEXT("%-60s %12.1f %12.1f"), *GetNameSafe(ClassPair.Key.ResolveObjectPtr()),
+		           ClassPair.Value.Considered / NumFrames, ClassPair.Value.Replicated / NumReplicatedFrames);
+	}
+
+	GLog->Logf(TEXT("%-60s %12s %12s"), TEXT("Connection"), TEXT("Bits"), TEXT("Replicated"));
+	for (const TPair<FObjectKey, FConnectionProfile>& ConnectionPair : ConnectionProfiles)
+	{
+		GLog->Logf(TEXT("%-60s %12.1f %12.1f"), *ConnectionPair.Value.Name, ConnectionPair.Value.Bits / NumFrames,
+		           ConnectionPair.Value.Replicated / NumReplicatedFrames);
+	}
+}
+
+FString FECRReplicationGraphProfiler::ExportCsv() const
+{
+	const double NumFrames = FMath::Max<double>(Frames, 1);
+	const double NumReplicatedFrames = FMath::Max<double>(ReplicatedSampleFrames, 1);
+
+	TArray<FString> Lines;
+	Lines.Add(TEXT("Section,Name,PerFrame1,PerFrame2"));
+	Lines.Add(FString::Printf(TEXT("Frame,ReplicateMs,%f,%lld"), ReplicateSeconds * 1000.0 / NumFrames, Frames));
+
+	for (const TPair<FName, FNodeProfile>& NodePair : Nodes)
+	{
+		Lines.Add(FString::Printf(TEXT("NodeGatherMs_Actors,%s,%f,%f"), *NodePair.Key.ToString(),
+		                          NodePair.Value.GatherSeconds * 1000.0 / NumFrames,
+		                          NodePair.Value.GatheredActors / NumFrames));
+	}
+
+	for (const TPair<FObjectKey, FClassProfile>& ClassPair : Classes)
+	{
+		Lines.Add(FString::Printf(TEXT("ClassConsidered_Replicated,%s,%f,%f"),
+		                          *GetNameSafe(ClassPair.Key.ResolveObjectPtr()), ClassPair.Value.Considered / NumFrames,
+		                          ClassPair.Value.Replicated / NumReplicatedFrames));
+	}
+
+	for (const TPair<FObjectKey, FConnectionProfile>& ConnectionPair : ConnectionProfiles)
+	{
+		Lines.Add(FString::Printf(TEXT("ConnectionBits_Replicated,%s,%f,%f"), *ConnectionPair.Value.Name,
+		                          ConnectionPair.Value.Bits / NumFrames, ConnectionPair.Value.Replicated / NumReplicatedFrames));
+	}
+
+	const FString FilePath = FPaths::Combine(FPaths::ProfilingDir(), TEXT("RepGraph"),
+	                                         FString::Printf(
+		                                         TEXT("ECRRepGraphProfile-%s.csv"), *FDateTime::Now().ToString()));
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(FilePath), true);
+	FFileHelper::SaveStringArrayToFile(Lines, *FilePath);
+	return FilePath;
+}
+
+void FECRReplicationGraphProfiler::UpdateOverlayRegistration()
+{
+	const bool bWantsOverlay = ECR::RepGraph::Profile::Overlay > 0;
+	if (bWantsOverlay && !OverlayHandle.IsValid())
+	{
+		OverlayHandle = UDebugDrawService::Register(
+			TEXT("Game"), FDebugDrawDelegate::CreateRaw(this, &FECRReplicationGraphProfiler::DrawOverlay));
+	}
+	else if (!bWantsOverlay && OverlayHandle.IsValid())
+	{
+		UDebugDrawService::Unregister(OverlayHandle);
+		OverlayHandle.Reset();
+	}
+}
+
+void FECRReplicationGraphProfiler::DrawOverlay(UCanvas* Canvas, APlayerController* PC)
+{
+	if (!Canvas || !GEngine)
+	{
+		return;
+	}
+
+	UFont* Font = GEngine->GetSmallFont();
+	const float LineHeight = Font->GetMaxCharHeight() + 2.f;
+	const double NumFrames = FMath::Max<double>(Frames, 1);
+	const double NumReplicatedFrames = FMath::Max<double>(ReplicatedSampleFrames, 1);
+	const int32 MaxRows = FMath::Max(ECR::RepGraph::Profile::OverlayMaxRows, 1);
+
+	float Y = 50.f;
+	auto DrawLine = [&](const FString& Line, const FLinearColor& Color)
+	{
+		Canvas->SetDrawColor(Color.ToFColor(true));
+		Canvas->DrawText(Font, Line, 20.f, Y);
+		Y += LineHeight;
+	};
+
+	DrawLine(FString::Printf(TEXT("RepGraph: %.3f ms last frame, %.3f ms avg over %lld frames"),
+	                         LastFrameReplicateSeconds * 1000.0, ReplicateSeconds * 1000.0 / NumFrames, Frames),
+	         FLinearColor::White);
+
+	// Most expensive entries first, everything is averaged per frame
+	TArray<TPair<FName, FNodeProfile>> SortedNodes = Nodes.Array();
+	SortedNodes.Sort([](const TPair<FName, FNodeProfile>& A, const TPair<FName, FNodeProfile>& B)
+	{
+		return A.Value.GatherSeconds > B.Value.GatherSeconds;
+	});
+	for (int32 Idx = 0; Idx < FMath::Min(SortedNodes.Num(), MaxRows); ++Idx)
+	{
+		DrawLine(FString::Printf(TEXT("  %s: %.4f ms, %.1f actors"), *SortedNodes[Idx].Key.ToString(),
+		                         SortedNodes[Idx].Value.GatherSeconds * 1000.0 / NumFrames,
+		                         SortedNodes[Idx].Value.GatheredActors / NumFrames), FLinearColor::Yellow);
+	}
+
+	TArray<TPair<FObjectKey, FClassProfile>> SortedClasses = Classes.Array();
+	SortedClasses.Sort([](const TPair<FObjectKey, FClassProfile>& A, const TPair<FObjectKey, FClassProfile>& B)
+	{
+		return A.Value.Replicated > B.Value.Replicated;
+	});
+	for (int32 Idx = 0; Idx < FMath::Min(SortedClasses.Num(), MaxRows); ++Idx)
+	{
+		DrawLine(FString::Printf(TEXT("  %s: %.1f considered, %.1f replicated"),
+		                         *GetNameSafe(SortedClasses[Idx].Key.ResolveObjectPtr()),
+		                         SortedClasses[Idx].Value.Considered / NumFrames,
+		                         SortedClasses[Idx].Value.Replicated / NumReplicatedFrames), FLinearColor::Green);
+	}
+
+	int32 ConnectionRows = 0;
+	for (const TPair<FObjectKey, FConnectionProfile>& ConnectionPair : ConnectionProfiles)
+	{
+		if (ConnectionPair.Value.bActive && ConnectionRows++ < MaxRows)
+		{
+			DrawLine(FString::Printf(TEXT("  %s: %.0f bits, %.1f replicated"), *ConnectionPair.Value.Name,
+			                         ConnectionPair.Value.Bits / NumFrames, ConnectionPair.Value.Replicated / NumReplicatedFrames),
+			         FLinearColor(0.4f, 0.8f, 1.f));
+		}
+	}
+}
+
+// ------------------------------------------------------------------------------
+
+FECRRepGraphNodeGatherScope::FECRRepGraphNodeGatherScope(const UReplicationGraphNode* InNode,
+                                                         const FConnectionGatherActorListParameters& InParams)
+	: Params(InParams)
+{
+	if (!FECRReplicationGraphProfiler::IsEnabled())
+	{
+		return;
+	}
+
+	Node = InNode;
+	for (int32 FlagsIdx = 0; FlagsIdx < (int32)EActorRepListTypeFlags::Max; ++FlagsIdx)
+	{
+		ListCountsBefore[FlagsIdx] = Params.OutGatheredReplicationLists.GetLists((EActorRepListTypeFlags)FlagsIdx).Num();
+	}
+	StartTime = FPlatformTime::Seconds();
+}
+
+FECRRepGraphNodeGatherScope::~FECRRepGraphNodeGatherScope()
+{
+	if (!Node)
+	{
+		return;
+	}
+
+	const double Seconds = FPlatformTime::Seconds() - StartTime;
+	if (UECRReplicationGraph* ECRGraph = Cast<UECRReplicationGraph>(Node->GetOuter()))
+	{
+		ECRGraph->GetProfiler().AddNodeGather(Node->GetClass()->GetFName(), Seconds, Params.OutGatheredReplicationLists,
+		                                      ListCountsBefore);
+	}
+}
@@ -0,0 +1,92 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReplicationGraphTypes.h"
+#include "UObject/ObjectKey.h"
+
+class UCanvas;
+class APlayerController;
+class UNetReplicationGraphConnection;
+class UReplicationGraphNode;
+
+/**
+ * Runtime instrumentation of ECR replication graph, enabled with ECR.RepGraph.Profile.Enabled.
+ * Accumulates gather time per node, actors gathered and replicated per class and bits sent per connection.
+ * Results can be printed, exported as CSV or shown in an overlay (ECR.RepGraph.Profile.Overlay). Overlay is drawn
+ * by local viewports only, so on dedicated server the log and CSV export are the output.
+ */
+class FECRReplicationGraphProfiler
+{
+public:
+	~FECRReplicationGraphProfiler();
+
+	static bool IsEnabled();
+
+	/** Records gather of one node for one connection, ListCountsBefore are taken from gathered lists before the gather */
+	void AddNodeGather(FName NodeName, double Seconds, const FGatheredReplicationActorLists& GatheredLists,
+	                   const int32 (&ListCountsBefore)[(int32)EActorRepListTypeFlags::Max]);
+
+	/** Records results of replication frame, must be called after replication of all connections */
+	void EndFrame(const TArray<UNetReplicationGraphConnection*>& Connections, uint32 ReplicationFrameNum, double ReplicateSeconds);
+
+	void Reset();
+
+	void PrintToLog() const;
+
+	/** Writes accumulated stats to CSV file and returns its path */
+	FString ExportCsv() const;
+
+private:
+	struct FNodeProfile
+	{
+		double GatherSeconds = 0.0;
+		int64 GatherCalls = 0;
+		int64 GatheredActors = 0;
+	};
+
+	struct FClassProfile
+	{
+		int64 Considered = 0;
+		int64 Replicated = 0;
+	};
+
+	struct FConnectionProfile
+	{
+		FString Name;
+		int64 Bits = 0;
+		int64 Replicated = 0;
+		int64 LastOutTotalBytes = INDEX_NONE;
+		bool bActive = false;
+	};
+
+	void DrawOverlay(UCanvas* Canvas, APlayerController* PC);
+	void UpdateOverlayRegistration();
+
+	TMap<FName, FNodeProfile> Nodes;
+	TMap<FObjectKey, FClassProfile> Classes;
+	TMap<FObjectKey, FConnectionProfile> ConnectionProfiles;
+
+	int64 Frames = 0;
+
+	/** Frames in which replicated actors were counted, per class and per connection Replicated are averaged over them */
+	int64 ReplicatedSampleFrames = 0;
+	double ReplicateSeconds = 0.0;
+	double LastFrameReplicateSeconds = 0.0;
+
+	FDelegateHandle OverlayHandle;
+};
+
+/** Measures gather of a node when profiling is enabled */
+struct FECRRepGraphNodeGatherScope
+{
+	FECRRepGraphNodeGatherScope(const UReplicationGraphNode* Node, const FConnectionGatherActorListParameters& InParams);
+	~FECRRepGraphNodeGatherScope();
+
+private:
+	const UReplicationGraphNode* Node = nullptr;
+	const FConnectionGatherActorListParameters& Params;
+	int32 ListCountsBefore[(int32)EActorRepListTypeFlags::Max] = {};
+	double StartTime = 0.0;
+};
@@ -56,15 +56,52 @@ public:
 	UPROPERTY(EditAnywhere, Category=SpatialGrid, meta=(ForceUnits=cm, ConsoleVariable = "ECR.RepGraph.SpatialBiasY"))
 	float SpatialBiasY = -200000.0f;
 
+	// Static and dormant actors outside of the grid are clamped to its border instead of rebuilding it. Dynamic actors still extend the grid
 	UPROPERTY(EditAnywhere, Category=SpatialGrid, meta = (ConsoleVariable = "ECR.RepGraph.DisableSpatialRebuilds"))
 	bool bDisableSpatialRebuilds = true;
 
+	// If valid, grid is limited to these bounds and never rebuilt, actors outside of them are clamped to the closest cell
+	UPROPERTY(config, EditAnywhere, Category=SpatialGrid)
+	FBox SpatialGridBounds = FBox(ForceInit);
+
+	// Whether dynamic actors in crowded cells are moved to a grid with smaller cells
+	UPROPERTY(config, EditAnywhere, Category=SpatialGrid)
+	bool bEnableHotCellGrid = true;
+
+	// Cell size of the grid used for crowded cells
+	UPROPERTY(EditAnywhere, Category=SpatialGrid, meta=(ForceUnits=cm, ConsoleVariable = "ECR.RepGraph.HotCell.CellSize"))
+	float HotCellGridCellSize = 5000.0f;
+
+	// Amount of dynamic actors in a cell which makes it hot
+	UPROPERTY(EditAnywhere, Category=SpatialGrid, meta=(ConsoleVariable = "ECR.RepGraph.HotCell.ActorThreshold"))
+	int32 HotCellActorThreshold = 24;
+
+	// Actors with bigger cull distance stay in the main grid, as they would cover too many small cells
+	UPROPERTY(EditAnywhere, Category=SpatialGrid, meta=(ForceUnits=cm, ConsoleVariable = "ECR.RepGraph.HotCell.MaxCullDistance"))
+	float HotCellMaxCullDistance = 10000.0f;
+
 	// How many buckets to spread dynamic, spatialized actors across.
 	// High number = more buckets = smaller effective replication frequency.
 	// This happens before individual actors do their own NetUpdateFrequency check.
 	UPROPERTY(EditAnywhere, Category = DynamicSpatialFrequency, meta = (ConsoleVariable = "ECR.RepGraph.DynamicActorFrequencyBuckets"))
 	int32 DynamicActorFrequencyBuckets = 3;
 
+	// Whether squad mates and same faction objective carriers are kept relevant regardless of spatial grid
+	UPROPERTY(config, EditAnywhere, Category = Teams)
+	bool bEnableTeamRelevancy = true;
+
+	// Squad mates and objective carriers are gathered for a connection once per this amount of frames
+	UPROPERTY(EditAnywhere, Category = Teams, meta = (ConsoleVariable = "ECR.RepGraph.Team.RelevancyPeriodFrames"))
+	int32 TeamRelevancyPeriodFrames = 4;
+
+	// Cull distance of pawns of the same faction, 0 means class cull distance
+	UPROPERTY(EditAnywhere, Category = Teams, meta = (ForceUnits = cm, ConsoleVariable = "ECR.RepGraph.Team.AllyCullDistance"))
+	float AllyCullDistance = 45000.0f;
+
+	// Cull distance of pawns of other factions, 0 means class cull distance
+	UPROPERTY(EditAnywhere, Category = Teams, meta = (ForceUnits = cm, ConsoleVariable = "ECR.RepGraph.Team.EnemyCullDistance"))
+	float EnemyCullDistance = 0.0f;
+
 	// Array of Custom Settings for Specific Classes 
 	UPROPERTY(config, EditAnywhere, Category = ReplicationGraph)
 	TArray<FRepGraphActorClassSettings> ClassSettings;
@@ -3,12 +3,68 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "CharacterOptimizerBudget.h"
 #include "SignificanceManager.h"
+#include "Tickable.h"
 #include "ECRSignificanceManager.generated.h"
 
+class UCharacterOptimizerComponent;
+
+/**
+ * Significance manager of the game. Once per frame gathers views of all local players and evaluates all registered
+ * objects against them in one batched pass, instead of every object ticking and projecting itself.
+ */
 UCLASS()
-class UECRSignificanceManager : public USignificanceManager
+class UECRSignificanceManager : public USignificanceManager, public FTickableGameObject
 {
 	GENERATED_BODY()
 
-};
\ No newline at end of file
+public:
+	/** Tag under which characters with optimizer component are registered */
+	static const FName CharacterSignificanceTag;
+
+	UECRSignificanceManager();
+
+	/**
+	 * Registers optimizer component, on each update either distance waves or update rates allocated from the global
+	 * character budget (see CharacterOptimizer.Budget.Enabled) will be applied to its owner
+	 */
+	void RegisterCharacterOptimizer(UCharacterOptimizerComponent* Optimizer);
+
+	void UnregisterCharacterOptimizer(UCharacterOptimizerComponent* Optimizer);
+
+	//~USignificanceManager interface
+	virtual void Update(TArrayView<const FTransform> Viewpoints) override;
+	//~End of USignificanceManager interface
+
+	//~FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+	//~End of FTickableGameObject interface
+
+protected:
+	/** Fills viewpoints of all local players, returns cos of the half of the widest view angle among them */
+	double GatherLocalViewpoints(TArray<FTransform>& OutViewpoints) const;
+
+	/** Distributes character budget by significance calculated during the last update */
+	void ApplyCharacterBudget();
+
+private:
+	/** Cos of the half of the widest local player view angle, updated before each significance pass */
+	double ViewConeCos;
+
+	/** Whether the current update runs in budgeted mode, cached so that cvar change doesn't affect update midway */
+	bool bBudgetedOptimization;
+
+	/** Frame time averaged over recent frames, used to convert budgeted update rates to tick intervals */
+	float SmoothedFrameTime;
+
+	/** Reused between frames to avoid reallocation */
+	TArray<FTransform> ViewpointsScratch;
+	TArray<FManagedObjectInfo*> SortedCharInfosScratch;
+	TArray<FCharOptimizerBudgetRequest> BudgetRequestsScratch;
+	TArray<int32> UpdateRatesScratch;
+};
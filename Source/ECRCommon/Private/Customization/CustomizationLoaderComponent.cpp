@@ -7,6 +7,7 @@
 #include "Customization/CustomizationLoaderAsset.h"
 #include "Customization/CustomizationMaterialAsset.h"
 #include "Customization/CustomizationMaterialNameSpace.h"
+#include "Customization/CustomizationMergedMeshCache.h"
 #include "CustomizationUtilsLibrary.h"
 #include "MeshMergeFunctionLibrary.h"
 #include "Customization/CustomizationAttachmentAsset.h"
@@ -15,10 +16,26 @@
 #include "Particles/ParticleSystemComponent.h"
 
 
+static float CustomizationAsyncLoadBudgetMs = 2.0f;
+static FAutoConsoleVariableRef CVarCustomizationAsyncLoadBudgetMs(
+	TEXT("ECR.Customization.AsyncLoadBudgetMs"),
+	CustomizationAsyncLoadBudgetMs,
+	TEXT("Time per frame all loader components may spend loading modules of LoadFromAssetAsync. At least one module is loaded each frame"),
+	ECVF_Default);
+
+// Budget is shared by all loader components, so many characters becoming relevant at once don't stall the frame
+static uint64 CustomizationAsyncLoadBudgetFrame = 0;
+static double CustomizationAsyncLoadSpentSeconds = 0.0;
+
+
 UCustomizationLoaderComponent::UCustomizationLoaderComponent()
 {
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+
 	bInheritParentAnimations = true;
 	bUseParentSkeleton = true;
+	bShareMaterialInstances = false;
 	bLoadOnBeginPlay = false;
 	bDebugLoading = false;
 }
@@ -34,6 +51,12 @@ void UCustomizationLoaderComponent::BeginPlay()
 	}
 }
 
+void UCustomizationLoaderComponent::OnComponentDestroyed(bool bDestroyingHierarchy)
+{
+	ReleaseMergedMeshes();
+	Super::OnComponentDestroyed(bDestroyingHierarchy);
+}
+
 
 template <class SceneComponentClass>
 SceneComponentClass* UCustomizationLoaderComponent::SpawnChildComponent(USkeletalMeshComponent* Component,
@@ -64,14 +87,15 @@ SceneComponentClass* UCustomizationLoaderComponent::SpawnChildComponent(USkeleta
 }
 
 
-void UCustomizationLoaderComponent::LoadFromAsset(TArray<UCustomizationElementaryAsset*> NewElementaryAssets,
-                                                  TArray<UCustomizationMaterialAsset*> NewMaterialConfigs,
-                                                  const TMap<UCustomizationElementaryAsset*,
-                                                             FCustomizationMaterialAssetMap>&
-                                                  NewMaterialConfigsOverrides,
-                                                  const TMap<UCustomizationElementaryAsset*,
-                                                             FCustomizationAttachmentAssetArray>&
-                                                  NewExternalAttachments)
+bool UCustomizationLoaderComponent::PrepareLoad(const TArray<UCustomizationElementaryAsset*>& NewElementaryAssets,
+                                                const TArray<UCustomizationMaterialAsset*>& NewMaterialConfigs,
+                                                const TMap<UCustomizationElementaryAsset*,
+                                                           FCustomizationMaterialAssetMap>&
+                                                NewMaterialConfigsOverrides,
+                                                USkeletalMeshComponent*& OutSkeletalMeshParentComponent,
+                                                TMap<FName, UCustomizationMaterialAsset*>&
+                                                OutMaterialNamespacesToData,
+                                                TArray<FCustomizationLoadStep>& OutSteps) const
 {
 	// Setting new elementary assets if passed or old from config
 
@@ -79,18 +103,17 @@ void UCustomizationLoaderComponent::LoadFromAsset(TArray<UCustomizationElementar
 	TMap<FName, TArray<UCustomizationElementaryAsset*>> AttachSocketNameToModules;
 
 	// Retrieving first parent skeletal mesh: for attaching created components to it
-	USkeletalMeshComponent* SkeletalMeshParentComponent = UCustomizationUtilsLibrary::GetFirstParentComponentOfType<
+	OutSkeletalMeshParentComponent = UCustomizationUtilsLibrary::GetFirstParentComponentOfType<
 		USkeletalMeshComponent>(this);
-	if (SkeletalMeshParentComponent == nullptr)
+	if (OutSkeletalMeshParentComponent == nullptr)
 	{
 		UE_LOG(LogTemp, Warning,
 		       TEXT("Couldn't find SkeletalMeshComponent among parents of %s, exiting"),
 		       *(UKismetSystemLibrary::GetDisplayName(this)))
-		return;
+		return false;
 	}
 
 	// Material namespace data
-	TMap<FName, UCustomizationMaterialAsset*> MaterialNamespacesToData = {};
 	for (UCustomizationMaterialAsset* Config : NewMaterialConfigs)
 	{
 		if (!Config)
@@ -99,7 +122,7 @@ void UCustomizationLoaderComponent::LoadFromAsset(TArray<UCustomizationElementar
 			continue;
 		}
 
-		MaterialNamespacesToData.Add(Config->MaterialNamespace, Config);
+		OutMaterialNamespacesToData.Add(Config->MaterialNamespace, Config);
 	}
 
 	if (bDebugLoading)
@@ -137,24 +160,184 @@ void UCustomizationLoaderComponent::LoadFromAsset(TArray<UCustomizationElementar
 		}
 	}
 
-	// Processing mesh merges
+	// Mesh merges first, then mesh attaches
 	for (TTuple<FName, TArray<UCustomizationElementaryAsset*>>& MergeNamespaceAndModule : MergeNamespaceToModules)
 	{
-		ProcessMeshMergeModule(MergeNamespaceAndModule.Key, MergeNamespaceAndModule.Value, SkeletalMeshParentComponent,
-		                       MaterialNamespacesToData, NewExternalAttachments);
+		FCustomizationLoadStep& Step = OutSteps.AddDefaulted_GetRef();
+		Step.Key = MergeNamespaceAndModule.Key;
+		Step.Assets = MoveTemp(MergeNamespaceAndModule.Value);
+		Step.bMerge = true;
 	}
 
-	// Processing mesh attaches
-	for (TTuple<FName, TArray<UCustomizationElementaryAsset*>> AttachSocketNameAndModule : AttachSocketNameToModules)
+	for (TTuple<FName, TArray<UCustomizationElementaryAsset*>>& AttachSocketNameAndModule : AttachSocketNameToModules)
+	{
+		// Attached assets are independent, so each is a step of its own
+		for (UCustomizationElementaryAsset* ElementaryAsset : AttachSocketNameAndModule.Value)
+		{
+			FCustomizationLoadStep& Step = OutSteps.AddDefaulted_GetRef();
+			Step.Key = AttachSocketNameAndModule.Key;
+			Step.Assets.Add(ElementaryAsset);
+		}
+	}
+
+	return true;
+}
+
+void UCustomizationLoaderComponent::ProcessLoadStep(FCustomizationLoadStep& Step,
+                                                    USkeletalMeshComponent* SkeletalMeshParentComponent,
+                                                    TMap<FName, UCustomizationMaterialAsset*>&
+                                                    MaterialNamespacesToData,
+                                                    const TMap<UCustomizationElementaryAsset*,
+                                                               FCustomizationMaterialAssetMap>&
+                                                    NewMaterialConfigsOverrides,
+                                                    const TMap<UCustomizationElementaryAsset*,
+                                                               FCustomizationAttachmentAssetArray>&
+                                                    NewExternalAttachments)
+{
+	if (Step.bMerge)
 	{
-		ProcessAttachmentModule(AttachSocketNameAndModule.Key, AttachSocketNameAndModule.Value,
-		                        SkeletalMeshParentComponent, MaterialNamespacesToData, NewMaterialConfigsOverrides,
-		                        NewExternalAttachments);
+		ProcessMeshMergeModule(Step.Key, Step.Assets, SkeletalMeshParentComponent, MaterialNamespacesToData,
+		                       NewExternalAttachments);
+	}
+	else
+	{
+		ProcessAttachmentModule(Step.Key, Step.Assets, SkeletalMeshParentComponent, MaterialNamespacesToData,
+		                        NewMaterialConfigsOverrides, NewExternalAttachments);
 	}
 }
 
+void UCustomizationLoaderComponent::LoadFromAsset(TArray<UCustomizationElementaryAsset*> NewElementaryAssets,
+                                                  TArray<UCustomizationMaterialAsset*> NewMaterialConfigs,
+                                                  const TMap<UCustomizationElementaryAsset*,
+                                                             FCustomizationMaterialAssetMap>&
+                                                  NewMaterialConfigsOverrides,
+                                                  const TMap<UCustomizationElementaryAsset*,
+                                                             FCustomizationAttachmentAssetArray>&
+                                                  NewExternalAttachments)
+{
+	// Modules of a previous async load would otherwise keep loading on top of this one
+	CancelAsyncLoad();
+
+	USkeletalMeshComponent* SkeletalMeshParentComponent = nullptr;
+	TMap<FName, UCustomizationMaterialAsset*> MaterialNamespacesToData;
+	TArray<FCustomizationLoadStep> Steps;
+	if (!PrepareLoad(NewElementaryAssets, NewMaterialConfigs, NewMaterialConfigsOverrides,
+	                 SkeletalMeshParentComponent, MaterialNamespacesToData, Steps))
+	{
+		return;
+	}
+
+	for (FCustomizationLoadStep& Step : Steps)
+	{
+		ProcessLoadStep(Step, SkeletalMeshParentComponent, MaterialNamespacesToData, NewMaterialConfigsOverrides,
+		                NewExternalAttachments);
+	}
+
+	OnCustomizationLoaded.Broadcast(this);
+}
+
+void UCustomizationLoaderComponent::LoadFromAssetAsync(TArray<UCustomizationElementaryAsset*> NewElementaryAssets,
+                                                       TArray<UCustomizationMaterialAsset*> NewMaterialConfigs,
+                                                       const TMap<UCustomizationElementaryAsset*,
+                                                                  FCustomizationMaterialAssetMap>&
+                                                       NewMaterialConfigsOverrides,
+                                                       const TMap<UCustomizationElementaryAsset*,
+                                                                  FCustomizationAttachmentAssetArray>&
+                                                       NewExternalAttachments)
+{
+	CancelAsyncLoad();
+
+	USkeletalMeshComponent* SkeletalMeshParentComponent = nullptr;
+	if (!PrepareLoad(NewElementaryAssets, NewMaterialConfigs, NewMaterialConfigsOverrides,
+	                 SkeletalMeshParentComponent, PendingLoadMaterialNamespacesToData, PendingLoadSteps))
+	{
+		CancelAsyncLoad();
+		return;
+	}
+
+	if (PendingLoadSteps.IsEmpty())
+	{
+		FinishAsyncLoad();
+		return;
+	}
+
+	// Kept until loaded, as modules are loaded over next frames
+	PendingLoadParentComponent = SkeletalMeshParentComponent;
+	PendingLoadMaterialConfigsOverrides = NewMaterialConfigsOverrides;
+	PendingLoadExternalAttachments = NewExternalAttachments;
+
+	SetComponentTickEnabled(true);
+}
+
+void UCustomizationLoaderComponent::TickComponent(float DeltaTime, ELevelTick TickType,
+                                                  FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (!IsAsyncLoadPending())
+	{
+		SetComponentTickEnabled(false);
+		return;
+	}
+
+	USkeletalMeshComponent* SkeletalMeshParentComponent = PendingLoadParentComponent.Get();
+	if (!SkeletalMeshParentComponent)
+	{
+		CancelAsyncLoad();
+		return;
+	}
+
+	if (CustomizationAsyncLoadBudgetFrame != GFrameCounter)
+	{
+		CustomizationAsyncLoadBudgetFrame = GFrameCounter;
+		CustomizationAsyncLoadSpentSeconds = 0.0;
+	}
+
+	// First loader ticking in a frame always loads a module, so loading progresses with zero budget too
+	const double BudgetSeconds = CustomizationAsyncLoadBudgetMs / 1000.0;
+	if (CustomizationAsyncLoadSpentSeconds > 0.0 && CustomizationAsyncLoadSpentSeconds >= BudgetSeconds)
+	{
+		return;
+	}
+
+	do
+	{
+		const double StepStartTime = FPlatformTime::Seconds();
+		ProcessLoadStep(PendingLoadSteps[NextLoadStepIndex++], SkeletalMeshParentComponent,
+		                PendingLoadMaterialNamespacesToData, PendingLoadMaterialConfigsOverrides,
+		                PendingLoadExternalAttachments);
+		CustomizationAsyncLoadSpentSeconds += FPlatformTime::Seconds() - StepStartTime;
+	}
+	while (IsAsyncLoadPending() && CustomizationAsyncLoadSpentSeconds < BudgetSeconds);
+
+	if (!IsAsyncLoadPending())
+	{
+		FinishAsyncLoad();
+	}
+}
+
+void UCustomizationLoaderComponent::FinishAsyncLoad()
+{
+	CancelAsyncLoad();
+	OnCustomizationLoaded.Broadcast(this);
+}
+
+void UCustomizationLoaderComponent::CancelAsyncLoad()
+{
+	PendingLoadSteps.Empty();
+	NextLoadStepIndex = 0;
+	PendingLoadParentComponent.Reset();
+	PendingLoadMaterialNamespacesToData.Empty();
+	PendingLoadMaterialConfigsOverrides.Empty();
+	PendingLoadExternalAttachments.Empty();
+
+	SetComponentTickEnabled(false);
+}
+
 void UCustomizationLoaderComponent::UnloadPreviousCustomization()
 {
+	CancelAsyncLoad();
+
 	for (USceneComponent* SpawnedComponent : SpawnedComponents)
 	{
 		if (SpawnedComponent)
@@ -163,6 +346,37 @@ void UCustomizationLoaderComponent::UnloadPreviousCustomization()
 		}
 	}
 	SpawnedComponents.Empty();
+
+	ReleaseMergedMeshes();
+}
+
+void UCustomizationLoaderComponent::ReleaseMergedMeshes()
+{
+	if (UCustomizationMergedMeshCache* MergedMeshCache = UCustomizationMergedMeshCache::Get())
+	{
+		for (const USkeletalMesh* MergedMesh : AcquiredMergedMeshes)
+		{
+			MergedMeshCache->ReleaseMergedMesh(MergedMesh);
+		}
+	}
+	AcquiredMergedMeshes.Empty();
+}
+
+
+void UCustomizationLoaderComponent::ApplyMaterialDataToSlots(UMeshComponent* Component,
+                                                             const TMap<const UCustomizationMaterialAsset*,
+                                                                        TArray<FName>>& MaterialDataToSlotNames) const
+{
+	for (const TTuple<const UCustomizationMaterialAsset*, TArray<FName>>& MaterialDataAndSlotNames :
+	     MaterialDataToSlotNames)
+	{
+		const UCustomizationMaterialAsset* MaterialData = MaterialDataAndSlotNames.Key;
+		UCustomizationMaterialNameSpace::ApplyMaterialChanges(Component, MaterialData->ScalarParameters,
+		                                                      MaterialData->VectorParameters,
+		                                                      MaterialData->TextureParameters,
+		                                                      MaterialDataAndSlotNames.Value,
+		                                                      bShareMaterialInstances);
+	}
 }
 
 
@@ -206,6 +420,7 @@ void UCustomizationLoaderComponent::ProcessSkeletalAttachesForComponent(USkeleta
 			SkeletalMeshComponent->SetCollisionProfileName(CollisionProfileName);
 		}
 
+		TMap<const UCustomizationMaterialAsset*, TArray<FName>> MaterialDataToSlotNames;
 		TArray<FName> MaterialSlotNames = SkeletalMeshComponent->GetMaterialSlotNames();
 		for (auto SlotName : MaterialSlotNames)
 		{
@@ -226,10 +441,7 @@ void UCustomizationLoaderComponent::ProcessSkeletalAttachesForComponent(USkeleta
 					       *(GetNameSafe(MaterialData)))
 				}
 
-				UCustomizationMaterialNameSpace::ApplyMaterialChanges(SkeletalMeshComponent,
-				                                                      MaterialData->ScalarParameters,
-				                                                      MaterialData->VectorParameters,
-				                                                      MaterialData->TextureParameters, {SlotName});
+				MaterialDataToSlotNames.FindOrAdd(MaterialData).Add(SlotName);
 			}
 			else
 			{
@@ -244,6 +456,8 @@ void UCustomizationLoaderComponent::ProcessSkeletalAttachesForComponent(USkeleta
 				}
 			}
 		}
+
+		ApplyMaterialDataToSlots(SkeletalMeshComponent, MaterialDataToSlotNames);
 	}
 }
 
@@ -270,6 +484,7 @@ void UCustomizationLoaderComponent::ProcessStaticAttachesForComponent(USkeletalM
 			StaticMeshComponent->SetCollisionProfileName(CollisionProfileName);
 		}
 
+		TMap<const UCustomizationMaterialAsset*, TArray<FName>> MaterialDataToSlotNames;
 		TArray<FName> MaterialSlotNames = StaticMeshComponent->GetMaterialSlotNames();
 		for (auto SlotName : MaterialSlotNames)
 		{
@@ -289,10 +504,7 @@ void UCustomizationLoaderComponent::ProcessStaticAttachesForComponent(USkeletalM
 					       *(GetNameSafe(StaticMesh)), *(SlotName.ToString()), *(CustomizationNamespace.ToString()),
 					       *(GetNameSafe(MaterialData)))
 				}
-				UCustomizationMaterialNameSpace::ApplyMaterialChanges(StaticMeshComponent,
-				                                                      MaterialData->ScalarParameters,
-				                                                      MaterialData->VectorParameters,
-				                                                      MaterialData->TextureParameters, {SlotName});
+				MaterialDataToSlotNames.FindOrAdd(MaterialData).Add(SlotName);
 			}
 			else
 			{
@@ -307,6 +519,8 @@ void UCustomizationLoaderComponent::ProcessStaticAttachesForComponent(USkeletalM
 				}
 			}
 		}
+
+		ApplyMaterialDataToSlots(StaticMeshComponent, MaterialDataToSlotNames);
 	}
 }
 
@@ -413,7 +627,20 @@ void UCustomizationLoaderComponent::ProcessMeshMergeModule(const FName Namespace
 			MergeParams.bSkeletonBefore = false;
 		}
 		MergeParams.MeshesToMerge = MeshesForMerge;
-		MergedSkeletalMesh = UMeshMergeFunctionLibrary::MergeMeshes(MergeParams);
+
+		// Characters with the same parts share merged mesh
+		if (UCustomizationMergedMeshCache* MergedMeshCache = UCustomizationMergedMeshCache::Get())
+		{
+			MergedSkeletalMesh = MergedMeshCache->AcquireMergedMesh(MergeParams);
+			if (MergedSkeletalMesh)
+			{
+				AcquiredMergedMeshes.Add(MergedSkeletalMesh);
+			}
+		}
+		else
+		{
+			MergedSkeletalMesh = UMeshMergeFunctionLibrary::MergeMeshes(MergeParams);
+		}
 	}
 	else if (MeshesForMerge.Num() == 1)
 	{
@@ -462,7 +689,8 @@ void UCustomizationLoaderComponent::ProcessMeshMergeModule(const FName Namespace
 			UCustomizationMaterialNameSpace::ApplyMaterialChanges(ChildComponent, MaterialData->ScalarParameters,
 			                                                      MaterialData->VectorParameters,
 			                                                      MaterialData->TextureParameters,
-			                                                      MaterialNamespaceAndSlotNames.Value);
+			                                                      MaterialNamespaceAndSlotNames.Value,
+			                                                      bShareMaterialInstances);
 		}
 	}
 
@@ -513,6 +741,7 @@ void UCustomizationLoaderComponent::ProcessAttachmentModule(FName SocketName,
 		}
 
 		// Applying materials
+		TMap<const UCustomizationMaterialAsset*, TArray<FName>> MaterialDataToSlotNames;
 		TArray<FName> MaterialSlotNames = ChildComponent->GetMaterialSlotNames();
 		for (auto SlotName : MaterialSlotNames)
 		{
@@ -556,12 +785,10 @@ void UCustomizationLoaderComponent::ProcessAttachmentModule(FName SocketName,
 
 			if (MaterialData)
 			{
-				UCustomizationMaterialNameSpace::ApplyMaterialChanges(
-					ChildComponent, MaterialData->ScalarParameters,
-					MaterialData->VectorParameters,
-					MaterialData->TextureParameters, {SlotName});
+				MaterialDataToSlotNames.FindOrAdd(MaterialData).Add(SlotName);
 			}
 		}
+		ApplyMaterialDataToSlots(ChildComponent, MaterialDataToSlotNames);
 
 		TMap<FName, UCustomizationMaterialAsset*> OverridenMaterialNamespacesToData = MaterialNamespacesToData;
 		// Overriding material data with override map
@@ -0,0 +1,238 @@
+// Copyleft: All rights reversed
+
+
+#include "CustomizationMaterialCache.h"
+
+#include "Algo/BinarySearch.h"
+#include "Components/SkinnedMeshComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/SkinnedAsset.h"
+#include "Engine/StaticMesh.h"
+#include "Materials/MaterialInstanceDynamic.h"
+#include "UObject/Package.h"
+
+
+template <typename ValueType>
+static void AppendSortedParameters(TArray<TPair<FName, ValueType>>& Parameters, const FName Name,
+                                   const ValueType& Value)
+{
+	const int32 Index = Algo::LowerBoundBy(Parameters, Name, [](const TPair<FName, ValueType>& Parameter)
+	{
+		return Parameter.Key;
+	}, [](const FName A, const FName B)
+	{
+		return A.FastLess(B);
+	});
+
+	if (Parameters.IsValidIndex(Index) && Parameters[Index].Key == Name)
+	{
+		Parameters[Index].Value = Value;
+	}
+	else
+	{
+		Parameters.Insert(TPair<FName, ValueType>(Name, Value), Index);
+	}
+}
+
+void FCustomizationMaterialParameterSet::Append(const TMap<FName, float>& GivenScalarParameters,
+                                                const TMap<FName, FLinearColor>& GivenVectorParameters,
+                                                const TMap<FName, UTexture*>& GivenTextureParameters)
+{
+	for (const TTuple<FName, float>& NameAndValue : GivenScalarParameters)
+	{
+		AppendSortedParameters(ScalarParameters, NameAndValue.Key, NameAndValue.Value);
+	}
+
+	for (const TTuple<FName, FLinearColor>& NameAndValue : GivenVectorParameters)
+	{
+		AppendSortedParameters(VectorParameters, NameAndValue.Key, NameAndValue.Value);
+	}
+
+	for (const TTuple<FName, UTexture*>& NameAndValue : GivenTextureParameters)
+	{
+		AppendSortedParameters(TextureParameters, NameAndValue.Key, TObjectKey<UTexture>(NameAndValue.Value));
+	}
+}
+
+uint32 FCustomizationMaterialParameterSet::GetHash() const
+{
+	uint32 Hash = 0;
+	for (const TPair<FName, float>& Parameter : ScalarParameters)
+	{
+		Hash = HashCombine(Hash, HashCombine(GetTypeHash(Parameter.Key), GetTypeHash(Parameter.Value)));
+	}
+	for (const TPair<FName, FLinearColor>& Parameter : VectorParameters)
+	{
+		Hash = HashCombine(Hash, HashCombine(GetTypeHash(Parameter.Key), GetTypeHash(Parameter.Value)));
+	}
+	for (const TPair<FName, TObjectKey<UTexture>>& Parameter : TextureParameters)
+	{
+		Hash = HashCombine(Hash, HashCombine(GetTypeHash(Parameter.Key), GetTypeHash(Parameter.Value)));
+	}
+	return Hash;
+}
+
+bool FCustomizationMaterialParameterSet::operator==(const FCustomizationMaterialParameterSet& Other) const
+{
+	return ScalarParameters == Other.ScalarParameters
+		&& VectorParameters == Other.VectorParameters
+		&& TextureParameters == Other.TextureParameters;
+}
+
+
+FCustomizationMaterialCache& FCustomizationMaterialCache::Get()
+{
+	static FCustomizationMaterialCache Cache;
+	return Cache;
+}
+
+FCustomizationMaterialCache::FCustomizationMaterialCache()
+{
+#if WITH_EDITOR
+	// Material slots of meshes may be edited
+	FCoreUObjectDelegates::OnObjectPropertyChanged.AddLambda([this](UObject* Object, FPropertyChangedEvent&)
+	{
+		SlotTables.Remove(Object);
+	});
+#endif
+}
+
+const FCustomizationMaterialSlotTable* FCustomizationMaterialCache::FindOrBuildSlotTable(
+	const UMeshComponent* MeshComponent)
+{
+	const UObject* MeshAsset = nullptr;
+	int32 NumMaterials = 0;
+
+	const USkinnedAsset* SkinnedAsset = nullptr;
+	const UStaticMesh* StaticMesh = nullptr;
+	if (const USkinnedMeshComponent* SkinnedMeshComponent = Cast<USkinnedMeshComponent>(MeshComponent))
+	{
+		SkinnedAsset = SkinnedMeshComponent->GetSkinnedAsset();
+		MeshAsset = SkinnedAsset;
+		NumMaterials = SkinnedAsset ? SkinnedAsset->GetMaterials().Num() : 0;
+	}
+	else if (const UStaticMeshComponent* StaticMeshComponent = Cast<UStaticMeshComponent>(MeshComponent))
+	{
+		StaticMesh = StaticMeshComponent->GetStaticMesh();
+		MeshAsset = StaticMesh;
+		NumMaterials = StaticMesh ? StaticMesh->GetStaticMaterials().Num() : 0;
+	}
+
+	if (!MeshAsset)
+	{
+		return nullptr;
+	}
+
+	FCustomizationMaterialSlotTable* SlotTable = SlotTables.Find(MeshAsset);
+	if (SlotTable && SlotTable->NumMaterials == NumMaterials)
+	{
+		return SlotTable;
+	}
+
+	if (!SlotTable)
+	{
+		if (++NumAddedSincePrune >= 256)
+		{
+			Prune();
+		}
+		SlotTable = &SlotTables.Add(MeshAsset);
+	}
+
+	SlotTable->NumMaterials = NumMaterials;
+	SlotTable->SlotIndices.Reset();
+	for (int32 MaterialIndex = 0; MaterialIndex < NumMaterials; ++MaterialIndex)
+	{
+		const FName SlotName = SkinnedAsset
+			                       ? SkinnedAsset->GetMaterials()[MaterialIndex].MaterialSlotName
+			                       : StaticMesh->GetStaticMaterials()[MaterialIndex].MaterialSlotName;
+		SlotTable->SlotIndices.FindOrAdd(SlotName).Add(MaterialIndex);
+	}
+	return SlotTable;
+}
+
+UMaterialInstanceDynamic* FCustomizationMaterialCache::FindOrCreateSharedInstance(
+	UMaterialInstance* Parent, const FCustomizationMaterialParameterSet& Parameters, bool& bOutCreated)
+{
+	bOutCreated = false;
+
+	const uint32 Hash = HashCombine(GetTypeHash(Parent), Parameters.GetHash());
+	FSharedInstance* SharedInstance = SharedInstances.Find(Hash);
+	if (SharedInstance)
+	{
+		if (UMaterialInstanceDynamic* Instance = SharedInstance->Instance.Get())
+		{
+			if (SharedInstance->Parent.Get() == Parent && SharedInstance->Parameters == Parameters)
+			{
+				return Instance;
+			}
+
+			// Hash collision with an instance in use
+			return nullptr;
+		}
+	}
+	else
+	{
+		if (++NumAddedSincePrune >= 256)
+		{
+			Prune();
+		}
+		SharedInstance = &SharedInstances.Add(Hash);
+	}
+
+	// Outered to transient package, as it is shared between components of different actors
+	UMaterialInstanceDynamic* Instance = UMaterialInstanceDynamic::Create(Parent, GetTransientPackage());
+	SharedInstance->Instance = Instance;
+	SharedInstance->Parent = Parent;
+	SharedInstance->Parameters = Parameters;
+	SharedInstanceHashes.Add(Instance, Hash);
+
+	bOutCreated = true;
+	return Instance;
+}
+
+bool FCustomizationMaterialCache::GetSharedInstanceRecipe(const UMaterialInterface* Material,
+                                                          UMaterialInstance*& OutParent,
+                                                          const FCustomizationMaterialParameterSet*& OutParameters)
+const
+{
+	const uint32* Hash = SharedInstanceHashes.Find(Material);
+	const FSharedInstance* SharedInstance = Hash ? SharedInstances.Find(*Hash) : nullptr;
+	UMaterialInstance* Parent = SharedInstance ? SharedInstance->Parent.Get() : nullptr;
+	if (!Parent || SharedInstance->Instance.Get() != Material)
+	{
+		return false;
+	}
+
+	OutParent = Parent;
+	OutParameters = &SharedInstance->Parameters;
+	return true;
+}
+
+void FCustomizationMaterialCache::Prune()
+{
+	NumAddedSincePrune = 0;
+
+	for (auto It = SlotTables.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().ResolveObjectPtr())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	for (auto It = SharedInstances.CreateIterator(); It; ++It)
+	{
+		if (!It.Value().Instance.IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	for (auto It = SharedInstanceHashes.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().ResolveObjectPtr())
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
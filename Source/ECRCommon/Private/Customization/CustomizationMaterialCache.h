@@ -0,0 +1,84 @@
+// Copyleft: All rights reversed
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+
+class UMaterialInstance;
+class UMaterialInstanceDynamic;
+class UMaterialInterface;
+class UMeshComponent;
+class UTexture;
+
+
+/** Material slot names of one mesh asset to material indices */
+struct FCustomizationMaterialSlotTable
+{
+	int32 NumMaterials = 0;
+	TMap<FName, TArray<int32, TInlineAllocator<2>>> SlotIndices;
+};
+
+
+/** Sorted material parameter values, comparable and hashable to find dynamic material instances with same values */
+struct FCustomizationMaterialParameterSet
+{
+	TArray<TPair<FName, float>> ScalarParameters;
+	TArray<TPair<FName, FLinearColor>> VectorParameters;
+	TArray<TPair<FName, TObjectKey<UTexture>>> TextureParameters;
+
+	/** Adds given values, replacing existing ones with same name */
+	void Append(const TMap<FName, float>& GivenScalarParameters,
+	            const TMap<FName, FLinearColor>& GivenVectorParameters,
+	            const TMap<FName, UTexture*>& GivenTextureParameters);
+
+	uint32 GetHash() const;
+
+	bool operator==(const FCustomizationMaterialParameterSet& Other) const;
+};
+
+
+/**
+ * Game thread caches used when applying customization to materials:
+ * slot name to index tables per mesh asset and dynamic material instances shared by all components
+ * with same parent material and parameter values. Shared instances are referenced weakly,
+ * so they are destroyed when no component uses them.
+ */
+class FCustomizationMaterialCache
+{
+public:
+	static FCustomizationMaterialCache& Get();
+
+	/** Slot table of mesh asset of static or skinned mesh component, nullptr for other components or no mesh */
+	const FCustomizationMaterialSlotTable* FindOrBuildSlotTable(const UMeshComponent* MeshComponent);
+
+	/** Returns shared instance of Parent with Parameters, creating it if needed, in which case caller sets its parameters.
+	 * Returns nullptr on hash collision */
+	UMaterialInstanceDynamic* FindOrCreateSharedInstance(UMaterialInstance* Parent,
+	                                                     const FCustomizationMaterialParameterSet& Parameters,
+	                                                     bool& bOutCreated);
+
+	/** If instance is shared, provides its parent and parameters */
+	bool GetSharedInstanceRecipe(const UMaterialInterface* Material, UMaterialInstance*& OutParent,
+	                             const FCustomizationMaterialParameterSet*& OutParameters) const;
+
+private:
+	FCustomizationMaterialCache();
+
+	struct FSharedInstance
+	{
+		TWeakObjectPtr<UMaterialInstanceDynamic> Instance;
+		TWeakObjectPtr<UMaterialInstance> Parent;
+		FCustomizationMaterialParameterSet Parameters;
+	};
+
+	/** Removes entries of destroyed mesh assets and instances */
+	void Prune();
+
+	TMap<TObjectKey<UObject>, FCustomizationMaterialSlotTable> SlotTables;
+
+	TMap<uint32, FSharedInstance> SharedInstances;
+	TMap<TObjectKey<UMaterialInterface>, uint32> SharedInstanceHashes;
+
+	int32 NumAddedSincePrune = 0;
+};
@@ -5,6 +5,7 @@
 
 #include "Customization/CustomizationMaterialAsset.h"
 #include "Customization/CustomizationSavingNameSpace.h"
+#include "CustomizationMaterialCache.h"
 #include "CustomizationUtilsLibrary.h"
 #include "Components/MeshComponent.h"
 #include "Customization/CustomizationElementaryModule.h"
@@ -72,6 +73,8 @@ void UCustomizationMaterialNameSpace::OnChildAttached(USceneComponent* ChildComp
 
 		if (UMeshComponent* MeshComponent = Cast<UMeshComponent>(ChildComponent))
 		{
+			// Slots of the same namespace are applied together
+			TMap<FName, TArray<FName>> MaterialNamespacesToSlotNames;
 			TArray<FName> SlotNames = MeshComponent->GetMaterialSlotNames();
 			for (auto SlotName : SlotNames)
 			{
@@ -80,12 +83,16 @@ void UCustomizationMaterialNameSpace::OnChildAttached(USceneComponent* ChildComp
 				{
 					MaterialNamespace = SlotNamesCustomizationNamespacesOverride[SlotName];
 				}
+				MaterialNamespacesToSlotNames.FindOrAdd(MaterialNamespace).Add(SlotName);
+			}
 
+			for (const TTuple<FName, TArray<FName>>& MaterialNamespaceAndSlotNames : MaterialNamespacesToSlotNames)
+			{
 				const FCustomizationMaterialNamespaceData CustomizationData = GetMaterialCustomizationData(
-					MaterialNamespace);
+					MaterialNamespaceAndSlotNames.Key);
 				ApplyMaterialChanges(MeshComponent, CustomizationData.ScalarParameters,
 				                     CustomizationData.VectorParameters,
-				                     CustomizationData.TextureParameters, {SlotName});
+				                     CustomizationData.TextureParameters, MaterialNamespaceAndSlotNames.Value);
 			}
 		}
 	}
@@ -102,94 +109,150 @@ bool UCustomizationMaterialNameSpace::CheckIfMaterialContainsParameter(const UMa
 }
 
 
-void UCustomizationMaterialNameSpace::ApplyMaterialChanges(USceneComponent* ChildComponent,
-                                                           const TMap<FName, float>& GivenScalarParameters,
-                                                           const TMap<FName, FLinearColor>& GivenVectorParameters,
-                                                           const TMap<FName, UTexture*>& GivenTextureParameters,
-                                                           const TArray<FName> SlotNames)
+void UCustomizationMaterialNameSpace::SetInstanceParameters(UMaterialInstanceDynamic* MaterialInstanceDynamic,
+                                                            const UMaterialInstance* MaterialInstance,
+                                                            const FCustomizationMaterialParameterSet& Parameters)
 {
-	if (UMeshComponent* MeshChildComponent = Cast<UMeshComponent>(ChildComponent))
+	for (const TPair<FName, float>& NameAndScalarValue : Parameters.ScalarParameters)
 	{
-		TArray<FName> MaterialNames = MeshChildComponent->GetMaterialSlotNames();
+		if (CheckIfMaterialContainsParameter(MaterialInstance, NameAndScalarValue.Key,
+		                                     EMaterialParameterType::Scalar))
+		{
+			MaterialInstanceDynamic->SetScalarParameterValue(NameAndScalarValue.Key, NameAndScalarValue.Value);
+		}
+	}
 
-		const USkinnedMeshComponent* SkinnedMeshComponent = Cast<USkinnedMeshComponent>(MeshChildComponent);
-		const UStaticMeshComponent* StaticMeshComponent = Cast<UStaticMeshComponent>(MeshChildComponent);
+	for (const TPair<FName, FLinearColor>& NameAndVectorValue : Parameters.VectorParameters)
+	{
+		if (CheckIfMaterialContainsParameter(MaterialInstance, NameAndVectorValue.Key,
+		                                     EMaterialParameterType::Vector))
+		{
+			MaterialInstanceDynamic->SetVectorParameterValue(NameAndVectorValue.Key, NameAndVectorValue.Value);
+		}
+	}
 
-		for (const FName MaterialName : MaterialNames)
+	for (const TPair<FName, TObjectKey<UTexture>>& NameAndTextureValue : Parameters.TextureParameters)
+	{
+		if (CheckIfMaterialContainsParameter(MaterialInstance, NameAndTextureValue.Key,
+		                                     EMaterialParameterType::Texture))
 		{
-			// Continue if SlotNames non empty and doesn't contain material name we got
-			if (SlotNames.Num() > 0 && !SlotNames.Contains(MaterialName))
-			{
-				continue;
-			}
+			MaterialInstanceDynamic->SetTextureParameterValue(NameAndTextureValue.Key,
+			                                                  NameAndTextureValue.Value.ResolveObjectPtr());
+		}
+	}
+}
 
-			// Getting material indices corresponding to one material slot name
-			TArray<int32> MaterialIndices = {};
 
-			if (SkinnedMeshComponent)
-			{
-				if (SkinnedMeshComponent->GetSkinnedAsset())
-				{
-					TArray<FSkeletalMaterial> SkeletalMaterials = SkinnedMeshComponent->GetSkinnedAsset()->
-						GetMaterials();
-					MaterialIndices = UCustomizationUtilsLibrary::GetMaterialIndices(SkeletalMaterials, MaterialName);
-				}
-			}
-			else if (StaticMeshComponent)
+void UCustomizationMaterialNameSpace::ApplyMaterialChangesToIndex(UMeshComponent* MeshComponent,
+                                                                  const int32 MaterialIndex,
+                                                                  const TMap<FName, float>& GivenScalarParameters,
+                                                                  const TMap<FName, FLinearColor>&
+                                                                  GivenVectorParameters,
+                                                                  const TMap<FName, UTexture*>& GivenTextureParameters,
+                                                                  const bool bShareInstances)
+{
+	UMaterialInterface* MaterialInterface = MeshComponent->GetMaterial(MaterialIndex);
+	UMaterialInstance* MaterialInstance = Cast<UMaterialInstance>(MaterialInterface);
+	if (!MaterialInstance)
+	{
+		return;
+	}
+
+	FCustomizationMaterialCache& MaterialCache = FCustomizationMaterialCache::Get();
+
+	// Applying over shared instance results in instance of its parent with parameters of both
+	UMaterialInstance* Parent = MaterialInstance;
+	FCustomizationMaterialParameterSet Parameters;
+	const FCustomizationMaterialParameterSet* AppliedParameters = nullptr;
+	const bool bAppliedShared = MaterialCache.GetSharedInstanceRecipe(MaterialInstance, Parent, AppliedParameters);
+	if (bAppliedShared)
+	{
+		Parameters = *AppliedParameters;
+	}
+	Parameters.Append(GivenScalarParameters, GivenVectorParameters, GivenTextureParameters);
+
+	// Dynamic instances created by others are modified in place, as their parameters are unknown
+	if (bShareInstances && (bAppliedShared || !MaterialInstance->IsA<UMaterialInstanceDynamic>()))
+	{
+		bool bCreated = false;
+		if (UMaterialInstanceDynamic* SharedInstance = MaterialCache.FindOrCreateSharedInstance(
+			Parent, Parameters, bCreated))
+		{
+			if (bCreated)
 			{
-				if (StaticMeshComponent->GetStaticMesh())
-				{
-					TArray<FStaticMaterial> StaticMaterials = StaticMeshComponent->GetStaticMesh()->
-						GetStaticMaterials();
-					MaterialIndices = UCustomizationUtilsLibrary::GetMaterialIndices(StaticMaterials, MaterialName);
-				}
+				SetInstanceParameters(SharedInstance, Parent, Parameters);
 			}
-			else
+
+			if (SharedInstance != MaterialInterface)
 			{
-				// Not static or skeletal mesh component, can't get materials
-				continue;
+				MeshComponent->SetMaterial(MaterialIndex, SharedInstance);
 			}
+			return;
+		}
+	}
 
-			for (const int32 MaterialIndex : MaterialIndices)
-			{
-				UMaterialInterface* MaterialInterface = MeshChildComponent->GetMaterial(MaterialIndex);
+	UMaterialInstanceDynamic* MaterialInstanceDynamic;
+	if (bAppliedShared)
+	{
+		// Shared instance must stay unchanged, so component gets its own
+		MaterialInstanceDynamic = UMaterialInstanceDynamic::Create(Parent, MeshComponent);
+		MeshComponent->SetMaterial(MaterialIndex, MaterialInstanceDynamic);
+	}
+	else
+	{
+		// Returns existing instance if material is already dynamic
+		MaterialInstanceDynamic = MeshComponent->CreateDynamicMaterialInstance(MaterialIndex, MaterialInterface);
+	}
 
-				if (const UMaterialInstance* MaterialInstance = Cast<UMaterialInstance>(MaterialInterface))
-				{
-					UMaterialInstanceDynamic* MaterialInstanceDynamic = MeshChildComponent->
-						CreateDynamicMaterialInstance(
-							MaterialIndex, MaterialInterface);
-
-					for (const TTuple<FName, float> NameAndScalarValue : GivenScalarParameters)
-					{
-						if (CheckIfMaterialContainsParameter(MaterialInstance, NameAndScalarValue.Key,
-						                                     EMaterialParameterType::Scalar))
-						{
-							MaterialInstanceDynamic->SetScalarParameterValue(
-								NameAndScalarValue.Key, NameAndScalarValue.Value);
-						}
-					}
-
-					for (const TTuple<FName, FLinearColor> NameAndVectorValue : GivenVectorParameters)
-					{
-						if (CheckIfMaterialContainsParameter(MaterialInstance, NameAndVectorValue.Key,
-						                                     EMaterialParameterType::Vector))
-						{
-							MaterialInstanceDynamic->SetVectorParameterValue(
-								NameAndVectorValue.Key, NameAndVectorValue.Value);
-						}
-					}
-
-					for (const TTuple<FName, UTexture*> NameAndTextureValue : GivenTextureParameters)
-					{
-						if (CheckIfMaterialContainsParameter(MaterialInstance, NameAndTextureValue.Key,
-						                                     EMaterialParameterType::Texture))
-						{
-							MaterialInstanceDynamic->SetTextureParameterValue(
-								NameAndTextureValue.Key, NameAndTextureValue.Value);
-						}
-					}
-				}
+	SetInstanceParameters(MaterialInstanceDynamic, Parent, Parameters);
+}
+
+
+void UCustomizationMaterialNameSpace::ApplyMaterialChanges(USceneComponent* ChildComponent,
+                                                           const TMap<FName, float>& GivenScalarParameters,
+                                                           const TMap<FName, FLinearColor>& GivenVectorParameters,
+                                                           const TMap<FName, UTexture*>& GivenTextureParameters,
+                                                           const TArray<FName> SlotNames, const bool bShareInstances)
+{
+	UMeshComponent* MeshChildComponent = Cast<UMeshComponent>(ChildComponent);
+	if (!MeshChildComponent)
+	{
+		return;
+	}
+
+	// Nothing to change, don't create dynamic instances
+	if (GivenScalarParameters.IsEmpty() && GivenVectorParameters.IsEmpty() && GivenTextureParameters.IsEmpty())
+	{
+		return;
+	}
+
+	// Material indices of slot names, built once per mesh asset
+	const FCustomizationMaterialSlotTable* SlotTable = FCustomizationMaterialCache::Get().FindOrBuildSlotTable(
+		MeshChildComponent);
+	if (!SlotTable)
+	{
+		// Not static or skeletal mesh component, can't get materials
+		return;
+	}
+
+	if (SlotNames.IsEmpty())
+	{
+		for (int32 MaterialIndex = 0; MaterialIndex < SlotTable->NumMaterials; ++MaterialIndex)
+		{
+			ApplyMaterialChangesToIndex(MeshChildComponent, MaterialIndex, GivenScalarParameters,
+			                            GivenVectorParameters, GivenTextureParameters, bShareInstances);
+		}
+		return;
+	}
+
+	for (const FName SlotName : SlotNames)
+	{
+		if (const TArray<int32, TInlineAllocator<2>>* MaterialIndices = SlotTable->SlotIndices.Find(SlotName))
+		{
+			for (const int32 MaterialIndex : *MaterialIndices)
+			{
+				ApplyMaterialChangesToIndex(MeshChildComponent, MaterialIndex, GivenScalarParameters,
+				                            GivenVectorParameters, GivenTextureParameters, bShareInstances);
 			}
 		}
 	}
@@ -0,0 +1,241 @@
+// Copyleft: All rights reversed
+
+
+#include "Customization/CustomizationMergedMeshCache.h"
+
+#include "MeshMergeFunctionLibrary.h"
+#include "Animation/Skeleton.h"
+#include "Engine/Engine.h"
+#include "Engine/SkeletalMesh.h"
+
+
+static float MergedMeshCacheBudgetMB = 256.0f;
+static FAutoConsoleVariableRef CVarMergedMeshCacheBudgetMB(
+	TEXT("ECR.Customization.MergedMeshCacheBudgetMB"),
+	MergedMeshCacheBudgetMB,
+	TEXT("Size of merged skeletal meshes kept in cache, above it unreferenced meshes are evicted. 0 keeps only meshes in use"),
+	ECVF_Default);
+
+static FAutoConsoleCommand CmdMergedMeshCacheStats(
+	TEXT("ECR.Customization.MergedMeshCacheStats"),
+	TEXT("Prints hit rate and size of merged skeletal mesh cache. Pass 'reset' to reset counters"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		if (UCustomizationMergedMeshCache* Cache = UCustomizationMergedMeshCache::Get())
+		{
+			Cache->PrintStats();
+			if (Args.Contains(TEXT("reset")))
+			{
+				Cache->ResetStats();
+			}
+		}
+	}));
+
+
+UCustomizationMergedMeshCache* UCustomizationMergedMeshCache::Get()
+{
+	return GEngine ? GEngine->GetEngineSubsystem<UCustomizationMergedMeshCache>() : nullptr;
+}
+
+uint32 UCustomizationMergedMeshCache::GetRecipeHash(const TArray<USkeletalMesh*>& SourceMeshes,
+                                                    const FSkeletalMeshMergeParams& Params)
+{
+	// Recipe is every field of merge params, section mappings and UV transforms don't exist in them, as MergeMeshes
+	// always merges with empty ones. Order of meshes defines order of sections in merged mesh, so it is part of the recipe
+	uint32 Hash = GetTypeHash(SourceMeshes.Num());
+	for (const USkeletalMesh* Mesh : SourceMeshes)
+	{
+		Hash = HashCombine(Hash, GetTypeHash(Mesh));
+	}
+	Hash = HashCombine(Hash, GetTypeHash(Params.Skeleton));
+	Hash = HashCombine(Hash, GetTypeHash(Params.StripTopLODS));
+	Hash = HashCombine(Hash, GetTypeHash((Params.bNeedsCpuAccess ? 1u : 0u) | (Params.bSkeletonBefore ? 2u : 0u)));
+	return Hash;
+}
+
+bool UCustomizationMergedMeshCache::MatchesRecipe(const FCustomizationMergedMeshCacheEntry& Entry,
+                                                  const TArray<USkeletalMesh*>& SourceMeshes,
+                                                  const FSkeletalMeshMergeParams& Params)
+{
+	if (Entry.SourceMeshes.Num() != SourceMeshes.Num()
+		|| Entry.Skeleton.Get() != Params.Skeleton
+		|| Entry.StripTopLODS != Params.StripTopLODS
+		|| Entry.bNeedsCpuAccess != static_cast<bool>(Params.bNeedsCpuAccess)
+		|| Entry.bSkeletonBefore != static_cast<bool>(Params.bSkeletonBefore))
+	{
+		return false;
+	}
+
+	for (int32 MeshIdx = 0; MeshIdx < SourceMeshes.Num(); ++MeshIdx)
+	{
+		if (Entry.SourceMeshes[MeshIdx].Get() != SourceMeshes[MeshIdx])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+USkeletalMesh* UCustomizationMergedMeshCache::AcquireMergedMesh(const FSkeletalMeshMergeParams& Params)
+{
+	TArray<USkeletalMesh*> SourceMeshes = Params.MeshesToMerge;
+	SourceMeshes.RemoveAll([](const USkeletalMesh* InMesh)
+	{
+		return InMesh == nullptr;
+	});
+
+	const uint32 RecipeHash = GetRecipeHash(SourceMeshes, Params);
+	FCustomizationMergedMeshCacheEntry* Entry = Entries.Find(RecipeHash);
+	if (Entry && Entry->Mesh && MatchesRecipe(*Entry, SourceMeshes, Params))
+	{
+		Hits++;
+		Entry->RefCount++;
+		Entry->LastUsedTime = FPlatformTime::Seconds();
+		return Entry->Mesh;
+	}
+
+	Misses++;
+	USkeletalMesh* MergedMesh = UMeshMergeFunctionLibrary::MergeMeshes(Params);
+	if (!MergedMesh)
+	{
+		return nullptr;
+	}
+
+	if (Entry)
+	{
+		if (Entry->RefCount > 0)
+		{
+			// Hash collision with a mesh in use, leave this one uncached
+			return MergedMesh;
+		}
+		RemoveEntry(RecipeHash);
+	}
+
+	FCustomizationMergedMeshCacheEntry& NewEntry = Entries.Add(RecipeHash);
+	NewEntry.Mesh = MergedMesh;
+	NewEntry.SourceMeshes.Append(SourceMeshes);
+	NewEntry.Skeleton = Params.Skeleton;
+	NewEntry.StripTopLODS = Params.StripTopLODS;
+	NewEntry.bNeedsCpuAccess = Params.bNeedsCpuAccess;
+	NewEntry.bSkeletonBefore = Params.bSkeletonBefore;
+	NewEntry.RefCount = 1;
+	NewEntry.ResourceSizeBytes = MergedMesh->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+	NewEntry.LastUsedTime = FPlatformTime::Seconds();
+
+	RecipeHashByMesh.Add(MergedMesh, RecipeHash);
+	TotalResourceSizeBytes += NewEntry.ResourceSizeBytes;
+
+	TrimToBudget();
+	return MergedMesh;
+}
+
+void UCustomizationMergedMeshCache::ReleaseMergedMesh(const USkeletalMesh* Mesh)
+{
+	const uint32* RecipeHash = RecipeHashByMesh.Find(Mesh);
+	if (!RecipeHash)
+	{
+		// Not cached
+		return;
+	}
+
+	FCustomizationMergedMeshCacheEntry& Entry = Entries.FindChecked(*RecipeHash);
+	if (ensure(Entry.RefCount > 0))
+	{
+		Entry.RefCount--;
+		Entry.LastUsedTime = FPlatformTime::Seconds();
+	}
+
+	if (Entry.RefCount == 0)
+	{
+		TrimToBudget();
+	}
+}
+
+void UCustomizationMergedMeshCache::TrimToBudget()
+{
+	const int64 BudgetBytes = static_cast<int64>(FMath::Max(MergedMeshCacheBudgetMB, 0.0f) * 1024.0f * 1024.0f);
+	if (TotalResourceSizeBytes <= BudgetBytes)
+	{
+		return;
+	}
+
+	TArray<TPair<double, uint32>> EvictionCandidates;
+	for (const TPair<uint32, FCustomizationMergedMeshCacheEntry>& EntryPair : Entries)
+	{
+		if (EntryPair.Value.RefCount == 0)
+		{
+			EvictionCandidates.Emplace(EntryPair.Value.LastUsedTime, EntryPair.Key);
+		}
+	}
+
+	// Least recently used first
+	EvictionCandidates.Sort([](const TPair<double, uint32>& A, const TPair<double, uint32>& B)
+	{
+		return A.Key < B.Key;
+	});
+
+	for (const TPair<double, uint32>& Candidate : EvictionCandidates)
+	{
+		if (TotalResourceSizeBytes <= BudgetBytes)
+		{
+			break;
+		}
+		RemoveEntry(Candidate.Value);
+		Evictions++;
+	}
+}
+
+void UCustomizationMergedMeshCache::RemoveEntry(const uint32 RecipeHash)
+{
+	FCustomizationMergedMeshCacheEntry Entry;
+	if (Entries.RemoveAndCopyValue(RecipeHash, Entry))
+	{
+		RecipeHashByMesh.Remove(Entry.Mesh.Get());
+		TotalResourceSizeBytes -= Entry.ResourceSizeBytes;
+	}
+}
+
+FCustomizationMergedMeshCacheStats UCustomizationMergedMeshCache::GetStats() const
+{
+	FCustomizationMergedMeshCacheStats Stats;
+	Stats.Hits = Hits;
+	Stats.Misses = Misses;
+	Stats.Evictions = Evictions;
+	Stats.NumEntries = Entries.Num();
+	Stats.TotalResourceSizeBytes = TotalResourceSizeBytes;
+	Stats.HitRate = Hits + Misses > 0 ? static_cast<float>(Hits) / (Hits + Misses) : 0.0f;
+
+	for (const TPair<uint32, FCustomizationMergedMeshCacheEntry>& EntryPair : Entries)
+	{
+		if (EntryPair.Value.RefCount > 0)
+		{
+			Stats.NumReferencedEntries++;
+		}
+	}
+	return Stats;
+}
+
+void UCustomizationMergedMeshCache::ResetStats()
+{
+	Hits = 0;
+	Misses = 0;
+	Evictions = 0;
+}
+
+void UCustomizationMergedMeshCache::PrintStats() const
+{
+	const FCustomizationMergedMeshCacheStats Stats = GetStats();
+	UE_LOG(LogTemp, Display,
+	       TEXT("Merged mesh cache: %d hits, %d misses (hit rate %.1f%%), %d evictions, %d entries (%d in use), %.2f MB of %.2f MB"),
+	       Stats.Hits, Stats.Misses, Stats.HitRate * 100.0f, Stats.Evictions, Stats.NumEntries,
+	       Stats.NumReferencedEntries, Stats.TotalResourceSizeBytes / (1024.0 * 1024.0), MergedMeshCacheBudgetMB)
+}
+
+void UCustomizationMergedMeshCache::Deinitialize()
+{
+	Entries.Empty();
+	RecipeHashByMesh.Empty();
+	TotalResourceSizeBytes = 0;
+
+	Super::Deinitialize();
+}
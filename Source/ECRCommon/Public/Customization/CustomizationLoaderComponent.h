@@ -32,6 +32,29 @@ struct ECRCOMMON_API FCustomizationAttachmentAssetArray
 };
 
 
+/** One module to load: merged meshes of a merger namespace or one attached CEA */
+USTRUCT()
+struct FCustomizationLoadStep
+{
+	GENERATED_BODY()
+
+	/** Merger namespace or socket name */
+	UPROPERTY()
+	FName Key;
+
+	UPROPERTY()
+	TArray<UCustomizationElementaryAsset*> Assets;
+
+	UPROPERTY()
+	bool bMerge = false;
+};
+
+class UCustomizationLoaderComponent;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FCustomizationLoadedSignature, UCustomizationLoaderComponent*,
+                                            LoaderComponent);
+
+
 /**
  * 
  */
@@ -56,6 +79,11 @@ class ECRCOMMON_API UCustomizationLoaderComponent : public USceneComponent
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta=(AllowPrivateAccess="true"))
 	bool bUseParentSkeleton;
 
+	/** Whether spawned components share dynamic material instances with other characters using same materials.
+	 * Parameters of their materials must not be changed at runtime then */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta=(AllowPrivateAccess="true"))
+	bool bShareMaterialInstances;
+
 	/** Collision profile name to use for static and skeletal components. Leave None for default */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta=(AllowPrivateAccess="true"))
 	FName CollisionProfileName;
@@ -63,6 +91,28 @@ class ECRCOMMON_API UCustomizationLoaderComponent : public USceneComponent
 	UPROPERTY(BlueprintReadOnly, meta=(AllowPrivateAccess="true"))
 	TArray<USceneComponent*> SpawnedComponents;
 
+	/** Merged meshes acquired from UCustomizationMergedMeshCache, released on unload */
+	UPROPERTY(Transient)
+	TArray<USkeletalMesh*> AcquiredMergedMeshes;
+
+	/** Modules of LoadFromAssetAsync not loaded yet, starting from NextLoadStepIndex */
+	UPROPERTY(Transient)
+	TArray<FCustomizationLoadStep> PendingLoadSteps;
+
+	int32 NextLoadStepIndex = 0;
+
+	UPROPERTY(Transient)
+	TWeakObjectPtr<USkeletalMeshComponent> PendingLoadParentComponent;
+
+	UPROPERTY(Transient)
+	TMap<FName, UCustomizationMaterialAsset*> PendingLoadMaterialNamespacesToData;
+
+	UPROPERTY(Transient)
+	TMap<UCustomizationElementaryAsset*, FCustomizationMaterialAssetMap> PendingLoadMaterialConfigsOverrides;
+
+	UPROPERTY(Transient)
+	TMap<UCustomizationElementaryAsset*, FCustomizationAttachmentAssetArray> PendingLoadExternalAttachments;
+
 protected:
 	/** Spawn child component for Component and attach to it */
 	template <class SceneComponentClass>
@@ -105,11 +155,36 @@ protected:
 										   const TArray<FCustomizationElementarySubmoduleParticle>& ParticlesForAttach,
 										   const FString NameEnding);
 
+	/** Apply each CMA to its material slots of the Component */
+	void ApplyMaterialDataToSlots(UMeshComponent* Component,
+	                              const TMap<const UCustomizationMaterialAsset*, TArray<FName>>&
+	                              MaterialDataToSlotNames) const;
+
 	/** Check if socket exists, if it does, return socket name, else return NAME_None and print warning */
 	template <class ComponentClass>
 	static FName GetExistingSocketNameOrNameNone(const ComponentClass* Component, FName SocketName);
 
-	/** Load CustomizationLoaderAsset. Note that previous loaded meshes won't be destroyed,
+	/** Find first parent skeletal mesh and split elementary assets into merge and attachment modules.
+	 * Returns false if there is no parent to load customization on */
+	bool PrepareLoad(const TArray<UCustomizationElementaryAsset*>& NewElementaryAssets,
+	                 const TArray<UCustomizationMaterialAsset*>& NewMaterialConfigs,
+	                 const TMap<UCustomizationElementaryAsset*, FCustomizationMaterialAssetMap>&
+	                 NewMaterialConfigsOverrides,
+	                 USkeletalMeshComponent*& OutSkeletalMeshParentComponent,
+	                 TMap<FName, UCustomizationMaterialAsset*>& OutMaterialNamespacesToData,
+	                 TArray<FCustomizationLoadStep>& OutSteps) const;
+
+	/** Load one module prepared by PrepareLoad */
+	void ProcessLoadStep(FCustomizationLoadStep& Step, USkeletalMeshComponent* SkeletalMeshParentComponent,
+	                     TMap<FName, UCustomizationMaterialAsset*>& MaterialNamespacesToData,
+	                     const TMap<UCustomizationElementaryAsset*, FCustomizationMaterialAssetMap>&
+	                     NewMaterialConfigsOverrides,
+	                     const TMap<UCustomizationElementaryAsset*, FCustomizationAttachmentAssetArray>&
+	                     NewExternalAttachments);
+
+	void FinishAsyncLoad();
+
+	/** Load CustomizationLoaderAsset. Pending async load is cancelled. Note that previous loaded meshes won't be destroyed,
 	 * you should call UnloadPreviousCustomization for that */
 	UFUNCTION(BlueprintCallable)
 	void LoadFromAsset(
@@ -118,12 +193,43 @@ protected:
 		const TMap<UCustomizationElementaryAsset*, FCustomizationMaterialAssetMap>& NewMaterialConfigsOverrides,
 		const TMap<UCustomizationElementaryAsset*, FCustomizationAttachmentAssetArray>& NewExternalAttachments);
 
+	/** Same as LoadFromAsset, but modules are loaded over next frames within ECR.Customization.AsyncLoadBudgetMs
+	 * shared by all loader components. Pending async load is cancelled. OnCustomizationLoaded is broadcast when done */
+	UFUNCTION(BlueprintCallable)
+	void LoadFromAssetAsync(
+		TArray<UCustomizationElementaryAsset*> NewElementaryAssets,
+		TArray<UCustomizationMaterialAsset*> NewMaterialConfigs,
+		const TMap<UCustomizationElementaryAsset*, FCustomizationMaterialAssetMap>& NewMaterialConfigsOverrides,
+		const TMap<UCustomizationElementaryAsset*, FCustomizationAttachmentAssetArray>& NewExternalAttachments);
+
+	/** Stop loading modules of LoadFromAssetAsync, already loaded ones stay until UnloadPreviousCustomization */
+	UFUNCTION(BlueprintCallable)
+	void CancelAsyncLoad();
+
+	/** Destroys loaded customization, cancelling pending async load */
 	UFUNCTION(BlueprintCallable)
 	void UnloadPreviousCustomization();
 
+	/** Return merged meshes to UCustomizationMergedMeshCache */
+	void ReleaseMergedMeshes();
+
 public:
 	UCustomizationLoaderComponent();
 
+	/** Called when LoadFromAsset or LoadFromAssetAsync finished loading all modules */
+	UPROPERTY(BlueprintAssignable)
+	FCustomizationLoadedSignature OnCustomizationLoaded;
+
+	UFUNCTION(BlueprintPure)
+	bool IsAsyncLoadPending() const { return NextLoadStepIndex < PendingLoadSteps.Num(); }
+
 	/** LoadFromAsset on BeginPlay */
 	virtual void BeginPlay() override;
+
+	/** Loads pending modules of LoadFromAssetAsync */
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType,
+	                           FActorComponentTickFunction* ThisTickFunction) override;
+
+	/** Releases merged meshes */
+	virtual void OnComponentDestroyed(bool bDestroyingHierarchy) override;
 };
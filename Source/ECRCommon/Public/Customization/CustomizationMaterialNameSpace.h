@@ -8,6 +8,9 @@
 #include "Materials/MaterialInstance.h"
 #include "CustomizationMaterialNameSpace.generated.h"
 
+struct FCustomizationMaterialParameterSet;
+class UMaterialInstanceDynamic;
+
 
 UCLASS(ClassGroup=(ModularCustomization), meta=(BlueprintSpawnableComponent))
 class ECRCOMMON_API UCustomizationMaterialNameSpace : public USceneComponent
@@ -19,6 +22,18 @@ protected:
 	static bool CheckIfMaterialContainsParameter(const UMaterialInstance* MaterialInstance, FName ParameterName,
 	                                             EMaterialParameterType ParameterType);
 
+	/** Apply parameters to material of one index, creating or finding dynamic material instance for it */
+	static void ApplyMaterialChangesToIndex(UMeshComponent* MeshComponent, int32 MaterialIndex,
+	                                        const TMap<FName, float>& GivenScalarParameters,
+	                                        const TMap<FName, FLinearColor>& GivenVectorParameters,
+	                                        const TMap<FName, UTexture*>& GivenTextureParameters,
+	                                        bool bShareInstances);
+
+	/** Set parameters existing on MaterialInstance to dynamic instance */
+	static void SetInstanceParameters(UMaterialInstanceDynamic* MaterialInstanceDynamic,
+	                                  const UMaterialInstance* MaterialInstance,
+	                                  const FCustomizationMaterialParameterSet& Parameters);
+
 	/** ApplyMaterialChanges to child on child attached */
 	virtual void OnChildAttached(USceneComponent* ChildComponent) override;
 
@@ -28,11 +43,13 @@ public:
 
 	FCustomizationMaterialNamespaceData GetMaterialCustomizationData(const FName NamespaceOverride = "") const;
 
-	/** Update child material parameters, pass non empty SlotNames array to limit material names that will be modified */
+	/** Update child material parameters, pass non empty SlotNames array to limit material names that will be modified.
+	 * With bShareInstances, dynamic material instances are shared with all components having same parent material
+	 * and parameters, so their parameters must not be changed afterwards */
 	void static ApplyMaterialChanges(USceneComponent* ChildComponent, const TMap<FName, float>& GivenScalarParameters,
 	                                 const TMap<FName, FLinearColor>& GivenVectorParameters,
 	                                 const TMap<FName, UTexture*>& GivenTextureParameters,
-	                                 const TArray<FName> SlotNames);
+	                                 const TArray<FName> SlotNames, const bool bShareInstances = false);
 
 	/** Save CMA for this namespace */
 	UFUNCTION(CallInEditor, BlueprintCallable)
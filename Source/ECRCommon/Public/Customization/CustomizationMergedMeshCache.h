@@ -0,0 +1,115 @@
+// Copyleft: All rights reversed
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/EngineSubsystem.h"
+#include "CustomizationMergedMeshCache.generated.h"
+
+struct FSkeletalMeshMergeParams;
+
+
+/** Merged mesh with recipe it was built from */
+USTRUCT()
+struct FCustomizationMergedMeshCacheEntry
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TObjectPtr<USkeletalMesh> Mesh = nullptr;
+
+	/** Recipe, compared on lookup to rule out hash collisions and reused addresses of unloaded meshes */
+	TArray<TWeakObjectPtr<USkeletalMesh>> SourceMeshes;
+	TWeakObjectPtr<USkeleton> Skeleton;
+	int32 StripTopLODS = 0;
+	bool bNeedsCpuAccess = false;
+	bool bSkeletonBefore = false;
+
+	/** Number of acquires not yet released, entry can be evicted only when zero */
+	int32 RefCount = 0;
+
+	int64 ResourceSizeBytes = 0;
+	double LastUsedTime = 0.0;
+};
+
+
+/** Counters of merged mesh cache since start or last reset */
+USTRUCT(BlueprintType)
+struct ECRCOMMON_API FCustomizationMergedMeshCacheStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly)
+	int32 Hits = 0;
+
+	UPROPERTY(BlueprintReadOnly)
+	int32 Misses = 0;
+
+	UPROPERTY(BlueprintReadOnly)
+	int32 Evictions = 0;
+
+	UPROPERTY(BlueprintReadOnly)
+	int32 NumEntries = 0;
+
+	UPROPERTY(BlueprintReadOnly)
+	int32 NumReferencedEntries = 0;
+
+	UPROPERTY(BlueprintReadOnly)
+	int64 TotalResourceSizeBytes = 0;
+
+	/** Hits / (Hits + Misses) */
+	UPROPERTY(BlueprintReadOnly)
+	float HitRate = 0.0f;
+};
+
+
+/**
+ * Process wide cache of merged skeletal meshes, keyed by hash of source meshes, skeleton and merge params.
+ * Characters loading identical set of merged parts share one mesh and its GPU buffers instead of merging again.
+ * Unreferenced meshes are kept for next loads and evicted least recently used first
+ * when total size exceeds ECR.Customization.MergedMeshCacheBudgetMB.
+ */
+UCLASS()
+class ECRCOMMON_API UCustomizationMergedMeshCache : public UEngineSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	static UCustomizationMergedMeshCache* Get();
+
+	/** Returns cached or newly merged mesh for the params. Each acquired mesh must be released with ReleaseMergedMesh */
+	USkeletalMesh* AcquireMergedMesh(const FSkeletalMeshMergeParams& Params);
+
+	/** Releases mesh returned by AcquireMergedMesh */
+	void ReleaseMergedMesh(const USkeletalMesh* Mesh);
+
+	UFUNCTION(BlueprintPure, Category = "Customization")
+	FCustomizationMergedMeshCacheStats GetStats() const;
+
+	void ResetStats();
+
+	void PrintStats() const;
+
+	virtual void Deinitialize() override;
+
+private:
+	static uint32 GetRecipeHash(const TArray<USkeletalMesh*>& SourceMeshes, const FSkeletalMeshMergeParams& Params);
+
+	static bool MatchesRecipe(const FCustomizationMergedMeshCacheEntry& Entry,
+	                          const TArray<USkeletalMesh*>& SourceMeshes, const FSkeletalMeshMergeParams& Params);
+
+	/** Evicts unreferenced entries until total size fits budget */
+	void TrimToBudget();
+
+	void RemoveEntry(uint32 RecipeHash);
+
+	UPROPERTY(Transient)
+	TMap<uint32, FCustomizationMergedMeshCacheEntry> Entries;
+
+	TMap<TObjectKey<USkeletalMesh>, uint32> RecipeHashByMesh;
+
+	int64 TotalResourceSizeBytes = 0;
+	int32 Hits = 0;
+	int32 Misses = 0;
+	int32 Evictions = 0;
+};
@@ -12,6 +12,8 @@ class UCustomizationElementaryAsset;
 
 /**
 * Struct containing all parameters used to perform a Skeletal Mesh merge.
+* Every field is part of merged mesh cache recipe (UCustomizationMergedMeshCache), fields added here have to be added there too.
+* Unlike the engine version, section mappings and UV transforms aren't supported, meshes are merged with empty ones.
 */
 USTRUCT(BlueprintType)
 struct ECRCOMMON_API FSkeletalMeshMergeParams